@@ -0,0 +1,178 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Benchmarks for FcgiRecordDecoder in isolation from sockets and from the
+// processing of records.
+//
+// * BM_DecodeSynthetic decodes a 64 MiB stream of FCGI_STDIN records with
+//   range(0) bytes of content and 7 bytes of padding. The stream is given to
+//   the decoder in spans of range(1) bytes. 512 B is the span of a read of
+//   FcgiServerInterface and of TestFcgiClientInterface.
+// * BM_DecodeCapture decodes the file which is named by the environment
+//   variable FCGI_RECORD_CAPTURE in spans of range(0) bytes. The file is a
+//   captured stream of records, for example the bytes which a web server
+//   sent on a connection. The file is mapped into memory and is read once
+//   before timing starts. The benchmark is skipped if the variable is not
+//   set.
+//
+// The handler counts records and sums content lengths so that no part of
+// decoding is optimized away. Bytes processed are the bytes of the stream.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "googlebenchmark/include/benchmark/benchmark.h"
+
+#include "fcgi/include/fcgi_protocol_constants.h"
+#include "fcgi/include/fcgi_record_decoder.h"
+
+namespace {
+
+using as_components::fcgi::FCGI_HEADER_LEN;
+using as_components::fcgi::FCGI_VERSION_1;
+using as_components::fcgi::FcgiRecordDecoder;
+using as_components::fcgi::FcgiType;
+
+struct CountingHandler
+{
+  inline void OnHeader(const FcgiRecordDecoder::Header&) noexcept
+  {}
+
+  inline void OnContent(const std::uint8_t* begin, const std::uint8_t* end)
+    noexcept
+  {
+    content_bytes += static_cast<std::size_t>(end - begin);
+  }
+
+  inline void OnRecordEnd() noexcept
+  {
+    ++records;
+  }
+
+  std::size_t records       {0U};
+  std::size_t content_bytes {0U};
+};
+
+void DecodeInSpans(const std::uint8_t* data, std::size_t size,
+  std::size_t span, benchmark::State& state)
+{
+  for(auto _ : state)
+  {
+    FcgiRecordDecoder decoder {};
+    CountingHandler handler {};
+    for(std::size_t i {0U}; i < size; i += span)
+    {
+      std::size_t end {((size - i) > span) ? (i + span) : size};
+      decoder.Decode(data + i, data + end, &handler);
+    }
+    benchmark::DoNotOptimize(handler.records);
+    benchmark::DoNotOptimize(handler.content_bytes);
+  }
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+    static_cast<std::int64_t>(size));
+}
+
+void BM_DecodeSynthetic(benchmark::State& state)
+{
+  constexpr std::size_t kStreamLength {64U * 1024U * 1024U};
+  constexpr std::uint8_t kPaddingLength {7U};
+  const std::size_t content_length {static_cast<std::size_t>(
+    state.range(0))};
+  const std::size_t span {static_cast<std::size_t>(state.range(1))};
+
+  std::vector<std::uint8_t> stream {};
+  stream.reserve(kStreamLength + FCGI_HEADER_LEN + content_length +
+    kPaddingLength);
+  while(stream.size() < kStreamLength)
+  {
+    const std::uint8_t header[FCGI_HEADER_LEN] = {FCGI_VERSION_1,
+      static_cast<std::uint8_t>(FcgiType::kFCGI_STDIN), 0U, 1U,
+      static_cast<std::uint8_t>(content_length >> 8U),
+      static_cast<std::uint8_t>(content_length), kPaddingLength, 0U};
+    stream.insert(stream.end(), header, header + FCGI_HEADER_LEN);
+    stream.insert(stream.end(), content_length + kPaddingLength, 'c');
+  }
+  DecodeInSpans(stream.data(), stream.size(), span, state);
+}
+
+void BM_DecodeCapture(benchmark::State& state)
+{
+  const char* path {std::getenv("FCGI_RECORD_CAPTURE")};
+  if(path == nullptr)
+  {
+    state.SkipWithError("FCGI_RECORD_CAPTURE is not set.");
+    return;
+  }
+  int descriptor {open(path, O_RDONLY)};
+  struct stat file_status {};
+  if((descriptor == -1) || (fstat(descriptor, &file_status) == -1) ||
+     (file_status.st_size == 0))
+  {
+    if(descriptor != -1)
+      close(descriptor);
+    state.SkipWithError("The capture file could not be read.");
+    return;
+  }
+  std::size_t size {static_cast<std::size_t>(file_status.st_size)};
+  void* mapping {mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0)};
+  close(descriptor);
+  if(mapping == MAP_FAILED)
+  {
+    state.SkipWithError("The capture file could not be mapped.");
+    return;
+  }
+  const std::uint8_t* data {static_cast<const std::uint8_t*>(mapping)};
+  // Fault in the mapping so that the first iteration does not measure
+  // disk reads.
+  std::uint8_t sum {0U};
+  for(std::size_t i {0U}; i < size; i += 4096U)
+    sum += data[i];
+  benchmark::DoNotOptimize(sum);
+
+  DecodeInSpans(data, size, static_cast<std::size_t>(state.range(0)), state);
+  munmap(mapping, size);
+}
+
+// {content length, span}
+BENCHMARK(BM_DecodeSynthetic)
+  ->Args({0, 512})
+  ->Args({8, 512})
+  ->Args({1024, 512})
+  ->Args({8192, 512})
+  ->Args({65535, 512})
+  ->Args({1024, 1})
+  ->Args({1024, 65536})
+  ->Args({65535, 65536});
+
+// {span}
+BENCHMARK(BM_DecodeCapture)
+  ->Arg(512)
+  ->Arg(65536);
+
+} // namespace
@@ -0,0 +1,129 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// A reconnection storm benchmark for connection acceptance by
+// FcgiServerInterface. A web server which is reloaded closes its connections
+// to an application server and then opens many new connections at once.
+//
+// Each iteration:
+// 1) range(0) AF_UNIX client sockets are connected to the listening socket of
+//    an interface.
+// 2) AcceptRequests is called until all of the connections were accepted.
+// 3) The client sockets are closed. The interface observes the closures
+//    during the calls of AcceptRequests of the next iteration. As such, the
+//    interface is constructed to allow two iterations of connections.
+//    Since FcgiServerInterface uses select, range(0) is limited so that all
+//    descriptors are less than FD_SETSIZE.
+//
+// The counter accept_batches_per_iteration shows how many calls of
+// AcceptRequests were needed to accept range(0) connections given
+// FcgiServerInterface::kAcceptBatchLimit.
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "googlebenchmark/include/benchmark/benchmark.h"
+
+#include "fcgi/include/fcgi_server_interface.h"
+
+namespace {
+
+constexpr const char*const kSocketPath
+  {"/tmp/fcgi_server_interface_accept_benchmark_socket"};
+
+void BM_ReconnectStorm(benchmark::State& state)
+{
+  using as_components::fcgi::FcgiServerInterface;
+
+  // Closed connections may be written to by the interface.
+  signal(SIGPIPE, SIG_IGN);
+  const int connection_count {static_cast<int>(state.range(0))};
+
+  int listening_descriptor {socket(AF_UNIX, SOCK_STREAM, 0)};
+  struct sockaddr_un address {};
+  address.sun_family = AF_UNIX;
+  std::strcpy(address.sun_path, kSocketPath);
+  struct sockaddr* address_ptr {static_cast<struct sockaddr*>(
+    static_cast<void*>(&address))};
+  unlink(kSocketPath);
+  if((listening_descriptor == -1)                                        ||
+     (bind(listening_descriptor, address_ptr, sizeof(address)) == -1)   ||
+     (listen(listening_descriptor, 2 * connection_count) == -1))
+  {
+    state.SkipWithError(std::strerror(errno));
+    return;
+  }
+
+  {
+    FcgiServerInterface inter {listening_descriptor, 2 * connection_count,
+      1};
+    std::vector<int> clients(connection_count, -1);
+    std::uint64_t initial_batches
+      {inter.connection_acceptance_counters().accept_batches};
+    for(auto _ : state)
+    {
+      for(int& client : clients)
+      {
+        client = socket(AF_UNIX, SOCK_STREAM, 0);
+        if((client == -1) ||
+           (connect(client, address_ptr, sizeof(address)) == -1))
+        {
+          state.SkipWithError(std::strerror(errno));
+          break;
+        }
+      }
+      std::uint64_t target {inter.connection_acceptance_counters().accepted
+        + static_cast<std::uint64_t>(connection_count)};
+      while(inter.connection_acceptance_counters().accepted < target)
+        inter.AcceptRequests();
+      for(int& client : clients)
+      {
+        close(client);
+        client = -1;
+      }
+    }
+    for(int client : clients)
+    {
+      if(client != -1)
+        close(client);
+    }
+    state.SetItemsProcessed(state.iterations() * connection_count);
+    state.counters["accept_batches_per_iteration"] = benchmark::Counter(
+      static_cast<double>(inter.connection_acceptance_counters().accept_batches
+        - initial_batches), benchmark::Counter::kAvgIterations);
+  }
+  close(listening_descriptor);
+  unlink(kSocketPath);
+}
+
+BENCHMARK(BM_ReconnectStorm)->Arg(16)->Arg(64)->Arg(256)->Arg(448)
+  ->Unit(benchmark::kMicrosecond);
+
+} // namespace
@@ -0,0 +1,397 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// An end-to-end, in-process benchmark of FcgiServerInterface. This is the
+// reference measurement for changes to the fcgi library.
+//
+// Arguments: range(0): transport (0 for AF_UNIX, 1 for loopback AF_INET,
+//                      2 for connections created by CreateLoopbackConnection)
+//            range(1): client connections
+//            range(2): requests in flight per connection (multiplexing depth)
+//            range(3): worker threads (0: requests are serviced by the
+//                      interface thread)
+//
+// Setup: an interface is created on a server thread. The server thread calls
+// AcceptRequests in a loop and gives each FcgiRequest to the worker pool. A
+// worker writes a short FCGI_STDOUT response and calls Complete.
+// A TestFcgiClientInterface on the benchmark thread opens the connections and
+// sends depth Responder requests on each. For transport 2, the server thread
+// creates the connections and the client adopts them. The listening socket is
+// then only used to wake the server thread for shutdown.
+//
+// Each iteration: one response is retrieved and a new request is sent on the
+// connection of the response. The number of requests in flight is constant.
+//
+// Reported values:
+// items_per_second:     completed requests per second.
+// p50_us, p99_us,
+// p999_us:              latency from SendRequest to the receipt of the
+//                       response.
+// cpu_us_per_request:   user and system CPU time of the process per request.
+//                       The client and the server share the process, so this
+//                       is an upper bound for the server.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "googlebenchmark/include/benchmark/benchmark.h"
+
+#include "fcgi/include/fcgi_protocol_constants.h"
+#include "fcgi/include/fcgi_request.h"
+#include "fcgi/include/fcgi_request_identifier.h"
+#include "fcgi/include/fcgi_server_interface.h"
+#include "fcgi/test/include/test_fcgi_client_interface.h"
+
+namespace {
+
+using as_components::fcgi::FCGI_RESPONDER;
+using as_components::fcgi::FcgiRequest;
+using as_components::fcgi::FcgiRequestIdentifier;
+using as_components::fcgi::FcgiServerInterface;
+using as_components::fcgi::test::FcgiRequestDataReference;
+using as_components::fcgi::test::FcgiResponse;
+using as_components::fcgi::test::ParamsMap;
+using as_components::fcgi::test::ServerEvent;
+using as_components::fcgi::test::TestFcgiClientInterface;
+
+constexpr const char*const kSocketPath
+  {"/tmp/fcgi_server_interface_end_to_end_benchmark_socket"};
+
+const std::uint8_t kResponse[] {"Content-Type: text/plain\r\n\r\n"
+  "Hello, world!\n"};
+
+void Respond(FcgiRequest* request_ptr)
+{
+  request_ptr->Write(kResponse, kResponse + sizeof(kResponse) - 1);
+  request_ptr->Complete(EXIT_SUCCESS);
+}
+
+// A fixed pool of threads which service requests from a shared queue.
+class WorkerPool {
+ public:
+  explicit WorkerPool(int worker_count)
+  {
+    for(int i {0}; i < worker_count; ++i)
+      workers_.emplace_back(&WorkerPool::Work, this);
+  }
+
+  ~WorkerPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock {mutex_};
+      stop_ = true;
+    }
+    condition_.notify_all();
+    for(std::thread& worker : workers_)
+      worker.join();
+  }
+
+  void Submit(std::vector<FcgiRequest>* requests_ptr)
+  {
+    {
+      std::lock_guard<std::mutex> lock {mutex_};
+      for(FcgiRequest& request : *requests_ptr)
+        queue_.push_back(std::move(request));
+    }
+    condition_.notify_all();
+  }
+
+ private:
+  void Work()
+  {
+    std::unique_lock<std::mutex> lock {mutex_};
+    while(true)
+    {
+      condition_.wait(lock, [this]()->bool
+        {return stop_ || !queue_.empty();});
+      if(queue_.empty())
+        return;
+      FcgiRequest request {std::move(queue_.front())};
+      queue_.pop_front();
+      lock.unlock();
+      Respond(&request);
+      lock.lock();
+    }
+  }
+
+  std::mutex              mutex_     {};
+  std::condition_variable condition_ {};
+  std::deque<FcgiRequest> queue_     {};
+  bool                    stop_      {false};
+  std::vector<std::thread> workers_  {};
+};
+
+// Creates, binds, and listens on a socket. Returns -1 on failure. For AF_INET,
+// *port_ptr is set to the ephemeral port in network byte order.
+int CreateListeningSocket(bool use_inet, int backlog, in_port_t* port_ptr)
+{
+  int listening_descriptor {socket(use_inet ? AF_INET : AF_UNIX,
+    SOCK_STREAM, 0)};
+  if(listening_descriptor == -1)
+    return -1;
+  int bind_return {};
+  if(use_inet)
+  {
+    struct sockaddr_in address {};
+    address.sin_family      = AF_INET;
+    address.sin_port        = 0U;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    // Accepted connections inherit TCP_NODELAY from the listening socket on
+    // Linux. Without it, the separate writes of Write and Complete interact
+    // with delayed acknowledgement and add tens of milliseconds per request.
+    int no_delay {1};
+    setsockopt(listening_descriptor, IPPROTO_TCP, TCP_NODELAY, &no_delay,
+      sizeof(no_delay));
+    bind_return = bind(listening_descriptor, static_cast<struct sockaddr*>(
+      static_cast<void*>(&address)), sizeof(address));
+    socklen_t length {sizeof(address)};
+    if((bind_return != -1) &&
+       (getsockname(listening_descriptor, static_cast<struct sockaddr*>(
+         static_cast<void*>(&address)), &length) != -1))
+      *port_ptr = address.sin_port;
+  }
+  else
+  {
+    struct sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, kSocketPath);
+    unlink(kSocketPath);
+    bind_return = bind(listening_descriptor, static_cast<struct sockaddr*>(
+      static_cast<void*>(&address)), sizeof(address));
+  }
+  if((bind_return == -1) || (listen(listening_descriptor, backlog) == -1))
+  {
+    close(listening_descriptor);
+    return -1;
+  }
+  return listening_descriptor;
+}
+
+double CpuMicroseconds()
+{
+  struct rusage usage {};
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6 +
+    (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+void BM_EndToEnd(benchmark::State& state)
+{
+  using Clock = std::chrono::steady_clock;
+
+  signal(SIGPIPE, SIG_IGN);
+  const bool use_inet        {state.range(0) == 1};
+  const bool use_loopback    {state.range(0) == 2};
+  const int  connection_count {static_cast<int>(state.range(1))};
+  const int  depth           {static_cast<int>(state.range(2))};
+  const int  worker_count    {static_cast<int>(state.range(3))};
+
+  in_port_t port {0U};
+  // One extra connection is used to wake the server thread for shutdown.
+  int listening_descriptor {CreateListeningSocket(use_inet,
+    connection_count + 1, &port)};
+  if(listening_descriptor == -1)
+  {
+    state.SkipWithError(std::strerror(errno));
+    return;
+  }
+
+  std::atomic<bool> server_ready {false};
+  std::atomic<bool> stop_server  {false};
+  // Written by the server thread before server_ready is set.
+  std::vector<int>  loopback_connections {};
+  std::thread server {[&]()->void
+  {
+    FcgiServerInterface inter {listening_descriptor, connection_count + 1,
+      depth};
+    WorkerPool pool {worker_count};
+    for(int i {0}; use_loopback && (i < connection_count); ++i)
+      loopback_connections.push_back(inter.CreateLoopbackConnection());
+    server_ready.store(true);
+    while(!stop_server.load())
+    {
+      std::vector<FcgiRequest> requests {inter.AcceptRequests()};
+      if(worker_count == 0)
+      {
+        for(FcgiRequest& request : requests)
+          Respond(&request);
+      }
+      else
+        pool.Submit(&requests);
+    }
+  }};
+  while(!server_ready.load())
+    std::this_thread::yield();
+
+  const char* address {use_inet ? "127.0.0.1" : kSocketPath};
+  const ParamsMap params {
+    {{'R','E','Q','U','E','S','T','_','M','E','T','H','O','D'}, {'G','E','T'}},
+    {{'S','C','R','I','P','T','_','N','A','M','E'}, {'/','b','e','n','c','h'}},
+    {{'S','E','R','V','E','R','_','P','R','O','T','O','C','O','L'},
+      {'H','T','T','P','/','1','.','1'}}
+  };
+  const FcgiRequestDataReference request {FCGI_RESPONDER, true, &params,
+    nullptr, nullptr, nullptr, nullptr};
+
+  {
+    TestFcgiClientInterface client {};
+    std::map<FcgiRequestIdentifier, Clock::time_point> send_times {};
+    std::vector<std::int64_t> latencies {};
+    auto Send = [&](int connection)->bool
+    {
+      Clock::time_point now {Clock::now()};
+      FcgiRequestIdentifier id {client.SendRequest(connection, request)};
+      if(id == FcgiRequestIdentifier {})
+        return false;
+      send_times[id] = now;
+      return true;
+    };
+    // Returns the connection of the next response or -1 on an unexpected
+    // event.
+    auto Receive = [&]()->int
+    {
+      std::unique_ptr<ServerEvent> event {client.RetrieveServerEvent()};
+      FcgiResponse* response_ptr {dynamic_cast<FcgiResponse*>(event.get())};
+      if(response_ptr == nullptr)
+        return -1;
+      FcgiRequestIdentifier id {response_ptr->RequestId()};
+      Clock::time_point now {Clock::now()};
+      std::map<FcgiRequestIdentifier, Clock::time_point>::iterator
+        time_iter {send_times.find(id)};
+      latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        now - time_iter->second).count());
+      send_times.erase(time_iter);
+      client.ReleaseId(id);
+      return id.descriptor();
+    };
+
+    bool setup_error {false};
+    // Every loopback connection is adopted so that the client closes it.
+    for(int& loopback : loopback_connections)
+    {
+      if(loopback == -1)
+        setup_error = true;
+      else
+        client.AdoptConnection(loopback);
+    }
+    for(int i {0}; (i < connection_count) && !setup_error; ++i)
+    {
+      int connection {use_loopback ? loopback_connections[i] :
+        client.Connect(address, port)};
+      setup_error = (connection == -1);
+      if(use_inet && !setup_error)
+      {
+        // TestFcgiClientInterface writes the streams of a request separately.
+        int no_delay {1};
+        setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &no_delay,
+          sizeof(no_delay));
+      }
+      for(int j {0}; (j < depth) && !setup_error; ++j)
+        setup_error = !Send(connection);
+    }
+    if(setup_error)
+      state.SkipWithError("Connection or request transmission failed.");
+    else
+    {
+      double cpu_start {CpuMicroseconds()};
+      for(auto _ : state)
+      {
+        int connection {Receive()};
+        if((connection == -1) || !Send(connection))
+        {
+          state.SkipWithError("An unexpected server event occurred.");
+          break;
+        }
+      }
+      double cpu_used {CpuMicroseconds() - cpu_start};
+      while(send_times.size() && (Receive() != -1))
+        continue;
+
+      state.SetItemsProcessed(state.iterations());
+      if(latencies.size())
+      {
+        auto Percentile = [&latencies](double p)->double
+        {
+          std::vector<std::int64_t>::iterator nth {latencies.begin() +
+            static_cast<std::ptrdiff_t>(p * (latencies.size() - 1))};
+          std::nth_element(latencies.begin(), nth, latencies.end());
+          return *nth / 1e3;
+        };
+        state.counters["p50_us"]  = Percentile(0.5);
+        state.counters["p99_us"]  = Percentile(0.99);
+        state.counters["p999_us"] = Percentile(0.999);
+      }
+      if(state.iterations())
+        state.counters["cpu_us_per_request"] = cpu_used / state.iterations();
+    }
+
+    // Wake the server thread with a new connection so that it observes
+    // stop_server.
+    stop_server.store(true);
+    client.Connect(address, port);
+    server.join();
+  } // The client closes its connections.
+  close(listening_descriptor);
+  if(!use_inet)
+    unlink(kSocketPath);
+}
+
+// {transport, connections, depth, workers}
+BENCHMARK(BM_EndToEnd)
+  ->Args({0, 1, 1, 0})
+  ->Args({0, 1, 1, 4})
+  ->Args({0, 8, 1, 4})
+  ->Args({0, 8, 8, 4})
+  ->Args({0, 64, 4, 8})
+  ->Args({1, 1, 1, 0})
+  ->Args({1, 8, 8, 4})
+  ->Args({1, 64, 4, 8})
+  ->Args({2, 1, 1, 0})
+  ->Args({2, 8, 8, 4})
+  ->Args({2, 64, 4, 8})
+  ->Unit(benchmark::kMicrosecond)
+  ->UseRealTime();
+
+} // namespace
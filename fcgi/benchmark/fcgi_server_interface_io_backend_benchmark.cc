@@ -0,0 +1,140 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Compares the I/O multiplexing backends of FcgiServerInterface
+// (IoBackend::kSelect and IoBackend::kIoUring) for an interface which has
+// many idle connections and one active connection. This is the usual state of
+// an application server behind a web server which keeps connections open.
+//
+// Setup: range(0) idle AF_UNIX clients and one active client are connected
+// and accepted.
+//
+// Each iteration: the active client writes an empty FCGI_GET_VALUES record,
+// AcceptRequests is called once, and the client reads the
+// FCGI_GET_VALUES_RESULT response.
+//
+// With select, each call sets and scans a bit for every connection. With
+// io_uring, only the active connection is examined and re-armed. Since select is used for
+// comparison, range(0) is limited so that all descriptors are less than
+// FD_SETSIZE. The io_uring benchmark is skipped if io_uring is not available.
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "googlebenchmark/include/benchmark/benchmark.h"
+
+#include "fcgi/include/fcgi_protocol_constants.h"
+#include "fcgi/include/fcgi_server_interface.h"
+#include "fcgi/include/fcgi_utilities.h"
+
+namespace {
+
+constexpr const char*const kSocketPath
+  {"/tmp/fcgi_server_interface_io_backend_benchmark_socket"};
+
+using as_components::fcgi::FcgiServerInterface;
+
+template<FcgiServerInterface::IoBackend backend>
+void BM_IdleConnectionsGetValues(benchmark::State& state)
+{
+  using as_components::fcgi::FCGI_HEADER_LEN;
+  using as_components::fcgi::FcgiType;
+
+  signal(SIGPIPE, SIG_IGN);
+  const int idle_count {static_cast<int>(state.range(0))};
+  const int client_count {idle_count + 1};
+
+  int listening_descriptor {socket(AF_UNIX, SOCK_STREAM, 0)};
+  struct sockaddr_un address {};
+  address.sun_family = AF_UNIX;
+  std::strcpy(address.sun_path, kSocketPath);
+  struct sockaddr* address_ptr {static_cast<struct sockaddr*>(
+    static_cast<void*>(&address))};
+  unlink(kSocketPath);
+  if((listening_descriptor == -1)                                        ||
+     (bind(listening_descriptor, address_ptr, sizeof(address)) == -1)   ||
+     (listen(listening_descriptor, client_count) == -1))
+  {
+    state.SkipWithError(std::strerror(errno));
+    return;
+  }
+
+  {
+    FcgiServerInterface inter {listening_descriptor, client_count, 1,
+      EXIT_FAILURE, backend};
+    std::vector<int> clients {};
+    if(inter.io_backend() != backend)
+      state.SkipWithError("io_uring is not available.");
+    else
+    {
+      for(int i {0}; i < client_count; ++i)
+      {
+        int client {socket(AF_UNIX, SOCK_STREAM, 0)};
+        if(client == -1)
+          break;
+        clients.push_back(client);
+        if(connect(client, address_ptr, sizeof(address)) == -1)
+          break;
+      }
+      if(clients.size() != static_cast<std::size_t>(client_count))
+        state.SkipWithError(std::strerror(errno));
+      while(inter.connection_count() < clients.size())
+        inter.AcceptRequests();
+    }
+
+    std::uint8_t header[FCGI_HEADER_LEN];
+    as_components::fcgi::PopulateHeader(header, FcgiType::kFCGI_GET_VALUES,
+      0U, 0U, 0U);
+    std::uint8_t response[128U];
+    int active {(clients.size()) ? clients.back() : -1};
+    for(auto _ : state)
+    {
+      if((write(active, header, FCGI_HEADER_LEN) != FCGI_HEADER_LEN) ||
+         (inter.AcceptRequests().size() != 0U)                        ||
+         (read(active, response, sizeof(response)) < FCGI_HEADER_LEN))
+      {
+        state.SkipWithError("A FCGI_GET_VALUES exchange failed.");
+        break;
+      }
+    }
+    for(int client : clients)
+      close(client);
+  }
+  close(listening_descriptor);
+  unlink(kSocketPath);
+}
+
+BENCHMARK_TEMPLATE(BM_IdleConnectionsGetValues,
+  FcgiServerInterface::IoBackend::kSelect)
+  ->Arg(0)->Arg(64)->Arg(256)->Arg(448)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_IdleConnectionsGetValues,
+  FcgiServerInterface::IoBackend::kIoUring)
+  ->Arg(0)->Arg(64)->Arg(256)->Arg(448)->Unit(benchmark::kMicrosecond);
+
+} // namespace
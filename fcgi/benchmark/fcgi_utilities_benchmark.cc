@@ -0,0 +1,287 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Benchmarks for the encoding and decoding primitives of fcgi_utilities.h
+// which are used for every request.
+//
+// * Name-value pair encoding and decoding are measured for the FCGI_PARAMS
+//   stream which nginx sends with its default fastcgi_params file and for a
+//   single pair whose value has range(0) bytes. Names and values which are
+//   longer than 127 bytes use four-byte lengths.
+// * PartitionByteSequence is measured for writes of range(0) bytes from 1 B
+//   to 16 MiB. Each iteration partitions the whole sequence as
+//   FcgiRequest::Write does.
+// * The length and header primitives are measured for a single call.
+//
+// Bytes processed are the bytes of the encoded or decoded content. Encoding
+// and partitioning reference content through struct iovec instances rather
+// than copying it, so their throughput grows with content size.
+
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "googlebenchmark/include/benchmark/benchmark.h"
+
+#include "fcgi/include/fcgi_protocol_constants.h"
+#include "fcgi/include/fcgi_utilities.h"
+
+namespace {
+
+using as_components::fcgi::FCGI_HEADER_LEN;
+using as_components::fcgi::FcgiType;
+
+using ByteSequence = std::vector<std::uint8_t>;
+using PairList = std::vector<std::pair<ByteSequence, ByteSequence>>;
+
+ByteSequence ToBytes(const std::string& s)
+{
+  return ByteSequence(s.begin(), s.end());
+}
+
+// The FCGI_PARAMS content which nginx produces for a typical browser GET
+// request with its default fastcgi_params file.
+PairList NginxParams()
+{
+  const std::vector<std::pair<std::string, std::string>> params {
+    {"QUERY_STRING", "page=2&sort=desc&filter=active"},
+    {"REQUEST_METHOD", "GET"},
+    {"CONTENT_TYPE", ""},
+    {"CONTENT_LENGTH", ""},
+    {"SCRIPT_NAME", "/index.php"},
+    {"REQUEST_URI", "/articles/index.php?page=2&sort=desc&filter=active"},
+    {"DOCUMENT_URI", "/articles/index.php"},
+    {"DOCUMENT_ROOT", "/var/www/html"},
+    {"SERVER_PROTOCOL", "HTTP/1.1"},
+    {"REQUEST_SCHEME", "https"},
+    {"HTTPS", "on"},
+    {"GATEWAY_INTERFACE", "CGI/1.1"},
+    {"SERVER_SOFTWARE", "nginx/1.18.0"},
+    {"REMOTE_ADDR", "203.0.113.57"},
+    {"REMOTE_PORT", "51324"},
+    {"SERVER_ADDR", "192.0.2.10"},
+    {"SERVER_PORT", "443"},
+    {"SERVER_NAME", "www.example.com"},
+    {"REDIRECT_STATUS", "200"},
+    {"SCRIPT_FILENAME", "/var/www/html/articles/index.php"},
+    {"HTTP_HOST", "www.example.com"},
+    {"HTTP_USER_AGENT", "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+      "(KHTML, like Gecko) Chrome/90.0.4430.93 Safari/537.36"},
+    {"HTTP_ACCEPT", "text/html,application/xhtml+xml,application/xml;q=0.9,"
+      "image/avif,image/webp,*/*;q=0.8"},
+    {"HTTP_ACCEPT_LANGUAGE", "en-US,en;q=0.5"},
+    {"HTTP_ACCEPT_ENCODING", "gzip, deflate, br"},
+    {"HTTP_CONNECTION", "keep-alive"},
+    {"HTTP_REFERER", "https://www.example.com/articles/index.php?page=1"},
+    {"HTTP_COOKIE", "session_id=" + std::string(64, 'a') +
+      "; preferences=" + std::string(96, 'b') + "; tracking=" +
+      std::string(48, 'c')},
+    {"HTTP_UPGRADE_INSECURE_REQUESTS", "1"}
+  };
+  PairList pairs {};
+  for(const std::pair<std::string, std::string>& p : params)
+    pairs.emplace_back(ToBytes(p.first), ToBytes(p.second));
+  return pairs;
+}
+
+PairList LargeValueParams(std::size_t value_length)
+{
+  PairList pairs {};
+  pairs.emplace_back(ToBytes("HTTP_X_LARGE_HEADER"),
+    ByteSequence(value_length, 'v'));
+  return pairs;
+}
+
+// Encodes pairs in the FastCGI name-value pair format without record
+// headers. This is the form which ExtractBinaryNameValuePairs accepts.
+ByteSequence EncodeContent(const PairList& pairs)
+{
+  ByteSequence content {};
+  auto AppendLength = [&content](std::size_t length)->void
+  {
+    if(length <= 127U)
+      content.push_back(static_cast<std::uint8_t>(length));
+    else
+    {
+      std::uint8_t encoded_length[4];
+      as_components::fcgi::EncodeFourByteLength(
+        static_cast<std::int_fast32_t>(length), encoded_length);
+      content.insert(content.end(), encoded_length, encoded_length + 4);
+    }
+  };
+  for(const std::pair<ByteSequence, ByteSequence>& pair : pairs)
+  {
+    AppendLength(pair.first.size());
+    AppendLength(pair.second.size());
+    content.insert(content.end(), pair.first.begin(), pair.first.end());
+    content.insert(content.end(), pair.second.begin(), pair.second.end());
+  }
+  return content;
+}
+
+// Encodes all of pairs with as many calls to EncodeNameValuePairs as are
+// needed. Returns false if encoding failed.
+bool EncodeAll(const PairList& pairs)
+{
+  PairList::const_iterator pair_iter {pairs.cbegin()};
+  PairList::const_iterator end {pairs.cend()};
+  std::size_t offset {0U};
+  while(pair_iter != end)
+  {
+    std::tuple<bool, std::size_t, std::vector<struct iovec>, int,
+      ByteSequence, std::size_t, PairList::const_iterator>
+    result {as_components::fcgi::EncodeNameValuePairs(pair_iter, end,
+      FcgiType::kFCGI_PARAMS, 1U, offset)};
+    if(!std::get<0>(result))
+      return false;
+    benchmark::DoNotOptimize(std::get<2>(result).data());
+    offset    = std::get<5>(result);
+    pair_iter = std::get<6>(result);
+  }
+  return true;
+}
+
+void EncodeNameValuePairsBenchmark(benchmark::State& state,
+  const PairList& pairs)
+{
+  for(auto _ : state)
+  {
+    if(!EncodeAll(pairs))
+    {
+      state.SkipWithError("EncodeNameValuePairs failed.");
+      break;
+    }
+  }
+  state.SetBytesProcessed(state.iterations() *
+    static_cast<std::int64_t>(EncodeContent(pairs).size()));
+}
+
+void ExtractBinaryNameValuePairsBenchmark(benchmark::State& state,
+  const PairList& pairs)
+{
+  const ByteSequence content {EncodeContent(pairs)};
+  for(auto _ : state)
+  {
+    benchmark::DoNotOptimize(as_components::fcgi::
+      ExtractBinaryNameValuePairs(content.data(), content.size()).size());
+  }
+  state.SetBytesProcessed(state.iterations() *
+    static_cast<std::int64_t>(content.size()));
+}
+
+void BM_EncodeNameValuePairsNginx(benchmark::State& state)
+{
+  EncodeNameValuePairsBenchmark(state, NginxParams());
+}
+BENCHMARK(BM_EncodeNameValuePairsNginx);
+
+void BM_EncodeNameValuePairsLargeValue(benchmark::State& state)
+{
+  EncodeNameValuePairsBenchmark(state,
+    LargeValueParams(static_cast<std::size_t>(state.range(0))));
+}
+BENCHMARK(BM_EncodeNameValuePairsLargeValue)->RangeMultiplier(16)
+  ->Range(128, 1 << 20);
+
+void BM_ExtractBinaryNameValuePairsNginx(benchmark::State& state)
+{
+  ExtractBinaryNameValuePairsBenchmark(state, NginxParams());
+}
+BENCHMARK(BM_ExtractBinaryNameValuePairsNginx);
+
+void BM_ExtractBinaryNameValuePairsLargeValue(benchmark::State& state)
+{
+  ExtractBinaryNameValuePairsBenchmark(state,
+    LargeValueParams(static_cast<std::size_t>(state.range(0))));
+}
+BENCHMARK(BM_ExtractBinaryNameValuePairsLargeValue)->RangeMultiplier(16)
+  ->Range(128, 1 << 20);
+
+void BM_PartitionByteSequence(benchmark::State& state)
+{
+  const ByteSequence data(static_cast<std::size_t>(state.range(0)), 'd');
+  for(auto _ : state)
+  {
+    ByteSequence::const_iterator begin_iter {data.cbegin()};
+    ByteSequence::const_iterator end_iter {data.cend()};
+    while(begin_iter != end_iter)
+    {
+      std::tuple<ByteSequence, std::vector<struct iovec>, std::size_t,
+        ByteSequence::const_iterator>
+      result {as_components::fcgi::PartitionByteSequence(begin_iter,
+        end_iter, FcgiType::kFCGI_STDOUT, 1U)};
+      benchmark::DoNotOptimize(std::get<1>(result).data());
+      begin_iter = std::get<3>(result);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PartitionByteSequence)->RangeMultiplier(16)->Range(1, 1 << 24);
+
+void BM_EncodeFourByteLength(benchmark::State& state)
+{
+  std::uint8_t encoded_length[4];
+  std::int_fast32_t length {1 << 20};
+  for(auto _ : state)
+  {
+    as_components::fcgi::EncodeFourByteLength(length, encoded_length);
+    benchmark::ClobberMemory();
+    // Vary the input so that the encoding is not hoisted.
+    length = (length + 1) & 0x7fffffff;
+  }
+}
+BENCHMARK(BM_EncodeFourByteLength);
+
+void BM_ExtractFourByteLength(benchmark::State& state)
+{
+  std::uint8_t encoded_length[4];
+  as_components::fcgi::EncodeFourByteLength(1 << 20, encoded_length);
+  for(auto _ : state)
+  {
+    benchmark::ClobberMemory();
+    benchmark::DoNotOptimize(as_components::fcgi::
+      ExtractFourByteLength(encoded_length) + 0);
+  }
+}
+BENCHMARK(BM_ExtractFourByteLength);
+
+void BM_PopulateHeader(benchmark::State& state)
+{
+  std::uint8_t header[FCGI_HEADER_LEN];
+  std::uint16_t content_length {0U};
+  for(auto _ : state)
+  {
+    as_components::fcgi::PopulateHeader(header, FcgiType::kFCGI_STDOUT, 1U,
+      content_length, static_cast<std::uint8_t>((8U - (content_length % 8U))
+      % 8U));
+    benchmark::ClobberMemory();
+    ++content_length;
+  }
+}
+BENCHMARK(BM_PopulateHeader);
+
+} // namespace
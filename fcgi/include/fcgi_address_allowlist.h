@@ -0,0 +1,270 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// A set of authorized internet addresses of a single domain (AF_INET or
+// AF_INET6) which is used by FcgiServerInterface to validate the address of
+// the peer of a newly-accepted connection.
+// * Entries are either single addresses or CIDR prefixes as in "10.0.0.0/8"
+//   and "fd00::/8". A single address is a prefix of maximal length.
+// * Entries are added during configuration with AddPrefix. Lookup with
+//   Contains compares the raw bytes of sin_addr or sin6_addr. Lookup does not
+//   allocate and does not convert an address to text.
+//
+// Implementation discussion:
+//    Each prefix is stored as the closed range of addresses which it covers.
+// Two CIDR prefixes either cover disjoint ranges or one covers the other. When
+// a prefix is added, a prefix which is covered by another prefix is discarded.
+// The stored ranges are thus disjoint, and they are kept sorted by their first
+// address. Lookup is a binary search for the last range whose first address
+// is not greater than the address followed by a comparison with the last
+// address of that range.
+
+#ifndef AS_COMPONENTS_FCGI_INCLUDE_FCGI_ADDRESS_ALLOWLIST_H_
+#define AS_COMPONENTS_FCGI_INCLUDE_FCGI_ADDRESS_ALLOWLIST_H_
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace as_components {
+namespace fcgi {
+
+class AddressAllowlist {
+ public:
+  // Adds the address or CIDR prefix described by token to the allowlist.
+  // Returns true if token was well-formed. Returns false otherwise. A
+  // malformed token does not change the allowlist.
+  //
+  // A token is well-formed if it has the form <address> or
+  // <address>/<length> where:
+  // 1) inet_pton accepts <address> for the domain of the allowlist.
+  // 2) <length> is a decimal integer which is not greater than the number of
+  //    bits of an address of the domain.
+  //    Bits of <address> which are not part of the prefix are ignored.
+  //
+  // Preconditions:
+  // 1) token is not null.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception.
+  // 2) Throws std::logic_error if the allowlist was default-constructed.
+  // 3) Throws std::system_error if inet_pton failed with an error.
+  // 4) The strong exception guarantee is provided.
+  bool AddPrefix(const char* token);
+
+  // Returns true if address is of the domain of the allowlist and is covered
+  // by a prefix of the allowlist. Returns false otherwise.
+  //
+  // Preconditions:
+  // 1) address points to a socket address structure which is at least as
+  //    large as the structure indicated by address->sa_family.
+  bool Contains(const struct sockaddr* address) const noexcept;
+
+  inline int domain() const noexcept
+  {
+    return domain_;
+  }
+
+  inline bool empty() const noexcept
+  {
+    return ranges_.empty();
+  }
+
+  // The number of disjoint address ranges of the allowlist. This may be less
+  // than the number of prefixes which were added.
+  inline std::size_t size() const noexcept
+  {
+    return ranges_.size();
+  }
+
+  // Constructs an empty allowlist which has no domain. Entries cannot be added
+  // to it.
+  inline AddressAllowlist() noexcept
+  : domain_         {AF_UNSPEC},
+    address_length_ {0U},
+    ranges_         {}
+  {}
+
+  // Throws std::invalid_argument if domain is neither AF_INET nor AF_INET6.
+  inline explicit AddressAllowlist(int domain)
+  : domain_         {domain},
+    address_length_ {(domain == AF_INET) ?
+      sizeof(struct in_addr) : sizeof(struct in6_addr)},
+    ranges_         {}
+  {
+    if((domain != AF_INET) && (domain != AF_INET6))
+    {
+      throw std::invalid_argument {"An AddressAllowlist may only be "
+        "constructed for AF_INET or AF_INET6."};
+    }
+  }
+
+  AddressAllowlist(const AddressAllowlist&) = default;
+  AddressAllowlist(AddressAllowlist&&) = default;
+  AddressAllowlist& operator=(const AddressAllowlist&) = default;
+  AddressAllowlist& operator=(AddressAllowlist&&) = default;
+
+  ~AddressAllowlist() = default;
+
+ private:
+  // Addresses are stored in network byte order. IPv4 addresses occupy the
+  // first four bytes, and the remaining bytes are zero.
+  using Address = std::array<std::uint8_t, sizeof(struct in6_addr)>;
+
+  struct Range {
+    Address first;
+    Address last;
+  };
+
+  static inline bool Less(const Address& lhs, const Address& rhs) noexcept
+  {
+    return std::memcmp(lhs.data(), rhs.data(), lhs.size()) < 0;
+  }
+
+  int domain_;
+  std::size_t address_length_;
+  std::vector<Range> ranges_;
+};
+
+inline bool AddressAllowlist::AddPrefix(const char* token)
+{
+  if(domain_ == AF_UNSPEC)
+  {
+    throw std::logic_error {"A prefix was added to a default-constructed "
+      "AddressAllowlist."};
+  }
+  const std::size_t bit_count {8U * address_length_};
+  const char* slash_ptr {std::strchr(token, '/')};
+  std::size_t prefix_length {bit_count};
+  if(slash_ptr)
+  {
+    // Between one and three decimal digits are accepted.
+    const char* length_ptr {slash_ptr + 1};
+    std::size_t digit_count {std::strlen(length_ptr)};
+    if((digit_count == 0U) || (digit_count > 3U))
+      return false;
+    prefix_length = 0U;
+    for(std::size_t i {0U}; i < digit_count; ++i)
+    {
+      if((length_ptr[i] < '0') || (length_ptr[i] > '9'))
+        return false;
+      prefix_length = 10U * prefix_length + (length_ptr[i] - '0');
+    }
+    if(prefix_length > bit_count)
+      return false;
+  }
+
+  // inet_pton requires a terminated address string.
+  std::string address_string {(slash_ptr) ?
+    std::string(token, slash_ptr) : std::string(token)};
+  Address address {};
+  int inet_pton_return {inet_pton(domain_, address_string.data(),
+    address.data())};
+  if(inet_pton_return == 0)
+    return false;
+  else if(inet_pton_return == -1)
+  {
+    std::error_code ec {errno, std::system_category()};
+    throw std::system_error {ec, "inet_pton"};
+  }
+
+  Range range {address, address};
+  for(std::size_t i {0U}; i < address_length_; ++i)
+  {
+    std::size_t bit_start {8U * i};
+    std::uint8_t mask {0U};
+    if(prefix_length >= bit_start + 8U)
+      mask = 0xFFU;
+    else if(prefix_length > bit_start)
+      mask = static_cast<std::uint8_t>(0xFFU << (8U - (prefix_length -
+        bit_start)));
+    range.first[i] &= mask;
+    range.last[i]  |= static_cast<std::uint8_t>(~mask);
+  }
+
+  // Find the first range whose first address is greater than the first
+  // address of the new range.
+  std::vector<Range>::iterator position {std::upper_bound(ranges_.begin(),
+    ranges_.end(), range.first, [](const Address& lhs, const Range& rhs)
+    ->bool {return Less(lhs, rhs.first);})};
+  // Is the new range covered by the preceding range?
+  if((position != ranges_.begin()) &&
+     !Less(std::prev(position)->last, range.first))
+    return true;
+  // Ranges which are covered by the new range follow it.
+  std::vector<Range>::iterator covered_end {position};
+  while((covered_end != ranges_.end()) &&
+        !Less(range.last, covered_end->first))
+    ++covered_end;
+  if(position == covered_end)
+    ranges_.insert(position, range); // May throw.
+  else
+  {
+    *position = range;
+    ranges_.erase(std::next(position), covered_end);
+  }
+  return true;
+}
+
+inline bool AddressAllowlist::Contains(const struct sockaddr* address)
+  const noexcept
+{
+  if(address->sa_family != domain_)
+    return false;
+  Address key {};
+  if(domain_ == AF_INET)
+  {
+    const struct sockaddr_in* inet_address_ptr
+      {static_cast<const struct sockaddr_in*>(static_cast<const void*>(
+        address))};
+    std::memcpy(key.data(), &(inet_address_ptr->sin_addr), address_length_);
+  }
+  else
+  {
+    const struct sockaddr_in6* inet_address_ptr
+      {static_cast<const struct sockaddr_in6*>(static_cast<const void*>(
+        address))};
+    std::memcpy(key.data(), &(inet_address_ptr->sin6_addr), address_length_);
+  }
+  std::vector<Range>::const_iterator position {std::upper_bound(
+    ranges_.begin(), ranges_.end(), key, [](const Address& lhs,
+    const Range& rhs)->bool {return Less(lhs, rhs.first);})};
+  return (position != ranges_.begin()) &&
+         !Less(std::prev(position)->last, key);
+}
+
+} // namespace fcgi
+} // namespace as_components
+
+#endif // AS_COMPONENTS_FCGI_INCLUDE_FCGI_ADDRESS_ALLOWLIST_H_
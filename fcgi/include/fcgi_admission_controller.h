@@ -0,0 +1,210 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// An admission controller which is used by FcgiServerInterface to reject
+// new requests with FCGI_OVERLOADED when the application falls behind.
+// * The controller maintains a limit on the number of requests which are in
+//   flight. A request is in flight from the acceptance of its
+//   FCGI_BEGIN_REQUEST record until its removal from the interface.
+// * Queueing delay is the time from the construction of the FcgiRequest
+//   object of a request to its first write. It measures how long requests
+//   wait for the application to begin service.
+// * The limit is adjusted once per interval. The detection of a standing
+//   queue follows CoDel: the interval is congested if the minimum queueing
+//   delay which was observed during the interval exceeded the target. The
+//   minimum is used as a transient burst does not raise the minimum of an
+//   interval while a standing queue does. The adjustment is AIMD: a
+//   congested interval halves the limit, and an uncongested interval in
+//   which the limit was reached increases it by one.
+// * An AdmissionController performs no synchronization. FcgiServerInterface
+//   accesses its controller under the protection of interface_state_mutex_.
+
+#ifndef AS_COMPONENTS_FCGI_INCLUDE_FCGI_ADMISSION_CONTROLLER_H_
+#define AS_COMPONENTS_FCGI_INCLUDE_FCGI_ADMISSION_CONTROLLER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace as_components {
+namespace fcgi {
+
+class AdmissionController {
+ public:
+  struct Parameters
+  {
+    // The queueing delay above which an interval is congested.
+    std::chrono::nanoseconds target_delay {std::chrono::milliseconds {5}};
+    // The duration over which the minimum queueing delay is measured and
+    // after which the limit is adjusted.
+    std::chrono::nanoseconds interval {std::chrono::milliseconds {100}};
+    // The bounds of the in-flight request limit. The limit starts at
+    // maximum_limit.
+    int minimum_limit {1};
+    int maximum_limit {1024};
+  };
+
+  // Returns true if a request may be accepted when in_flight requests are in
+  // flight. Records that the limit was reached if it was.
+  inline bool Admit(std::size_t in_flight) noexcept
+  {
+    if(in_flight + 1U >= static_cast<std::size_t>(limit_))
+      limit_reached_ = true;
+    if(in_flight < static_cast<std::size_t>(limit_))
+      return true;
+    ++rejections_;
+    return false;
+  }
+
+  // Records the queueing delay of a request.
+  inline void RecordQueueingDelay(std::chrono::nanoseconds delay) noexcept
+  {
+    if((sample_count_ == 0U) || (delay < minimum_delay_))
+      minimum_delay_ = delay;
+    ++sample_count_;
+  }
+
+  // Records the removal of a request which was in flight.
+  inline void RecordCompletion() noexcept
+  {
+    ++completion_count_;
+  }
+
+  // Ends the current interval and adjusts the limit if the interval elapsed
+  // before now. Otherwise, does nothing.
+  //
+  // Effects:
+  // 1) If the interval ended and requests wrote during it:
+  //    a) If the minimum queueing delay exceeded the target, the limit was
+  //       halved. The limit is not reduced below minimum_limit.
+  //    b) Otherwise, if the limit was reached, the limit was incremented.
+  //       The limit is not increased above maximum_limit.
+  // 2) If the interval ended, the completion rate of the interval is
+  //    returned by last_completion_rate, and a new interval was started at
+  //    now.
+  inline void Update(std::chrono::steady_clock::time_point now) noexcept
+  {
+    std::chrono::nanoseconds elapsed {now - interval_start_};
+    if(elapsed < parameters_.interval)
+      return;
+    if(sample_count_)
+    {
+      if(minimum_delay_ > parameters_.target_delay)
+      {
+        limit_ /= 2;
+        if(limit_ < parameters_.minimum_limit)
+          limit_ = parameters_.minimum_limit;
+      }
+      else if(limit_reached_ && (limit_ < parameters_.maximum_limit))
+        ++limit_;
+    }
+    last_minimum_delay_ = (sample_count_) ?
+      minimum_delay_ : std::chrono::nanoseconds::zero();
+    last_completion_rate_ = static_cast<double>(completion_count_) /
+      std::chrono::duration<double> {elapsed}.count();
+    interval_start_   = now;
+    sample_count_     = 0U;
+    completion_count_ = 0U;
+    limit_reached_    = false;
+  }
+
+  // The current in-flight request limit.
+  inline int limit() const noexcept
+  {
+    return limit_;
+  }
+
+  // The minimum queueing delay of the last complete interval. Zero if no
+  // request wrote during the interval.
+  inline std::chrono::nanoseconds last_minimum_delay() const noexcept
+  {
+    return last_minimum_delay_;
+  }
+
+  // Completions per second during the last complete interval.
+  inline double last_completion_rate() const noexcept
+  {
+    return last_completion_rate_;
+  }
+
+  inline const Parameters& parameters() const noexcept
+  {
+    return parameters_;
+  }
+
+  // The number of calls of Admit which returned false.
+  inline std::uint64_t rejections() const noexcept
+  {
+    return rejections_;
+  }
+
+  // Throws std::invalid_argument if:
+  // 1) The target delay is negative or the interval is not positive.
+  // 2) minimum_limit is less than one or maximum_limit is less than
+  //    minimum_limit.
+  inline AdmissionController(const Parameters& parameters,
+    std::chrono::steady_clock::time_point now)
+  : parameters_     {parameters},
+    limit_          {parameters.maximum_limit},
+    interval_start_ {now}
+  {
+    if((parameters.target_delay < std::chrono::nanoseconds::zero()) ||
+       (parameters.interval <= std::chrono::nanoseconds::zero()))
+      throw std::invalid_argument {"An AdmissionController requires a "
+        "non-negative target delay and a positive interval."};
+    if((parameters.minimum_limit < 1) ||
+       (parameters.maximum_limit < parameters.minimum_limit))
+      throw std::invalid_argument {"An AdmissionController requires "
+        "1 <= minimum_limit <= maximum_limit."};
+  }
+
+  AdmissionController() = delete;
+  AdmissionController(const AdmissionController&) = default;
+  AdmissionController(AdmissionController&&) = default;
+  AdmissionController& operator=(const AdmissionController&) = default;
+  AdmissionController& operator=(AdmissionController&&) = default;
+
+  ~AdmissionController() = default;
+
+ private:
+  Parameters parameters_;
+  int limit_;
+  std::chrono::steady_clock::time_point interval_start_;
+
+  // State of the current interval.
+  std::chrono::nanoseconds minimum_delay_ {};
+  std::size_t sample_count_ {0U};
+  std::uint64_t completion_count_ {0U};
+  bool limit_reached_ {false};
+
+  // State of the last complete interval.
+  std::chrono::nanoseconds last_minimum_delay_ {};
+  double last_completion_rate_ {0.0};
+
+  std::uint64_t rejections_ {0U};
+};
+
+} // namespace fcgi
+} // namespace as_components
+
+#endif // AS_COMPONENTS_FCGI_INCLUDE_FCGI_ADMISSION_CONTROLLER_H_
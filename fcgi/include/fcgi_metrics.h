@@ -0,0 +1,184 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// A process-wide registry of counters and latency histograms which is updated
+// by FcgiServerInterface and FcgiRequest.
+// * The registry is process-wide rather than a member of an interface as
+//   FcgiRequest objects may outlive the interface which produced them and as
+//   at most one interface exists at a time.
+// * Updates are lock-free and do not allocate. They may be made concurrently
+//   by the interface thread and by request threads.
+// * FcgiMetrics::Snapshot returns the sum of all updates which happened
+//   before the call. It performs a fixed number of relaxed atomic loads and
+//   does not block updating threads. Values are monotonic across snapshots.
+//   The values of a snapshot are not guaranteed to be mutually consistent
+//   when updates occur concurrently with the snapshot.
+//
+// Implementation discussion:
+//    Values are stored in kShardCount shards. Each shard is aligned to a
+// cache line. A thread is assigned a shard on its first update, and threads
+// are assigned shards in a round-robin order. Threads which share a shard
+// remain correct as atomic increments are used, but they contend for the
+// cache line of the shard. A snapshot sums the values of every shard.
+
+#ifndef AS_COMPONENTS_FCGI_INCLUDE_FCGI_METRICS_H_
+#define AS_COMPONENTS_FCGI_INCLUDE_FCGI_METRICS_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "fcgi/include/fcgi_protocol_constants.h"
+
+namespace as_components {
+namespace fcgi {
+
+enum class FcgiCounter : std::uint8_t
+{
+  // Connections which were accepted and added to an interface.
+  kConnectionsAccepted = 0U,
+  // Connections which were closed immediately because the interface was
+  // overloaded.
+  kConnectionsRejectedForOverload,
+  // Connections which were closed immediately because the maximum connection
+  // count was met.
+  kConnectionsRejectedForLimit,
+  // Connections which were closed immediately because the address of the
+  // peer was not authorized.
+  kConnectionsRejectedForAddress,
+  // Accepted connections which were later closed by an interface.
+  kConnectionsClosed,
+  // FCGI_BEGIN_REQUEST records which caused a request to be added.
+  kRequestsAccepted,
+  // Requests which were ended with FCGI_REQUEST_COMPLETE by a call to
+  // FcgiRequest::Complete.
+  kRequestsCompleted,
+  // FCGI_ABORT_REQUEST records for requests which were known to an
+  // interface.
+  kRequestsAborted,
+  // FCGI_BEGIN_REQUEST records which were answered with FCGI_OVERLOADED.
+  kRequestsRejectedOverloaded,
+  // FCGI_BEGIN_REQUEST records which were answered with FCGI_CANT_MPX_CONN.
+  kRequestsRejectedCantMpxConn,
+  // Bytes read from connections by an interface.
+  kBytesRead,
+  // Bytes written to connections by an interface or by FcgiRequest objects.
+  kBytesWritten,
+  // Writes which were abandoned after blocking for
+  // FcgiServerInterface::kWriteBlockTimeout_ seconds.
+  kWriteTimeouts,
+  // Calls of AcceptRequests which found data on the self-pipe of an
+  // interface. Request threads write to the self-pipe to wake the interface.
+  kSelfPipeWakeups,
+  // Transitions of a connection to the throttled state, in which it is not
+  // read because a backpressure budget is exceeded.
+  kReadThrottles,
+  // FCGI_BEGIN_REQUEST records which were rejected by admission control.
+  // These are also counted by kRequestsRejectedOverloaded.
+  kRequestsRejectedByAdmission,
+  // Reads of a connection which stopped because the read budget of the
+  // interface was exhausted while data remained.
+  kReadBudgetExhaustions,
+  // Writes of request threads which were handed over to and performed by the
+  // thread which held the write mutex of the connection.
+  kCombinedWrites
+};
+
+enum class FcgiHistogram : std::uint8_t
+{
+  // From the receipt of the FCGI_BEGIN_REQUEST record of a request to the
+  // construction of the FcgiRequest object for the request.
+  kBeginRequestToFcgiRequest = 0U,
+  // From the construction of an FcgiRequest object to a successful call of
+  // Complete on the object.
+  kFcgiRequestToComplete
+};
+
+class FcgiMetrics {
+ public:
+  static constexpr std::size_t kCounterCount {static_cast<std::size_t>(
+    FcgiCounter::kCombinedWrites) + 1U};
+  static constexpr std::size_t kHistogramCount
+    {static_cast<std::size_t>(FcgiHistogram::kFcgiRequestToComplete) + 1U};
+  // Records are counted by the type value of their header. Index 0 counts
+  // records with a type value which is not an FcgiType value.
+  static constexpr std::size_t kRecordTypeCount
+    {static_cast<std::size_t>(FcgiType::kFCGI_UNKNOWN_TYPE) + 1U};
+  // Bucket i of a histogram counts durations d in nanoseconds with
+  // 2^i <= d < 2^(i+1). Bucket 0 also counts a duration of zero. The last
+  // bucket counts every duration which is at least 2^(kBucketCount - 1)
+  // nanoseconds (about 275 seconds).
+  static constexpr std::size_t kBucketCount {39U};
+  static constexpr std::size_t kShardCount {32U};
+
+  struct HistogramSnapshot
+  {
+    std::uint64_t count;
+    std::uint64_t sum_nanoseconds;
+    std::array<std::uint64_t, kBucketCount> buckets;
+  };
+
+  struct MetricsSnapshot
+  {
+    inline std::uint64_t counter(FcgiCounter c) const noexcept
+    {
+      return counters[static_cast<std::size_t>(c)];
+    }
+
+    inline std::uint64_t records_parsed(FcgiType type) const noexcept
+    {
+      std::size_t index {static_cast<std::size_t>(type)};
+      return records_parsed_by_type[(index < kRecordTypeCount) ? index : 0U];
+    }
+
+    inline const HistogramSnapshot& histogram(FcgiHistogram h) const noexcept
+    {
+      return histograms[static_cast<std::size_t>(h)];
+    }
+
+    std::array<std::uint64_t, kCounterCount>     counters;
+    std::array<std::uint64_t, kRecordTypeCount>  records_parsed_by_type;
+    std::array<HistogramSnapshot, kHistogramCount> histograms;
+  };
+
+  // Adds n to counter c.
+  static void Add(FcgiCounter c, std::uint64_t n = 1U) noexcept;
+
+  // Increments the parsed record count of the type value of a record header.
+  static void CountRecord(FcgiType type) noexcept;
+
+  // Adds a duration to histogram h. A negative duration is recorded as zero.
+  static void Record(FcgiHistogram h, std::chrono::nanoseconds duration)
+    noexcept;
+
+  // Returns the sum of the updates of every thread. Snapshot is intended to
+  // be called periodically by a thread which exports metrics.
+  static MetricsSnapshot Snapshot() noexcept;
+
+  FcgiMetrics() = delete;
+};
+
+} // namespace fcgi
+} // namespace as_components
+
+#endif // AS_COMPONENTS_FCGI_INCLUDE_FCGI_METRICS_H_
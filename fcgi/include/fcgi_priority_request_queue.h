@@ -0,0 +1,152 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// A queue of FcgiRequest objects which is shared by the thread which calls
+// FcgiServerInterface::AcceptRequests and a pool of worker threads. The
+// queue dispatches requests by the priority which was assigned to them by
+// the classifier of the interface (FcgiRequest::get_priority).
+// * The queue has one level per weight which was given at construction.
+//   A request with priority p is placed in level p. A request with a priority
+//   which is greater than or equal to the number of levels is placed in the
+//   last level.
+// * Requests are dispatched from the non-empty levels by smooth weighted
+//   round robin (WeightedRoundRobin). While every level is non-empty, out of
+//   a sum of weights consecutive dispatches, each level receives a number of
+//   dispatches which is equal to its weight, and dispatches from a level are
+//   spread across the sequence. Lower levels win ties. A level of low
+//   priority is not starved by a continuous supply of requests of high
+//   priority.
+// * Requests of a level are dispatched in the order in which they were
+//   pushed.
+// * The methods of the queue may be called concurrently.
+
+#ifndef AS_COMPONENTS_FCGI_INCLUDE_FCGI_PRIORITY_REQUEST_QUEUE_H_
+#define AS_COMPONENTS_FCGI_INCLUDE_FCGI_PRIORITY_REQUEST_QUEUE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "fcgi/include/fcgi_request.h"
+#include "fcgi/include/fcgi_weighted_round_robin.h"
+
+namespace as_components {
+namespace fcgi {
+
+class PriorityRequestQueue {
+ public:
+  // Parameters:
+  // weights: The weight of each level. weights[0] is the weight of the level
+  //          of priority zero.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception.
+  // 2) Throws std::invalid_argument if weights is empty or if a weight is
+  //    zero.
+  explicit PriorityRequestQueue(const std::vector<unsigned int>& weights);
+
+  // Adds requests to the levels of their priorities.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception.
+  // 2) Throws std::logic_error if Close was called. The requests are not
+  //    moved from in this case.
+  // 3) If an exception was thrown by a call of Push for a vector of requests,
+  //    the requests which were not moved from remain in the vector.
+  void Push(FcgiRequest&& request);
+  void Push(std::vector<FcgiRequest>&& requests);
+
+  // Blocks until a request is available or until the queue is closed and
+  // empty.
+  //
+  // Parameters:
+  // request_ptr: The request to which a dispatched request is move-assigned.
+  //
+  // Preconditions:
+  // 1) *request_ptr must be in a valid state to be moved to. See
+  //    FcgiRequest::operator=(FcgiRequest&&).
+  //
+  // Exceptions:
+  // 1) Throws std::system_error if the synchronization primitives of the
+  //    queue encounter an error.
+  //
+  // Effects:
+  // 1) If true was returned, a request was removed from the queue and
+  //    move-assigned to *request_ptr.
+  // 2) If false was returned, the queue was closed and empty.
+  bool Pop(FcgiRequest* request_ptr);
+
+  // As Pop, but returns false without blocking if no request is available.
+  bool TryPop(FcgiRequest* request_ptr);
+
+  // Prevents further calls of Push and wakes threads which are blocked in
+  // Pop. Requests which are in the queue remain available.
+  //
+  // Exceptions:
+  // 1) Throws std::system_error if the synchronization primitives of the
+  //    queue encounter an error.
+  void Close();
+
+  // Preconditions and exceptions: as for Close.
+  std::size_t size() const;
+
+  inline std::size_t level_count() const noexcept
+  {
+    return scheduler_.level_count();
+  }
+
+  // No copy or move.
+  PriorityRequestQueue(const PriorityRequestQueue&) = delete;
+  PriorityRequestQueue(PriorityRequestQueue&&) = delete;
+  PriorityRequestQueue& operator=(const PriorityRequestQueue&) = delete;
+  PriorityRequestQueue& operator=(PriorityRequestQueue&&) = delete;
+
+  ~PriorityRequestQueue() = default;
+
+ private:
+  // Adds request to its level.
+  //
+  // Synchronization:
+  // 1) mutex_ must be held prior to a call.
+  void PushHelper(FcgiRequest&& request);
+
+  // Removes the next request and move-assigns it to *request_ptr.
+  //
+  // Synchronization:
+  // 1) mutex_ must be held prior to a call.
+  // 2) size_ must be greater than zero.
+  void PopHelper(FcgiRequest* request_ptr);
+
+  mutable std::mutex                   mutex_;
+  std::condition_variable              request_available_;
+  WeightedRoundRobin                   scheduler_;
+  std::vector<std::deque<FcgiRequest>> levels_;
+  std::size_t                          size_;
+  bool                                 closed_;
+};
+
+} // namespace fcgi
+} // namespace as_components
+
+#endif // AS_COMPONENTS_FCGI_INCLUDE_FCGI_PRIORITY_REQUEST_QUEUE_H_
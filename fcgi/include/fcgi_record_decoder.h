@@ -0,0 +1,250 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// A push-based decoder for a stream of FastCGI records. It is used by
+// FcgiServerInterface to decode the records which are received on a
+// connection and by TestFcgiClientInterface to decode the records which are
+// received from a server.
+// * Bytes of the stream are given to Decode in spans of any size. A record
+//   may be split across spans at any byte.
+// * Decode reports the parts of records to a handler. The header of a record
+//   is reported when it is complete. Content is reported as it is received
+//   and is not copied. Padding is discarded. The end of a record is reported
+//   after its padding.
+// * Content may instead be received by the caller directly into its
+//   destination and reported with ConsumeContent.
+// * The decoder does not validate records. The values of the header are
+//   reported as received.
+// * The decoder does not allocate and does not throw. A decoder holds at most
+//   FCGI_HEADER_LEN bytes of a partial header.
+// * A FcgiRecordDecoder performs no synchronization.
+
+#ifndef AS_COMPONENTS_FCGI_INCLUDE_FCGI_RECORD_DECODER_H_
+#define AS_COMPONENTS_FCGI_INCLUDE_FCGI_RECORD_DECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "fcgi/include/fcgi_protocol_constants.h"
+
+namespace as_components {
+namespace fcgi {
+
+class FcgiRecordDecoder {
+ public:
+  struct Header
+  {
+    std::uint8_t  version        {0U};
+    FcgiType      type           {static_cast<FcgiType>(0U)};
+    std::uint16_t fcgi_id        {0U};
+    std::uint16_t content_length {0U};
+    std::uint8_t  padding_length {0U};
+  };
+
+  // Decodes the bytes of [begin, end) and reports the parts of records to
+  // handler.
+  //
+  // Parameters:
+  // begin, end: The next span of bytes of the stream.
+  // handler:    A pointer to an object h with the following member functions:
+  //             1) h.OnHeader(const Header& header)
+  //                Called when the header of a record was completed.
+  //             2) h.OnContent(const std::uint8_t* content_begin,
+  //                  const std::uint8_t* content_end)
+  //                Called with a non-empty span of the content of the
+  //                current record. The span is a subrange of [begin, end).
+  //             3) h.OnRecordEnd()
+  //                Called when the record was completed. For a record without
+  //                content or padding, OnRecordEnd immediately follows
+  //                OnHeader.
+  //
+  // Preconditions:
+  // 1) [begin, end) is a valid range.
+  //
+  // Exceptions:
+  // 1) Exceptions which are thrown by a member function of handler are
+  //    propagated. The decoder then behaves as if the bytes which were
+  //    reported by the throwing call, and every byte before them, were
+  //    consumed.
+  //
+  // Effects:
+  // 1) Every byte of [begin, end) was consumed and the parts of records which
+  //    were completed by the bytes were reported in stream order.
+  // 2) The header returned by header() is the header of the current record
+  //    once OnHeader was called for the record.
+  template<typename Handler>
+  inline void Decode(const std::uint8_t* begin, const std::uint8_t* end,
+    Handler* handler)
+  {
+    while(begin != end)
+    {
+      std::size_t available {static_cast<std::size_t>(end - begin)};
+      switch(part_) {
+        case Part::kHeader : {
+          const std::uint8_t* header_ptr {};
+          // A header which is contained in the span is decoded in place.
+          if((partial_header_length_ == 0U) &&
+             (available >= static_cast<std::size_t>(FCGI_HEADER_LEN)))
+          {
+            header_ptr  = begin;
+            begin      += FCGI_HEADER_LEN;
+          }
+          else
+          {
+            std::size_t copy_size {static_cast<std::size_t>(
+              FCGI_HEADER_LEN - partial_header_length_)};
+            if(copy_size > available)
+              copy_size = available;
+            std::memcpy(partial_header_ + partial_header_length_, begin,
+              copy_size);
+            begin                  += copy_size;
+            partial_header_length_ += static_cast<std::uint8_t>(copy_size);
+            if(partial_header_length_ < FCGI_HEADER_LEN)
+              return;
+            header_ptr = partial_header_;
+          }
+          partial_header_length_ = 0U;
+          header_.version = header_ptr[kHeaderVersionIndex];
+          header_.type    = static_cast<FcgiType>(header_ptr[kHeaderTypeIndex]);
+          header_.fcgi_id = static_cast<std::uint16_t>(
+            (header_ptr[kHeaderRequestIDB1Index] << 8U) |
+             header_ptr[kHeaderRequestIDB0Index]);
+          header_.content_length = static_cast<std::uint16_t>(
+            (header_ptr[kHeaderContentLengthB1Index] << 8U) |
+             header_ptr[kHeaderContentLengthB0Index]);
+          header_.padding_length = header_ptr[kHeaderPaddingLengthIndex];
+          content_remaining_ = header_.content_length;
+          padding_remaining_ = header_.padding_length;
+          part_ = NextPart();
+          handler->OnHeader(header_);
+          if(part_ == Part::kHeader)
+            handler->OnRecordEnd();
+          break;
+        }
+        case Part::kContent : {
+          std::size_t content_size {(available < content_remaining_) ?
+            available : content_remaining_};
+          const std::uint8_t* content_begin {begin};
+          begin              += content_size;
+          content_remaining_ -= static_cast<std::uint16_t>(content_size);
+          part_ = NextPart();
+          handler->OnContent(content_begin, begin);
+          if(part_ == Part::kHeader)
+            handler->OnRecordEnd();
+          break;
+        }
+        case Part::kPadding : {
+          std::size_t padding_size {(available < padding_remaining_) ?
+            available : padding_remaining_};
+          begin              += padding_size;
+          padding_remaining_ -= static_cast<std::uint8_t>(padding_size);
+          if(padding_remaining_ == 0U)
+          {
+            part_ = Part::kHeader;
+            handler->OnRecordEnd();
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  // The number of content bytes of the current record which have not been
+  // consumed. Zero unless the header of the current record was completed and
+  // content remains.
+  inline std::size_t ContentRemaining() const noexcept
+  {
+    return (part_ == Part::kContent) ? content_remaining_ : 0U;
+  }
+
+  // Consumes count content bytes of the current record which were received
+  // by the caller without a call of Decode. This allows content to be read
+  // directly into its destination. OnContent is not called for the bytes.
+  //
+  // Parameters:
+  // count:   The number of content bytes which were received.
+  // handler: As for Decode. Only OnRecordEnd may be called.
+  //
+  // Preconditions:
+  // 1) count <= ContentRemaining().
+  //
+  // Effects:
+  // 1) The decoder behaves as if the bytes had been given to Decode.
+  //    OnRecordEnd was called if the bytes completed a record without padding.
+  template<typename Handler>
+  inline void ConsumeContent(std::size_t count, Handler* handler)
+  {
+    if(count == 0U)
+      return;
+    content_remaining_ -= static_cast<std::uint16_t>(count);
+    part_ = NextPart();
+    if(part_ == Part::kHeader)
+      handler->OnRecordEnd();
+  }
+
+  // True if no part of a record has been received since the last record was
+  // completed.
+  inline bool AtRecordBoundary() const noexcept
+  {
+    return (part_ == Part::kHeader) && (partial_header_length_ == 0U);
+  }
+
+  // The header of the most recent record whose header was completed.
+  inline const Header& header() const noexcept
+  {
+    return header_;
+  }
+
+  // Discards any partial record. The decoder then has the state which it had
+  // immediately after construction.
+  inline void Reset() noexcept
+  {
+    *this = FcgiRecordDecoder {};
+  }
+
+ private:
+  enum class Part : std::uint8_t
+  {
+    kHeader,
+    kContent,
+    kPadding
+  };
+
+  inline Part NextPart() const noexcept
+  {
+    return (content_remaining_) ? Part::kContent :
+      ((padding_remaining_) ? Part::kPadding : Part::kHeader);
+  }
+
+  Header        header_                          {};
+  Part          part_                            {Part::kHeader};
+  std::uint8_t  partial_header_length_           {0U};
+  std::uint8_t  padding_remaining_               {0U};
+  std::uint16_t content_remaining_               {0U};
+  std::uint8_t  partial_header_[FCGI_HEADER_LEN] = {};
+};
+
+} // namespace fcgi
+} // namespace as_components
+
+#endif // AS_COMPONENTS_FCGI_INCLUDE_FCGI_RECORD_DECODER_H_
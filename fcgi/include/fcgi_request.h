@@ -27,16 +27,24 @@
 #include <sys/uio.h>
 #include <unistd.h>
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
 #include "fcgi/include/fcgi_protocol_constants.h"
 #include "fcgi/include/fcgi_request_identifier.h"
+#include "fcgi/include/fcgi_request_trace.h"
 #include "fcgi/include/fcgi_server_interface.h"
 #include "fcgi/include/fcgi_utilities.h"
+#include "fcgi/include/fcgi_well_known_params.h"
 
 namespace as_components {
 namespace fcgi {
@@ -44,6 +52,15 @@ namespace fcgi {
 // See the fcgi namespace README for a discussion of FcgiRequest.
 class FcgiRequest {
  public:
+  // The maximum number of content bytes which Write and WriteError send while
+  // they hold the write mutex of the connection of the request. A longer
+  // sequence is sent in several quanta. Each quantum is a sequence of whole
+  // records, and the write mutex is released between quanta. When requests
+  // are multiplexed over a connection, a request which is waiting to write
+  // acquires the write mutex at the end of the current quantum. The records
+  // of a large response are then interleaved with those of other requests,
+  // and a small response does not wait for the whole of a large one.
+  static constexpr std::size_t kWriteQuantum {64U * 1024U};
 
   // Returns true if the request was aborted by the client or the interface.
   // Returns false otherwise. In particular, calls on default-constructed and
@@ -57,6 +74,60 @@ class FcgiRequest {
   //    should be destroyed.
   bool AbortStatus();
 
+  // Returns true if an abort of the request was signaled by the interface.
+  // The interface signals an abort when it processes an FCGI_ABORT_REQUEST
+  // record for the request, when it closes the connection of the request,
+  // and when it is destroyed. Returns false for default-constructed and
+  // moved-from requests.
+  //    Unlike AbortStatus, AbortRequested does not acquire a mutex and may be
+  // polled frequently by a long-running handler. It does not update the
+  // state of the request. AbortStatus remains the authoritative check and
+  // should be called before the request is abandoned.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions: noexcept.
+  inline bool AbortRequested() const noexcept
+  {
+    return abort_signal_ &&
+      abort_signal_->aborted.load(std::memory_order_acquire);
+  }
+
+  // Returns true if the abort of the request was signaled because the
+  // interface closed the connection of the request or was destroyed. Writes
+  // of the request then fail without use of the connection, and the
+  // descriptor of the connection should not be polled. Returns false for
+  // default-constructed and moved-from requests.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions: noexcept.
+  inline bool ConnectionClosed() const noexcept
+  {
+    return abort_signal_ &&
+      abort_signal_->connection_closed.load(std::memory_order_acquire);
+  }
+
+  // Registers a callback which is invoked once when an abort of the request
+  // is signaled. A callback replaces a previously-registered callback which
+  // has not been invoked. If an abort was already signaled and a callback
+  // was already invoked, callback is invoked by the calling thread before
+  // the call returns.
+  //    The callback is invoked by the thread which calls
+  // FcgiServerInterface::AcceptRequests, or which destroys the interface,
+  // after interface_state_mutex_ was released. It should be brief, for
+  // example a condition variable notification or a write to an eventfd. The
+  // callback must not throw and must not destroy the request.
+  //    A registered callback is never invoked for default-constructed and
+  // moved-from requests.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions:
+  // 1) May throw std::bad_alloc. If a throw occurred, the call had no
+  //    effect.
+  void SetAbortCallback(std::function<void()> callback);
+
   // Completes the response of an FcgiRequest object.
   //
   // Note that allowing a valid FcgiRequest to be destroyed without completion
@@ -110,6 +181,14 @@ class FcgiRequest {
     return completed_;
   }
 
+  // Returns a pointer to the timing trace of the request, or null if the
+  // request was not traced. Points which were not reached hold the epoch of
+  // std::chrono::steady_clock. See fcgi_request_trace.h.
+  inline const FcgiRequestTrace* trace() const noexcept
+  {
+    return trace_.get();
+  }
+
   // Returns a constant reference to the FCGI_DATA byte sequence sent by the
   // client for the request.
   inline const std::vector<uint8_t>& get_DATA() const noexcept
@@ -126,6 +205,16 @@ class FcgiRequest {
     return environment_map_;
   }
 
+  // Returns a pointer to the value of a well-known environment variable or
+  // null if the variable was not defined for the request. The result is
+  // equal to that of a lookup of FcgiWellKnownParams::Name(param) in the
+  // environment map, but no key is constructed and no search is performed.
+  // The pointer is valid as long as the environment map of the request is.
+  inline const std::vector<uint8_t>* Param(FcgiParam param) const noexcept
+  {
+    return well_known_params_[static_cast<std::size_t>(param)];
+  }
+
   // Returns the value of the FCGI_KEEP_CONN flag which was present in the
   // FCGI_BEGIN_REQUEST record for the request.
   inline bool get_keep_conn() const noexcept
@@ -133,6 +222,14 @@ class FcgiRequest {
     return !close_connection_;
   }
 
+  // Returns the priority which was assigned to the request by the classifier
+  // of the interface. Requests have a priority of zero when no classifier was
+  // set. See FcgiServerInterface::set_request_classifier.
+  inline unsigned int get_priority() const noexcept
+  {
+    return priority_;
+  }
+
   // Returns the internal request identifier for the request. Request
   // identifiers are ordered pairs whose first component is the socket
   // descriptor of the connection of the request and whose second component
@@ -190,6 +287,8 @@ class FcgiRequest {
   // 1) If true was returned.
   //    a) The byte sequence given by [begin_iter, end_iter) was sent to the 
   //       client. (No FastCGI records are sent if begin_iter == end_iter.)
+  //       The records of other requests on the connection may be interleaved
+  //       with the records of the sequence. See kWriteQuantum.
   // 2) If false was returned.
   //    a) If the request had not been previously completed:
   //       1) The connection was found to be closed or the connection was found
@@ -483,6 +582,38 @@ class FcgiRequest {
   bool ScatterGatherWriteHelper(struct iovec* iovec_ptr, int iovec_count,
     std::size_t number_to_write, bool interface_mutex_held);
 
+  //    Writes the pending writes of *combiner_ptr in batches until none
+  // remain. Each waiting thread is notified of the outcome of its write. Used
+  // by the thread which acquired the write mutex of a connection to write
+  // the data which other threads handed over to it while it wrote.
+  //
+  // Preconditions:
+  // 1) *write_lock_ptr owns the write mutex of the connection given by fd.
+  // 2) combiner_ptr->combining == true.
+  // 3) interface_state_mutex_ is not held.
+  //
+  // Exceptions:
+  // 1) Exceptions derived from std::exception may be thrown. If an exception
+  //    was thrown, every pending write was failed, combining was stopped, and
+  //    the write mutex was released.
+  //
+  // Effects:
+  // 1) The write mutex was released and combiner_ptr->combining == false.
+  // 2) If a batch could not be written, it and all remaining pending writes
+  //    were failed. If part of a batch was written, *bad_connection_state_ptr
+  //    was set.
+  static void CombineWrites(FcgiServerInterface::WriteCombiner* combiner_ptr,
+    int fd, bool* bad_connection_state_ptr,
+    std::unique_lock<std::mutex>* write_lock_ptr);
+
+  // Sets the status of *pending_ptr and notifies its waiting thread.
+  static void SignalPendingWrite(FcgiServerInterface::PendingWrite* pending_ptr,
+    FcgiServerInterface::PendingWrite::Status status) noexcept;
+
+  // Ends combining for *combiner_ptr and fails every pending write.
+  static void StopCombining(FcgiServerInterface::WriteCombiner* combiner_ptr)
+    noexcept;
+
   // A utility function which allows fcgi_si::PartitionByteSequence to 
   // partition only a subrange of the range [begin_iter, end_iter).
   //
@@ -503,9 +634,13 @@ class FcgiRequest {
 
   // Request information.
   std::map<std::vector<uint8_t>, std::vector<uint8_t>> environment_map_;
+    // Pointers into environment_map_. See RequestData::well_known_params_.
+  std::array<const std::vector<uint8_t>*, FcgiWellKnownParams::kParamCount>
+    well_known_params_;
   std::vector<uint8_t> request_stdin_content_;
   std::vector<uint8_t> request_data_content_;
   uint16_t role_;
+  unsigned int priority_;
     // A flag which indicates that the connection associated with the request
     // should be closed by the interface after the request is no longer
     // relevant to the interface.
@@ -516,6 +651,17 @@ class FcgiRequest {
     // the request's RequestData instance in request_map_.
   bool was_aborted_;
   bool completed_;
+    // Used for FcgiHistogram::kFcgiRequestToComplete.
+  std::chrono::steady_clock::time_point construction_time_;
+    // True once a write was begun for the request. The first write ends the
+    // queueing delay of the request for admission control.
+  bool response_started_;
+    // Null unless the request is traced. The trace is only allocated for
+    // traced requests so that an untraced request does not carry it.
+  std::unique_ptr<FcgiRequestTrace> trace_;
+    // Shared with the RequestData object of the request. Null for
+    // default-constructed and moved-from requests.
+  std::shared_ptr<FcgiServerInterface::AbortSignal> abort_signal_;
 };
 
 } // namespace fcgi
@@ -32,12 +32,16 @@
 #include <sys/uio.h>
 #include <unistd.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <iterator>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include "fcgi/include/fcgi_protocol_constants.h"
+#include "fcgi/include/fcgi_request_trace.h"
 #include "fcgi/include/fcgi_utilities.h"
 
 namespace as_components {
@@ -51,11 +55,20 @@ bool FcgiRequest::WriteHelper(ByteIter begin_iter, ByteIter end_iter,
     return false;
 
   bool write_success {true};
+  bool wrote_data {begin_iter != end_iter};
   while(write_success && (begin_iter != end_iter))
   {
+    // The sequence is written in quanta of at most kWriteQuantum bytes. The
+    // write mutex of the connection is released between quanta so that the
+    // records of other requests on the connection are interleaved with the
+    // records of this request.
+    ByteIter quantum_end {end_iter};
+    if(static_cast<std::size_t>(std::distance(begin_iter, end_iter)) >
+       kWriteQuantum)
+      quantum_end = std::next(begin_iter, kWriteQuantum);
     std::tuple<std::vector<std::uint8_t>, std::vector<struct iovec>,
       std::size_t, ByteIter> 
-    partition_return {PartitionByteSequence(begin_iter, end_iter, 
+    partition_return {PartitionByteSequence(begin_iter, quantum_end, 
       type, request_identifier_.Fcgi_id())};
 
     write_success = ScatterGatherWriteHelper(
@@ -66,6 +79,9 @@ bool FcgiRequest::WriteHelper(ByteIter begin_iter, ByteIter end_iter,
     );
     begin_iter = std::get<3>(partition_return);
   }
+  if(trace_ && write_success && wrote_data &&
+     !trace_->reached(FcgiTracePoint::kFirstWrite))
+    trace_->Mark(FcgiTracePoint::kFirstWrite);
   return write_success;
 }
 
@@ -0,0 +1,145 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Per-request timing trace points and a sampling sink for completed traces.
+//
+// Tracing is disabled by default. When it is disabled, the cost to a request
+// is a check of a null trace pointer of the request at each trace point. The
+// trace of a request is only allocated when the request is traced. Whether a request
+// is traced is decided once, when its FCGI_BEGIN_REQUEST record is accepted
+// by an interface, by a call of FcgiTracing::enabled.
+//
+// For a traced request, FcgiRequest::trace returns a pointer to the
+// timestamps which were reached so far. It returns null otherwise. When a traced request is completed with Complete, its trace
+// is offered to the sink. The sink keeps one of every sample_period offered
+// traces per thread in a ring buffer of the thread. The ring buffers of all
+// threads are collected on demand by FcgiTracing::Dump. The oldest trace of a
+// ring buffer is overwritten when the buffer is full.
+//
+// Timestamps are taken from std::chrono::steady_clock.
+
+#ifndef AS_COMPONENTS_FCGI_INCLUDE_FCGI_REQUEST_TRACE_H_
+#define AS_COMPONENTS_FCGI_INCLUDE_FCGI_REQUEST_TRACE_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fcgi/include/fcgi_request_identifier.h"
+
+namespace as_components {
+namespace fcgi {
+
+enum class FcgiTracePoint : std::uint8_t
+{
+  // The FCGI_BEGIN_REQUEST record of the request was read and accepted by the
+  // interface in RecordStatus::ReadRecords.
+  kBeginRequestReceived = 0U,
+  // The terminal FCGI_PARAMS record of the request was read.
+  kParamsComplete,
+  // The terminal FCGI_STDIN record of the request was read.
+  kStdinComplete,
+  // The FcgiRequest object of the request was constructed in
+  // AcceptRequests.
+  kFcgiRequestConstructed,
+  // The FcgiRequest object was returned to the application by
+  // AcceptRequests.
+  kHandedToApplication,
+  // The first call of Write or WriteError which wrote data completed.
+  kFirstWrite,
+  // The terminal records of the request were written by Complete.
+  kCompleteWritten
+};
+
+struct FcgiRequestTrace
+{
+  static constexpr std::size_t kPointCount
+    {static_cast<std::size_t>(FcgiTracePoint::kCompleteWritten) + 1U};
+
+  // Returns true if point p was reached.
+  inline bool reached(FcgiTracePoint p) const noexcept
+  {
+    return points[static_cast<std::size_t>(p)] !=
+      std::chrono::steady_clock::time_point {};
+  }
+
+  // Returns the time at which point p was reached. The value is the epoch of
+  // std::chrono::steady_clock if p was not reached.
+  inline std::chrono::steady_clock::time_point at(FcgiTracePoint p)
+    const noexcept
+  {
+    return points[static_cast<std::size_t>(p)];
+  }
+
+  inline void Mark(FcgiTracePoint p) noexcept
+  {
+    points[static_cast<std::size_t>(p)] = std::chrono::steady_clock::now();
+  }
+
+  FcgiRequestIdentifier request_id {};
+  std::array<std::chrono::steady_clock::time_point, kPointCount> points {};
+};
+
+class FcgiTracing {
+ public:
+  static constexpr std::size_t kDefaultRingCapacity {1024U};
+
+  // Enables tracing for requests whose FCGI_BEGIN_REQUEST records are
+  // accepted after the call. One of every sample_period completed traces
+  // is kept by the sink of each thread. A sample_period of zero disables the
+  // sink while leaving FcgiRequest::trace available. ring_capacity bounds
+  // the number of traces kept per thread.
+  //
+  // Exceptions:
+  // 1) Throws std::invalid_argument if ring_capacity is zero.
+  static void Enable(std::uint32_t sample_period = 1U,
+    std::size_t ring_capacity = kDefaultRingCapacity);
+
+  // Disables tracing for requests whose FCGI_BEGIN_REQUEST records are
+  // accepted after the call. Traces which were kept by the sink remain
+  // available to Dump.
+  static void Disable() noexcept;
+
+  static bool enabled() noexcept;
+
+  // Offers a completed trace to the sink of the calling thread. A trace is
+  // dropped if memory for the sink could not be allocated.
+  static void Submit(const FcgiRequestTrace& trace) noexcept;
+
+  // Removes and returns the traces which were kept by the sinks of all
+  // threads, including threads which have exited. Traces of a thread are
+  // in the order of their submission.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception. In the event of a
+  //    throw, no traces were removed.
+  static std::vector<FcgiRequestTrace> Dump();
+
+  FcgiTracing() = delete;
+};
+
+} // namespace fcgi
+} // namespace as_components
+
+#endif // AS_COMPONENTS_FCGI_INCLUDE_FCGI_REQUEST_TRACE_H_
@@ -0,0 +1,224 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// A single-threaded reactor which sends the responses of many FcgiRequest
+// objects without dedicating a thread to each request. An application thread
+// which produces output for a request hands it to the reactor and returns
+// immediately. The thread which runs the reactor sends output only to
+// connections which poll(2) reports as writable. A request whose peer reads
+// slowly does not delay the output of other requests.
+// * Requests are moved into the reactor by Adopt, which returns a handle.
+//   After adoption, the FcgiRequest object is used only by the thread which
+//   runs the reactor.
+// * Write and Complete enqueue an operation for a request and return without
+//   blocking. The operations of a request are performed in the order in
+//   which they were enqueued. An optional completion callback is invoked with
+//   the result of the operation.
+// * RunOnce waits for a writable connection with pending output and performs
+//   at most one chunk of output for each such request. Run calls RunOnce
+//   until Stop is called.
+// * Adopt, Write, Complete, Stop, and size may be called concurrently with
+//   each other and with RunOnce and Run. RunOnce and Run must be called by a
+//   single thread at a time.
+//
+// Implementation discussion:
+//    Output is sent through FcgiRequest::Write in chunks of at most
+// chunk_size bytes. A chunk is sent only after poll reported the connection
+// as writable. Sockets are reported as writable when a substantial part of
+// their send buffer is free, so a chunk which is small relative to the send
+// buffer is written without blocking. A chunk which is larger than the free
+// space of the send buffer blocks the reactor as Write blocks.
+//    A request whose connection was closed by the interface
+// (FcgiRequest::ConnectionClosed) is not polled, as the descriptor of a
+// closed connection may never be reported as writable. Its operations fail
+// at the next call of RunOnce without a write to the connection. A request
+// which was aborted by its client is polled as usual.
+//    Completion callbacks are invoked by the thread which runs the reactor
+// when no mutex of the reactor is held. A callback may enqueue further
+// operations.
+//    Input is not streamed by FcgiServerInterface. The FCGI_STDIN content of
+// a request is available from FcgiRequest::get_STDIN before adoption.
+
+#ifndef AS_COMPONENTS_FCGI_INCLUDE_FCGI_RESPONSE_REACTOR_H_
+#define AS_COMPONENTS_FCGI_INCLUDE_FCGI_RESPONSE_REACTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "fcgi/include/fcgi_request.h"
+
+namespace as_components {
+namespace fcgi {
+
+class ResponseReactor {
+ public:
+  using Handle = std::uint64_t;
+  // Invoked with the result of an operation. For a write, true indicates
+  // that all of the bytes of the operation were sent. For a completion, the
+  // value is the value returned by FcgiRequest::Complete.
+  using Completion = std::function<void(bool)>;
+
+  static constexpr std::size_t kDefaultChunkSize {16U * 1024U};
+
+  // Parameters:
+  // chunk_size: The maximum number of bytes which are sent for a request
+  //             each time its connection is reported as writable.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception.
+  // 2) Throws std::invalid_argument if chunk_size is zero.
+  // 3) Throws std::system_error if the self-pipe of the reactor could not be
+  //    created.
+  explicit ResponseReactor(std::size_t chunk_size = kDefaultChunkSize);
+
+  // Moves request into the reactor.
+  //
+  // Preconditions:
+  // 1) request was produced by an FcgiServerInterface and was not completed.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception. If a throw
+  //    occurred, request was not moved from.
+  //
+  // Effects:
+  // 1) Returns a handle which identifies the request in calls of Write and
+  //    Complete. Handles are not reused.
+  Handle Adopt(FcgiRequest&& request);
+
+  // Enqueues the transmission of bytes on the FCGI_STDOUT stream of the
+  // request of handle.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception. If a throw
+  //    occurred, the call had no effect.
+  //
+  // Effects:
+  // 1) If false was returned, handle does not identify a request of the
+  //    reactor. The request was completed, its output failed, or handle was
+  //    not returned by Adopt. on_done is not invoked.
+  // 2) If true was returned, the operation was enqueued.
+  bool Write(Handle handle, std::vector<std::uint8_t> bytes,
+    Completion on_done = {});
+
+  // Enqueues the completion of the request of handle with app_status. After
+  // the operation was performed, the request is removed from the reactor.
+  //
+  // Exceptions and effects: as for Write.
+  bool Complete(Handle handle, std::int32_t app_status,
+    Completion on_done = {});
+
+  // Waits for at most timeout_milliseconds for a request with pending output
+  // whose connection is writable, or for an operation to be enqueued. A
+  // negative value waits indefinitely. Then performs at most one chunk of
+  // output for each request whose connection is writable.
+  //    If an operation of a request fails, the completion callbacks of the
+  // pending operations of the request are invoked with false and the request
+  // is removed from the reactor.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception. Exceptions thrown
+  //    by FcgiRequest methods are handled as failures of the request.
+  //
+  // Effects:
+  // 1) Returns the number of operations which were finished.
+  std::size_t RunOnce(int timeout_milliseconds);
+
+  // Calls RunOnce until Stop is called.
+  void Run();
+
+  // Causes Run to return. RunOnce returns early if it is waiting. After a
+  // call, RunOnce and Run return immediately.
+  void Stop();
+
+  // The number of requests in the reactor.
+  std::size_t size() const;
+
+  // No copy or move.
+  ResponseReactor(const ResponseReactor&) = delete;
+  ResponseReactor(ResponseReactor&&) = delete;
+  ResponseReactor& operator=(const ResponseReactor&) = delete;
+  ResponseReactor& operator=(ResponseReactor&&) = delete;
+
+  // Requests which remain are destroyed. Their pending completion callbacks
+  // are not invoked.
+  ~ResponseReactor();
+
+ private:
+  struct Operation
+  {
+    bool                      complete;
+    std::vector<std::uint8_t> bytes;
+    // The number of bytes of bytes which were sent.
+    std::size_t               offset;
+    std::int32_t              app_status;
+    Completion                on_done;
+  };
+
+  struct Entry
+  {
+    inline Entry(FcgiRequest&& fcgi_request, int connection) noexcept
+    : request    {std::move(fcgi_request)},
+      descriptor {connection},
+      operations {}
+    {}
+
+    // Accessed only by the thread which runs the reactor after adoption.
+    FcgiRequest           request;
+    int                   descriptor;
+    // Accessed under the protection of mutex_. References to the front
+    // operation remain valid while other operations are appended.
+    std::deque<Operation> operations;
+  };
+
+  // Enqueues operation for handle and wakes the thread of the reactor.
+  bool Enqueue(Handle handle, Operation&& operation);
+
+  // Writes to the self-pipe of the reactor.
+  void Wake();
+
+  // Performs one step of the front operation of *entry_ptr. Appends the
+  // callbacks which must be invoked to *callbacks_ptr.
+  //
+  // Effects:
+  // 1) Returns true if the request should be removed from the reactor.
+  bool Step(Entry* entry_ptr,
+    std::vector<std::pair<Completion, bool>>* callbacks_ptr);
+
+  const std::size_t       chunk_size_;
+  mutable std::mutex      mutex_;
+  std::map<Handle, Entry> entries_;
+  Handle                  next_handle_;
+  bool                    stopped_;
+  int                     self_pipe_read_descriptor_;
+  int                     self_pipe_write_descriptor_;
+};
+
+} // namespace fcgi
+} // namespace as_components
+
+#endif // AS_COMPONENTS_FCGI_INCLUDE_FCGI_RESPONSE_REACTOR_H_
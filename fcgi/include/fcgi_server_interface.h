@@ -23,16 +23,30 @@
 #ifndef AS_COMPONENTS_FCGI_INCLUDE_FCGI_SERVER_INTERFACE_H_
 #define AS_COMPONENTS_FCGI_INCLUDE_FCGI_SERVER_INTERFACE_H_
 
+#include <sys/uio.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <vector>
 
+#include "fcgi/include/fcgi_address_allowlist.h"
+#include "fcgi/include/fcgi_admission_controller.h"
 #include "fcgi/include/fcgi_protocol_constants.h"
+#include "fcgi/include/fcgi_record_decoder.h"
 #include "fcgi/include/fcgi_request_identifier.h"
+#include "fcgi/include/fcgi_request_trace.h"
+#include "fcgi/include/fcgi_well_known_params.h"
 
 namespace as_components {
 namespace fcgi {
@@ -44,6 +58,103 @@ class FcgiRequest;
 // See the fcgi namespace README for a discussion of FcgiServerInterface.
 class FcgiServerInterface {
  public:
+  // Counters which summarize connection acceptance over the lifetime of an
+  // interface. They are updated by the interface thread during calls to
+  // AcceptRequests.
+  struct ConnectionAcceptanceCounters
+  {
+    // Connections which were accepted and added to the interface.
+    std::uint64_t accepted;
+    // Connections which were closed immediately because the interface was
+    // overloaded or the maximum connection count was met.
+    std::uint64_t rejected_for_load;
+    // Connections which were closed immediately because the address of the
+    // peer was not authorized.
+    std::uint64_t rejected_for_address;
+    // Calls to AcceptRequests in which pending connections were accepted.
+    std::uint64_t accept_batches;
+    // Accept batches which stopped at kAcceptBatchLimit connections while
+    // connections may have remained pending.
+    std::uint64_t accept_batch_limit_reached;
+  };
+
+  // The maximum number of connections which are accepted (or rejected) in
+  // one call to AcceptRequests. Connections which remain pending are accepted
+  // during later calls. This bounds the time which the interface thread
+  // spends accepting connections during a reconnection storm at the expense
+  // of reading from established connections.
+  static constexpr int kAcceptBatchLimit {64};
+
+  // The default number of bytes which are read from a connection in one call
+  // to AcceptRequests. See set_read_budget.
+  static constexpr std::size_t kDefaultReadBudget {64U * 1024U};
+
+  // The mechanism which AcceptRequests uses to wait for connection requests
+  // and incoming data.
+  // kSelect:  select is called on the listening socket, the self-pipe, and
+  //           every connection in each call of AcceptRequests. Descriptor
+  //           values must be less than FD_SETSIZE.
+  // kIoUring: The descriptors are registered with an io_uring instance
+  //           through one-shot IORING_OP_POLL_ADD operations. A descriptor
+  //           is registered when it is added to the interface and is
+  //           re-registered after it was found to be ready. Waiting and the
+  //           submission of registrations occur in a single io_uring_enter
+  //           call. Reads and writes are unchanged.
+  enum class IoBackend {kSelect, kIoUring};
+
+  // Limits on the request data which the interface holds and on the number
+  // of requests which the application holds. A value of zero means that the
+  // limit is not enforced. The default budgets enforce no limits.
+  //
+  // connection_buffered_bytes:    The FCGI_PARAMS, FCGI_STDIN, and FCGI_DATA
+  //                               bytes of the requests of a connection which
+  //                               were received and which have not yet been
+  //                               used to construct an FcgiRequest object.
+  // total_buffered_bytes:         As connection_buffered_bytes for every
+  //                               connection of the interface.
+  // connection_assigned_requests: The requests of a connection for which an
+  //                               FcgiRequest object was produced and which
+  //                               have not been completed or destroyed.
+  // total_assigned_requests:      As connection_assigned_requests for every
+  //                               connection of the interface.
+  //
+  // While a connection exceeds one of its budgets or the interface exceeds
+  // one of the total budgets, the interface does not read from the
+  // connection. The connection is read again once the budget was freed by
+  // the completion or destruction of an FcgiRequest object. Data sent by the
+  // client remains in the socket in the meantime, and the transport applies
+  // flow control to the client.
+  //
+  // A byte budget is only enforced while requests of the connection (for
+  // connection_buffered_bytes) or of the interface (for
+  // total_buffered_bytes) are assigned. Otherwise, a request which is larger
+  // than the budget could never be received in full. The byte budgets should
+  // be at least the size of the largest request which is expected.
+  //
+  // A read which exceeds a budget is not undone. A connection may exceed a
+  // byte budget by the size of the read buffer of the interface and an
+  // assigned request budget by the number of requests which are completed by
+  // that buffer.
+  struct BackpressureBudgets
+  {
+    std::size_t connection_buffered_bytes;
+    std::size_t total_buffered_bytes;
+    int         connection_assigned_requests;
+    int         total_assigned_requests;
+  };
+
+  // A function which assigns a priority to a request once its FCGI_PARAMS
+  // stream was received and processed. Lower values are more urgent. The
+  // priority of a request is available from FcgiRequest::get_priority.
+  //
+  // Parameters:
+  // environment_map: The environment variables of the request as they will
+  //                  be returned by FcgiRequest::get_environment_map.
+  // role:            The role of the request.
+  using RequestClassifier = std::function<unsigned int(
+    const std::map<std::vector<std::uint8_t>, std::vector<std::uint8_t>>&
+      environment_map,
+    std::uint16_t role)>;
 
   // Attempts to return a list of FcgiRequest objects which are ready for 
   // service. Attempts to update internal state as appropriate for data and
@@ -113,15 +224,15 @@ class FcgiServerInterface {
   //    error is present in the content of an FCGI_GET_VALUES request, an
   //    FCGI_GET_VALUES_RESULT response with an empty body was sent.
   //    All other management requests received an FCGI_UNKNOWN_TYPE response.
-  // 7) New connections which were waiting to be accepted were accepted. 
+  // 7) New connections which were waiting to be accepted were accepted. At
+  //    most kAcceptBatchLimit connections were accepted or rejected.
   //    a) For internet domains, connections were validated against the list of
   //       authorized IP addresses if the list contains addresses. Unauthorized
   //       connections were immediately closed.
   //    b) If the interface was overloaded or the maximum number of connections
   //       was met, new connections were immediately closed.
-  //    c) Connections were validated for socket domain and socket type. The
-  //       reference domain and type were those determined from 
-  //       listening_socket during interface construction.
+  //    c) Accepted sockets have the domain and type of listening_socket.
+  //       These were determined once during interface construction.
   // 8) Connections which were scheduled to be closed were closed. Connection
   //    closure scheduling occurs in several cases:
   //    a) On the completion of a request for which the FCGI_KEEP_CONN flag was
@@ -143,6 +254,39 @@ class FcgiServerInterface {
   //       an error.
   std::vector<FcgiRequest> AcceptRequests();
 
+  //    Creates a connection which does not pass through the listening socket
+  // of the interface. The connection is one end of an AF_UNIX socket pair,
+  // and the other end is returned to the caller. The connection is read and
+  // written by the interface as an accepted connection is. A client, such as
+  // TestFcgiClientInterface after a call of AdoptConnection, may use the
+  // returned descriptor.
+  //    Loopback connections allow the interface to be exercised in-process
+  // without binding a socket to an address or a file path and without the
+  // overhead of the internet protocol stack.
+  //
+  // Preconditions: none.
+  //
+  // Synchronization:
+  // 1) Must be called by the thread which calls AcceptRequests.
+  // 2) Acquires and releases interface_state_mutex_.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception.
+  // 2) Throws std::system_error if the socket pair could not be created.
+  // 3) On a throw, interface state is not modified and no descriptor was
+  //    leaked.
+  //
+  // Effects:
+  // 1) If the interface was overloaded or the maximum connection count was
+  //    met, -1 was returned. Otherwise:
+  //    a) The interface end of the socket pair was added to the interface as
+  //       for a connection which was accepted by AcceptConnection. It is
+  //       non-blocking and close-on-exec.
+  //    b) The descriptor of the other end was returned. It is blocking and
+  //       close-on-exec, and it is owned by the caller.
+  // 2) Address validation does not apply to loopback connections.
+  int CreateLoopbackConnection();
+
   // Gets the current number of connected sockets which were accepted by
   // the listening socket associated with listening_socket.
   //
@@ -152,6 +296,15 @@ class FcgiServerInterface {
     return record_status_map_.size() + dummy_descriptor_set_.size();
   }
 
+  // Returns a copy of the connection acceptance counters of the interface.
+  //
+  // Preconditions: none.
+  inline ConnectionAcceptanceCounters connection_acceptance_counters() const
+    noexcept
+  {
+    return connection_acceptance_counters_;
+  }
+
   // Returns the current overload status of the interface. Returns false
   // unless the interface was put into an overloaded state by a call of
   // set_overload(true).
@@ -172,6 +325,16 @@ class FcgiServerInterface {
   //    access interface state encounters an error.
   bool interface_status() const;
 
+  // Returns the I/O multiplexing mechanism which is used by the interface.
+  // This may differ from the mechanism requested during construction. See
+  // the constructor.
+  //
+  // Preconditions: none.
+  inline IoBackend io_backend() const noexcept
+  {
+    return (io_uring_poller_) ? IoBackend::kIoUring : IoBackend::kSelect;
+  }
+
   // Sets the overload flag of the interface to overload_status. 
   //
   // Parameters:
@@ -201,6 +364,159 @@ class FcgiServerInterface {
     application_overload_ = overload_status;
   }
 
+  // Returns a copy of the admission controller of the interface or an empty
+  // optional if admission control is disabled. See EnableAdmissionControl.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions:
+  // 1) Throws std::system_error if the synchronization primitive used to
+  //    access interface state encounters an error.
+  std::optional<AdmissionController> admission_controller() const;
+
+  // Enables automatic admission control with a new AdmissionController which
+  // is constructed from parameters. Replaces a previous controller.
+  //
+  // Parameters:
+  // parameters: The targets of the controller. See AdmissionController.
+  //
+  // Preconditions:
+  // 1) As for set_overload, the call should be made by the thread which calls
+  //    AcceptRequests.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception.
+  // 2) Throws std::invalid_argument if AdmissionController rejects
+  //    parameters. Admission control is unchanged in this case.
+  //
+  // Effects:
+  // 1) While admission control is enabled:
+  //    a) The controller limits the number of requests which are in flight.
+  //       A request is in flight from the acceptance of its
+  //       FCGI_BEGIN_REQUEST record until it is completed, aborted, or
+  //       otherwise removed from the interface.
+  //    b) An FCGI_BEGIN_REQUEST record which is received while the limit is
+  //       met is rejected as for set_overload(true). The protocol status of
+  //       the FCGI_END_REQUEST record is FCGI_OVERLOADED.
+  //    c) The queueing delay of each request, the time from the construction
+  //       of its FcgiRequest object to its first write, is recorded. The limit
+  //       is adjusted during calls of AcceptRequests once per interval of the
+  //       controller.
+  //    d) Connections are accepted normally, and set_overload retains its
+  //       effects.
+  void EnableAdmissionControl(const AdmissionController::Parameters&
+    parameters);
+
+  // Disables admission control. Does nothing if it was not enabled.
+  //
+  // Preconditions and exceptions: as for admission_controller.
+  void DisableAdmissionControl();
+
+  // Returns the backpressure budgets of the interface.
+  //
+  // Preconditions:
+  // 1) As for set_backpressure_budgets, the call should be made by the
+  //    thread which calls AcceptRequests.
+  inline BackpressureBudgets backpressure_budgets() const noexcept
+  {
+    return backpressure_budgets_;
+  }
+
+  // Sets the backpressure budgets of the interface. See BackpressureBudgets.
+  //
+  // Parameters:
+  // budgets: The new budgets. Budgets with a value of zero are not enforced.
+  //
+  // Preconditions:
+  // 1) As for set_overload, the call should be made by the thread which calls
+  //    AcceptRequests.
+  //
+  // Exceptions:
+  // 1) Throws std::invalid_argument if a request budget is negative. The
+  //    budgets are unchanged in this case.
+  // 2) May throw exceptions derived from std::exception.
+  //
+  // Synchronization:
+  // 1) Acquires and releases interface_state_mutex_.
+  //
+  // Effects:
+  // 1) The new budgets are applied to connections at the start of the next
+  //    call of AcceptRequests.
+  void set_backpressure_budgets(const BackpressureBudgets& budgets);
+
+  // Returns the read budget of the interface. See set_read_budget.
+  //
+  // Preconditions: none.
+  inline std::size_t read_budget() const noexcept
+  {
+    return read_budget_;
+  }
+
+  // Sets the number of bytes which are read from a connection in one call to
+  // AcceptRequests. The default budget is kDefaultReadBudget.
+  //
+  // Parameters:
+  // bytes: The new budget. A value of zero indicates that a connection is
+  //        read until it would block.
+  //
+  // Preconditions:
+  // 1) As for set_overload, the call should be made by the thread which calls
+  //    AcceptRequests.
+  //
+  // Effects:
+  // 1) A connection whose budget was exhausted is not read further during the
+  //    call of AcceptRequests. The data which remains in its socket is read
+  //    during later calls. A call of AcceptRequests returns the requests
+  //    which were completed by the data which was read.
+  // 2) The next call of AcceptRequests reads the ready connections in
+  //    ascending descriptor order starting after the last connection whose
+  //    budget was exhausted. Other connections are read before the data
+  //    which remains on that connection. A connection which sends a large
+  //    request therefore delays the requests of other connections by at most
+  //    the time which is needed to process the budget.
+  //
+  // The budget is checked after each read of the read buffer of the
+  // interface. A connection may exceed the budget by the size of that buffer.
+  inline void set_read_budget(std::size_t bytes) noexcept
+  {
+    read_budget_ = bytes;
+  }
+
+  // Sets the function which is used to assign priorities to requests. An
+  // empty function disables classification. Classification is disabled by
+  // default.
+  //
+  // Parameters:
+  // classifier: See RequestClassifier.
+  //
+  // Preconditions:
+  // 1) As for set_overload, the call should be made by the thread which calls
+  //    AcceptRequests.
+  // 2) classifier is called by the thread which calls AcceptRequests while
+  //    the synchronization primitive of the interface is not held. It must
+  //    not call the methods of the interface or of FcgiRequest objects.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception.
+  // 2) An exception thrown by classifier is treated as an error in the
+  //    processing of the connection of the request. The connection is
+  //    scheduled to be closed, and the exception propagates from
+  //    AcceptRequests.
+  //
+  // Effects:
+  // 1) While a classifier is set:
+  //    a) The classifier is called once for each request which was received
+  //       in full and which had a well-formed FCGI_PARAMS stream. The returned
+  //       value is the priority of the request.
+  //    b) The requests which are returned by a call of AcceptRequests are
+  //       ordered by priority. The order of requests with equal priorities
+  //       is the order in which they were completed.
+  // 2) When no classifier is set, every request has a priority of zero.
+  inline void set_request_classifier(RequestClassifier classifier)
+  {
+    request_classifier_ = std::move(classifier);
+  }
+
   // Normal constructor
   // Parameters:
   // listening_descriptor: The descriptor of the listening socket to be
@@ -217,6 +533,11 @@ class FcgiServerInterface {
   //                          application by the generation of an FcgiRequest
   //                          object.
   //                       The default value is EXIT_FAILURE.
+  // io_backend:           The requested I/O multiplexing mechanism. If
+  //                       IoBackend::kIoUring is requested and io_uring is
+  //                       not supported by the kernel or is not permitted for
+  //                       the process, IoBackend::kSelect is used. The
+  //                       default value is IoBackend::kSelect.
   //
   // Preconditions:
   // 1) Signal handling: SIGPIPE must be handled by the application. Failure to
@@ -236,9 +557,11 @@ class FcgiServerInterface {
   //    d) The socket provided by listening_socket is not listening.
   //    e) The socket domain of listening_socket is AF_INET or AF_INET6,
   //       FCGI_WEB_SERVER_ADDRS is bound to a non-empty value, and no
-  //       valid addresses are found when that value is processed. An address
-  //       is valid if inet_pton finds the address to be valid when given the
-  //       appropriate socket domain.
+  //       valid entries are found when that value is processed. The value is
+  //       a comma-separated list of addresses and CIDR prefixes (e.g.
+  //       "10.0.0.0/8,127.0.0.1"). An entry is valid if
+  //       AddressAllowlist::AddPrefix finds it to be well-formed for the
+  //       socket domain.
   // 4) An exception is thrown if, during construction, another
   //    FcgiServerInterface object exists.
   // 5) The file description of listening_descriptor may or may not have been
@@ -254,7 +577,8 @@ class FcgiServerInterface {
   // 3) The file description of listening_descriptor was made non-blocking
   //    (O_NONBLOCK). No other open file status flags were changed.
   FcgiServerInterface(int listening_descriptor, int max_connections,
-    int max_requests, std::int32_t app_status_on_abort = EXIT_FAILURE);
+    int max_requests, std::int32_t app_status_on_abort = EXIT_FAILURE,
+    IoBackend io_backend = IoBackend::kSelect);
 
   // No copy, move, or default construction.
   FcgiServerInterface() = delete;
@@ -270,6 +594,85 @@ class FcgiServerInterface {
 
   enum class RequestStatus {kRequestPending, kRequestAssigned};
 
+  // The requests of a connection and their use of the backpressure budgets.
+  struct ConnectionLoad
+  {
+    // The number of requests of the connection in request_map_.
+    int         request_count;
+    int         assigned_request_count;
+    std::size_t buffered_byte_count;
+  };
+
+  // A write of a request which was handed to the request thread which held
+  // the write mutex of the connection. The object is owned by the waiting
+  // request thread. See FcgiRequest::ScatterGatherWriteHelper.
+  struct PendingWrite
+  {
+    enum class Status {kPending, kWritten, kFailed};
+
+    struct iovec*           iovec_ptr;
+    int                     iovec_count;
+    std::size_t             number_to_write;
+    // status is accessed under the protection of mutex. The thread which
+    // performed the write notifies written while it holds mutex so that the
+    // object is not destroyed before the notification completes.
+    std::mutex              mutex           {};
+    std::condition_variable written         {};
+    Status                  status          {Status::kPending};
+  };
+
+  // The state which allows the request thread that holds the write mutex of
+  // a connection to perform the writes of other requests on the connection.
+  // Accessed under the protection of mutex. The lock order is: write mutex
+  // of the connection, then mutex.
+  struct WriteCombiner
+  {
+    std::mutex                mutex          {};
+    // True while a request thread holds the write mutex and will perform
+    // the writes in pending_writes before it releases the write mutex.
+    bool                      combining      {false};
+    std::vector<PendingWrite*> pending_writes {};
+  };
+
+  // The abort state of an assigned request. It is shared by the RequestData
+  // object of the request and by its FcgiRequest object, which may outlive
+  // the RequestData object and the interface.
+  //    aborted is set by the interface while it holds interface_state_mutex_
+  // when an FCGI_ABORT_REQUEST record for the request is processed, when
+  // the interface closes the connection of the request, and when the
+  // interface is destroyed. It may be read without a lock.
+  //    connection_closed is set with aborted when the abort is signaled
+  // because the interface closed the connection of the request or was
+  // destroyed. Writes of the request then fail without use of the
+  // connection.
+  //    The callback of the request is invoked once after aborted was set. The
+  // interface invokes it when it does not hold interface_state_mutex_.
+  // callback and notified are accessed under the protection of mutex.
+  struct AbortSignal
+  {
+    // Invokes the callback if it has not already been invoked. The callback
+    // is invoked after mutex was released.
+    inline void Notify() noexcept
+    {
+      std::function<void()> local_callback {};
+      {
+        std::lock_guard<std::mutex> lock {mutex};
+        if(notified)
+          return;
+        notified = true;
+        local_callback.swap(callback);
+      }
+      if(local_callback)
+        local_callback();
+    }
+
+    std::atomic<bool>     aborted           {false};
+    std::atomic<bool>     connection_closed {false};
+    std::mutex            mutex             {};
+    std::function<void()> callback          {};
+    bool                  notified          {false};
+  };
+
   class RequestData {
    public:
     using size = std::allocator_traits<std::allocator<std::uint8_t>>::size_type;
@@ -294,6 +697,12 @@ class FcgiServerInterface {
       client_set_abort_ = true;
     }
 
+    inline const std::shared_ptr<AbortSignal>& get_abort_signal() const
+      noexcept
+    {
+      return abort_signal_;
+    }
+
     inline bool get_close_connection() const noexcept
     {
       return close_connection_;
@@ -324,30 +733,53 @@ class FcgiServerInterface {
     //    true. E.g. get_DATA_completion returns true for any completed request.
     bool CheckRequestCompletionWithConditionalUpdate() noexcept;
 
-    // Attempts to convert the FCGI_PARAMS byte sequence which is encoded in the
-    // FastCGI name-value pair format into a std::map object with names as
-    // map keys and values as map values. The map is held within the
-    // RequestData object and later used in the construction of an FcgiRequest
-    // object.
+    // Parses the name-value pairs of the FCGI_PARAMS content which was
+    // appended since the last call. Each pair is added to the environment
+    // variable map of the request as it is parsed. The map is later used in
+    // the construction of an FcgiRequest object.
+    //    A pair which is not yet complete, as it straddles records, is
+    // retained and parsed by a later call. Parsing as records are completed
+    // spreads the work of a large FCGI_PARAMS stream over its receipt.
     //
     // Parameters: none
     //
-    // Preconditions:
-    // 1) This method may only be called once the FCGI_PARAMS stream is complete
-    //    as determined by get_PARAMS_completion.
+    // Preconditions: none.
     //
     // Exceptions:
     // 1) May throw exceptions derived from std::exception.
-    // 2) In the event of a throw, the call had no effect on the RequestData
-    //    object (strong exception guarantee).
+    // 2) In the event of a throw, pairs may have been added to the map. The
+    //    RequestData object should not be used to construct an FcgiRequest
+    //    object.
     //
     // Effects:
-    // 1) If true was returned, the FCGI_PARAMS byte sequence was used to
-    //    construct an internal environment variable map.
+    // 1) The complete pairs of the appended content were added to the map.
+    //    The bytes of a trailing partial pair were retained. The value of a
+    //    well-known variable (see FcgiWellKnownParams) was also recorded for
+    //    FcgiRequest::Param.
+    // 2) If a pair defined a variable which had a distinct definition, the
+    //    stream was marked as malformed and parsing stops.
+    void ParsePARAMS();
+
+    // Checks the result of the parsing of the FCGI_PARAMS stream by
+    // ParsePARAMS.
+    //
+    // Parameters: none
+    //
+    // Preconditions:
+    // 1) This method may only be called once the FCGI_PARAMS stream is complete
+    //    as determined by get_PARAMS_completion.
+    //
+    // Effects:
+    // 1) If true was returned, the environment variable map holds the
+    //    definitions of the FCGI_PARAMS stream.
     // 2) If false was returned, the FCGI_PARAMS byte sequence had a FastCGI
-    //    name-value pair binary formatting error or the list of environment
-    //    variable definitions had distinct definitions for the same variable.
-    bool ProcessFCGI_PARAMS();
+    //    name-value pair binary formatting error (the stream ended with a
+    //    partial pair) or the list of environment variable definitions had
+    //    distinct definitions for the same variable.
+    inline bool ProcessFCGI_PARAMS() const noexcept
+    {
+      return !FCGI_PARAMS_malformed_ && FCGI_PARAMS_.empty();
+    }
 
     inline bool get_PARAMS_completion() const noexcept
     {
@@ -357,11 +789,14 @@ class FcgiServerInterface {
     inline void CompletePARAMS() noexcept
     {
       FCGI_PARAMS_complete_ = true;
+      if(trace_)
+        trace_->Mark(FcgiTracePoint::kParamsComplete);
     }
 
     inline void AppendToPARAMS(const std::uint8_t* buffer_ptr, size count)
     {
       FCGI_PARAMS_.insert(FCGI_PARAMS_.end(), buffer_ptr, buffer_ptr + count);
+      buffered_byte_count_ += count;
     }
 
     inline bool get_STDIN_completion() const noexcept
@@ -372,11 +807,14 @@ class FcgiServerInterface {
     inline void CompleteSTDIN() noexcept
     {
       FCGI_STDIN_complete_ = true;
+      if(trace_)
+        trace_->Mark(FcgiTracePoint::kStdinComplete);
     }
 
     inline void AppendToSTDIN(const std::uint8_t* buffer_ptr, size count)
     {
       FCGI_STDIN_.insert(FCGI_STDIN_.end(), buffer_ptr, buffer_ptr + count);
+      buffered_byte_count_ += count;
     }
 
     inline bool get_DATA_completion() const noexcept
@@ -392,6 +830,87 @@ class FcgiServerInterface {
     inline void AppendToDATA(const std::uint8_t* buffer_ptr, size count)
     {
       FCGI_DATA_.insert(FCGI_DATA_.end(), buffer_ptr, buffer_ptr + count);
+      buffered_byte_count_ += count;
+    }
+
+    // Reserves storage for FCGI_STDIN from the value of the CONTENT_LENGTH
+    // environment variable in the map which was produced by ParsePARAMS. This
+    // allows FCGI_STDIN content to be read into its final storage without
+    // reallocation.
+    //
+    // Parameters:
+    // limit: The maximum number of bytes which will be reserved. The value of
+    //        CONTENT_LENGTH is supplied by the client and is not trusted.
+    //
+    // Preconditions:
+    // 1) The FCGI_PARAMS stream is complete.
+    //
+    // Exceptions:
+    // 1) May throw exceptions derived from std::exception. In the event of a
+    //    throw, the content of FCGI_STDIN is unchanged.
+    //
+    // Effects:
+    // 1) If the map contained a definition of CONTENT_LENGTH whose value was a
+    //    decimal integer, capacity for the minimum of the value and limit was
+    //    reserved for FCGI_STDIN. Otherwise, nothing was done.
+    void ReserveSTDIN(size limit);
+
+    // Extends FCGI_STDIN or FCGI_DATA by count bytes and returns a pointer to
+    // the first added byte. Content may then be read directly into the
+    // stream. The extension must be committed with CommitStreamExtension
+    // before the stream is otherwise used. As the added bytes are
+    // value-initialized, count should not exceed the number of bytes which
+    // are expected to be written.
+    //
+    // Preconditions:
+    // 1) type is FcgiType::kFCGI_STDIN or FcgiType::kFCGI_DATA.
+    //
+    // Exceptions:
+    // 1) May throw exceptions derived from std::exception. In the event of a
+    //    throw, the stream is unchanged.
+    inline std::uint8_t* ExtendStream(FcgiType type, size count)
+    {
+      std::vector<std::uint8_t>& stream {(type == FcgiType::kFCGI_STDIN) ?
+        FCGI_STDIN_ : FCGI_DATA_};
+      size old_size {stream.size()};
+      stream.resize(old_size + count);
+      return stream.data() + old_size;
+    }
+
+    // Removes the bytes of the last extension of a stream which were not
+    // received and adds the received bytes to the buffered byte count.
+    //
+    // Parameters:
+    // type:     As for ExtendStream.
+    // count:    The count of the last call of ExtendStream for the stream.
+    // received: The number of bytes which were written to the start of the
+    //           extension. received <= count.
+    inline void CommitStreamExtension(FcgiType type, size count, size received)
+      noexcept
+    {
+      std::vector<std::uint8_t>& stream {(type == FcgiType::kFCGI_STDIN) ?
+        FCGI_STDIN_ : FCGI_DATA_};
+      // Shrinking does not reallocate.
+      stream.resize(stream.size() - (count - received));
+      buffered_byte_count_ += received;
+    }
+
+    // The number of bytes which were appended to the streams of the request.
+    inline std::size_t get_buffered_byte_count() const noexcept
+    {
+      return buffered_byte_count_;
+    }
+
+    // The environment variable map which was produced by ParsePARAMS.
+    inline const std::map<std::vector<std::uint8_t>, std::vector<std::uint8_t>>&
+    get_environment_map() const noexcept
+    {
+      return environment_map_;
+    }
+
+    inline void set_priority(unsigned int priority) noexcept
+    {
+      priority_ = priority;
     }
 
     RequestData() = default;
@@ -416,20 +935,40 @@ class FcgiServerInterface {
     bool                      FCGI_PARAMS_complete_ {false};
     bool                      FCGI_STDIN_complete_  {false};
     bool                      FCGI_DATA_complete_   {false};
+    // FCGI_PARAMS_ holds only the bytes which were not yet parsed by
+    // ParsePARAMS.
+    bool                      FCGI_PARAMS_malformed_ {false};
     std::vector<std::uint8_t> FCGI_PARAMS_          {};
     std::vector<std::uint8_t> FCGI_STDIN_           {};
     std::vector<std::uint8_t> FCGI_DATA_            {};
+    std::size_t               buffered_byte_count_  {0U};
 
-    // Map to hold processed FCGI_PARAMS_ data.
+    // Map to hold parsed FCGI_PARAMS_ data.
     std::map<std::vector<std::uint8_t>, std::vector<std::uint8_t>>
                   environment_map_ {};
+    // Pointers to the values in environment_map_ of the well-known variables
+    // which were defined. They are indexed by FcgiParam value. As the nodes of
+    // a map are not moved when the map is moved, the pointers remain valid
+    // when environment_map_ is moved to an FcgiRequest object.
+    std::array<const std::vector<std::uint8_t>*,
+      FcgiWellKnownParams::kParamCount> well_known_params_ {};
 
     // Request metadata
     std::uint16_t role_;
+    unsigned int  priority_                       {0U};
     bool          client_set_abort_               {false};
     bool          close_connection_;
     RequestStatus request_status_                 {RequestStatus::kRequestPending};
     bool          connection_closed_by_interface_ {false};
+    // The time at which the FCGI_BEGIN_REQUEST record of the request was
+    // processed. Used for FcgiHistogram::kBeginRequestToFcgiRequest.
+    std::chrono::steady_clock::time_point begin_request_time_ {};
+    // Whether the request is traced is decided once at construction. The
+    // trace is only allocated for a traced request, and it is moved to the
+    // FcgiRequest object of the request.
+    std::unique_ptr<FcgiRequestTrace> trace_ {};
+    // Set by the constructor of the FcgiRequest object of the request.
+    std::shared_ptr<AbortSignal> abort_signal_ {};
   };
 
   // RecordStatus objects are used as internal components of an
@@ -442,13 +981,20 @@ class FcgiServerInterface {
    public:
 
     // Reads FastCGI records from a connected socket until it blocks, is found 
-    // to be closed, or an error prevents further reading. While reading,
+    // to be closed, a budget is exhausted, or an error prevents further
+    // reading. While reading,
     // FastCGI records are validated and interface state is updated
     // appropriately. On normal exit, a list is returned of request identifiers.
     // The identifiers indicate the requests which are ready to be used to
     // create an FcgiRequest object.
     //
-    // Parameters: none.
+    // Parameters:
+    // byte_budget:          The number of bytes after which reading stops even
+    //                       if the socket has more data. Zero indicates that
+    //                       reading is not limited.
+    // budget_exhausted_ptr: A pointer to a flag which is set to true if
+    //                       reading stopped because byte_budget was
+    //                       exhausted. The flag is otherwise unchanged.
     //
     // Preconditions:
     // 1) connection must refer to a connected socket which:
@@ -479,8 +1025,11 @@ class FcgiServerInterface {
     //    effects. For example, interface state may have been updated to track
     //    partially-complete requests or the interface may have sent the
     //    response to a FastCGI management request to a client.
+    // 3) Reading stops after the read which exhausted byte_budget. The data
+    //    which was read is processed in full. Unread data remains in the
+    //    socket, and the socket remains ready to be read.
     std::vector<std::map<FcgiRequestIdentifier, RequestData>::iterator>
-    ReadRecords();
+    ReadRecords(std::size_t byte_budget, bool* budget_exhausted_ptr);
 
     RecordStatus() = default;
     RecordStatus(int connection, FcgiServerInterface* interface_ptr);
@@ -500,23 +1049,24 @@ class FcgiServerInterface {
     // Sets the RecordStatus object to a state which is equivalent to the state
     // that it had immediately after normal construction. The local storage 
     // container is not destroyed but is rather cleared.
+    //
+    // Preconditions:
+    // 1) decoder_ is at a record boundary.
     void ClearRecord() noexcept;
 
-    inline std::int_fast32_t ExpectedBytes() const noexcept
-    {
-      return padding_bytes_expected_ + content_bytes_expected_
-            + FCGI_HEADER_LEN;
-    }
-
-    inline bool IsHeaderComplete() const noexcept
-    {
-      return bytes_received_ >= FCGI_HEADER_LEN;
-    }
-
-    inline bool IsRecordComplete() const noexcept
-    {
-      return ExpectedBytes() == bytes_received_;
-    }
+    // Adds connection_ to application_closure_request_set_. Intended to be
+    // called in a handler of an exception of ReadRecords before the exception
+    // is rethrown.
+    //
+    // Synchronization:
+    // 1) Acquires and releases interface_state_mutex_.
+    //
+    // Exceptions:
+    // 1) Throws std::runtime_error if the interface was found to be in a bad
+    //    state.
+    // 2) If the connection could not be added, the interface was put into a
+    //    bad state and the exception of the addition was propagated.
+    void ScheduleClosureAfterThrow();
 
     //    Takes various actions depending on the type of the completed record.
     // Returns either a non-null iterator to request_map_ or an iterator with
@@ -625,7 +1175,7 @@ class FcgiServerInterface {
     //             RecordStatus object tracks received record data.
     //
     // Preconditions:
-    // 1) header_ has been filled with the header bytes of a FastCGI record.
+    // 1) The header of the current record has been decoded by decoder_.
     //
     // Synchronization:
     // 1) Implicitly acquires and releases interface_state_mutex_.
@@ -636,8 +1186,8 @@ class FcgiServerInterface {
     //    indeterminate.
     //
     // Effects:
-    // 1) content_bytes_expected_, padding_bytes_expected_, type_, and
-    //    request_id_ have the values which where encoded in the header.
+    // 1) type_ and request_id_ have the values which where encoded in the
+    //    header.
     // 2) The validity of the record was determined and is recorded in
     //    invalid_record_. 
     // 3) Validity requirements for record types:
@@ -667,16 +1217,10 @@ class FcgiServerInterface {
 
     int connection_;
 
-    // The header of the FCGI record. The number of valid bytes in a
-    // prefix of header is determined by the value of bytes received.
-    std::uint8_t header_[FCGI_HEADER_LEN] = {};
-
-    // An accumulator variable to track header, content, and padding
-    // completion and, hence, record completion.
-    std::int_fast32_t bytes_received_ {0};
-
-    std::uint16_t content_bytes_expected_ {0U};
-    std::uint8_t padding_bytes_expected_ {0U};
+    // Tracks header, content, and padding completion and, hence, record
+    // completion. The header of the current record is given by
+    // decoder_.header().
+    FcgiRecordDecoder decoder_ {};
 
     // Implementation note:
     // The value zero is used for type_ as no FastCGI record has this value as a
@@ -700,6 +1244,112 @@ class FcgiServerInterface {
     FcgiServerInterface* i_ptr_;
   };
 
+  // IoUringPoller waits for the readability of descriptors with one-shot
+  // IORING_OP_POLL_ADD operations of an io_uring instance. It is used by the
+  // interface in place of select when IoBackend::kIoUring was selected. The
+  // io_uring system calls are made directly; liburing is not used.
+  //
+  // Each armed descriptor has a single outstanding poll operation. The user
+  // data of the operation combines the descriptor with a registration tag.
+  // A completion whose user data does not match the current registration of
+  // its descriptor is stale and is ignored.
+  //
+  // A pending poll operation holds a reference to the file of its
+  // descriptor. Disarm must be called before the interface closes a
+  // descriptor so that the file is released when the connection is closed.
+  class IoUringPoller {
+   public:
+    // Returns a poller or a null pointer if io_uring is not supported or is
+    // not permitted. completion_entries is the requested size of the
+    // completion queue. It is clamped by the kernel.
+    //
+    // Exceptions:
+    // 1) May throw exceptions derived from std::exception.
+    // 2) Throws std::system_error if a supported io_uring instance could not
+    //    be mapped into memory.
+    static std::unique_ptr<IoUringPoller> Create(
+      unsigned int completion_entries);
+
+    // Queues a poll operation for the readability of descriptor. The
+    // operation is submitted during the next call to Wait.
+    //
+    // Preconditions:
+    // 1) descriptor is not armed.
+    //
+    // Exceptions:
+    // 1) May throw exceptions derived from std::exception.
+    // 2) Throws std::system_error if queued operations could not be submitted
+    //    to make room in the submission queue.
+    // 3) The strong exception guarantee is provided.
+    void Arm(int descriptor);
+
+    // If descriptor is armed, queues the removal of its poll operation and
+    // regards descriptor as unarmed. Otherwise, does nothing.
+    //
+    // Exceptions:
+    // 1) As for Arm.
+    void Disarm(int descriptor);
+
+    // Submits queued operations and blocks until at least one armed
+    // descriptor is ready for reading. The ready descriptors are appended to
+    // *ready_ptr and are regarded as unarmed.
+    //
+    // Returns the number of descriptors which were appended. Returns -1 and
+    // sets errno to EINTR if a signal interrupted the wait.
+    //
+    // Exceptions:
+    // 1) May throw exceptions derived from std::exception.
+    // 2) Throws std::system_error if io_uring_enter failed with an error other
+    //    than EINTR.
+    int Wait(std::vector<int>* ready_ptr);
+
+    IoUringPoller(const IoUringPoller&) = delete;
+    IoUringPoller(IoUringPoller&&) = delete;
+    IoUringPoller& operator=(const IoUringPoller&) = delete;
+    IoUringPoller& operator=(IoUringPoller&&) = delete;
+
+    // Unmaps the rings and closes the io_uring instance. Pending operations
+    // are cancelled.
+    ~IoUringPoller();
+
+   private:
+    IoUringPoller() = default;
+
+    // Returns a cleared submission queue entry. Submits queued entries first
+    // if the submission queue is full.
+    void* NextSubmissionEntry();
+
+    // Submits queued entries without waiting for completions.
+    void Submit();
+
+    int ring_descriptor_ {-1};
+    void* sq_ring_ptr_ {nullptr};
+    std::size_t sq_ring_size_ {0U};
+    void* cq_ring_ptr_ {nullptr};
+    std::size_t cq_ring_size_ {0U};
+    void* sqes_ptr_ {nullptr};
+    std::size_t sqes_size_ {0U};
+
+    // Pointers into the mapped rings.
+    unsigned int* sq_head_ptr_ {nullptr};
+    unsigned int* sq_tail_ptr_ {nullptr};
+    unsigned int* sq_array_ptr_ {nullptr};
+    unsigned int sq_mask_ {0U};
+    unsigned int sq_entries_ {0U};
+    unsigned int* cq_head_ptr_ {nullptr};
+    unsigned int* cq_tail_ptr_ {nullptr};
+    unsigned int cq_mask_ {0U};
+    void* cqes_ptr_ {nullptr};
+
+    // The number of entries which were queued and not yet submitted.
+    unsigned int to_submit_ {0U};
+
+    std::uint32_t next_tag_ {1U};
+
+    // A map from an armed descriptor to the user data of its poll operation.
+    std::map<int, std::uint64_t> registrations_ {};
+  };
+
   // FRIENDS
 
   friend class FcgiRequest;
@@ -714,8 +1364,8 @@ class FcgiServerInterface {
     return (lhs.first < rhs.first);
   }
 
-  //    AcceptConnection wraps the accept system call. It performs socket error
-  // checking and FastCGI IP address validation. When a connection is accepted,
+  //    AcceptConnection wraps the accept4 system call. It performs socket
+  // error checking and FastCGI IP address validation. When a connection is accepted,
   // interface state is updated so that requests can be received over the
   // connection.
   //    It is intended that AcceptConnection is called in a loop in the
@@ -741,23 +1391,47 @@ class FcgiServerInterface {
   // 1) Connection validation uses several criteria:
   //    a) maximum_connection_count_
   //    b) application_overload_
-  //    c) If valid_ip_address_set_ is non-empty, whether or not the IP address
-  //       of the connection is in the set.
-  //    d) Whether or not the socket domain and type match socket_domain_ and
-  //       socket_type_, respectively.
-  //    Failure to meet any criterion results in connection rejection.       
+  //    c) If address_allowlist_ is non-empty, whether or not the IP address
+  //       of the connection is covered by the allowlist. The comparison uses
+  //       the binary address; the address is not converted to text.
+  //    Failure to meet any criterion results in connection rejection.
+  //    An accepted socket inherits the domain and type of the listening
+  //    socket. As such, these are not queried for each connection. The
+  //    domain is given by socket_domain_, and the type was verified to be
+  //    SOCK_STREAM during construction.
   // 2) If a connection request was pending on listening_socket_ and the
   //    connection was validated after being accepted:
   //    a) A new connected socket with a descriptor equal to the returned value
   //       is present.
-  //    b) The socket is non-blocking. 
+  //    b) The socket is non-blocking and close-on-exec. Both flags were set
+  //       atomically by accept4.
   //    c) The returned socket descriptor was added to record_status_map_, 
   //       write_mutex_map_, and request_count_map_. The appropriate default
   //       values were added as map values for the descriptor.
   // 3) If a connection was rejected, 0 was returned.
-  // 4) If a blocking error was returned by accept, -1 was returned.
+  // 4) If a blocking error was returned by accept4, -1 was returned.
+  // 5) connection_acceptance_counters_ was updated to reflect acceptance or
+  //    rejection.
   int AcceptConnection();
 
+  // Adds the connected socket given by connection to record_status_map_,
+  // write_mutex_map_, write_combiner_map_, and request_count_map_, and arms
+  // it for IoBackend::kIoUring. Used by AcceptConnection and
+  // CreateLoopbackConnection.
+  //
+  // Synchronization:
+  // 1) Acquires and releases interface_state_mutex_.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception.
+  // 2) On a throw, interface state is not modified (strong exception
+  //    guarantee). The descriptor is not closed.
+  // 3) May terminate the program if state could not be restored.
+  //
+  // Effects:
+  // 1) The connection was added and counted as accepted.
+  void AddConnection(int connection);
+
   // Attempts to add a new RequestData object to request_map_ while
   // maintaining the invariant between request_map_ and request_count_map_.
   //
@@ -937,6 +1611,9 @@ class FcgiServerInterface {
   // 1) If request_id was a key to an item of request_map_, the item was
   //    removed from request_map_ and
   //    request_count_map_[request_id.descriptor()] was decremented.
+  // 2) The backpressure usage of the request was released. If the request
+  //    was assigned and connections were throttled, the self-pipe was
+  //    written to so that a blocked interface re-evaluates throttling.
   void RemoveRequestHelper(std::map<FcgiRequestIdentifier, RequestData>::iterator 
     iter);
 
@@ -958,13 +1635,155 @@ class FcgiServerInterface {
   // Effects:
   // 1) Requests associated with connection which were assigned
   //    had the connection_closed_by_interface_ flag of their RequestData
-  //    object set.
+  //    object set. Their abort signals were set by SignalAbort.
   // 2) Requests associated with connection which were not assigned were
   //    removed from request_map_.
   // 3) Returns true if requests associated with connection were present and
   //    assigned. Returns false otherwise.
   bool RequestCleanupDuringConnectionClosure(int connection);
 
+  // Sets the abort flag of the AbortSignal of *request_data_ptr, if it has
+  // one, and schedules the invocation of its callback by
+  // NotifyAbortSignals. If connection_closed is true, the connection_closed
+  // flag of the AbortSignal is also set.
+  //
+  // Preconditions:
+  // 1) interface_state_mutex_ must be held prior to a call.
+  //
+  // Exceptions:
+  // 1) May throw std::bad_alloc. The abort flag was set.
+  void SignalAbort(RequestData* request_data_ptr, bool connection_closed);
+
+  // Invokes the callbacks of the abort signals which were scheduled by
+  // SignalAbort.
+  //
+  // Synchronization:
+  // 1) Acquires and releases interface_state_mutex_. The callbacks are
+  //    invoked after it was released.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception if
+  //    interface_state_mutex_ cannot be acquired. Callbacks are invoked in a
+  //    noexcept context.
+  void NotifyAbortSignals();
+
+  // Records the queueing delay of an assigned request if admission control
+  // is enabled. Called by FcgiRequest objects upon their first write.
+  //
+  // Preconditions:
+  // 1) interface_state_mutex_ must be held prior to a call.
+  inline void RecordQueueingDelay(std::chrono::nanoseconds delay) noexcept
+  {
+    if(admission_controller_)
+      admission_controller_->RecordQueueingDelay(delay);
+  }
+
+  // Returns true if backpressure_budgets_ has a budget which is enforced.
+  inline bool BackpressureEnabled() const noexcept
+  {
+    return backpressure_budgets_.connection_buffered_bytes    ||
+           backpressure_budgets_.total_buffered_bytes         ||
+           backpressure_budgets_.connection_assigned_requests ||
+           backpressure_budgets_.total_assigned_requests;
+  }
+
+  // Returns true if the total usage of the interface exceeds a total
+  // backpressure budget. pending_assignments is as for BudgetExceeded.
+  //
+  // Preconditions:
+  // 1) interface_state_mutex_ must be held prior to a call.
+  inline bool TotalBudgetExceeded(int pending_assignments) const noexcept
+  {
+    int total_assigned {total_assigned_request_count_ + pending_assignments};
+    return
+      (backpressure_budgets_.total_assigned_requests &&
+        (total_assigned >= backpressure_budgets_.total_assigned_requests)) ||
+      (backpressure_budgets_.total_buffered_bytes && total_assigned &&
+        (total_buffered_byte_count_ >=
+         backpressure_budgets_.total_buffered_bytes));
+  }
+
+  // Adds connection to throttling_update_set_ when a budget is enforced.
+  // Called when the backpressure usage of connection changes.
+  //
+  // Preconditions:
+  // 1) interface_state_mutex_ must be held prior to a call.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception. In the event of a
+  //    throw, bad_interface_state_detected_ == true.
+  inline void RecordLoadChange(int connection)
+  {
+    if(!BackpressureEnabled())
+      return;
+    try
+    {
+      throttling_update_set_.insert(connection);
+    }
+    catch(...)
+    {
+      bad_interface_state_detected_ = true;
+      throw;
+    }
+  }
+
+  // Adds count buffered bytes to the usage of connection and of the
+  // interface. Called when request data is appended to a RequestData object.
+  //
+  // Preconditions:
+  // 1) interface_state_mutex_ must be held prior to a call.
+  //
+  // Exceptions:
+  // 1) Throws std::logic_error if connection is not in request_count_map_.
+  //    bad_interface_state_detected_ == true after a throw.
+  // 2) May throw other exceptions derived from std::exception as for
+  //    RecordLoadChange. The usage is then unchanged.
+  void AddBufferedBytes(int connection, std::size_t count);
+
+  // Moves the usage of a request from the buffered byte budgets to the
+  // assigned request budgets. Called when an FcgiRequest object was produced
+  // for the request.
+  //
+  // Parameters:
+  // request_id:     The identifier of the request.
+  // buffered_bytes: The buffered byte count of the request before its data
+  //                 was moved to the FcgiRequest object.
+  //
+  // Preconditions:
+  // 1) interface_state_mutex_ must be held prior to a call.
+  //
+  // Exceptions:
+  // 1) As for AddBufferedBytes.
+  void AssignBudget(FcgiRequestIdentifier request_id,
+    std::size_t buffered_bytes);
+
+  // Returns true if connection or the interface exceeds a backpressure
+  // budget. pending_assignments is the number of requests of connection
+  // which are complete and for which FcgiRequest objects have not yet been
+  // produced. These are counted as assigned.
+  //
+  // Preconditions:
+  // 1) interface_state_mutex_ must be held prior to a call.
+  //
+  // Exceptions:
+  // 1) As for AddBufferedBytes.
+  bool BudgetExceeded(int connection, std::size_t pending_assignments);
+
+  // Updates throttled_connection_set_ from the usage of the connections of
+  // throttling_update_set_. Every connection of record_status_map_ is
+  // examined instead if throttling_update_all_ is set or if the total usage
+  // crossed a total budget since the last update. For IoBackend::kIoUring,
+  // connections which became throttled are disarmed, and connections which
+  // are no longer throttled are armed.
+  //
+  // Preconditions:
+  // 1) interface_state_mutex_ must be held prior to a call.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception.
+  // 2) In the event of a throw, bad_interface_state_detected_ == true.
+  void UpdateThrottling();
+
   // Attempts to send an FCGI_END_REQUEST record to a client over connection.
   // The request is identified by request_id. The body of the record contains
   // the given protocol_status and app_status fields.
@@ -1136,6 +1955,11 @@ class FcgiServerInterface {
   // discipline is not needed to access the value.)
   static constexpr time_t kWriteBlockTimeout_ {300};
 
+  // The maximum number of bytes which are reserved for the FCGI_STDIN stream
+  // of a request from its CONTENT_LENGTH value. Larger streams grow as they
+  // are received.
+  static constexpr std::size_t kMaximumStdinReservation_ {16U * 1024U * 1024U};
+
   // Configuration parameters:
   int listening_descriptor_;
     // The default application exit status that will be sent when requests
@@ -1144,13 +1968,33 @@ class FcgiServerInterface {
   int maximum_connection_count_;
   int maximum_request_count_per_connection_;
   int socket_domain_;
-    // A list of IP addresses from which the interface will accept connections.
-    // The IP version is given by socket_domain_ (AF_INET or AF_INET6).
-  std::set<std::string> valid_ip_address_set_;
+    // The IP addresses and CIDR prefixes from which the interface will accept
+    // connections. The allowlist is empty if address validation does not
+    // occur. Otherwise, its domain is socket_domain_ (AF_INET or AF_INET6).
+  AddressAllowlist address_allowlist_ {};
 
   // An application-set overload flag.
   bool application_overload_ {false};
 
+  BackpressureBudgets backpressure_budgets_ {};
+
+  std::size_t read_budget_ {kDefaultReadBudget};
+  // The last connection whose read budget was exhausted during the previous
+  // call of AcceptRequests or -1. Connections are read in a round-robin order
+  // which starts after this descriptor.
+  int read_resume_descriptor_ {-1};
+
+  // Empty unless set_request_classifier was called with a non-empty function.
+  RequestClassifier request_classifier_ {};
+
+  ConnectionAcceptanceCounters connection_acceptance_counters_ {};
+
+  // Null when select is used. See IoBackend.
+  std::unique_ptr<IoUringPoller> io_uring_poller_ {};
+  // Descriptors which were found to be ready by io_uring_poller_. The vector
+  // is reused across calls to AcceptRequests.
+  std::vector<int> ready_descriptors_ {};
+
   // File descriptors of the self-pipe which is used for wake ups on state
   // changes from blocking during I/O multiplexing for incoming connections 
   // and data. (The write descriptor is in the shared section below.)
@@ -1165,6 +2009,19 @@ class FcgiServerInterface {
 
   std::set<int> dummy_descriptor_set_ {};
 
+  // Connections which are not read because they exceed a backpressure
+  // budget. The set is a subset of the keys of record_status_map_.
+  std::set<int> throttled_connection_set_ {};
+  // Connections whose backpressure usage changed since the last call of
+  // UpdateThrottling. Descriptors of closed connections may be present.
+  std::set<int> throttling_update_set_ {};
+  // Set when every connection must be examined by the next call of
+  // UpdateThrottling, as when the budgets were changed.
+  bool          throttling_update_all_ {false};
+  // The value of TotalBudgetExceeded(0) at the last call of
+  // UpdateThrottling.
+  bool          total_budget_exceeded_ {false};
+
   std::vector<FcgiRequest> request_buffer_on_throw_ {};
 
   ///////////////// SHARED DATA REQUIRING SYNCHRONIZATION START ///////////////
@@ -1187,6 +2044,11 @@ class FcgiServerInterface {
   std::map<int, std::pair<std::unique_ptr<std::mutex>, bool>> 
   write_mutex_map_ {};
 
+  // A map to retrieve a connection's write combiner. The keys are those of
+  // write_mutex_map_. (A unique_ptr is used as a WriteCombiner may be
+  // accessed by a request thread while the map is modified.)
+  std::map<int, std::unique_ptr<WriteCombiner>> write_combiner_map_ {};
+
   // Static state used by FcgiRequest objects to check if the interface with
   // which they are associated is alive. The mutex is also used for general
   // synchronization among request objects and between request objects and
@@ -1206,9 +2068,24 @@ class FcgiServerInterface {
   // for an orderly closure of the connection by the interface thread.
   std::set<int> application_closure_request_set_ {};
 
-  // A map to retrieve the total number of requests associated with a
-  // connection.
-  std::map<int, int> request_count_map_ {};
+  // The abort signals whose flags were set by SignalAbort and whose callbacks
+  // have not yet been invoked by NotifyAbortSignals.
+  std::vector<std::shared_ptr<AbortSignal>> pending_abort_signals_ {};
+
+  // A map to retrieve the number of requests associated with a connection
+  // and the backpressure usage of those requests.
+  std::map<int, ConnectionLoad> request_count_map_ {};
+
+  // The sums of the backpressure usage of every connection.
+  std::size_t total_buffered_byte_count_    {0U};
+  int         total_assigned_request_count_ {0};
+  // True if throttled_connection_set_ was non-empty after its last update.
+  // Read by FcgiRequest objects when their requests are removed.
+  bool        throttling_active_            {false};
+
+  // Empty unless EnableAdmissionControl was called. Updated by FcgiRequest
+  // objects upon their first write and when their requests are removed.
+  std::optional<AdmissionController> admission_controller_ {};
 
   // A repository for incomplete request data and a marker for
   // assigned requests. The FcgiRequestIdentifier is the pair defined by the
@@ -0,0 +1,136 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// The level selection policy of PriorityRequestQueue: smooth weighted round
+// robin over a fixed number of levels.
+// * Each level has a positive weight which is given at construction.
+// * Select chooses one of the levels which are ready, for example the levels
+//   of a queue which are non-empty. Every ready level gains its weight in
+//   credit, the ready level with the most credit is chosen, and the chosen
+//   level pays the sum of the weights of the ready levels. Lower levels win
+//   ties.
+// * While the set of ready levels does not change, out of a sum of the weights
+//   of the ready levels consecutive selections, each ready level is selected
+//   a number of times which is equal to its weight, and the selections of a
+//   level are spread across the sequence.
+// * Idle discards the credit or debt of a level. It should be called when a
+//   level stops being ready so that a level which was idle neither claims a
+//   burst of selections nor waits to repay a debt when it becomes ready.
+// * A WeightedRoundRobin performs no synchronization.
+
+#ifndef AS_COMPONENTS_FCGI_INCLUDE_FCGI_WEIGHTED_ROUND_ROBIN_H_
+#define AS_COMPONENTS_FCGI_INCLUDE_FCGI_WEIGHTED_ROUND_ROBIN_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace as_components {
+namespace fcgi {
+
+class WeightedRoundRobin {
+ public:
+  // Parameters:
+  // weights: The weight of each level. weights[0] is the weight of level 0.
+  //
+  // Exceptions:
+  // 1) May throw exceptions derived from std::exception.
+  // 2) Throws std::invalid_argument if weights is empty or if a weight is
+  //    zero.
+  inline explicit WeightedRoundRobin(const std::vector<unsigned int>& weights)
+  : levels_ {}
+  {
+    if(weights.empty())
+      throw std::invalid_argument {"No levels were given to a "
+        "WeightedRoundRobin."};
+    levels_.reserve(weights.size());
+    for(unsigned int weight : weights)
+    {
+      if(weight == 0U)
+        throw std::invalid_argument {"A level of a WeightedRoundRobin was "
+          "given a weight of zero."};
+      levels_.push_back({weight, 0});
+    }
+  }
+
+  // Chooses the next level among the ready levels.
+  //
+  // Parameters:
+  // is_ready: A callable which is invoked as is_ready(level) for each level
+  //           in increasing order. It returns true if level may be chosen.
+  //
+  // Exceptions:
+  // 1) Exceptions which are thrown by is_ready are propagated. The credit of
+  //    the levels which were examined before the throw was changed.
+  //
+  // Effects:
+  // 1) Returns the chosen level, or level_count() if no level was ready.
+  template<typename IsReady>
+  inline std::size_t Select(IsReady&& is_ready)
+  {
+    std::int64_t total_weight {0};
+    std::size_t  chosen {levels_.size()};
+    for(std::size_t i {0U}; i < levels_.size(); ++i)
+    {
+      if(!is_ready(i))
+        continue;
+      levels_[i].current += levels_[i].weight;
+      total_weight       += levels_[i].weight;
+      if((chosen == levels_.size()) ||
+         (levels_[i].current > levels_[chosen].current))
+        chosen = i;
+    }
+    if(chosen != levels_.size())
+      levels_[chosen].current -= total_weight;
+    return chosen;
+  }
+
+  // Discards the credit or debt of level.
+  //
+  // Preconditions:
+  // 1) level < level_count().
+  inline void Idle(std::size_t level) noexcept
+  {
+    levels_[level].current = 0;
+  }
+
+  inline std::size_t level_count() const noexcept
+  {
+    return levels_.size();
+  }
+
+ private:
+  struct Level
+  {
+    std::int64_t weight;
+    // The running credit of the level.
+    std::int64_t current;
+  };
+
+  std::vector<Level> levels_;
+};
+
+} // namespace fcgi
+} // namespace as_components
+
+#endif // AS_COMPONENTS_FCGI_INCLUDE_FCGI_WEIGHTED_ROUND_ROBIN_H_
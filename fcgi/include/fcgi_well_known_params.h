@@ -0,0 +1,250 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// An index of the environment variables which are commonly defined for a
+// request by a web server: the meta-variables of CGI/1.1 (RFC 3875) and the
+// variables which web servers such as nginx define by default for FastCGI.
+// * FcgiWellKnownParams::Find maps a variable name to the index of an
+//   FcgiParam value with a perfect hash. The hash function and its table are
+//   generated at compile time. A lookup hashes the name once and compares it
+//   with at most one known name. Names which are longer than the longest
+//   known name are rejected without hashing.
+// * FcgiServerInterface uses the index while FCGI_PARAMS is parsed so that
+//   FcgiRequest::Param can return the value of a well-known variable without
+//   a map lookup.
+// * The functions are constexpr, do not allocate, and do not throw.
+//
+// Implementation discussion:
+//    The hash is a seeded FNV-1a hash which is reduced to an index of a table
+// with kTableSize slots. kSeed is the smallest seed for which the known names
+// have distinct indices. It is found by a constexpr search, and the table is
+// built from it. A static_assert fails compilation if no seed is found. A
+// slot holds the FcgiParam value of the name which hashes to it or
+// kParamCount for an empty slot.
+
+#ifndef AS_COMPONENTS_FCGI_INCLUDE_FCGI_WELL_KNOWN_PARAMS_H_
+#define AS_COMPONENTS_FCGI_INCLUDE_FCGI_WELL_KNOWN_PARAMS_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace as_components {
+namespace fcgi {
+
+// The order of the values matches the order of the names of
+// well_known_params_internal::kNames.
+enum class FcgiParam : std::uint8_t
+{
+  kAuthType = 0U,
+  kContentLength,
+  kContentType,
+  kDocumentRoot,
+  kDocumentUri,
+  kGatewayInterface,
+  kHttps,
+  kHttpAccept,
+  kHttpCookie,
+  kHttpHost,
+  kHttpUserAgent,
+  kPathInfo,
+  kPathTranslated,
+  kQueryString,
+  kRedirectStatus,
+  kRemoteAddr,
+  kRemoteHost,
+  kRemoteIdent,
+  kRemotePort,
+  kRemoteUser,
+  kRequestMethod,
+  kRequestScheme,
+  kRequestUri,
+  kScriptFilename,
+  kScriptName,
+  kServerAddr,
+  kServerName,
+  kServerPort,
+  kServerProtocol,
+  kServerSoftware
+};
+
+namespace well_known_params_internal {
+
+constexpr std::size_t kParamCount {static_cast<std::size_t>(
+  FcgiParam::kServerSoftware) + 1U};
+
+constexpr const char* kNames[kParamCount] =
+{
+  "AUTH_TYPE",
+  "CONTENT_LENGTH",
+  "CONTENT_TYPE",
+  "DOCUMENT_ROOT",
+  "DOCUMENT_URI",
+  "GATEWAY_INTERFACE",
+  "HTTPS",
+  "HTTP_ACCEPT",
+  "HTTP_COOKIE",
+  "HTTP_HOST",
+  "HTTP_USER_AGENT",
+  "PATH_INFO",
+  "PATH_TRANSLATED",
+  "QUERY_STRING",
+  "REDIRECT_STATUS",
+  "REMOTE_ADDR",
+  "REMOTE_HOST",
+  "REMOTE_IDENT",
+  "REMOTE_PORT",
+  "REMOTE_USER",
+  "REQUEST_METHOD",
+  "REQUEST_SCHEME",
+  "REQUEST_URI",
+  "SCRIPT_FILENAME",
+  "SCRIPT_NAME",
+  "SERVER_ADDR",
+  "SERVER_NAME",
+  "SERVER_PORT",
+  "SERVER_PROTOCOL",
+  "SERVER_SOFTWARE"
+};
+
+constexpr std::size_t kTableSize {128U};
+
+template<typename Byte>
+constexpr std::size_t Hash(const Byte* name, std::size_t length,
+  std::uint32_t seed) noexcept
+{
+  std::uint32_t hash {2166136261U ^ seed};
+  for(std::size_t i {0U}; i < length; ++i)
+    hash = (hash ^ static_cast<std::uint8_t>(name[i])) * 16777619U;
+  return (hash ^ (hash >> 15U)) & (kTableSize - 1U);
+}
+
+constexpr std::size_t Length(const char* name) noexcept
+{
+  std::size_t length {0U};
+  while(name[length] != '\0')
+    ++length;
+  return length;
+}
+
+constexpr std::size_t MaximumNameLength() noexcept
+{
+  std::size_t maximum {0U};
+  for(const char* name : kNames)
+    maximum = (Length(name) > maximum) ? Length(name) : maximum;
+  return maximum;
+}
+
+// Returns the smallest seed for which the known names have distinct indices
+// or zero if no seed less than kSeedLimit is suitable. A seed of zero is not
+// tried.
+constexpr std::uint32_t FindSeed() noexcept
+{
+  constexpr std::uint32_t kSeedLimit {4096U};
+  for(std::uint32_t seed {1U}; seed < kSeedLimit; ++seed)
+  {
+    bool used[kTableSize] = {};
+    bool collision {false};
+    for(const char* name : kNames)
+    {
+      std::size_t index {Hash(name, Length(name), seed)};
+      collision = collision || used[index];
+      used[index] = true;
+    }
+    if(!collision)
+      return seed;
+  }
+  return 0U;
+}
+
+constexpr std::array<std::uint8_t, kTableSize> MakeTable(std::uint32_t seed)
+  noexcept
+{
+  std::array<std::uint8_t, kTableSize> table {};
+  for(std::size_t i {0U}; i < kTableSize; ++i)
+    table[i] = static_cast<std::uint8_t>(kParamCount);
+  for(std::size_t i {0U}; i < kParamCount; ++i)
+    table[Hash(kNames[i], Length(kNames[i]), seed)] =
+      static_cast<std::uint8_t>(i);
+  return table;
+}
+
+constexpr std::array<std::size_t, kParamCount> MakeLengths() noexcept
+{
+  std::array<std::size_t, kParamCount> lengths {};
+  for(std::size_t i {0U}; i < kParamCount; ++i)
+    lengths[i] = Length(kNames[i]);
+  return lengths;
+}
+
+constexpr std::size_t kMaximumNameLength {MaximumNameLength()};
+constexpr std::array<std::size_t, kParamCount> kLengths {MakeLengths()};
+constexpr std::uint32_t kSeed {FindSeed()};
+static_assert(kSeed != 0U, "No perfect hash was found for the names of "
+  "FcgiWellKnownParams.");
+constexpr std::array<std::uint8_t, kTableSize> kTable {MakeTable(kSeed)};
+
+} // namespace well_known_params_internal
+
+class FcgiWellKnownParams {
+ public:
+  static constexpr std::size_t kParamCount
+    {well_known_params_internal::kParamCount};
+
+  // Returns the name of a well-known variable.
+  static constexpr const char* Name(FcgiParam param) noexcept
+  {
+    return well_known_params_internal::kNames[static_cast<std::size_t>(param)];
+  }
+
+  // Returns the index of the well-known variable whose name is the byte
+  // sequence [name, name + length). kParamCount is returned if the sequence
+  // is not the name of a well-known variable.
+  //
+  // Preconditions:
+  // 1) [name, name + length) is a valid range.
+  static constexpr std::size_t Find(const std::uint8_t* name,
+    std::size_t length) noexcept
+  {
+    namespace internal = well_known_params_internal;
+    if(length > internal::kMaximumNameLength)
+      return kParamCount;
+    std::size_t index {internal::kTable[internal::Hash(name, length,
+      internal::kSeed)]};
+    if((index == kParamCount) || (internal::kLengths[index] != length))
+      return kParamCount;
+    const char* known_name {internal::kNames[index]};
+    for(std::size_t i {0U}; i < length; ++i)
+    {
+      if(static_cast<std::uint8_t>(known_name[i]) != name[i])
+        return kParamCount;
+    }
+    return index;
+  }
+
+  FcgiWellKnownParams() = delete;
+};
+
+} // namespace fcgi
+} // namespace as_components
+
+#endif // AS_COMPONENTS_FCGI_INCLUDE_FCGI_WELL_KNOWN_PARAMS_H_
@@ -0,0 +1,130 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "fcgi/include/fcgi_metrics.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace as_components {
+namespace fcgi {
+
+namespace {
+
+// The size of a cache line on the targeted processors.
+constexpr std::size_t kCacheLineSize {64U};
+
+struct Histogram
+{
+  std::atomic<std::uint64_t> count;
+  std::atomic<std::uint64_t> sum_nanoseconds;
+  std::atomic<std::uint64_t> buckets[FcgiMetrics::kBucketCount];
+};
+
+// Static storage is zero-initialized before any dynamic initialization. No
+// constructor needs to run before a shard is used.
+struct alignas(kCacheLineSize) Shard
+{
+  std::atomic<std::uint64_t> counters[FcgiMetrics::kCounterCount];
+  std::atomic<std::uint64_t> records[FcgiMetrics::kRecordTypeCount];
+  Histogram                  histograms[FcgiMetrics::kHistogramCount];
+};
+
+Shard shards[FcgiMetrics::kShardCount];
+std::atomic<std::size_t> next_shard_index {0U};
+
+inline Shard& LocalShard() noexcept
+{
+  thread_local Shard* shard_ptr {nullptr};
+  if(shard_ptr == nullptr)
+  {
+    shard_ptr = &shards[next_shard_index.fetch_add(1U,
+      std::memory_order_relaxed) % FcgiMetrics::kShardCount];
+  }
+  return *shard_ptr;
+}
+
+inline std::uint64_t Load(const std::atomic<std::uint64_t>& value) noexcept
+{
+  return value.load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+void FcgiMetrics::Add(FcgiCounter c, std::uint64_t n) noexcept
+{
+  LocalShard().counters[static_cast<std::size_t>(c)].fetch_add(n,
+    std::memory_order_relaxed);
+}
+
+void FcgiMetrics::CountRecord(FcgiType type) noexcept
+{
+  std::size_t index {static_cast<std::size_t>(type)};
+  if(index >= kRecordTypeCount)
+    index = 0U;
+  LocalShard().records[index].fetch_add(1U, std::memory_order_relaxed);
+}
+
+void FcgiMetrics::Record(FcgiHistogram h, std::chrono::nanoseconds duration)
+  noexcept
+{
+  std::uint64_t nanoseconds {(duration.count() > 0) ?
+    static_cast<std::uint64_t>(duration.count()) : 0U};
+  // The index of the most significant set bit is the base-two logarithm
+  // rounded down.
+  std::size_t bucket {(nanoseconds == 0U) ? 0U :
+    static_cast<std::size_t>(63 - __builtin_clzll(nanoseconds))};
+  if(bucket >= kBucketCount)
+    bucket = kBucketCount - 1U;
+  Histogram& histogram
+    {LocalShard().histograms[static_cast<std::size_t>(h)]};
+  histogram.count.fetch_add(1U, std::memory_order_relaxed);
+  histogram.sum_nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+  histogram.buckets[bucket].fetch_add(1U, std::memory_order_relaxed);
+}
+
+FcgiMetrics::MetricsSnapshot FcgiMetrics::Snapshot() noexcept
+{
+  MetricsSnapshot snapshot {};
+  for(const Shard& shard : shards)
+  {
+    for(std::size_t i {0U}; i < kCounterCount; ++i)
+      snapshot.counters[i] += Load(shard.counters[i]);
+    for(std::size_t i {0U}; i < kRecordTypeCount; ++i)
+      snapshot.records_parsed_by_type[i] += Load(shard.records[i]);
+    for(std::size_t h {0U}; h < kHistogramCount; ++h)
+    {
+      const Histogram& histogram {shard.histograms[h]};
+      HistogramSnapshot& result {snapshot.histograms[h]};
+      result.count           += Load(histogram.count);
+      result.sum_nanoseconds += Load(histogram.sum_nanoseconds);
+      for(std::size_t b {0U}; b < kBucketCount; ++b)
+        result.buckets[b] += Load(histogram.buckets[b]);
+    }
+  }
+  return snapshot;
+}
+
+} // namespace fcgi
+} // namespace as_components
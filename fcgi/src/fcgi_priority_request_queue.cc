@@ -0,0 +1,149 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "fcgi/include/fcgi_priority_request_queue.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "fcgi/include/fcgi_request.h"
+#include "fcgi/include/fcgi_weighted_round_robin.h"
+
+namespace as_components {
+namespace fcgi {
+
+PriorityRequestQueue::PriorityRequestQueue(
+  const std::vector<unsigned int>& weights)
+// The weights are validated by the construction of scheduler_.
+: mutex_             {},
+  request_available_ {},
+  scheduler_         {weights},
+  // The move constructor of std::deque is not noexcept. Levels are
+  // constructed in place as a vector of levels cannot be reallocated.
+  levels_            (weights.size()),
+  size_              {0U},
+  closed_            {false}
+{}
+
+void PriorityRequestQueue::Close()
+{
+  {
+    std::lock_guard<std::mutex> lock {mutex_};
+    closed_ = true;
+  }
+  request_available_.notify_all();
+}
+
+bool PriorityRequestQueue::Pop(FcgiRequest* request_ptr)
+{
+  std::unique_lock<std::mutex> lock {mutex_};
+  request_available_.wait(lock, [this]()->bool
+    {
+      return (size_ > 0U) || closed_;
+    }
+  );
+  if(size_ == 0U)
+    return false;
+  PopHelper(request_ptr);
+  return true;
+}
+
+// Synchronization:
+// 1) mutex_ must be held prior to a call.
+// 2) size_ must be greater than zero.
+void PriorityRequestQueue::PopHelper(FcgiRequest* request_ptr)
+{
+  std::size_t index {scheduler_.Select([this](std::size_t level)->bool
+    {
+      return !levels_[level].empty();
+    }
+  )};
+  std::deque<FcgiRequest>& level {levels_[index]};
+  *request_ptr = std::move(level.front());
+  level.pop_front();
+  --size_;
+  // A level which became empty does not retain credit or debt.
+  if(level.empty())
+    scheduler_.Idle(index);
+}
+
+void PriorityRequestQueue::Push(FcgiRequest&& request)
+{
+  {
+    std::lock_guard<std::mutex> lock {mutex_};
+    if(closed_)
+      throw std::logic_error {"A request was pushed to a closed "
+        "PriorityRequestQueue."};
+    PushHelper(std::move(request));
+  }
+  request_available_.notify_one();
+}
+
+void PriorityRequestQueue::Push(std::vector<FcgiRequest>&& requests)
+{
+  if(requests.empty())
+    return;
+  {
+    std::lock_guard<std::mutex> lock {mutex_};
+    if(closed_)
+      throw std::logic_error {"A request was pushed to a closed "
+        "PriorityRequestQueue."};
+    for(FcgiRequest& request : requests)
+      PushHelper(std::move(request));
+  }
+  requests.clear();
+  request_available_.notify_all();
+}
+
+// Synchronization:
+// 1) mutex_ must be held prior to a call.
+void PriorityRequestQueue::PushHelper(FcgiRequest&& request)
+{
+  std::size_t index {request.get_priority()};
+  if(index >= levels_.size())
+    index = levels_.size() - 1U;
+  levels_[index].push_back(std::move(request));
+  ++size_;
+}
+
+std::size_t PriorityRequestQueue::size() const
+{
+  std::lock_guard<std::mutex> lock {mutex_};
+  return size_;
+}
+
+bool PriorityRequestQueue::TryPop(FcgiRequest* request_ptr)
+{
+  std::lock_guard<std::mutex> lock {mutex_};
+  if(size_ == 0U)
+    return false;
+  PopHelper(request_ptr);
+  return true;
+}
+
+} // namespace fcgi
+} // namespace as_components
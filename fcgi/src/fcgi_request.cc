@@ -242,6 +242,8 @@
 #include <unistd.h>
 
 #include <cerrno>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <map>
@@ -253,8 +255,10 @@
 #include <utility>
 #include <vector>
 
+#include "fcgi/include/fcgi_metrics.h"
 #include "fcgi/include/fcgi_protocol_constants.h"
 #include "fcgi/include/fcgi_request_identifier.h"
+#include "fcgi/include/fcgi_request_trace.h"
 #include "fcgi/include/fcgi_utilities.h"
 #include "socket_functions/include/socket_functions.h"
 
@@ -270,12 +274,18 @@ FcgiRequest::FcgiRequest()
   bad_connection_state_ptr_        {nullptr},
   interface_pipe_write_descriptor_ {-1},
   environment_map_                 {},
+  well_known_params_               {},
   request_stdin_content_           {},
   request_data_content_            {},
   role_                            {0U},
+  priority_                        {0U},
   close_connection_                {false},
   was_aborted_                     {false},
-  completed_                       {false}
+  completed_                       {false},
+  construction_time_               {},
+  response_started_                {false},
+  trace_                           {},
+  abort_signal_                    {}
 {}
 
 // Implementation notes:
@@ -299,12 +309,18 @@ FcgiRequest::FcgiRequest(
     bad_connection_state_ptr_        {bad_connection_state_ptr},
     interface_pipe_write_descriptor_ {write_fd},
     environment_map_                 {},
+    well_known_params_               {},
     request_stdin_content_           {},
     request_data_content_            {},
     role_                            {request_data_ptr->role_},
+    priority_                        {request_data_ptr->priority_},
     close_connection_                {request_data_ptr->close_connection_},
     was_aborted_                     {false},
-    completed_                       {false}
+    completed_                       {false},
+    construction_time_               {std::chrono::steady_clock::now()},
+    response_started_                {false},
+    trace_                           {std::move(request_data_ptr->trace_)},
+    abort_signal_                    {}
 {
   if((interface_ptr == nullptr || request_data_ptr == nullptr
      || write_mutex_ptr == nullptr || bad_connection_state_ptr == nullptr)
@@ -341,11 +357,17 @@ FcgiRequest::FcgiRequest(
     throw std::logic_error {error_status};
   }
 
+  // Allocated before any state of the interface is modified. A throw leaves
+  // the RequestData object unassigned.
+  abort_signal_ = std::make_shared<FcgiServerInterface::AbortSignal>();
+  request_data_ptr_->abort_signal_ = abort_signal_;
+
   // TODO double check noexcept specifications for move assignments.
   // It is currently assumed that move assignments are noexcept.
   // This assumption also applies to the move constructor and move assignment
   // operator.
   environment_map_       = std::move(request_data_ptr->environment_map_);
+  well_known_params_     = request_data_ptr->well_known_params_;
   request_stdin_content_ = std::move(request_data_ptr->FCGI_STDIN_);
   request_data_content_  = std::move(request_data_ptr->FCGI_DATA_);
   
@@ -353,6 +375,14 @@ FcgiRequest::FcgiRequest(
   // construction of an FcgiRequest which will be exposed to the application.
   request_data_ptr_->request_status_ =
     FcgiServerInterface::RequestStatus::kRequestAssigned;
+  FcgiMetrics::Record(FcgiHistogram::kBeginRequestToFcgiRequest,
+    construction_time_ - request_data_ptr->begin_request_time_);
+  if(trace_)
+  {
+    trace_->request_id = request_id;
+    trace_->points[static_cast<std::size_t>(
+      FcgiTracePoint::kFcgiRequestConstructed)] = construction_time_;
+  }
 }
 
 FcgiRequest::FcgiRequest(FcgiRequest&& request) noexcept
@@ -364,12 +394,18 @@ FcgiRequest::FcgiRequest(FcgiRequest&& request) noexcept
   bad_connection_state_ptr_        {request.bad_connection_state_ptr_},
   interface_pipe_write_descriptor_ {request.interface_pipe_write_descriptor_},
   environment_map_                 {std::move(request.environment_map_)},
+  well_known_params_               {request.well_known_params_},
   request_stdin_content_           {std::move(request.request_stdin_content_)},
   request_data_content_            {std::move(request.request_data_content_)},
   role_                            {request.role_},
+  priority_                        {request.priority_},
   close_connection_                {request.close_connection_},
   was_aborted_                     {request.was_aborted_},
-  completed_                       {request.completed_}
+  completed_                       {request.completed_},
+  construction_time_               {request.construction_time_},
+  response_started_                {request.response_started_},
+  trace_                           {std::move(request.trace_)},
+  abort_signal_                    {std::move(request.abort_signal_)}
 {
   request.associated_interface_id_ = 0U;
   request.interface_ptr_ = nullptr;
@@ -379,9 +415,11 @@ FcgiRequest::FcgiRequest(FcgiRequest&& request) noexcept
   request.bad_connection_state_ptr_ = nullptr;
   request.interface_pipe_write_descriptor_ = -1;
   request.environment_map_.clear();
+  request.well_known_params_.fill(nullptr);
   request.request_stdin_content_.clear();
   request.request_data_content_.clear();
   request.role_ = 0U;
+  request.priority_ = 0U;
   request.close_connection_ = false;
   request.was_aborted_ = false;
   request.completed_ = false;
@@ -403,12 +441,18 @@ FcgiRequest& FcgiRequest::operator=(FcgiRequest&& request)
     bad_connection_state_ptr_ = request.bad_connection_state_ptr_;
     interface_pipe_write_descriptor_ = request.interface_pipe_write_descriptor_;
     environment_map_ = std::move(request.environment_map_);
+    well_known_params_ = request.well_known_params_;
     request_stdin_content_ = std::move(request.request_stdin_content_);
     request_data_content_ = std::move(request.request_data_content_);
     role_ = request.role_;
+    priority_ = request.priority_;
     close_connection_ = request.close_connection_;
     was_aborted_ = request.was_aborted_;
     completed_ = request.completed_;
+    construction_time_ = request.construction_time_;
+    response_started_ = request.response_started_;
+    trace_ = std::move(request.trace_);
+    abort_signal_ = std::move(request.abort_signal_);
 
     request.associated_interface_id_ = 0U;
     request.interface_ptr_ = nullptr;
@@ -418,9 +462,11 @@ FcgiRequest& FcgiRequest::operator=(FcgiRequest&& request)
     request.bad_connection_state_ptr_ = nullptr;
     request.interface_pipe_write_descriptor_ = -1;
     request.environment_map_.clear();
+    request.well_known_params_.fill(nullptr);
     request.request_stdin_content_.clear();
     request.request_data_content_.clear();
     request.role_ = 0U;
+    request.priority_ = 0U;
     request.close_connection_ = false;
     request.was_aborted_ = false;
     request.completed_ = false;
@@ -568,6 +614,140 @@ bool FcgiRequest::AbortStatus()
   return was_aborted_;
 } // RELEASE interface_state_mutex_.
 
+// Synchronization:
+// 1) The write mutex of the connection must be held through *write_lock_ptr
+//    and combiner_ptr->combining must be true. The write mutex is released
+//    before return.
+// 2) interface_state_mutex_ must not be held.
+void FcgiRequest::CombineWrites(
+  FcgiServerInterface::WriteCombiner* combiner_ptr, int fd,
+  bool* bad_connection_state_ptr,
+  std::unique_lock<std::mutex>* write_lock_ptr)
+{
+  using PendingWrite = FcgiServerInterface::PendingWrite;
+
+  std::vector<PendingWrite*> batch {};
+  std::vector<struct iovec> iovec_list {};
+  try
+  {
+    while(true)
+    {
+      batch.clear();
+      iovec_list.clear();
+      std::size_t number_to_write {0U};
+      bool batch_empty {false};
+      {
+        std::lock_guard<std::mutex> combiner_lock {combiner_ptr->mutex};
+        std::vector<PendingWrite*>& pending_writes
+          {combiner_ptr->pending_writes};
+        if(pending_writes.empty())
+        {
+          // A thread which finds combining == false after combiner_lock is
+          // released waits for the write mutex, so no write is lost.
+          combiner_ptr->combining = false;
+          batch_empty = true;
+        }
+        else
+        {
+          // Writes are taken in the order in which they were handed over.
+          // The number of struct iovec instances of a batch is bounded by
+          // iovec_MAX.
+          std::vector<PendingWrite*>::size_type taken {0U};
+          for(/*no-op*/; taken < pending_writes.size(); ++taken)
+          {
+            PendingWrite* pending_ptr {pending_writes[taken]};
+            if(taken && ((iovec_list.size() +
+               static_cast<std::size_t>(pending_ptr->iovec_count)) >
+               static_cast<std::size_t>(iovec_MAX)))
+              break;
+            iovec_list.insert(iovec_list.end(), pending_ptr->iovec_ptr,
+              pending_ptr->iovec_ptr + pending_ptr->iovec_count);
+            number_to_write += pending_ptr->number_to_write;
+            batch.push_back(pending_ptr);
+          }
+          pending_writes.erase(pending_writes.begin(),
+            pending_writes.begin() + taken);
+        }
+      }
+      if(batch_empty)
+      {
+        // The combiner must never be accessed after the write mutex is
+        // released. The interface may then remove the connection and destroy
+        // the combiner. combiner_lock was destroyed above for this reason.
+        // RELEASE the write mutex.
+        write_lock_ptr->unlock();
+        return;
+      }
+
+      // As for ScatterGatherWriteHelper, blocking is limited to
+      // kWriteBlockTimeout_ seconds for each wait.
+      std::tuple<struct iovec*, int, std::size_t> write_return
+        {iovec_list.data(), static_cast<int>(iovec_list.size()),
+         number_to_write};
+      bool timed_out {false};
+      while(true)
+      {
+        std::size_t remaining {std::get<2>(write_return)};
+        write_return = as_components::socket_functions::
+          ScatterGatherSocketWrite(fd, std::get<0>(write_return),
+            std::get<1>(write_return), remaining);
+        FcgiMetrics::Add(FcgiCounter::kBytesWritten,
+          remaining - std::get<2>(write_return));
+        if((std::get<2>(write_return) == 0U) ||
+           !((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+          break;
+        fd_set write_set {};
+        int select_return {};
+        do
+        {
+          FD_ZERO(&write_set);
+          FD_SET(fd, &write_set);
+          struct timeval timeout {FcgiServerInterface::kWriteBlockTimeout_, 0};
+          select_return = select(fd + 1, nullptr, &write_set, nullptr,
+            &timeout);
+        } while((select_return == -1) && (errno == EINTR));
+        if(select_return <= 0)
+        {
+          timed_out = (select_return == 0);
+          break;
+        }
+      }
+      bool written {std::get<2>(write_return) == 0U};
+      if(written)
+        FcgiMetrics::Add(FcgiCounter::kCombinedWrites, batch.size());
+      else
+      {
+        if(std::get<2>(write_return) < number_to_write)
+          *bad_connection_state_ptr = true;
+        if(timed_out)
+          FcgiMetrics::Add(FcgiCounter::kWriteTimeouts);
+      }
+      for(PendingWrite* pending_ptr : batch)
+        SignalPendingWrite(pending_ptr, (written) ?
+          PendingWrite::Status::kWritten : PendingWrite::Status::kFailed);
+      batch.clear();
+      if(!written)
+      {
+        // The waiting threads schedule the connection for closure.
+        StopCombining(combiner_ptr);
+        // The combiner must never be accessed after this point.
+        // RELEASE the write mutex.
+        write_lock_ptr->unlock();
+        return;
+      }
+    }
+  }
+  catch(...)
+  {
+    for(PendingWrite* pending_ptr : batch)
+      SignalPendingWrite(pending_ptr, PendingWrite::Status::kFailed);
+    StopCombining(combiner_ptr);
+    if(write_lock_ptr->owns_lock())
+      write_lock_ptr->unlock();
+    throw;
+  }
+}
+
 // Implementation notes:
 // Synchronization:
 // 1) Acquires and releases interface_state_mutex_.
@@ -645,6 +825,20 @@ bool FcgiRequest::EndRequestHelper(std::int32_t app_status,
   if(write_return)
   {
     completed_ = true;
+    if(protocol_status == FCGI_REQUEST_COMPLETE)
+    {
+      std::chrono::steady_clock::time_point now
+        {std::chrono::steady_clock::now()};
+      FcgiMetrics::Add(FcgiCounter::kRequestsCompleted);
+      FcgiMetrics::Record(FcgiHistogram::kFcgiRequestToComplete,
+        now - construction_time_);
+      if(trace_)
+      {
+        trace_->points[static_cast<std::size_t>(
+          FcgiTracePoint::kCompleteWritten)] = now;
+        FcgiTracing::Submit(*trace_);
+      }
+    }
     try 
     {
       interface_ptr_->RemoveRequest(request_identifier_);
@@ -887,6 +1081,69 @@ ScatterGatherWriteHelper(struct iovec* iovec_ptr, int iovec_count,
     if(!InterfaceStateCheckForWritingUponMutexAcquisition())
       return false;
   }
+  // Write combining:
+  //    If another request thread holds the write mutex of the connection and
+  // is combining writes, the records of this call are handed to that thread.
+  // This thread then waits for the write without holding any mutex rather
+  // than waiting for the write mutex while it holds interface_state_mutex_.
+  // The thread which holds the write mutex writes the records of every
+  // waiting thread with one scatter-gather write before it releases the
+  // write mutex.
+  //    Combining is only used when interface_state_mutex_ is not held by the
+  // caller. Otherwise, no other thread could hand over a write.
+  FcgiServerInterface::WriteCombiner* combiner_ptr {nullptr};
+  if(!interface_mutex_held)
+  {
+    std::map<int, std::unique_ptr<FcgiServerInterface::WriteCombiner>>::
+      iterator combiner_iter {interface_ptr_->write_combiner_map_.find(
+        request_identifier_.descriptor())};
+    if(combiner_iter != interface_ptr_->write_combiner_map_.end())
+      combiner_ptr = combiner_iter->second.get();
+  }
+  if(combiner_ptr != nullptr)
+  {
+    FcgiServerInterface::PendingWrite pending_write
+      {iovec_ptr, iovec_count, number_to_write};
+    bool handed_over {false};
+    {
+      std::lock_guard<std::mutex> combiner_lock {combiner_ptr->mutex};
+      if(combiner_ptr->combining)
+      {
+        combiner_ptr->pending_writes.push_back(&pending_write);
+        handed_over = true;
+      }
+    }
+    if(handed_over)
+    {
+      if(!response_started_)
+      {
+        response_started_ = true;
+        interface_ptr_->RecordQueueingDelay(
+          std::chrono::steady_clock::now() - construction_time_);
+      }
+      // RELEASE interface_state_mutex_.
+      interface_state_lock.unlock();
+      FcgiServerInterface::PendingWrite::Status status {};
+      {
+        std::unique_lock<std::mutex> pending_lock {pending_write.mutex};
+        pending_write.written.wait(pending_lock, [&pending_write]()->bool
+          {
+            return pending_write.status !=
+              FcgiServerInterface::PendingWrite::Status::kPending;
+          }
+        );
+        status = pending_write.status;
+      }
+      if(status == FcgiServerInterface::PendingWrite::Status::kWritten)
+        return true;
+      // The combined write failed. The connection may be corrupt, and it was
+      // found to be closed or blocked. It is closed as for a time-out.
+      // May ACQUIRE interface_state_mutex_.
+      TryToAddToApplicationClosureRequestSet(true);
+      return false;
+    }
+  }
+
   // ACQUIRE *write_mutex_ptr_
   // This is a case where a throw may occur but FcgiRequest object state
   // is not updated.
@@ -908,6 +1165,37 @@ ScatterGatherWriteHelper(struct iovec* iovec_ptr, int iovec_count,
     interface_ptr_->RemoveRequest(request_identifier_);
     return false;
   }
+  if(!response_started_)
+  {
+    response_started_ = true;
+    interface_ptr_->RecordQueueingDelay(
+      std::chrono::steady_clock::now() - construction_time_);
+  }
+  // Begin combining. The destructor of combining_guard ends combining and
+  // fails the writes which were handed over if the write mutex is released
+  // on a path other than CombineWrites. It is destroyed before write_lock.
+  struct CombiningGuard
+  {
+    inline void Stop() noexcept
+    {
+      if(combiner_ptr != nullptr)
+        StopCombining(combiner_ptr);
+      combiner_ptr = nullptr;
+    }
+
+    ~CombiningGuard()
+    {
+      Stop();
+    }
+
+    FcgiServerInterface::WriteCombiner* combiner_ptr;
+  } combining_guard {nullptr};
+  if(combiner_ptr != nullptr)
+  {
+    std::lock_guard<std::mutex> combiner_lock {combiner_ptr->mutex};
+    combiner_ptr->combining = true;
+    combining_guard.combiner_ptr = combiner_ptr;
+  }
   // Conditionally RELEASE interface_state_mutex_ to free the interface
   // before the write. (The mutex will still be held by the caller if
   // interface_mutex_held == true.)
@@ -923,11 +1211,20 @@ ScatterGatherWriteHelper(struct iovec* iovec_ptr, int iovec_count,
     std::tuple<struct iovec*, int, std::size_t> write_return
       {as_components::socket_functions::ScatterGatherSocketWrite(fd, iovec_ptr,
         iovec_count, working_number_to_write)};
+    FcgiMetrics::Add(FcgiCounter::kBytesWritten,
+      working_number_to_write - std::get<2>(write_return));
     // Start return processing if-else-if ladder.
     if(std::get<2>(write_return) == 0) // All data was written.
     {
       // RELEASE *write_mutex_ptr_.
-      write_lock.unlock();
+      if(combining_guard.combiner_ptr != nullptr)
+      {
+        combining_guard.combiner_ptr = nullptr;
+        CombineWrites(combiner_ptr, fd, bad_connection_state_ptr_,
+          &write_lock);
+      }
+      else
+        write_lock.unlock();
       working_number_to_write = 0;
     }
     else // The number written was less than number_to_write. We must check 
@@ -981,6 +1278,7 @@ ScatterGatherWriteHelper(struct iovec* iovec_ptr, int iovec_count,
                 *bad_connection_state_ptr_ = true;
               }
               // RELEASE *write_mutex_ptr_.
+              combining_guard.Stop();
               write_lock.unlock();
 
               // May ACQUIRE interface_state_mutex_.
@@ -998,6 +1296,7 @@ ScatterGatherWriteHelper(struct iovec* iovec_ptr, int iovec_count,
               }
               else
               {
+                FcgiMetrics::Add(FcgiCounter::kWriteTimeouts);
                 return false; // A time-out is not exceptional.
               }
             }
@@ -1017,6 +1316,7 @@ ScatterGatherWriteHelper(struct iovec* iovec_ptr, int iovec_count,
         // The acquisition pattern "has write mutex, wants interface mutex"
         // is forbidden.
         // RELEASE *write_mutex_ptr_.
+        combining_guard.Stop();
         write_lock.unlock();
         // Conditionally ACQUIRE interface_state_mutex_
         // If close_connection_ == true, try to add to
@@ -1038,6 +1338,7 @@ ScatterGatherWriteHelper(struct iovec* iovec_ptr, int iovec_count,
       
         // *write_mutex_ptr_ MUST NOT be held to prevent potential deadlock.
         // RELEASE *write_mutex_ptr_.
+        combining_guard.Stop();
         write_lock.unlock();
         // May ACQUIRE interface_state_mutex_.
         TryToAddToApplicationClosureRequestSet(true);
@@ -1051,5 +1352,50 @@ ScatterGatherWriteHelper(struct iovec* iovec_ptr, int iovec_count,
   return true;
 }
 
+// Synchronization:
+// 1) Acquires and releases the mutex of *abort_signal_. A callback which is
+//    invoked by the call is invoked after the mutex was released.
+void FcgiRequest::SetAbortCallback(std::function<void()> callback)
+{
+  if(!abort_signal_)
+    return;
+  {
+    std::lock_guard<std::mutex> signal_lock {abort_signal_->mutex};
+    if(!abort_signal_->notified)
+    {
+      abort_signal_->callback = std::move(callback);
+      return;
+    }
+  }
+  // The abort was signaled and notification occurred before the callback
+  // was registered.
+  if(callback)
+    callback();
+}
+
+void FcgiRequest::SignalPendingWrite(
+  FcgiServerInterface::PendingWrite* pending_ptr,
+  FcgiServerInterface::PendingWrite::Status status) noexcept
+{
+  // The notification is made while the mutex of the pending write is held.
+  // The waiting thread, which owns the object, cannot observe the new status
+  // and destroy the object before the notification is complete.
+  std::lock_guard<std::mutex> pending_lock {pending_ptr->mutex};
+  pending_ptr->status = status;
+  pending_ptr->written.notify_one();
+}
+
+void FcgiRequest::StopCombining(
+  FcgiServerInterface::WriteCombiner* combiner_ptr) noexcept
+{
+  std::lock_guard<std::mutex> combiner_lock {combiner_ptr->mutex};
+  combiner_ptr->combining = false;
+  for(FcgiServerInterface::PendingWrite* pending_ptr :
+    combiner_ptr->pending_writes)
+    SignalPendingWrite(pending_ptr,
+      FcgiServerInterface::PendingWrite::Status::kFailed);
+  combiner_ptr->pending_writes.clear();
+}
+
 } // namespace fcgi
 } // namespace as_components
@@ -0,0 +1,162 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "fcgi/include/fcgi_request_trace.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace as_components {
+namespace fcgi {
+
+namespace {
+
+// The traces which were kept by a thread. The mutex is only contended by
+// Dump.
+struct TraceRing
+{
+  std::mutex mutex {};
+  std::vector<FcgiRequestTrace> traces {};
+  // The index of the oldest trace once traces has reached the ring capacity.
+  std::size_t next {0U};
+};
+
+std::atomic<bool>          tracing_enabled {false};
+std::atomic<std::uint32_t> sample_period   {1U};
+std::atomic<std::size_t>   ring_capacity   {FcgiTracing::kDefaultRingCapacity};
+
+// The rings of all threads which submitted a kept trace. Rings are shared
+// with their threads so that the traces of a thread which exited remain
+// available to Dump.
+std::mutex registry_mutex {};
+std::vector<std::shared_ptr<TraceRing>> registry {};
+
+TraceRing& LocalRing()
+{
+  thread_local std::shared_ptr<TraceRing> ring_ptr {};
+  if(!ring_ptr)
+  {
+    std::shared_ptr<TraceRing> new_ring {std::make_shared<TraceRing>()};
+    std::lock_guard<std::mutex> registry_lock {registry_mutex};
+    registry.push_back(new_ring);
+    ring_ptr = std::move(new_ring);
+  }
+  return *ring_ptr;
+}
+
+} // namespace
+
+void FcgiTracing::Enable(std::uint32_t period, std::size_t capacity)
+{
+  if(capacity == 0U)
+    throw std::invalid_argument {"A ring capacity of zero was given to "
+      "FcgiTracing::Enable."};
+  sample_period.store(period, std::memory_order_relaxed);
+  ring_capacity.store(capacity, std::memory_order_relaxed);
+  tracing_enabled.store(true, std::memory_order_release);
+}
+
+void FcgiTracing::Disable() noexcept
+{
+  tracing_enabled.store(false, std::memory_order_release);
+}
+
+bool FcgiTracing::enabled() noexcept
+{
+  return tracing_enabled.load(std::memory_order_acquire);
+}
+
+void FcgiTracing::Submit(const FcgiRequestTrace& trace) noexcept
+{
+  std::uint32_t period {sample_period.load(std::memory_order_relaxed)};
+  if(period == 0U)
+    return;
+  thread_local std::uint32_t offered {0U};
+  if((++offered % period) != 0U)
+    return;
+
+  try
+  {
+    TraceRing& ring {LocalRing()};
+    std::size_t capacity {ring_capacity.load(std::memory_order_relaxed)};
+    std::lock_guard<std::mutex> ring_lock {ring.mutex};
+    // A trace is appended only while the ring has not wrapped so that the
+    // oldest trace is always at next.
+    if((ring.next == 0U) && (ring.traces.size() < capacity))
+      ring.traces.push_back(trace);
+    else
+    {
+      ring.traces[ring.next] = trace;
+      ring.next = (ring.next + 1U) % ring.traces.size();
+    }
+  }
+  catch(...)
+  {
+    // The trace is dropped.
+  }
+}
+
+std::vector<FcgiRequestTrace> FcgiTracing::Dump()
+{
+  std::lock_guard<std::mutex> registry_lock {registry_mutex};
+  // Every ring is locked before any trace is removed so that a throw leaves
+  // every ring unchanged.
+  std::vector<std::unique_lock<std::mutex>> ring_locks {};
+  ring_locks.reserve(registry.size());
+  for(std::shared_ptr<TraceRing>& ring_ptr : registry)
+    ring_locks.emplace_back(ring_ptr->mutex);
+
+  std::vector<FcgiRequestTrace> result {};
+  for(std::shared_ptr<TraceRing>& ring_ptr : registry)
+  {
+    std::vector<FcgiRequestTrace>& traces {ring_ptr->traces};
+    std::vector<FcgiRequestTrace>::iterator oldest
+      {traces.begin() + ring_ptr->next};
+    result.insert(result.end(), oldest, traces.end());
+    result.insert(result.end(), traces.begin(), oldest);
+  }
+  for(std::shared_ptr<TraceRing>& ring_ptr : registry)
+  {
+    ring_ptr->traces.clear();
+    ring_ptr->next = 0U;
+  }
+  ring_locks.clear();
+
+  // The rings of threads which exited are no longer needed once emptied.
+  std::vector<std::shared_ptr<TraceRing>>::iterator new_end {registry.begin()};
+  for(std::shared_ptr<TraceRing>& ring_ptr : registry)
+  {
+    if(ring_ptr.use_count() > 1)
+      *(new_end++) = std::move(ring_ptr);
+  }
+  registry.erase(new_end, registry.end());
+  return result;
+}
+
+} // namespace fcgi
+} // namespace as_components
@@ -0,0 +1,313 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "fcgi/include/fcgi_response_reactor.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "fcgi/include/fcgi_request.h"
+
+namespace as_components {
+namespace fcgi {
+
+ResponseReactor::ResponseReactor(std::size_t chunk_size)
+: chunk_size_                 {chunk_size},
+  mutex_                      {},
+  entries_                    {},
+  next_handle_                {1U},
+  stopped_                    {false},
+  self_pipe_read_descriptor_  {-1},
+  self_pipe_write_descriptor_ {-1}
+{
+  if(chunk_size == 0U)
+    throw std::invalid_argument {"A chunk size of zero was given to a "
+      "ResponseReactor."};
+  int pipe_fd_array[2] = {};
+  if(pipe(pipe_fd_array) < 0)
+  {
+    std::error_code ec {errno, std::system_category()};
+    throw std::system_error {ec, "pipe"};
+  }
+  for(int i {0}; i < 2; ++i)
+  {
+    int f_getfl_return {fcntl(pipe_fd_array[i], F_GETFL)};
+    if((f_getfl_return == -1) ||
+       (fcntl(pipe_fd_array[i], F_SETFL, f_getfl_return | O_NONBLOCK) == -1))
+    {
+      std::error_code ec {errno, std::system_category()};
+      close(pipe_fd_array[0]);
+      close(pipe_fd_array[1]);
+      throw std::system_error {ec, "fcntl"};
+    }
+  }
+  self_pipe_read_descriptor_  = pipe_fd_array[0];
+  self_pipe_write_descriptor_ = pipe_fd_array[1];
+}
+
+ResponseReactor::~ResponseReactor()
+{
+  // The requests are destroyed before the descriptors of the self-pipe are
+  // released.
+  entries_.clear();
+  close(self_pipe_read_descriptor_);
+  close(self_pipe_write_descriptor_);
+}
+
+ResponseReactor::Handle ResponseReactor::Adopt(FcgiRequest&& request)
+{
+  int descriptor {request.get_request_identifier().descriptor()};
+  {
+    std::lock_guard<std::mutex> lock {mutex_};
+    Handle handle {next_handle_};
+    // The entry is constructed in its node. request is only moved from if
+    // the node was allocated.
+    entries_.emplace(std::piecewise_construct, std::forward_as_tuple(handle),
+      std::forward_as_tuple(std::move(request), descriptor));
+    ++next_handle_;
+    return handle;
+  }
+}
+
+bool ResponseReactor::Write(Handle handle, std::vector<std::uint8_t> bytes,
+  Completion on_done)
+{
+  return Enqueue(handle, Operation {false, std::move(bytes), 0U, 0,
+    std::move(on_done)});
+}
+
+bool ResponseReactor::Complete(Handle handle, std::int32_t app_status,
+  Completion on_done)
+{
+  return Enqueue(handle, Operation {true, {}, 0U, app_status,
+    std::move(on_done)});
+}
+
+bool ResponseReactor::Enqueue(Handle handle, Operation&& operation)
+{
+  {
+    std::lock_guard<std::mutex> lock {mutex_};
+    std::map<Handle, Entry>::iterator entry_iter {entries_.find(handle)};
+    if(entry_iter == entries_.end())
+      return false;
+    entry_iter->second.operations.push_back(std::move(operation));
+  }
+  Wake();
+  return true;
+}
+
+void ResponseReactor::Run()
+{
+  while(true)
+  {
+    {
+      std::lock_guard<std::mutex> lock {mutex_};
+      if(stopped_)
+        return;
+    }
+    RunOnce(-1);
+  }
+}
+
+std::size_t ResponseReactor::RunOnce(int timeout_milliseconds)
+{
+  // Entries are only erased by the thread which runs the reactor. The
+  // iterators remain valid during the call.
+  std::vector<struct pollfd> poll_list {};
+  std::vector<std::map<Handle, Entry>::iterator> polled_entries {};
+  {
+    std::lock_guard<std::mutex> lock {mutex_};
+    if(stopped_)
+      return 0U;
+    for(std::map<Handle, Entry>::iterator entry_iter {entries_.begin()};
+        entry_iter != entries_.end(); ++entry_iter)
+    {
+      if(entry_iter->second.operations.empty())
+        continue;
+      // When the interface closes a connection which has assigned requests,
+      // the descriptor of the connection may be made to refer to a socket
+      // which never becomes writable. Such a request is not polled. It is
+      // stepped without waiting, and its write fails without use of the
+      // connection. A request which was aborted by its client is polled as
+      // its connection remains open.
+      if(entry_iter->second.request.ConnectionClosed())
+      {
+        poll_list.push_back({-1, 0, 0});
+        timeout_milliseconds = 0;
+      }
+      else
+        poll_list.push_back({entry_iter->second.descriptor, POLLOUT, 0});
+      polled_entries.push_back(entry_iter);
+    }
+  }
+  poll_list.push_back({self_pipe_read_descriptor_, POLLIN, 0});
+  int poll_return {poll(poll_list.data(), poll_list.size(),
+    timeout_milliseconds)};
+  if(poll_return == -1)
+  {
+    if(errno == EINTR)
+      return 0U;
+    std::error_code ec {errno, std::system_category()};
+    throw std::system_error {ec, "poll"};
+  }
+  if(poll_list.back().revents & POLLIN)
+  {
+    std::uint8_t read_buffer[32];
+    while(read(self_pipe_read_descriptor_, read_buffer, sizeof(read_buffer))
+          > 0)
+      continue;
+  }
+
+  // Callbacks are invoked after every step was performed so that a callback
+  // cannot observe an entry which is about to be removed.
+  std::vector<std::pair<Completion, bool>> callbacks {};
+  for(std::size_t i {0U}; i < polled_entries.size(); ++i)
+  {
+    // A connection which is not writable may have an error or may have been
+    // closed. In these cases, the failure is found by the write.
+    std::map<Handle, Entry>::iterator entry_iter {polled_entries[i]};
+    if(!(poll_list[i].revents & (POLLOUT | POLLERR | POLLHUP | POLLNVAL)) &&
+       (poll_list[i].fd != -1))
+      continue;
+    if(Step(&(entry_iter->second), &callbacks))
+    {
+      FcgiRequest removed_request {};
+      {
+        std::lock_guard<std::mutex> lock {mutex_};
+        // Operations which were enqueued after the request was finished
+        // fail.
+        for(Operation& operation : entry_iter->second.operations)
+          callbacks.emplace_back(std::move(operation.on_done), false);
+        removed_request = std::move(entry_iter->second.request);
+        entries_.erase(entry_iter);
+      }
+      // removed_request is destroyed when mutex_ is not held as the
+      // destructor of an incomplete request acquires the mutex of the
+      // interface.
+    }
+  }
+  for(std::pair<Completion, bool>& callback : callbacks)
+  {
+    if(callback.first)
+      callback.first(callback.second);
+  }
+  return callbacks.size();
+}
+
+// Synchronization:
+// 1) Must be called by the thread which runs the reactor. mutex_ must not be
+//    held.
+bool ResponseReactor::Step(Entry* entry_ptr,
+  std::vector<std::pair<Completion, bool>>* callbacks_ptr)
+{
+  Operation* operation_ptr {nullptr};
+  {
+    std::lock_guard<std::mutex> lock {mutex_};
+    operation_ptr = &(entry_ptr->operations.front());
+  }
+  bool finished {false};
+  bool result {false};
+  bool remove {false};
+  try
+  {
+    if(operation_ptr->complete)
+    {
+      result   = entry_ptr->request.Complete(operation_ptr->app_status);
+      finished = true;
+      remove   = true;
+    }
+    else
+    {
+      std::size_t remaining
+        {operation_ptr->bytes.size() - operation_ptr->offset};
+      std::size_t chunk {std::min(remaining, chunk_size_)};
+      std::vector<std::uint8_t>::iterator chunk_begin
+        {operation_ptr->bytes.begin() + operation_ptr->offset};
+      if(chunk && !entry_ptr->request.Write(chunk_begin, chunk_begin + chunk))
+      {
+        finished = true;
+        remove   = true;
+      }
+      else
+      {
+        operation_ptr->offset += chunk;
+        finished = (operation_ptr->offset == operation_ptr->bytes.size());
+        result   = finished;
+      }
+    }
+  }
+  catch(...)
+  {
+    // The request cannot be serviced.
+    result   = false;
+    finished = true;
+    remove   = true;
+  }
+  if(finished)
+  {
+    std::lock_guard<std::mutex> lock {mutex_};
+    callbacks_ptr->emplace_back(std::move(operation_ptr->on_done), result);
+    entry_ptr->operations.pop_front();
+  }
+  return remove;
+}
+
+std::size_t ResponseReactor::size() const
+{
+  std::lock_guard<std::mutex> lock {mutex_};
+  return entries_.size();
+}
+
+void ResponseReactor::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock {mutex_};
+    stopped_ = true;
+  }
+  Wake();
+}
+
+void ResponseReactor::Wake()
+{
+  // A full pipe already indicates that the reactor should wake.
+  std::uint8_t byte {1U};
+  while((write(self_pipe_write_descriptor_, &byte, 1U) == -1) &&
+        (errno == EINTR))
+    continue;
+}
+
+} // namespace fcgi
+} // namespace as_components
@@ -92,20 +92,25 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <iterator>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <regex>
 #include <stdexcept>
 #include <system_error>
 #include <utility>
 
+#include "fcgi/include/fcgi_metrics.h"
 #include "fcgi/include/fcgi_protocol_constants.h"
 #include "fcgi/include/fcgi_request.h"
 #include "fcgi/include/fcgi_request_identifier.h"
+#include "fcgi/include/fcgi_request_trace.h"
 #include "fcgi/include/fcgi_utilities.h"
 #include "socket_functions/include/socket_functions.h"
 
@@ -122,7 +127,7 @@ unsigned long FcgiServerInterface::previous_interface_identifier_ {0U};
 
 FcgiServerInterface::
 FcgiServerInterface(int listening_descriptor, int max_connections,
-  int max_requests, std::int32_t app_status_on_abort)
+  int max_requests, std::int32_t app_status_on_abort, IoBackend io_backend)
 : listening_descriptor_ {listening_descriptor},
   app_status_on_abort_ {app_status_on_abort},
   maximum_connection_count_ {max_connections},
@@ -217,10 +222,10 @@ FcgiServerInterface(int listening_descriptor, int max_connections,
 
   // For internet domains, check for IP addresses which are deemed authorized.
   // If FCGI_WEB_SERVER_ADDRS is unbound or bound to an empty value, any
-  // address is authorized. If no valid addresses are found after processing a
-  // list, an error is thrown. Otherwise, a list of well-formed addresses which
-  // have been converted to a normalized presentation format is stored in the
-  // FcgiServerInterface object.
+  // address is authorized. If no valid entries are found after processing a
+  // list, an error is thrown. Otherwise, the well-formed addresses and CIDR
+  // prefixes of the list are stored in binary form in the FcgiServerInterface
+  // object.
   if((socket_domain_ == AF_INET) || (socket_domain_ == AF_INET6))
   {
     const char* ip_address_list_ptr = std::getenv("FCGI_WEB_SERVER_ADDRS");
@@ -228,22 +233,7 @@ FcgiServerInterface(int listening_descriptor, int max_connections,
       std::string(ip_address_list_ptr) : ""};
     if(ip_address_list.size() != 0U) // A non-empty address list was bound.
     {
-      // Declare appropriate variables to use with inet_pton() and inet_ntop().
-      // These structs are internal to struct sockaddr_in and
-      // struct sockaddr_in6.
-      struct in_addr ipv4_internal_address;
-      struct in6_addr ipv6_internal_address;
-      void* inet_address_subaddress_ptr {nullptr};
-      if(socket_domain_ == AF_INET)
-      {
-        inet_address_subaddress_ptr = &(ipv4_internal_address);
-      }
-      else
-      {
-        inet_address_subaddress_ptr = &(ipv6_internal_address);
-      }
-      // Allocate enough space for a maximal normalized address string.
-      char normalized_address[INET6_ADDRSTRLEN];
+      address_allowlist_ = AddressAllowlist {socket_domain_};
 
       // Construct a tokenizer to split the string into address tokens.
       // The -1 option selects non-matching substrings and, hence, tokens.
@@ -252,32 +242,12 @@ FcgiServerInterface(int listening_descriptor, int max_connections,
         ip_address_list.end(), comma_tokenizer, -1};
       std::sregex_token_iterator end {};
 
-      // Iterate over tokens and add the normalized textual representation of
-      // every well-formed address to the set of authorized addresses. The
-      // call sequence inet_pton, inet_ntop normalizes the textual
-      // representation of the address.
+      // Iterate over tokens and add every well-formed address or prefix to
+      // the allowlist. Malformed tokens are ignored.
       for(/*no-op*/; token_it != end; ++token_it)
-      {
-        int inet_pton_return {};
-        if((inet_pton_return = inet_pton(socket_domain_,
-          (token_it->str()).data(), inet_address_subaddress_ptr)) == 1)
-        {
-          if(!inet_ntop(socket_domain_, inet_address_subaddress_ptr,
-            normalized_address, INET6_ADDRSTRLEN))
-          {
-            std::error_code ec {errno, std::system_category()};
-            throw std::system_error {ec, "inet_ntop"};
-          }
-          valid_ip_address_set_.insert(normalized_address);
-        }
-        else if(inet_pton_return == -1)
-        {
-          std::error_code ec {errno, std::system_category()};
-          throw std::system_error {ec, "inet_pton"};
-        }
-      }
+        address_allowlist_.AddPrefix((token_it->str()).data());
 
-      if(!valid_ip_address_set_.size())
+      if(address_allowlist_.empty())
       {
         throw std::runtime_error {"No authorized IP addresses "
           "were found during construction of an FcgiServerInterface object."};
@@ -285,6 +255,18 @@ FcgiServerInterface(int listening_descriptor, int max_connections,
     }
   }
 
+  // Create the io_uring instance if it was requested. A null poller indicates
+  // that io_uring is unavailable. In this case, select is used. The
+  // completion queue is sized for a poll operation for every connection, the
+  // listening socket, and the self-pipe and for the removal of each of these.
+  if(io_backend == IoBackend::kIoUring)
+  {
+    io_uring_poller_ = IoUringPoller::Create(
+      2U * (static_cast<unsigned int>(max_connections) + 2U));
+    if(io_uring_poller_)
+      io_uring_poller_->Arm(listening_descriptor_);
+  }
+
   // Ensure singleton status and update interface_identifier_ to a valid value.
 
   // ACQUIRE interface_state_mutex_.
@@ -333,6 +315,20 @@ FcgiServerInterface(int listening_descriptor, int max_connections,
       throw std::system_error {ec, "fcntl"};
     }
   }
+  if(io_uring_poller_)
+  {
+    try
+    {
+      io_uring_poller_->Arm(self_pipe_read_descriptor_);
+    }
+    catch(...)
+    {
+      interface_identifier_ = 0U;
+      close(self_pipe_read_descriptor_);
+      close(self_pipe_write_descriptor_);
+      throw;
+    }
+  }
 } // RELEASE interface_state_mutex_.
 
 FcgiServerInterface::~FcgiServerInterface()
@@ -348,8 +344,15 @@ FcgiServerInterface::~FcgiServerInterface()
     }
 
     // ACQUIRE interface_state_mutex_.
-    std::lock_guard<std::mutex> interface_state_lock
+    std::unique_lock<std::mutex> interface_state_lock
       {FcgiServerInterface::interface_state_mutex_};
+
+    // Every assigned request is aborted by the destruction of the interface.
+    for(std::pair<const FcgiRequestIdentifier, RequestData>& request_pair :
+      request_map_)
+    {
+      SignalAbort(&(request_pair.second), true);
+    }
     
     close(self_pipe_read_descriptor_);
     close(self_pipe_write_descriptor_);
@@ -370,7 +373,12 @@ FcgiServerInterface::~FcgiServerInterface()
 
     // Indicates that no interface is present.
     FcgiServerInterface::interface_identifier_ = 0U;
-  } // RELEASE interface_state_mutex_.
+
+    // RELEASE interface_state_mutex_.
+    interface_state_lock.unlock();
+    for(std::shared_ptr<AbortSignal>& signal_ptr : pending_abort_signals_)
+      signal_ptr->Notify();
+  }
   catch(...)
   {
     std::terminate();
@@ -440,9 +448,11 @@ int FcgiServerInterface::AcceptConnection()
     length_ptr = &new_connection_address_length;
   }  
   
+  // accept4 makes the connected socket non-blocking and close-on-exec
+  // without additional calls to fcntl.
   int accept_return {};
-  while(((accept_return = accept(listening_descriptor_, address_ptr,
-    length_ptr)) == -1) && (errno == EINTR ||
+  while(((accept_return = accept4(listening_descriptor_, address_ptr,
+    length_ptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) == -1) && (errno == EINTR ||
     errno == ECONNABORTED))
   {
     new_connection_address_length = sizeof(struct sockaddr_storage);
@@ -454,7 +464,7 @@ int FcgiServerInterface::AcceptConnection()
     else
     {
       std::error_code ec {errno, std::system_category()};
-      throw std::system_error {ec, "accept"};
+      throw std::system_error {ec, "accept4"};
     }
   }
   // With so many circumstances that may require file closure to prevent a
@@ -462,115 +472,40 @@ int FcgiServerInterface::AcceptConnection()
   // closed on function exit. An error from close is ignored.
   UniqueDescriptor managed_descriptor {accept_return};
 
-  int getsockopt_int_buffer {};
-  socklen_t getsockopt_int_buffer_size {sizeof(int)};
-  int getsockopt_return {};
-
-  while(((getsockopt_return = getsockopt(managed_descriptor.get_descriptor(),
-    SOL_SOCKET, SO_TYPE, &getsockopt_int_buffer, &getsockopt_int_buffer_size))
-    == -1) && (errno == EINTR))
-  {
-    getsockopt_int_buffer_size = sizeof(int);
-  }
-  if(getsockopt_return == -1)
-  {
-    std::error_code ec {errno, std::system_category()};
-    throw std::system_error {ec, "getsockopt with SO_TYPE"};
-  }
-  int new_socket_type {getsockopt_int_buffer};
-
-  // Check if the interface is overloaded, the maximum connection count was
-  // met, or the socket is of an incorrect type. Reject by closing if so.
-  if(application_overload_                                 || 
-    (record_status_map_.size() >= 
-     static_cast<unsigned int>(maximum_connection_count_)) ||
-    (new_socket_type != SOCK_STREAM))
+  // Check if the interface is overloaded or the maximum connection count was
+  // met. Reject by closing if so.
+  //    The socket type and domain of the connected socket are those of the
+  // listening socket. The type was verified to be SOCK_STREAM during
+  // construction, and the domain is given by socket_domain_.
+  if(application_overload_                                 ||
+    (record_status_map_.size() >=
+     static_cast<unsigned int>(maximum_connection_count_)))
   {
+    ++connection_acceptance_counters_.rejected_for_load;
+    FcgiMetrics::Add(application_overload_ ?
+      FcgiCounter::kConnectionsRejectedForOverload :
+      FcgiCounter::kConnectionsRejectedForLimit);
     return 0;
   }
 
-  // Reset the buffer length value-result variable.
-  getsockopt_int_buffer_size = sizeof(int);
-  while(((getsockopt_return = getsockopt(managed_descriptor.get_descriptor(),
-    SOL_SOCKET, SO_DOMAIN, &getsockopt_int_buffer, &getsockopt_int_buffer_size))
-    == -1) && (errno == EINTR))
-  {
-    getsockopt_int_buffer_size = sizeof(int);
-  }
-  if(getsockopt_return == -1)
-  {
-    std::error_code ec {errno, std::system_category()};
-    throw std::system_error {ec, "getsockopt with SO_DOMAIN"};
-  }
-  int new_socket_domain {getsockopt_int_buffer};
-
   // Perform address validation against the list of authorized addresses
-  // if applicable. A non-empty set implies an internet domain.
-  std::string new_address {};
-  bool valid_address {true};
-  if(valid_ip_address_set_.size())
-  {
-    char address_array[INET6_ADDRSTRLEN];
-    void* addr_ptr {nullptr};
+  // if applicable. A non-empty allowlist implies an internet domain.
+  bool valid_address {address_allowlist_.empty() ||
+    address_allowlist_.Contains(address_ptr)};
 
-    // Handle both IPv4 and IPv6.
-    if(new_socket_domain == AF_INET)
-    {
-      struct sockaddr_in* inet_addr_ptr {static_cast<struct sockaddr_in*>(
-        static_cast<void*>(&new_connection_address))};
-      addr_ptr = &(inet_addr_ptr->sin_addr);
-    }
-    else if(new_socket_domain == AF_INET6)
-    {
-      struct sockaddr_in6* inet_addr_ptr {static_cast<struct sockaddr_in6*>(
-        static_cast<void*>(&new_connection_address))};
-      addr_ptr = &(inet_addr_ptr->sin6_addr);
-    }
-    
-    if(addr_ptr)
-    {     
-      if(!inet_ntop(new_socket_domain, addr_ptr, address_array, 
-        INET6_ADDRSTRLEN))
-      {
-        std::error_code ec {errno, std::system_category()};
-        throw std::system_error(ec, "inet_ntop");
-      }
-      new_address = address_array;
-      valid_address = (valid_ip_address_set_.find(new_address) 
-        != valid_ip_address_set_.end());
-    }
-    else
-      valid_address = false;
-  }
-
-  // Validate the new connected socket against domain and address.
-  if(!((new_socket_domain == socket_domain_) && valid_address))
+  if(!valid_address)
   {
+    ++connection_acceptance_counters_.rejected_for_address;
+    FcgiMetrics::Add(FcgiCounter::kConnectionsRejectedForAddress);
     return 0;
   }
 
-  // Make the accepted connected sockets non-blocking.
-  int flags {};
-  while(((flags = fcntl(managed_descriptor.get_descriptor(), F_GETFL)) == -1)
-    && (errno == EINTR))
-    continue;
-  if(flags == -1)
-  {
-    std::error_code ec {errno, std::system_category()};
-    throw std::system_error {ec, "fcntl with F_GETFL"};
-  }
-
-  flags |= O_NONBLOCK;
-
-  while(((flags = fcntl(managed_descriptor.get_descriptor(), F_SETFL, flags)) 
-    == -1) && (errno == EINTR))
-    continue;
-  if(flags == -1)
-  {
-    std::error_code ec {errno, std::system_category()};
-    throw std::system_error {ec, "fcntl with F_SETFL"};
-  }
+  AddConnection(managed_descriptor.get_descriptor());
+  return managed_descriptor.release_descriptor();
+}
 
+void FcgiServerInterface::AddConnection(int connection)
+{
   // NON-LOCAL STATE modification block start.
   // Updates state to reflect the new connection. Tries to update and undoes
   // any changes if an exception is caught. (Strong exception guarantee.)
@@ -582,8 +517,11 @@ int FcgiServerInterface::AcceptConnection()
     bool
   >
     write_mutex_map_insert_return {{}, {false}};
+
+  std::pair<std::map<int, std::unique_ptr<WriteCombiner>>::iterator, bool>
+    write_combiner_map_emplace_return {{}, {false}};
   
-  std::pair<std::map<int, int>::iterator, bool>
+  std::pair<std::map<int, ConnectionLoad>::iterator, bool>
     request_count_map_emplace_return {{}, {false}};
   
   // ACQUIRE interface_state_mutex_.
@@ -593,23 +531,34 @@ int FcgiServerInterface::AcceptConnection()
   try
   {
     record_status_map_emplace_return = record_status_map_.emplace(
-      managed_descriptor.get_descriptor(), 
-      RecordStatus {managed_descriptor.get_descriptor(), this});
+      connection, RecordStatus {connection, this});
 
     std::unique_ptr<std::mutex> new_mutex_manager {new std::mutex {}};
     write_mutex_map_insert_return = write_mutex_map_.insert(
-      {managed_descriptor.get_descriptor(), 
-      std::pair<std::unique_ptr<std::mutex>, bool> 
+      {connection, std::pair<std::unique_ptr<std::mutex>, bool>
         {std::move(new_mutex_manager), false}});
 
+    write_combiner_map_emplace_return = write_combiner_map_.emplace(
+      connection,
+      std::unique_ptr<WriteCombiner> {new WriteCombiner {}});
+
     request_count_map_emplace_return = request_count_map_.emplace(
-        managed_descriptor.get_descriptor(), 0);
+        connection, ConnectionLoad {});
 
     if(!(record_status_map_emplace_return.second
         && write_mutex_map_insert_return.second
+        && write_combiner_map_emplace_return.second
         && request_count_map_emplace_return.second))
       throw std::logic_error {"Socket descriptor emplacement "
         "failed due to duplication."};
+
+    // A new connection is throttled if a total budget is exceeded.
+    if(BackpressureEnabled())
+      throttling_update_set_.insert(connection);
+
+    // Last as Arm provides the strong exception guarantee.
+    if(io_uring_poller_)
+      io_uring_poller_->Arm(connection);
   }
   catch(...)
   {
@@ -618,10 +567,15 @@ int FcgiServerInterface::AcceptConnection()
     // iterator is valid and the socket descriptor must be removed from the map.
     try
     {
+      // An element for connection cannot have been present before the call
+      // as the connection was not in record_status_map_.
+      throttling_update_set_.erase(connection);
       if(record_status_map_emplace_return.second)
         record_status_map_.erase(record_status_map_emplace_return.first);
       if(write_mutex_map_insert_return.second)
         write_mutex_map_.erase(write_mutex_map_insert_return.first);
+      if(write_combiner_map_emplace_return.second)
+        write_combiner_map_.erase(write_combiner_map_emplace_return.first);
       if(request_count_map_emplace_return.second)
         request_count_map_.erase(request_count_map_emplace_return.first);
     }
@@ -636,7 +590,8 @@ int FcgiServerInterface::AcceptConnection()
   }
   // NON-LOCAL STATE modification block end.
 
-  return managed_descriptor.release_descriptor();
+  ++connection_acceptance_counters_.accepted;
+  FcgiMetrics::Add(FcgiCounter::kConnectionsAccepted);
 } // RELEASE interface_state_mutex_.
 
 std::vector<FcgiRequest> FcgiServerInterface::AcceptRequests()
@@ -648,11 +603,24 @@ std::vector<FcgiRequest> FcgiServerInterface::AcceptRequests()
         "corrupt in a call to "
         "fcgi_si::FcgiServerInterface::AcceptRequests."};
   };
+
+  auto MarkHandedToApplication = [](std::vector<FcgiRequest>* requests_ptr)
+    ->void
+  {
+    for(FcgiRequest& request : *requests_ptr)
+    {
+      if(request.trace_)
+        request.trace_->Mark(FcgiTracePoint::kHandedToApplication);
+    }
+  };
   
   // Check for previously-created requests that could not be returned because
   // of an error.
   if(request_buffer_on_throw_.size())
+  {
+    MarkHandedToApplication(&request_buffer_on_throw_);
     return std::move(request_buffer_on_throw_);
+  }
 
   // CLEANUP CONNECTIONS
   {
@@ -729,10 +697,13 @@ std::vector<FcgiRequest> FcgiServerInterface::AcceptRequests()
     int read_return {};
     constexpr int bl {32};
     std::uint8_t read_buffer[bl];
+    bool self_pipe_written {false};
     while((read_return = read(self_pipe_read_descriptor_, read_buffer, bl)) > 0)
     {
-      continue;
+      self_pipe_written = true;
     }
+    if(self_pipe_written)
+      FcgiMetrics::Add(FcgiCounter::kSelfPipeWakeups);
     if(read_return == 0) 
     {
       bad_interface_state_detected_ = true;
@@ -772,46 +743,47 @@ std::vector<FcgiRequest> FcgiServerInterface::AcceptRequests()
       bad_interface_state_detected_ = true;
       throw;
     }
+
+    // Determine which connections are read given the backpressure usage
+    // which remains after the removal of requests.
+    UpdateThrottling();
+
+    if(admission_controller_)
+      admission_controller_->Update(std::chrono::steady_clock::now());
   } // RELEASE interface_state_mutex_;
 
-  // DESCRIPTOR MONITORING
+  // Notify the requests which were aborted by connection closure.
+  NotifyAbortSignals();
 
-  // TODO Determine a better I/O multiplexing system call or library function.
-  // For example, some glibc implementations have an upper limit of 1023 for
-  // file descriptor values due to the size of FD_SET (which is just an integer
-  // type used as a bitset).
+  // DESCRIPTOR MONITORING
 
+  // After monitoring, ready_count is the number of ready descriptors. The
+  // ready descriptors are given by read_set for select and by
+  // ready_descriptors_ for io_uring.
   fd_set read_set;
-  FD_ZERO(&read_set);
-  FD_SET(listening_descriptor_, &read_set);
-  FD_SET(self_pipe_read_descriptor_, &read_set);
-  int number_for_select 
-    {std::max<int>(listening_descriptor_, self_pipe_read_descriptor_) + 1};
-  // Reverse to access highest fd immediately.
-  std::map<int, RecordStatus>::reverse_iterator map_reverse_iter
-    {record_status_map_.rbegin()};
-  std::map<int, RecordStatus>::reverse_iterator map_rend
-    {record_status_map_.rend()};
-  if(map_reverse_iter != map_rend)
-  {
-    number_for_select = std::max<int>(number_for_select, 
-      (map_reverse_iter->first) + 1);
-    for(/*no-op*/; map_reverse_iter != map_rend; ++map_reverse_iter)
-    {
-      FD_SET(map_reverse_iter->first, &read_set);
-    }
-  }
-  int select_return {select(number_for_select, &read_set, nullptr, nullptr, 
-    nullptr)};
-  if(select_return == -1)
+  int ready_count {};
+  if(io_uring_poller_)
   {
-    // Return when a signal was caught by the thread of the interface.
-    if(errno == EINTR)
+    ready_descriptors_.clear();
+    ready_count = io_uring_poller_->Wait(&ready_descriptors_);
+    if(ready_count == -1) // EINTR
       return {};
-    // TODO Are there any situations that could cause select to return EBADF
-    // from a call with only a non-null read set other than one of the file
-    // descriptors not being open?
-    if(errno == EBADF)
+    std::sort(ready_descriptors_.begin(), ready_descriptors_.end());
+    // Polls are one-shot. The ready descriptors are re-armed now. The new
+    // operations are submitted during the next call, and they complete
+    // immediately if data remains. A connection which is closed before then
+    // is disarmed by RemoveConnection.
+    // A descriptor which could not be re-armed would never be read again.
+    // A throttled connection is armed when it is no longer throttled.
+    try
+    {
+      for(int descriptor : ready_descriptors_)
+      {
+        if(!throttled_connection_set_.count(descriptor))
+          io_uring_poller_->Arm(descriptor);
+      }
+    }
+    catch(...)
     {
       try
       {
@@ -824,10 +796,66 @@ std::vector<FcgiRequest> FcgiServerInterface::AcceptRequests()
       {
         std::terminate();
       }
-    } 
-    std::error_code ec {errno, std::system_category()};
-    throw std::system_error {ec, "select"};
+      throw;
+    }
+  }
+  else
+  {
+    // Some glibc implementations have an upper limit of 1023 for file
+    // descriptor values due to the size of FD_SET (which is just an integer
+    // type used as a bitset). IoBackend::kIoUring does not have this limit.
+    FD_ZERO(&read_set);
+    FD_SET(listening_descriptor_, &read_set);
+    FD_SET(self_pipe_read_descriptor_, &read_set);
+    int number_for_select 
+      {std::max<int>(listening_descriptor_, self_pipe_read_descriptor_) + 1};
+    // Reverse to access highest fd immediately.
+    std::map<int, RecordStatus>::reverse_iterator map_reverse_iter
+      {record_status_map_.rbegin()};
+    std::map<int, RecordStatus>::reverse_iterator map_rend
+      {record_status_map_.rend()};
+    if(map_reverse_iter != map_rend)
+    {
+      number_for_select = std::max<int>(number_for_select, 
+        (map_reverse_iter->first) + 1);
+      for(/*no-op*/; map_reverse_iter != map_rend; ++map_reverse_iter)
+      {
+        if(!throttled_connection_set_.count(map_reverse_iter->first))
+          FD_SET(map_reverse_iter->first, &read_set);
+      }
+    }
+    ready_count = select(number_for_select, &read_set, nullptr, nullptr, 
+      nullptr);
+    if(ready_count == -1)
+    {
+      // Return when a signal was caught by the thread of the interface.
+      if(errno == EINTR)
+        return {};
+      // TODO Are there any situations that could cause select to return EBADF
+      // from a call with only a non-null read set other than one of the file
+      // descriptors not being open?
+      if(errno == EBADF)
+      {
+        try
+        {
+          // ACQUIRE interface_state_mutex_
+          std::unique_lock<std::mutex> interface_state_lock
+            {FcgiServerInterface::interface_state_mutex_};
+          bad_interface_state_detected_ = true;
+        } // RELEASE interface_state_mutex_
+        catch(...)
+        {
+          std::terminate();
+        }
+      } 
+      std::error_code ec {errno, std::system_category()};
+      throw std::system_error {ec, "select"};
+    }
   }
+  bool listening_ready {(io_uring_poller_) ?
+    std::binary_search(ready_descriptors_.begin(), ready_descriptors_.end(),
+      listening_descriptor_) :
+    static_cast<bool>(FD_ISSET(listening_descriptor_, &read_set))};
 
   // Check if the interface was corrupted while it blocked on select.
   { // ACQUIRE interface_state_mutex_.
@@ -846,9 +874,8 @@ std::vector<FcgiRequest> FcgiServerInterface::AcceptRequests()
   std::vector<FcgiRequest>::size_type length_at_loop {0U};
 
   // This variable allows the number of connected sockets read in the below
-  // loop to be tracked so that a comparison of select_return and it determines
-  // if select found that peers were waiting for socket connection requests
-  // to be accepted.
+  // loop to be tracked so that the loop can stop once every ready descriptor
+  // was examined.
   int connections_read {0};
 
   // This variable serves as the value of the current file descriptor
@@ -859,86 +886,149 @@ std::vector<FcgiRequest> FcgiServerInterface::AcceptRequests()
   int current_connection {};
   try
   {
-    std::map<int, RecordStatus>::iterator status_end {record_status_map_.end()};
-    for(std::map<int, RecordStatus>::iterator it {record_status_map_.begin()};
-        (it != status_end) && (connections_read < select_return); ++it)
+    // Call ReadRecords and construct FcgiRequest objects for any application
+    // requests which are complete and ready to be passed to the application.
+    auto ReadConnection = [&](std::map<int, RecordStatus>::iterator it)->void
     {
       current_connection = it->first;
-      // Call ReadRecords and construct FcgiRequest objects for any application
-      // requests which are complete and ready to be passed to the application.
-      if(FD_ISSET(current_connection, &read_set))
+      ++connections_read;
+      bool budget_exhausted {false};
+      std::vector<std::map<FcgiRequestIdentifier, RequestData>::iterator>
+      request_iterators {it->second.ReadRecords(read_budget_,
+        &budget_exhausted)};
+      if(budget_exhausted)
       {
-        ++connections_read;
-        std::vector<std::map<FcgiRequestIdentifier, RequestData>::iterator>
-        request_iterators {it->second.ReadRecords()};
-        if(request_iterators.size())
-        {
-          // ACQUIRE interface_state_mutex_.
-          std::unique_lock<std::mutex> unique_interface_state_lock
-            {FcgiServerInterface::interface_state_mutex_};
-          InterfaceCheck();
+        FcgiMetrics::Add(FcgiCounter::kReadBudgetExhaustions);
+        read_resume_descriptor_ = current_connection;
+      }
+      if(request_iterators.size())
+      {
+        // ACQUIRE interface_state_mutex_.
+        std::unique_lock<std::mutex> unique_interface_state_lock
+          {FcgiServerInterface::interface_state_mutex_};
+        InterfaceCheck();
 
-          std::map<int, std::pair<std::unique_ptr<std::mutex>, bool>>::iterator 
-            write_mutex_map_iter {write_mutex_map_.find(current_connection)};
-          if(write_mutex_map_iter == write_mutex_map_.end())
+        std::map<int, std::pair<std::unique_ptr<std::mutex>, bool>>::iterator 
+          write_mutex_map_iter {write_mutex_map_.find(current_connection)};
+        if(write_mutex_map_iter == write_mutex_map_.end())
+        {
+          bad_interface_state_detected_ = true;
+          throw std::logic_error {"An expected write mutex and flag pair "
+            "was not present in write_mutex_map_ in a call to "
+            "fcgi_si::FcgiServerInterface::AcceptRequests."};
+        }
+        std::mutex* write_mutex_ptr 
+          {write_mutex_map_iter->second.first.get()};
+        bool* write_mutex_bad_state_ptr
+          {&(write_mutex_map_iter->second.second)};
+
+        // For each request, extract a pointer to its RequestData object, and
+        // create an FcgiRequest object from it.
+        std::vector<std::map<FcgiRequestIdentifier,
+          RequestData>::iterator>::iterator req_iterators_end
+          {request_iterators.end()};
+        for(std::vector<std::map<FcgiRequestIdentifier,
+          RequestData>::iterator>::iterator iter {request_iterators.begin()};
+          iter != req_iterators_end; ++iter)
+        {
+          RequestData* request_data_ptr {&((*iter)->second)};
+          std::size_t buffered_bytes
+            {request_data_ptr->get_buffered_byte_count()};
+
+          // This is a rare instance where an FcgiRequest may be destroyed
+          // within the scope of implementation code. The destructor of
+          // FcgiRequest objects tries to acquire interface_state_mutex_
+          // if the object to be destroyed is neither completed nor null.
+          // See the catch block immediately below.
+          //
+          // Note that the normal constructor of FcgiRequest causes the
+          // associated RequestData instance to transition from pending to
+          // assigned.
+          FcgiRequest request {(*iter)->first,
+            FcgiServerInterface::interface_identifier_, this, 
+            request_data_ptr, write_mutex_ptr, write_mutex_bad_state_ptr, 
+            self_pipe_write_descriptor_};
+          try
           {
-            bad_interface_state_detected_ = true;
-            throw std::logic_error {"An expected write mutex and flag pair "
-              "was not present in write_mutex_map_ in a call to "
-              "fcgi_si::FcgiServerInterface::AcceptRequests."};
+            // Before push_back so that the budget is released by the
+            // destructor of request on a throw.
+            AssignBudget((*iter)->first, buffered_bytes);
+            requests.push_back(std::move(request));
           }
-          std::mutex* write_mutex_ptr 
-            {write_mutex_map_iter->second.first.get()};
-          bool* write_mutex_bad_state_ptr
-            {&(write_mutex_map_iter->second.second)};
-
-          // For each request, extract a pointer to its RequestData object, and
-          // create an FcgiRequest object from it.
-          std::vector<std::map<FcgiRequestIdentifier,
-            RequestData>::iterator>::iterator req_iterators_end
-            {request_iterators.end()};
-          for(std::vector<std::map<FcgiRequestIdentifier,
-            RequestData>::iterator>::iterator iter {request_iterators.begin()};
-            iter != req_iterators_end; ++iter)
+          catch(...)
           {
-            RequestData* request_data_ptr {&((*iter)->second)};
-
-            // This is a rare instance where an FcgiRequest may be destroyed
-            // within the scope of implementation code. The destructor of
-            // FcgiRequest objects tries to acquire interface_state_mutex_
-            // if the object to be destroyed is neither completed nor null.
-            // See the catch block immediately below.
-            //
-            // Note that the normal constructor of FcgiRequest causes the
-            // associated RequestData instance to transition from pending to
-            // assigned.
-            FcgiRequest request {(*iter)->first,
-              FcgiServerInterface::interface_identifier_, this, 
-              request_data_ptr, write_mutex_ptr, write_mutex_bad_state_ptr, 
-              self_pipe_write_descriptor_};
-            try
-            {
-              requests.push_back(std::move(request));
-            }
-            catch(...)
-            {
-              // Conditionally RELEASE interface_state_mutex_ so that
-              // deadlock will not occur when the destructor of request
-              // executes.
-              unique_interface_state_lock.unlock();
-              throw;
-            }
+            // Conditionally RELEASE interface_state_mutex_ so that
+            // deadlock will not occur when the destructor of request
+            // executes.
+            unique_interface_state_lock.unlock();
+            throw;
           }
-          length_at_loop = requests.size();
-        } // RELEASE interface_state_mutex_.
-      }
+        }
+        length_at_loop = requests.size();
+      } // RELEASE interface_state_mutex_.
+    };
+
+    // Connections are read in ascending order starting after the last
+    // connection whose read budget was exhausted during the previous call.
+    // The order wraps around to the lowest descriptor. A connection which is
+    // still ready because of an exhausted budget is thereby read after the
+    // other ready connections.
+    int resume_descriptor {read_resume_descriptor_};
+    read_resume_descriptor_ = -1;
+    std::map<int, RecordStatus>::iterator status_end {record_status_map_.end()};
+    if(io_uring_poller_)
+    {
+      // Only ready descriptors are examined.
+      std::vector<int>::iterator ready_begin {ready_descriptors_.begin()};
+      std::vector<int>::iterator ready_end {ready_descriptors_.end()};
+      std::vector<int>::iterator ready_start {std::upper_bound(ready_begin,
+        ready_end, resume_descriptor)};
+      auto ReadRange = [&](std::vector<int>::iterator first,
+        std::vector<int>::iterator last)->void
+      {
+        for(/*no-op*/; first != last; ++first)
+        {
+          std::map<int, RecordStatus>::iterator it
+            {record_status_map_.find(*first)};
+          if(it != status_end)
+            ReadConnection(it);
+        }
+      };
+      ReadRange(ready_start, ready_end);
+      ReadRange(ready_begin, ready_start);
+    }
+    else
+    {
+      std::map<int, RecordStatus>::iterator status_start
+        {record_status_map_.upper_bound(resume_descriptor)};
+      auto ReadRange = [&](std::map<int, RecordStatus>::iterator first,
+        std::map<int, RecordStatus>::iterator last)->void
+      {
+        for(/*no-op*/; (first != last) && (connections_read < ready_count);
+            ++first)
+        {
+          if(FD_ISSET(first->first, &read_set))
+            ReadConnection(first);
+        }
+      };
+      ReadRange(status_start, status_end);
+      ReadRange(record_status_map_.begin(), status_start);
     }
     // Accept new connections if some are present.
-    if(connections_read < select_return)
+    // The number of connections which are handled is bounded so that a
+    // reconnection storm cannot starve established connections. The listening
+    // socket remains readable while connections are pending.
+    if(listening_ready)
     {
+      ++connection_acceptance_counters_.accept_batches;
+      int accept_count {0};
       while(AcceptConnection() != -1)
       {
-        continue;
+        if(++accept_count == kAcceptBatchLimit)
+        {
+          ++connection_acceptance_counters_.accept_batch_limit_reached;
+          break;
+        }
       }
     }
   }
@@ -990,16 +1080,56 @@ std::vector<FcgiRequest> FcgiServerInterface::AcceptRequests()
     throw;
   } // RELEASE interface_state_mutex_.
 
+  // Requests were produced in the order in which they were completed. A
+  // stable sort preserves this order among requests of equal priority.
+  if(request_classifier_ && (requests.size() > 1U))
+  {
+    std::stable_sort(requests.begin(), requests.end(),
+      [](const FcgiRequest& lhs, const FcgiRequest& rhs)->bool
+      {
+        return lhs.get_priority() < rhs.get_priority();
+      }
+    );
+  }
+  // Notify the requests which were aborted while connections were read.
+  NotifyAbortSignals();
+  MarkHandedToApplication(&requests);
   return requests;
 }
 
+std::optional<AdmissionController> FcgiServerInterface::
+admission_controller() const
+{
+  // ACQUIRE interface_state_mutex_.
+  std::lock_guard<std::mutex> interface_state_lock
+    {FcgiServerInterface::interface_state_mutex_};
+  return admission_controller_;
+} // RELEASE interface_state_mutex_.
+
+// Synchronization:
+// 1) interface_state_mutex_ must be held prior to a call.
+void FcgiServerInterface::AddBufferedBytes(int connection, std::size_t count)
+{
+  std::map<int, ConnectionLoad>::iterator load_iter
+    {request_count_map_.find(connection)};
+  if(load_iter == request_count_map_.end())
+  {
+    bad_interface_state_detected_ = true;
+    throw std::logic_error {"request_count_map_ did not possess an "
+      "expected file descriptor key."};
+  }
+  RecordLoadChange(connection);
+  load_iter->second.buffered_byte_count += count;
+  total_buffered_byte_count_            += count;
+}
+
 // Synchronization:
 // 1) interface_state_mutex_ must be held prior to a call.
 std::map<FcgiRequestIdentifier, FcgiServerInterface::RequestData>::iterator
 FcgiServerInterface::AddRequest(FcgiRequestIdentifier request_id,
   std::uint16_t role, bool close_connection)
 {
-  std::map<int, int>::iterator request_count_iter {};
+  std::map<int, ConnectionLoad>::iterator request_count_iter {};
   std::map<FcgiRequestIdentifier, RequestData>::iterator request_map_iter {};
 
   try
@@ -1024,7 +1154,7 @@ FcgiServerInterface::AddRequest(FcgiRequestIdentifier request_id,
     throw;
   }
   
-  request_count_iter->second++;
+  request_count_iter->second.request_count++;
   try
   {
     // Insertion has no effect on a throw.
@@ -1034,11 +1164,124 @@ FcgiServerInterface::AddRequest(FcgiRequestIdentifier request_id,
   }
   catch(...)
   {
-    request_count_iter->second--;
+    request_count_iter->second.request_count--;
     throw;
   }
 }
 
+// Synchronization:
+// 1) interface_state_mutex_ must be held prior to a call.
+void FcgiServerInterface::AssignBudget(FcgiRequestIdentifier request_id,
+  std::size_t buffered_bytes)
+{
+  std::map<int, ConnectionLoad>::iterator load_iter
+    {request_count_map_.find(request_id.descriptor())};
+  if(load_iter == request_count_map_.end())
+  {
+    bad_interface_state_detected_ = true;
+    throw std::logic_error {"request_count_map_ did not possess an "
+      "expected file descriptor key."};
+  }
+  RecordLoadChange(request_id.descriptor());
+  load_iter->second.buffered_byte_count    -= buffered_bytes;
+  total_buffered_byte_count_               -= buffered_bytes;
+  load_iter->second.assigned_request_count += 1;
+  total_assigned_request_count_            += 1;
+}
+
+// Synchronization:
+// 1) interface_state_mutex_ must be held prior to a call.
+bool FcgiServerInterface::BudgetExceeded(int connection,
+  std::size_t pending_assignments)
+{
+  std::map<int, ConnectionLoad>::iterator load_iter
+    {request_count_map_.find(connection)};
+  if(load_iter == request_count_map_.end())
+  {
+    bad_interface_state_detected_ = true;
+    throw std::logic_error {"request_count_map_ did not possess an "
+      "expected file descriptor key."};
+  }
+  const BackpressureBudgets& budgets {backpressure_budgets_};
+  const ConnectionLoad& load {load_iter->second};
+  // Requests are bounded by maximum_request_count_per_connection_.
+  int pending {static_cast<int>(pending_assignments)};
+  int connection_assigned {load.assigned_request_count + pending};
+
+  // Byte budgets are only enforced when an assigned request will free
+  // budget. See BackpressureBudgets.
+  return
+    (budgets.connection_assigned_requests &&
+      (connection_assigned >= budgets.connection_assigned_requests)) ||
+    (budgets.connection_buffered_bytes && connection_assigned &&
+      (load.buffered_byte_count >= budgets.connection_buffered_bytes)) ||
+    TotalBudgetExceeded(pending);
+}
+
+int FcgiServerInterface::CreateLoopbackConnection()
+{
+  // As for AcceptConnection.
+  if(application_overload_                                 ||
+    (record_status_map_.size() >=
+     static_cast<unsigned int>(maximum_connection_count_)))
+  {
+    ++connection_acceptance_counters_.rejected_for_load;
+    FcgiMetrics::Add(application_overload_ ?
+      FcgiCounter::kConnectionsRejectedForOverload :
+      FcgiCounter::kConnectionsRejectedForLimit);
+    return -1;
+  }
+
+  int pair[2] = {-1, -1};
+  if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) == -1)
+  {
+    std::error_code ec {errno, std::system_category()};
+    throw std::system_error {ec, "socketpair"};
+  }
+  // pair[0] is used by the interface and must be non-blocking as an accepted
+  // connection is.
+  int f_getfl_return {fcntl(pair[0], F_GETFL)};
+  if((f_getfl_return == -1) ||
+     (fcntl(pair[0], F_SETFL, f_getfl_return | O_NONBLOCK) == -1))
+  {
+    std::error_code ec {errno, std::system_category()};
+    close(pair[0]);
+    close(pair[1]);
+    throw std::system_error {ec, "fcntl"};
+  }
+  try
+  {
+    AddConnection(pair[0]);
+  }
+  catch(...)
+  {
+    close(pair[0]);
+    close(pair[1]);
+    throw;
+  }
+  return pair[1];
+}
+
+void FcgiServerInterface::DisableAdmissionControl()
+{
+  // ACQUIRE interface_state_mutex_.
+  std::lock_guard<std::mutex> interface_state_lock
+    {FcgiServerInterface::interface_state_mutex_};
+  admission_controller_.reset();
+} // RELEASE interface_state_mutex_.
+
+void FcgiServerInterface::
+EnableAdmissionControl(const AdmissionController::Parameters& parameters)
+{
+  // Construct before acquisition as construction may throw.
+  AdmissionController controller {parameters,
+    std::chrono::steady_clock::now()};
+  // ACQUIRE interface_state_mutex_.
+  std::lock_guard<std::mutex> interface_state_lock
+    {FcgiServerInterface::interface_state_mutex_};
+  admission_controller_ = controller;
+} // RELEASE interface_state_mutex_.
+
 bool FcgiServerInterface::interface_status() const
 {
   // ACQUIRE interface_state_mutex_.
@@ -1047,6 +1290,20 @@ bool FcgiServerInterface::interface_status() const
   return !bad_interface_state_detected_;
 } // RELEASE interface_state_mutex_.
 
+void FcgiServerInterface::NotifyAbortSignals()
+{
+  std::vector<std::shared_ptr<AbortSignal>> signals {};
+  { // ACQUIRE interface_state_mutex_.
+    std::lock_guard<std::mutex> interface_state_lock
+      {FcgiServerInterface::interface_state_mutex_};
+    signals.swap(pending_abort_signals_);
+  } // RELEASE interface_state_mutex_.
+  // A callback may acquire interface_state_mutex_, for example through a call
+  // of FcgiRequest::AbortStatus.
+  for(std::shared_ptr<AbortSignal>& signal_ptr : signals)
+    signal_ptr->Notify();
+}
+
 // Synchronization:
 // 1) interface_state_mutex_ must be held prior to a call.
 bool FcgiServerInterface::RemoveConnection(int connection)
@@ -1054,7 +1311,8 @@ bool FcgiServerInterface::RemoveConnection(int connection)
   // Care must be taken to prevent descriptor leaks or double closures.
 
   // A lambda which checks for the presence of the connection in and attempts
-  // to erase the connection from record_status_map_ and write_mutex_map_.
+  // to erase the connection from record_status_map_, write_mutex_map_, and
+  // write_combiner_map_.
   // Terminates the program if erasure doesn't or can't occur.
   auto EraseConnectionOrTerminate = [this](int connection, 
     bool erase_request_count)->void
@@ -1065,21 +1323,25 @@ bool FcgiServerInterface::RemoveConnection(int connection)
         {record_status_map_.find(connection)};
       std::map<int, std::pair<std::unique_ptr<std::mutex>, bool>>::iterator
         write_iter {write_mutex_map_.find(connection)}; 
-      std::map<int, int>::iterator request_count_iter {};
+      std::map<int, std::unique_ptr<WriteCombiner>>::iterator combiner_iter
+        {write_combiner_map_.find(connection)};
+      std::map<int, ConnectionLoad>::iterator request_count_iter {};
       if(erase_request_count)
         request_count_iter = request_count_map_.find(connection);
 
       if(record_iter == record_status_map_.end() 
          || write_iter == write_mutex_map_.end()
+         || combiner_iter == write_combiner_map_.end()
          || (erase_request_count && 
              (request_count_iter == request_count_map_.end())))
         throw std::logic_error {"An expected connection was not present in "
-          "at least one of record_status_map_, write_mutex_map_, and "
-          "request_count_map_ in a call to "
+          "at least one of record_status_map_, write_mutex_map_, "
+          "write_combiner_map_, and request_count_map_ in a call to "
           "fcgi_si::FcgiServerInterface::RemoveConnection."};
 
       record_status_map_.erase(record_iter);
       write_mutex_map_.erase(write_iter);
+      write_combiner_map_.erase(combiner_iter);
       if(erase_request_count)
         request_count_map_.erase(request_count_iter);
     }
@@ -1102,6 +1364,13 @@ bool FcgiServerInterface::RemoveConnection(int connection)
       return false;
     unique_write_lock.unlock();
 
+    // A pending poll operation would keep the connection open after the
+    // descriptor is closed.
+    if(io_uring_poller_)
+      io_uring_poller_->Disarm(connection);
+    // The descriptor may be reused by a new connection.
+    throttled_connection_set_.erase(connection);
+
     bool assigned_requests {RequestCleanupDuringConnectionClosure(connection)};
     // Close the connection in one of two ways.
     if(assigned_requests)
@@ -1141,6 +1410,7 @@ bool FcgiServerInterface::RemoveConnection(int connection)
         throw std::system_error {ec, "close"};
       }
     }
+    FcgiMetrics::Add(FcgiCounter::kConnectionsClosed);
     return true;
   }
   catch(...)
@@ -1161,12 +1431,50 @@ RemoveRequestHelper(std::map<FcgiRequestIdentifier, RequestData>::iterator iter)
 
     // Use a pointer instead of a non-constant reference to conditionally 
     // modify the request count associated with request_id.descriptor().
-    int* request_count_ptr {&request_count_map_.at(
+    ConnectionLoad* load_ptr {&request_count_map_.at(
       iter->first.descriptor())};
-    if(*request_count_ptr == 0)
+    if(load_ptr->request_count == 0)
       throw std::logic_error {"request_count_map_ would have obtained "
         "a negative count."};
-    *request_count_ptr -= 1;
+
+    // Wake the interface if it may be blocked while connections are
+    // throttled. The byte is ignored if the interface was not blocked. The
+    // write precedes state changes so that a throw leaves request_map_ and
+    // request_count_map_ unchanged.
+    bool assigned
+      {iter->second.get_status() == RequestStatus::kRequestAssigned};
+    if(assigned && throttling_active_)
+    {
+      std::uint8_t pipe_buff[1] = {0};
+      ssize_t write_return {};
+      while(((write_return = write(self_pipe_write_descriptor_,
+        pipe_buff, 1)) < 0) && (errno == EINTR))
+        continue;
+      // A full pipe already wakes the interface.
+      if((write_return <= 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+        throw std::logic_error {"The self-pipe could not be written to."};
+    }
+
+    // As for the write, the insertion precedes state changes.
+    RecordLoadChange(iter->first.descriptor());
+
+    load_ptr->request_count -= 1;
+    // Release the backpressure usage of the request. The data of an assigned
+    // request was moved to its FcgiRequest object when it was assigned.
+    if(assigned)
+    {
+      load_ptr->assigned_request_count -= 1;
+      total_assigned_request_count_    -= 1;
+    }
+    else
+    {
+      std::size_t buffered_bytes {iter->second.get_buffered_byte_count()};
+      load_ptr->buffered_byte_count -= buffered_bytes;
+      total_buffered_byte_count_    -= buffered_bytes;
+    }
+
+    if(admission_controller_)
+      admission_controller_->RecordCompletion();
 
     request_map_.erase(iter);
   }
@@ -1196,6 +1504,7 @@ bool FcgiServerInterface::RequestCleanupDuringConnectionClosure(int connection)
         RequestStatus::kRequestAssigned)
       {
         request_map_iter->second.set_connection_closed_by_interface();
+        SignalAbort(&(request_map_iter->second), true);
         assigned_requests_present = true;
         ++request_map_iter;
       }
@@ -1418,6 +1727,7 @@ SendRecord(int connection, const std::uint8_t* buffer_ptr,
   struct timeval timeout {kWriteBlockTimeout_, 0};
   std::size_t number_written {as_components::socket_functions::
     WriteOnSelect(connection, buffer_ptr, count, &timeout)};
+  FcgiMetrics::Add(FcgiCounter::kBytesWritten, number_written);
   
   // Check for errors which prevented a full write.
   if(number_written < static_cast<std::size_t>(count))
@@ -1456,7 +1766,12 @@ SendRecord(int connection, const std::uint8_t* buffer_ptr,
       throw;
     }
 
-    if((errno == EPIPE) || (errno == 0))
+    if(errno == 0) // WriteOnSelect timed out.
+    {
+      FcgiMetrics::Add(FcgiCounter::kWriteTimeouts);
+      return false;
+    }
+    else if(errno == EPIPE)
       return false;
     else // Any other error is considered exceptional.
     {
@@ -1468,5 +1783,114 @@ SendRecord(int connection, const std::uint8_t* buffer_ptr,
   return true;
 } // RELEASE the write mutex for the connection.
 
+void FcgiServerInterface::
+set_backpressure_budgets(const BackpressureBudgets& budgets)
+{
+  if((budgets.connection_assigned_requests < 0) ||
+     (budgets.total_assigned_requests < 0))
+    throw std::invalid_argument {"A negative request budget was provided "
+      "to fcgi_si::FcgiServerInterface::set_backpressure_budgets."};
+  // ACQUIRE interface_state_mutex_.
+  // The budgets are read by request threads through RemoveRequestHelper.
+  std::lock_guard<std::mutex> interface_state_lock
+    {FcgiServerInterface::interface_state_mutex_};
+  backpressure_budgets_ = budgets;
+  // A change of a budget may change the throttling state of any connection.
+  throttling_update_all_ = true;
+} // RELEASE interface_state_mutex_.
+
+// Synchronization:
+// 1) interface_state_mutex_ must be held prior to a call.
+void FcgiServerInterface::SignalAbort(RequestData* request_data_ptr,
+  bool connection_closed)
+{
+  const std::shared_ptr<AbortSignal>& signal_ptr
+    {request_data_ptr->get_abort_signal()};
+  // A request which was not assigned has no FcgiRequest object to notify.
+  if(!signal_ptr)
+    return;
+  // A request which was aborted by its client may later have its connection
+  // closed.
+  if(connection_closed)
+    signal_ptr->connection_closed.store(true);
+  if(signal_ptr->aborted.exchange(true))
+    return;
+  pending_abort_signals_.push_back(signal_ptr);
+}
+
+// Synchronization:
+// 1) interface_state_mutex_ must be held prior to a call.
+void FcgiServerInterface::UpdateThrottling()
+{
+  try
+  {
+    if(!BackpressureEnabled() && throttled_connection_set_.empty())
+    {
+      throttling_update_set_.clear();
+      throttling_update_all_ = false;
+      throttling_active_     = false;
+      return;
+    }
+    // A connection exceeds a budget if its own usage or the total usage
+    // exceeds a budget. Only the connections whose usage changed since the
+    // last update need to be examined unless the total usage crossed a
+    // budget.
+    bool total_exceeded {BackpressureEnabled() && TotalBudgetExceeded(0)};
+    if(total_exceeded != total_budget_exceeded_)
+    {
+      throttling_update_all_ = true;
+      total_budget_exceeded_ = total_exceeded;
+    }
+    auto Update = [this](int connection)->void
+    {
+      bool exceeded {BackpressureEnabled() && BudgetExceeded(connection, 0U)};
+      std::set<int>::iterator throttled_iter
+        {throttled_connection_set_.find(connection)};
+      bool throttled {throttled_iter != throttled_connection_set_.end()};
+      if(exceeded == throttled)
+        return;
+      if(exceeded)
+      {
+        // The connection is disarmed first so that it is never both
+        // throttled and armed.
+        if(io_uring_poller_)
+          io_uring_poller_->Disarm(connection);
+        throttled_connection_set_.insert(connection);
+        FcgiMetrics::Add(FcgiCounter::kReadThrottles);
+      }
+      else
+      {
+        if(io_uring_poller_)
+          io_uring_poller_->Arm(connection);
+        throttled_connection_set_.erase(throttled_iter);
+      }
+    };
+    if(throttling_update_all_)
+    {
+      for(std::map<int, RecordStatus>::value_type& status :
+        record_status_map_)
+        Update(status.first);
+    }
+    else
+    {
+      // The set may hold connections which were closed. A closed connection
+      // whose assigned requests remain is not in record_status_map_.
+      for(int connection : throttling_update_set_)
+      {
+        if(record_status_map_.count(connection))
+          Update(connection);
+      }
+    }
+    throttling_update_set_.clear();
+    throttling_update_all_ = false;
+    throttling_active_     = !throttled_connection_set_.empty();
+  }
+  catch(...)
+  {
+    bad_interface_state_detected_ = true;
+    throw;
+  }
+}
+
 } // namespace fcgi
 } // namespace as_components
@@ -0,0 +1,273 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Implementation notes:
+// 1) The submission and completion rings are shared with the kernel. The
+//    kernel reads the submission queue tail and writes the completion queue
+//    tail. Stores to the submission queue tail and to the completion queue
+//    head use release semantics. Loads of the completion queue tail use
+//    acquire semantics.
+// 2) User data values:
+//    a) Poll operations: (tag << 32) | descriptor. Tags are never zero.
+//    b) Poll removal operations: 0. Their completions are ignored.
+// 3) Only the interface thread uses the poller.
+
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+#include "fcgi/include/fcgi_server_interface.h"
+
+namespace as_components {
+namespace fcgi {
+
+namespace {
+
+// The submission queue only holds poll and poll removal operations which are
+// queued between calls to Wait. It is flushed when it is full.
+constexpr unsigned int kSubmissionEntries {256U};
+
+inline int IoUringSetup(unsigned int entries, struct io_uring_params* params)
+{
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+inline int IoUringEnter(int ring_descriptor, unsigned int to_submit,
+  unsigned int min_complete, unsigned int flags)
+{
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_descriptor,
+    to_submit, min_complete, flags, nullptr, 0));
+}
+
+inline unsigned int* RingField(void* ring_ptr, std::uint32_t offset)
+{
+  return static_cast<unsigned int*>(static_cast<void*>(
+    static_cast<std::uint8_t*>(ring_ptr) + offset));
+}
+
+} // namespace
+
+std::unique_ptr<FcgiServerInterface::IoUringPoller>
+FcgiServerInterface::IoUringPoller::Create(unsigned int completion_entries)
+{
+  // The poller is allocated first so that the io_uring descriptor is not
+  // leaked if allocation throws.
+  std::unique_ptr<IoUringPoller> poller {new IoUringPoller {}};
+  struct io_uring_params params {};
+  params.flags      = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+  params.cq_entries = std::max(completion_entries, 2U * kSubmissionEntries);
+  poller->ring_descriptor_ = IoUringSetup(kSubmissionEntries, &params);
+  // ENOSYS: io_uring is not supported. EPERM: io_uring is disabled or
+  // restricted. EINVAL: a needed setup flag is not supported.
+  if(poller->ring_descriptor_ == -1)
+    return nullptr;
+  // Without IORING_FEAT_NODROP, completions may be lost when the completion
+  // queue overflows. A lost poll completion would leave a descriptor unarmed.
+  if(!(params.features & IORING_FEAT_NODROP))
+    return nullptr;
+
+  poller->sq_ring_size_ = params.sq_off.array +
+    params.sq_entries * sizeof(std::uint32_t);
+  poller->cq_ring_size_ = params.cq_off.cqes +
+    params.cq_entries * sizeof(struct io_uring_cqe);
+  bool single_mmap {(params.features & IORING_FEAT_SINGLE_MMAP) != 0U};
+  if(single_mmap)
+  {
+    poller->sq_ring_size_ = std::max(poller->sq_ring_size_,
+      poller->cq_ring_size_);
+    poller->cq_ring_size_ = poller->sq_ring_size_;
+  }
+  auto MapOrThrow = [&poller](std::size_t size, off_t offset)->void*
+  {
+    void* map_ptr {mmap(nullptr, size, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, poller->ring_descriptor_, offset)};
+    if(map_ptr == MAP_FAILED)
+    {
+      std::error_code ec {errno, std::system_category()};
+      throw std::system_error {ec, "mmap"};
+    }
+    return map_ptr;
+  };
+  poller->sq_ring_ptr_ = MapOrThrow(poller->sq_ring_size_, IORING_OFF_SQ_RING);
+  poller->cq_ring_ptr_ = (single_mmap) ? poller->sq_ring_ptr_ :
+    MapOrThrow(poller->cq_ring_size_, IORING_OFF_CQ_RING);
+  poller->sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  poller->sqes_ptr_ = MapOrThrow(poller->sqes_size_, IORING_OFF_SQES);
+
+  void* sq_ptr {poller->sq_ring_ptr_};
+  poller->sq_head_ptr_  = RingField(sq_ptr, params.sq_off.head);
+  poller->sq_tail_ptr_  = RingField(sq_ptr, params.sq_off.tail);
+  poller->sq_array_ptr_ = RingField(sq_ptr, params.sq_off.array);
+  poller->sq_mask_      = *RingField(sq_ptr, params.sq_off.ring_mask);
+  poller->sq_entries_   = params.sq_entries;
+  void* cq_ptr {poller->cq_ring_ptr_};
+  poller->cq_head_ptr_  = RingField(cq_ptr, params.cq_off.head);
+  poller->cq_tail_ptr_  = RingField(cq_ptr, params.cq_off.tail);
+  poller->cq_mask_      = *RingField(cq_ptr, params.cq_off.ring_mask);
+  poller->cqes_ptr_     = RingField(cq_ptr, params.cq_off.cqes);
+  return poller;
+}
+
+FcgiServerInterface::IoUringPoller::~IoUringPoller()
+{
+  if(sqes_ptr_)
+    munmap(sqes_ptr_, sqes_size_);
+  if(cq_ring_ptr_ && (cq_ring_ptr_ != sq_ring_ptr_))
+    munmap(cq_ring_ptr_, cq_ring_size_);
+  if(sq_ring_ptr_)
+    munmap(sq_ring_ptr_, sq_ring_size_);
+  if(ring_descriptor_ != -1)
+    close(ring_descriptor_);
+}
+
+void FcgiServerInterface::IoUringPoller::Submit()
+{
+  while(to_submit_ > 0U)
+  {
+    int enter_return {IoUringEnter(ring_descriptor_, to_submit_, 0U, 0U)};
+    if(enter_return == -1)
+    {
+      if(errno == EINTR)
+        continue;
+      std::error_code ec {errno, std::system_category()};
+      throw std::system_error {ec, "io_uring_enter"};
+    }
+    to_submit_ -= static_cast<unsigned int>(enter_return);
+  }
+}
+
+void* FcgiServerInterface::IoUringPoller::NextSubmissionEntry()
+{
+  if(to_submit_ == sq_entries_)
+    Submit();
+  // The tail is only written by this thread.
+  unsigned int tail {*sq_tail_ptr_};
+  unsigned int index {tail & sq_mask_};
+  struct io_uring_sqe* sqe_ptr {static_cast<struct io_uring_sqe*>(sqes_ptr_)
+    + index};
+  std::memset(sqe_ptr, 0, sizeof(struct io_uring_sqe));
+  sq_array_ptr_[index] = index;
+  return sqe_ptr;
+}
+
+void FcgiServerInterface::IoUringPoller::Arm(int descriptor)
+{
+  if(next_tag_ == 0U)
+    next_tag_ = 1U;
+  std::uint64_t user_data {(static_cast<std::uint64_t>(next_tag_) << 32U) |
+    static_cast<std::uint32_t>(descriptor)};
+  // Obtain the entry first. It is not published until the tail is updated.
+  struct io_uring_sqe* sqe_ptr {static_cast<struct io_uring_sqe*>(
+    NextSubmissionEntry())};
+  registrations_.emplace(descriptor, user_data); // May throw.
+  ++next_tag_;
+  sqe_ptr->opcode        = IORING_OP_POLL_ADD;
+  sqe_ptr->fd            = descriptor;
+  sqe_ptr->poll32_events = POLLIN;
+  sqe_ptr->user_data     = user_data;
+  __atomic_store_n(sq_tail_ptr_, *sq_tail_ptr_ + 1U, __ATOMIC_RELEASE);
+  ++to_submit_;
+}
+
+void FcgiServerInterface::IoUringPoller::Disarm(int descriptor)
+{
+  std::map<int, std::uint64_t>::iterator registration_iter
+    {registrations_.find(descriptor)};
+  if(registration_iter == registrations_.end())
+    return;
+  struct io_uring_sqe* sqe_ptr {static_cast<struct io_uring_sqe*>(
+    NextSubmissionEntry())};
+  sqe_ptr->opcode    = IORING_OP_POLL_REMOVE;
+  sqe_ptr->fd        = -1;
+  sqe_ptr->addr      = registration_iter->second;
+  sqe_ptr->user_data = 0U;
+  registrations_.erase(registration_iter);
+  __atomic_store_n(sq_tail_ptr_, *sq_tail_ptr_ + 1U, __ATOMIC_RELEASE);
+  ++to_submit_;
+}
+
+int FcgiServerInterface::IoUringPoller::Wait(std::vector<int>* ready_ptr)
+{
+  int ready_count {0};
+  while(ready_count == 0)
+  {
+    int enter_return {IoUringEnter(ring_descriptor_, to_submit_, 1U,
+      IORING_ENTER_GETEVENTS)};
+    if(enter_return == -1)
+    {
+      if(errno == EINTR)
+        return -1;
+      std::error_code ec {errno, std::system_category()};
+      throw std::system_error {ec, "io_uring_enter"};
+    }
+    to_submit_ -= static_cast<unsigned int>(enter_return);
+
+    unsigned int head {*cq_head_ptr_};
+    unsigned int tail {__atomic_load_n(cq_tail_ptr_, __ATOMIC_ACQUIRE)};
+    // When entries were submitted, io_uring_enter returns the number of
+    // submitted entries even if the wait was interrupted by a signal.
+    if(head == tail)
+    {
+      errno = EINTR;
+      return -1;
+    }
+    // Reserve before completions are consumed so that appending does not
+    // throw. A descriptor which was consumed but not reported would be lost.
+    ready_ptr->reserve(ready_ptr->size() + (tail - head));
+    const struct io_uring_cqe* cqes {static_cast<const struct io_uring_cqe*>(
+      cqes_ptr_)};
+    for(/*no-op*/; head != tail; ++head)
+    {
+      std::uint64_t user_data {cqes[head & cq_mask_].user_data};
+      if(user_data == 0U)
+        continue;
+      int descriptor {static_cast<int>(static_cast<std::uint32_t>(
+        user_data))};
+      std::map<int, std::uint64_t>::iterator registration_iter
+        {registrations_.find(descriptor)};
+      if((registration_iter == registrations_.end()) ||
+         (registration_iter->second != user_data))
+        continue; // Stale.
+      // A poll which completed with an error is reported as ready. The
+      // error is found when the descriptor is read.
+      ready_ptr->push_back(descriptor);
+      registrations_.erase(registration_iter);
+      ++ready_count;
+    }
+    __atomic_store_n(cq_head_ptr_, head, __ATOMIC_RELEASE);
+  }
+  return ready_count;
+}
+
+} // namespace fcgi
+} // namespace as_components
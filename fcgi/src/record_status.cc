@@ -43,13 +43,17 @@
 //       used by the FcgiRequest constructor to generate a request from the
 //       data of the request.
 
+#include <sys/ioctl.h>
+
 #include <cstdint>
 #include <cstring>
 #include <limits>
 #include <mutex>
 #include <vector>
 
+#include "fcgi/include/fcgi_metrics.h"
 #include "fcgi/include/fcgi_protocol_constants.h"
+#include "fcgi/include/fcgi_record_decoder.h"
 #include "fcgi/include/fcgi_request.h"
 #include "fcgi/include/fcgi_request_identifier.h"
 #include "fcgi/include/fcgi_server_interface.h"
@@ -67,30 +71,22 @@ RecordStatus(int connection, FcgiServerInterface* interface_ptr)
 FcgiServerInterface::RecordStatus::
 RecordStatus(RecordStatus&& record_status) noexcept
 : connection_ {record_status.connection_},
-  bytes_received_ {record_status.bytes_received_},
-  content_bytes_expected_ {record_status.content_bytes_expected_},
-  padding_bytes_expected_ {record_status.padding_bytes_expected_},
+  decoder_ {record_status.decoder_},
   type_ {record_status.type_},
   request_id_ {record_status.request_id_},
   invalidated_by_header_ {record_status.invalidated_by_header_},
   local_record_content_buffer_ {std::move(
     record_status.local_record_content_buffer_)},
   i_ptr_ {record_status.i_ptr_}
-{
-  std::memcpy(header_, record_status.header_, FCGI_HEADER_LEN);
-}
+{}
 
 FcgiServerInterface::RecordStatus& FcgiServerInterface::RecordStatus::
 operator=(RecordStatus&& record_status) noexcept
 {
   if(this != &record_status)
   {
-    std::memcpy(header_, record_status.header_, FCGI_HEADER_LEN);
-
     connection_ = record_status.connection_;
-    bytes_received_ = record_status.bytes_received_;
-    content_bytes_expected_ = record_status.content_bytes_expected_;
-    padding_bytes_expected_ = record_status.padding_bytes_expected_;
+    decoder_ = record_status.decoder_;
     type_ = record_status.type_;
     request_id_ = record_status.request_id_;
     invalidated_by_header_ = record_status.invalidated_by_header_;
@@ -104,10 +100,8 @@ operator=(RecordStatus&& record_status) noexcept
 void FcgiServerInterface::RecordStatus::ClearRecord() noexcept
 {
   // connection_ is unchanged.
-  std::memset(header_, 0, FCGI_HEADER_LEN);
-  bytes_received_ = 0;
-  content_bytes_expected_ = 0U;
-  padding_bytes_expected_ = 0U;
+  // decoder_ is unchanged. It is at a record boundary when a record is
+  // complete.
   type_ = static_cast<FcgiType>(0U);
   request_id_ = FcgiRequestIdentifier {};
   invalidated_by_header_ = false;
@@ -115,6 +109,34 @@ void FcgiServerInterface::RecordStatus::ClearRecord() noexcept
   // i_ptr_ is unchanged.
 }
 
+void FcgiServerInterface::RecordStatus::ScheduleClosureAfterThrow()
+{
+  std::unique_lock<std::mutex> unique_interface_state_lock
+    {FcgiServerInterface::interface_state_mutex_, std::defer_lock};
+  try
+  {
+    // ACQUIRE interface_state_mutex_.
+    unique_interface_state_lock.lock();
+  }
+  catch(...)
+  {
+    std::terminate();
+  }
+  if(i_ptr_->bad_interface_state_detected_)
+    throw std::runtime_error {"The interface was found to be "
+      "corrupt in a call to "
+      "fcgi_si::RecordStatus::ReadRecords."};
+  try
+  {
+    i_ptr_->application_closure_request_set_.insert(connection_);
+  }
+  catch(...)
+  {
+    i_ptr_->bad_interface_state_detected_ = true;
+    throw;
+  }
+} // RELEASE interface_state_mutex_.
+
 std::map<FcgiRequestIdentifier, FcgiServerInterface::RequestData>::iterator
 FcgiServerInterface::RecordStatus::ProcessCompleteRecord(
   std::vector<std::map<FcgiRequestIdentifier, RequestData>::iterator>*
@@ -174,6 +196,8 @@ FcgiServerInterface::RecordStatus::ProcessCompleteRecord(
 
           // Determine if the request limit was reached for the connection.
           bool limit_reached {false};
+          // Determine if the admission controller rejects the request.
+          bool admission_rejected {false};
           {
             // Start lock handling block.
             // ACQUIRE interface_state_mutex_.
@@ -181,7 +205,7 @@ FcgiServerInterface::RecordStatus::ProcessCompleteRecord(
               {FcgiServerInterface::interface_state_mutex_};
             InterfaceCheck();
 
-            std::map<int, int>::iterator request_count_it
+            std::map<int, ConnectionLoad>::iterator request_count_it
               {i_ptr_->request_count_map_.find(connection_)};
             // Logic error check.
             if(request_count_it == i_ptr_->request_count_map_.end())
@@ -190,21 +214,42 @@ FcgiServerInterface::RecordStatus::ProcessCompleteRecord(
               throw std::logic_error {"request_count_map_ did not have an "
                 "expected socket descriptor."};
             }
-            limit_reached = (request_count_it->second
+            limit_reached = (request_count_it->second.request_count
               >= i_ptr_->maximum_request_count_per_connection_);
+            // A request which is rejected for other reasons is not submitted
+            // to the controller.
+            admission_rejected = !limit_reached &&
+              !i_ptr_->application_overload_ &&
+              i_ptr_->admission_controller_ &&
+              !i_ptr_->admission_controller_->Admit(
+                i_ptr_->request_map_.size());
           } // RELEASE interface_state_mutex_.
 
-          // Reject or accept a new request based on the request limit and the
-          // application_set overload flag.
+          // Reject or accept a new request based on the request limit, the
+          // application_set overload flag, and admission control.
           if(limit_reached)
-            (i_ptr_->maximum_request_count_per_connection_ == 1) ?
+          {
+            if(i_ptr_->maximum_request_count_per_connection_ == 1)
+            {
+              FcgiMetrics::Add(FcgiCounter::kRequestsRejectedCantMpxConn);
               i_ptr_->SendFcgiEndRequest(connection_, request_id_,
-                FCGI_CANT_MPX_CONN, EXIT_FAILURE) :
+                FCGI_CANT_MPX_CONN, EXIT_FAILURE);
+            }
+            else
+            {
+              FcgiMetrics::Add(FcgiCounter::kRequestsRejectedOverloaded);
               i_ptr_->SendFcgiEndRequest(connection_, request_id_,
                 FCGI_OVERLOADED, EXIT_FAILURE);
-          else if(i_ptr_->application_overload_)
+            }
+          }
+          else if(i_ptr_->application_overload_ || admission_rejected)
+          {
+            if(admission_rejected)
+              FcgiMetrics::Add(FcgiCounter::kRequestsRejectedByAdmission);
+            FcgiMetrics::Add(FcgiCounter::kRequestsRejectedOverloaded);
             i_ptr_->SendFcgiEndRequest(connection_, request_id_,
               FCGI_OVERLOADED, EXIT_FAILURE);
+          }
           else // We can accept the request.
           {
             // Extract close_connection value.
@@ -220,6 +265,7 @@ FcgiServerInterface::RecordStatus::ProcessCompleteRecord(
             // this request.
             *request_iter_ptr = i_ptr_->AddRequest(request_id_, role,
               close_connection);
+            FcgiMetrics::Add(FcgiCounter::kRequestsAccepted);
           } // RELEASE interface_state_mutex_.
           break;
         }
@@ -255,6 +301,7 @@ FcgiServerInterface::RecordStatus::ProcessCompleteRecord(
             {
               break;
             }
+            FcgiMetrics::Add(FcgiCounter::kRequestsAborted);
             // The value-result parameter request_iter_ptr either should be or
             // must be used to update the pointed-to iterator to one that will
             // be handled correctly and will not be invalid.
@@ -266,6 +313,7 @@ FcgiServerInterface::RecordStatus::ProcessCompleteRecord(
               RequestStatus::kRequestAssigned)
             {
               local_request_iter->second.set_abort();
+              i_ptr_->SignalAbort(&(local_request_iter->second), false);
             }
             else // Not assigned. We can erase the request and update state.
             {
@@ -339,7 +387,10 @@ FcgiServerInterface::RecordStatus::ProcessCompleteRecord(
         case FcgiType::kFCGI_DATA   : {
           bool send_end_request {false};
           // Should we complete the stream?
-          if(content_bytes_expected_ == 0U)
+          bool stream_completed {decoder_.header().content_length == 0U};
+          // The pairs of an FCGI_PARAMS record with content are parsed when
+          // the record is completed. See RequestData::ParsePARAMS.
+          if(stream_completed || (type_ == FcgiType::kFCGI_PARAMS))
           {
             // Note that, since the request has not been assigned (as a stream
             // record was valid), no other thread can access the
@@ -367,52 +418,77 @@ FcgiServerInterface::RecordStatus::ProcessCompleteRecord(
             // RELEASE interface_state_mutex_.
             unique_interface_state_lock.unlock();
 
-            (type_ == FcgiType::kFCGI_PARAMS) ?
-              request_data_ptr->CompletePARAMS() :
-            (type_ == FcgiType::kFCGI_STDIN)  ?
-              request_data_ptr->CompleteSTDIN()  :
-              request_data_ptr->CompleteDATA();
-
-            // Check if the request is complete. If it is, validate the
-            // FCGI_PARAMS stream. This also puts the RequestData object into a
-            // valid state to be used for construction of an FcgiRequest object.
-            if(request_data_ptr->CheckRequestCompletionWithConditionalUpdate())
+            if(!stream_completed)
+            {
+              request_data_ptr->ParsePARAMS();
+            }
+            else
             {
-              //    In the case that the request is complete and well-formed,
-              // it is expected that no more records will be received for it.
-              // As such, if the external cached iterator pointed to this
-              // request, then it should be reset.
-              //    In the case that the request is complete but malformed,
-              // the external cached iterator must be set to a value that will
-              // not be invalid when ProcessCompleteRecord returns.
-              if(local_request_iter == *request_iter_ptr)
+              if(type_ == FcgiType::kFCGI_PARAMS)
               {
-                *request_iter_ptr = request_map_end;
+                request_data_ptr->CompletePARAMS();
+                // Presize FCGI_STDIN so that its content can be read directly
+                // into its final storage.
+                request_data_ptr->ReserveSTDIN(kMaximumStdinReservation_);
               }
-
-              if(request_data_ptr->ProcessFCGI_PARAMS())
+              else
               {
-                result = local_request_iter;
+                (type_ == FcgiType::kFCGI_STDIN) ?
+                  request_data_ptr->CompleteSTDIN() :
+                  request_data_ptr->CompleteDATA();
               }
-              else // The request has a malformed FCGI_PARAMS stream. Reject.
+
+              // Check if the request is complete. If it is, validate the
+              // FCGI_PARAMS stream. This also puts the RequestData object into
+              // a valid state to be used for construction of an FcgiRequest
+              // object.
+              if(request_data_ptr->
+                 CheckRequestCompletionWithConditionalUpdate())
               {
-                // ACQUIRE interface_state_mutex_.
-                unique_interface_state_lock.lock();
-                InterfaceCheck();
-                // Check if we should indicate that a request was made by the
-                // client web sever to close the connection.
-                if(request_data_ptr->get_close_connection())
+                //    In the case that the request is complete and well-formed,
+                // it is expected that no more records will be received for it.
+                // As such, if the external cached iterator pointed to this
+                // request, then it should be reset.
+                //    In the case that the request is complete but malformed,
+                // the external cached iterator must be set to a value that will
+                // not be invalid when ProcessCompleteRecord returns.
+                if(local_request_iter == *request_iter_ptr)
+                {
+                  *request_iter_ptr = request_map_end;
+                }
+
+                if(request_data_ptr->ProcessFCGI_PARAMS())
+                {
+                  // The classifier is user code. It is called while
+                  // interface_state_mutex_ is not held.
+                  if(i_ptr_->request_classifier_)
+                    request_data_ptr->set_priority(i_ptr_->request_classifier_(
+                      request_data_ptr->get_environment_map(),
+                      request_data_ptr->get_role()));
+                  result = local_request_iter;
+                }
+                else // The request has a malformed FCGI_PARAMS stream. Reject.
                 {
-                  i_ptr_->application_closure_request_set_.insert(connection_);
+                  // ACQUIRE interface_state_mutex_.
+                  unique_interface_state_lock.lock();
+                  InterfaceCheck();
+                  // Check if we should indicate that a request was made by the
+                  // client web sever to close the connection.
+                  if(request_data_ptr->get_close_connection())
+                  {
+                    i_ptr_->application_closure_request_set_.insert(
+                      connection_);
+                  }
+                  send_end_request = true;
+                  i_ptr_->RemoveRequest(local_request_iter);
                 }
-                send_end_request = true;
-                i_ptr_->RemoveRequest(local_request_iter);
               }
             }
           } /* Conditionally RELEASE interface_state_mutex_. */ /*
           else
             The record had content which was appended to the proper
-            stream when the content was received. No action need be taken now. */
+            stream when the content was received. No action need be taken now
+            unless the record was an FCGI_PARAMS record. */
 
           if(send_end_request) // (Because of a malformed FCGI_PARAMS stream.)
             i_ptr_->SendFcgiEndRequest(connection_, request_id_,
@@ -461,7 +537,8 @@ FcgiServerInterface::RecordStatus::ProcessCompleteRecord(
 //    the connection of the RecordStatus object.
 std::vector<std::map<FcgiRequestIdentifier,
   FcgiServerInterface::RequestData>::iterator>
-FcgiServerInterface::RecordStatus::ReadRecords()
+FcgiServerInterface::RecordStatus::ReadRecords(std::size_t byte_budget,
+  bool* budget_exhausted_ptr)
 {
   auto InterfaceCheck = [this]()->void
   {
@@ -471,8 +548,9 @@ FcgiServerInterface::RecordStatus::ReadRecords()
         "fcgi_si::RecordStatus::ReadRecords."};
   };
 
-  // Number of bytes read at a time from connected sockets.
-  constexpr int kBufferSize {512};
+  // Number of bytes read at a time from connected sockets when content is
+  // not read directly into the stream of a request.
+  constexpr std::size_t kBufferSize {512U};
   std::uint8_t read_buffer[kBufferSize];
 
   // Return value to be modified during processing.
@@ -486,22 +564,292 @@ FcgiServerInterface::RecordStatus::ReadRecords()
   std::map<FcgiRequestIdentifier, RequestData>::iterator local_request_iter
     {request_map_end};
 
+  std::size_t total_bytes_received {0U};
+
+  // Receives the parts of records from decoder_. As a local class,
+  // RecordHandler has the access of ReadRecords.
+  struct RecordHandler
+  {
+    void OnHeader(const FcgiRecordDecoder::Header&)
+    {
+      // Part of this update is conditionally setting the rejected flag.
+      try
+      {
+        status_ptr->UpdateAfterHeaderCompletion(local_request_iter_ptr);
+      }
+      catch(...)
+      {
+        status_ptr->ScheduleClosureAfterThrow();
+        throw;
+      }
+    }
+
+    void OnContent(const std::uint8_t* content_begin,
+      const std::uint8_t* content_end)
+    {
+      // Determine what we should do with the bytes based on rejection
+      // and type. Every record is rejected if it is not one of the
+      // six types below. Accordingly, we only need to check for those
+      // types.
+      if(status_ptr->invalidated_by_header_)
+        return;
+      FcgiServerInterface* i_ptr {status_ptr->i_ptr_};
+      std::int_fast32_t content_length {content_end - content_begin};
+      if(status_ptr->request_id_.Fcgi_id() == FCGI_NULL_REQUEST_ID
+          || status_ptr->type_ == FcgiType::kFCGI_BEGIN_REQUEST
+          || status_ptr->type_ == FcgiType::kFCGI_ABORT_REQUEST)
+      {
+        // Append to local buffer.
+        try
+        {
+          status_ptr->local_record_content_buffer_.insert(
+            status_ptr->local_record_content_buffer_.end(), content_begin,
+            content_end);
+        }
+        catch(...)
+        {
+          status_ptr->ScheduleClosureAfterThrow();
+          throw;
+        }
+      }
+      else // Append to non-local buffer.
+      {
+        // ACQUIRE interface_state_mutex_.
+        std::unique_lock<std::mutex> unique_interface_state_lock
+          {FcgiServerInterface::interface_state_mutex_,
+            std::defer_lock};
+        try
+        {
+          unique_interface_state_lock.lock();
+        }
+        catch(...)
+        {
+          std::terminate();
+        }
+        if(i_ptr->bad_interface_state_detected_)
+          throw std::runtime_error {"The interface was found to be "
+            "corrupt in a call to "
+            "fcgi_si::RecordStatus::ReadRecords."};
+        try
+        {
+          RequestData& request_data {CurrentRequestData()};
+          switch(status_ptr->type_) {
+            case FcgiType::kFCGI_PARAMS : {
+              request_data.AppendToPARAMS(content_begin, content_length);
+              break;
+            }
+            case FcgiType::kFCGI_STDIN : {
+              request_data.AppendToSTDIN(content_begin, content_length);
+              break;
+            }
+            case FcgiType::kFCGI_DATA : {
+              request_data.AppendToDATA(content_begin, content_length);
+              break;
+            }
+            default : {
+              i_ptr->bad_interface_state_detected_ = true;
+              // An invalid type should have been rejected upon header
+              // completion. The presence of an invalid type here then
+              // indicates a logic error in the program.
+              throw std::logic_error {"An invalid type was encountered "
+                "in a call to FcgiServerInterface::ReadRecords."};
+            }
+          }
+          i_ptr->AddBufferedBytes(status_ptr->connection_, content_length);
+        }
+        catch(...)
+        {
+          if(i_ptr->bad_interface_state_detected_ != true)
+          {
+            try
+            {
+              i_ptr->application_closure_request_set_.insert(
+                status_ptr->connection_);
+            }
+            catch(...)
+            {
+              i_ptr->bad_interface_state_detected_ = true;
+              throw;
+            }
+          }
+          throw;
+        }
+      } // RELEASE interface_state_mutex_.
+    }
+
+    void OnRecordEnd()
+    {
+      FcgiMetrics::CountRecord(status_ptr->type_);
+      try
+      {
+        std::map<FcgiRequestIdentifier, RequestData>::iterator result_iter
+          {status_ptr->ProcessCompleteRecord(request_iterators_ptr,
+            local_request_iter_ptr)};
+        status_ptr->ClearRecord();
+        if(result_iter != status_ptr->i_ptr_->request_map_.end())
+          request_iterators_ptr->push_back(result_iter);
+      }
+      catch(...)
+      {
+        status_ptr->ScheduleClosureAfterThrow();
+        throw;
+      }
+    }
+
+    // Returns the RequestData object of the current record and updates the
+    // cached iterator.
+    //
+    // Preconditions:
+    // 1) interface_state_mutex_ is held.
+    // 2) The current record is a valid stream record.
+    RequestData& CurrentRequestData()
+    {
+      FcgiServerInterface* i_ptr {status_ptr->i_ptr_};
+      // Check if the cached iterator is the correct iterator.
+      std::map<FcgiRequestIdentifier, RequestData>::iterator&
+        local_request_iter {*local_request_iter_ptr};
+      if((local_request_iter == i_ptr->request_map_.end()) ||
+         (local_request_iter->first.Fcgi_id() !=
+          status_ptr->request_id_.Fcgi_id()))
+      {
+        local_request_iter = i_ptr->request_map_.find(status_ptr->request_id_);
+        if(local_request_iter == i_ptr->request_map_.end())
+        {
+          i_ptr->bad_interface_state_detected_ = true;
+          throw std::logic_error {"request_map_ did not have an "
+            "expected RequestData object."};
+        }
+      }
+      return local_request_iter->second;
+    }
+
+    RecordStatus* status_ptr;
+    std::vector<std::map<FcgiRequestIdentifier, RequestData>::iterator>*
+      request_iterators_ptr;
+    std::map<FcgiRequestIdentifier, RequestData>::iterator*
+      local_request_iter_ptr;
+  };
+  RecordHandler handler {this, &request_iterators, &local_request_iter};
+
+  // Helpers for the locking and exception handling of direct reads.
+  auto LockInterfaceState = [](std::unique_lock<std::mutex>* lock_ptr)->void
+  {
+    try
+    {
+      lock_ptr->lock();
+    }
+    catch(...)
+    {
+      std::terminate();
+    }
+  };
+  auto ScheduleClosureWithLock = [this]()->void
+  {
+    if(!i_ptr_->bad_interface_state_detected_)
+    {
+      try
+      {
+        i_ptr_->application_closure_request_set_.insert(connection_);
+      }
+      catch(...)
+      {
+        i_ptr_->bad_interface_state_detected_ = true;
+        throw;
+      }
+    }
+  };
+
   // Read from the connection until it would block (no more data),
-  // it is found to be disconnected, or an unrecoverable error occurs.
+  // it is found to be disconnected, the budget is exhausted, or an
+  // unrecoverable error occurs.
   while(true)
   {
-    std::int_fast32_t number_bytes_processed {0};
+    // Content of a valid FCGI_STDIN or FCGI_DATA record which is larger than
+    // read_buffer is read directly into the stream of its request. This
+    // avoids a copy from read_buffer. Other bytes are read into read_buffer
+    // and given to decoder_.
+    std::size_t content_remaining {decoder_.ContentRemaining()};
+    bool direct_read {(content_remaining > kBufferSize) &&
+      !invalidated_by_header_ &&
+      (request_id_.Fcgi_id() != FCGI_NULL_REQUEST_ID) &&
+      ((type_ == FcgiType::kFCGI_STDIN) || (type_ == FcgiType::kFCGI_DATA))};
+    // The stream is only extended by the number of bytes which are available
+    // on the socket. Extension value-initializes the added bytes, and this
+    // work would otherwise be repeated for bytes which are not received. When
+    // the count is not larger than read_buffer or cannot be determined, a
+    // buffered read is made.
+    int available_bytes {0};
+    if(direct_read &&
+       ((ioctl(connection_, FIONREAD, &available_bytes) == -1) ||
+        (static_cast<std::size_t>(available_bytes) <= kBufferSize)))
+      direct_read = false;
+    std::uint8_t* read_ptr {read_buffer};
+    std::size_t read_size {kBufferSize};
+    RequestData* request_data_ptr {nullptr};
+    if(direct_read)
+    {
+      read_size = content_remaining;
+      if(read_size > static_cast<std::size_t>(available_bytes))
+        read_size = static_cast<std::size_t>(available_bytes);
+      if(byte_budget && (read_size > (byte_budget - total_bytes_received)))
+        read_size = byte_budget - total_bytes_received;
+      // Backpressure budgets are checked between reads. A direct read is
+      // limited to kBufferSize bytes while a byte budget is set so that a
+      // budget is not exceeded by more than one buffered read.
+      if((i_ptr_->backpressure_budgets_.connection_buffered_bytes ||
+          i_ptr_->backpressure_budgets_.total_buffered_bytes) &&
+         (read_size > kBufferSize))
+        read_size = kBufferSize;
+      // ACQUIRE interface_state_mutex_.
+      std::unique_lock<std::mutex> unique_interface_state_lock
+        {FcgiServerInterface::interface_state_mutex_, std::defer_lock};
+      LockInterfaceState(&unique_interface_state_lock);
+      InterfaceCheck();
+      try
+      {
+        request_data_ptr = &handler.CurrentRequestData();
+        read_ptr = request_data_ptr->ExtendStream(type_, read_size);
+      }
+      catch(...)
+      {
+        ScheduleClosureWithLock();
+        throw;
+      }
+    } // RELEASE interface_state_mutex_.
 
-    // A safe narrowing conversion as the return value is in the range
-    // [0, kBufferSize] and kBufferSize is fairly small.
-    //
     // Note that reading does not require synchronization as only the
-    // interface reads from the connected sockets.
-    std::int_fast32_t number_bytes_received(as_components::socket_functions::
-      SocketRead(connection_, read_buffer, kBufferSize));
+    // interface reads from the connected sockets. As the request of a direct
+    // read has not been assigned, no other thread accesses its stream.
+    std::size_t number_bytes_received {as_components::socket_functions::
+      SocketRead(connection_, read_ptr, read_size)};
+    FcgiMetrics::Add(FcgiCounter::kBytesRead,
+      static_cast<std::uint64_t>(number_bytes_received));
+
+    if(direct_read)
+    {
+      // errno is saved as the read is checked below.
+      int saved_errno {errno};
+      // ACQUIRE interface_state_mutex_.
+      std::unique_lock<std::mutex> unique_interface_state_lock
+        {FcgiServerInterface::interface_state_mutex_, std::defer_lock};
+      LockInterfaceState(&unique_interface_state_lock);
+      request_data_ptr->CommitStreamExtension(type_, read_size,
+        number_bytes_received);
+      InterfaceCheck();
+      try
+      {
+        i_ptr_->AddBufferedBytes(connection_, number_bytes_received);
+      }
+      catch(...)
+      {
+        ScheduleClosureWithLock();
+        throw;
+      }
+      errno = saved_errno;
+    } // RELEASE interface_state_mutex_.
 
     // Check for a disconnected socket or an unrecoverable error.
-    if(number_bytes_received < kBufferSize)
+    if(number_bytes_received < read_size)
     {
       if((errno == EAGAIN) || (errno == EWOULDBLOCK))
       {
@@ -553,263 +901,47 @@ FcgiServerInterface::RecordStatus::ReadRecords()
         }
       } // RELEASE interface_state_mutex_.
     }
-    // Processed received bytes.
-    while(number_bytes_processed < number_bytes_received)
-    {
-      std::int_fast32_t number_bytes_remaining =
-        number_bytes_received - number_bytes_processed;
+    // Process the received bytes. Partial records are retained by decoder_.
+    if(direct_read)
+      decoder_.ConsumeContent(number_bytes_received, &handler);
+    else
+      decoder_.Decode(read_buffer, read_buffer + number_bytes_received,
+        &handler);
 
-      // Process received bytes according to header and content/padding
-      // completion. Record completion is checked after header addition.
+    // Check if an additional read should be made on the socket. A short count
+    // can only mean that a call to read() blocked as EOF and other errors
+    // were handled above.
+    if(number_bytes_received < read_size)
+      break;
 
-      if(!IsHeaderComplete())
-      {
-        std::int_fast32_t remaining_header {FCGI_HEADER_LEN - bytes_received_};
-        bool header_can_be_completed 
-          {remaining_header <= number_bytes_remaining};
-        std::int_fast32_t number_to_write {(header_can_be_completed) ?
-          remaining_header : number_bytes_remaining};
-        std::memcpy(&header_[bytes_received_], 
-            &read_buffer[number_bytes_processed], number_to_write);
-        number_bytes_processed += number_to_write;
-        // Follow usage discipline for RecordStatus.
-        bytes_received_ += number_to_write;
-        // Update the RecordStatus object if the header has been completed.
-        // Part of this update is conditionally setting the rejected flag.
-        if(header_can_be_completed)
-        {
-          try
-          {
-            UpdateAfterHeaderCompletion(&local_request_iter);
-          }
-          catch(...)
-          {
-            std::unique_lock<std::mutex> unique_interface_state_lock
-              {FcgiServerInterface::interface_state_mutex_, std::defer_lock};
-            try
-            {
-              // ACQUIRE interface_state_mutex_.
-              unique_interface_state_lock.lock();
-            }
-            catch(...)
-            {
-              std::terminate();
-            }
-            InterfaceCheck();
-            try
-            {
-              i_ptr_->application_closure_request_set_.insert(connection_);
-            }
-            catch(...)
-            {
-              i_ptr_->bad_interface_state_detected_ = true;
-              throw;
-            }
+    // Stop reading once the read budget is exhausted so that other
+    // connections are read. The socket remains readable.
+    total_bytes_received += read_size;
+    if(byte_budget && (total_bytes_received >= byte_budget))
+    {
+      *budget_exhausted_ptr = true;
+      break;
+    }
 
-            throw;
-          } // RELEASE interface_state_mutex_.
-        }
-      }
-      // Header is complete, but the record may not be.
-      // Either the content is complete or it isn't.
-      else
+    // Stop reading once a backpressure budget is exceeded. The unread data
+    // remains in the socket until the connection is no longer throttled.
+    if(i_ptr_->BackpressureEnabled())
+    {
+      // ACQUIRE interface_state_mutex_.
+      std::unique_lock<std::mutex> unique_interface_state_lock
+        {FcgiServerInterface::interface_state_mutex_, std::defer_lock};
+      try
       {
-        std::int_fast32_t header_and_content {content_bytes_expected_};
-        header_and_content += FCGI_HEADER_LEN;
-        std::int_fast32_t remaining_content {};
-        if(bytes_received_ < header_and_content)
-          remaining_content = header_and_content - bytes_received_;
-        else
-          remaining_content = 0;
-
-        if(remaining_content > 0) // Content incomplete.
-        {
-          std::int_fast32_t number_to_write
-            {(remaining_content <= number_bytes_remaining) ?
-              remaining_content : number_bytes_remaining};
-          // Determine what we should do with the bytes based on rejection
-          // and type. Every record is rejected if it is not one of the
-          // six types below. Accordingly, we only need to check for those
-          // types.
-          if(!invalidated_by_header_)
-          {
-            if(request_id_.Fcgi_id() == FCGI_NULL_REQUEST_ID
-                || type_ == FcgiType::kFCGI_BEGIN_REQUEST
-                || type_ == FcgiType::kFCGI_ABORT_REQUEST)
-            {
-              // Append to local buffer.
-              try
-              {
-                local_record_content_buffer_.insert(
-                  local_record_content_buffer_.end(), 
-                  &read_buffer[number_bytes_processed],
-                  &read_buffer[number_bytes_processed] + number_to_write);
-                // Defer tracking variable updates to cover all cases.
-              }
-              catch(...)
-              {
-                std::unique_lock<std::mutex> unique_interface_state_lock
-                  {FcgiServerInterface::interface_state_mutex_, std::defer_lock};
-                try
-                {
-                  // ACQUIRE interface_state_mutex_.
-                  unique_interface_state_lock.lock();
-                }
-                catch(...)
-                {
-                  std::terminate();
-                }
-                InterfaceCheck();
-                try
-                {
-                  i_ptr_->application_closure_request_set_.insert(connection_);
-                }
-                catch(...)
-                {
-                  i_ptr_->bad_interface_state_detected_ = true;
-                  throw;
-                }
-
-                throw;
-              } // RELEASE interface_state_mutex_.
-            }
-            else // Append to non-local buffer.
-            {
-              // ACQUIRE interface_state_mutex_.
-              std::unique_lock<std::mutex> unique_interface_state_lock
-                {FcgiServerInterface::interface_state_mutex_,
-                  std::defer_lock};
-              try
-              {
-                unique_interface_state_lock.lock();
-              }
-              catch(...)
-              {
-                std::terminate();
-              }
-              InterfaceCheck();
-              try
-              {
-                // Check if the cached iterator is the correct iterator.
-                if((local_request_iter == request_map_end) ||
-                   (local_request_iter->first.Fcgi_id() !=
-                    request_id_.Fcgi_id()))
-                {
-                  local_request_iter = i_ptr_->request_map_.find(request_id_);
-                  if(local_request_iter == i_ptr_->request_map_.end())
-                  {
-                    i_ptr_->bad_interface_state_detected_ = true;
-                    throw std::logic_error {"request_map_ did not have an "
-                      "expected RequestData object."};
-                  }
-                }
-                switch(type_) {
-                  case FcgiType::kFCGI_PARAMS : {
-                    local_request_iter->second.AppendToPARAMS(
-                      &read_buffer[number_bytes_processed], number_to_write);
-                    break;
-                  }
-                  case FcgiType::kFCGI_STDIN : {
-                    local_request_iter->second.AppendToSTDIN(
-                      &read_buffer[number_bytes_processed], number_to_write);
-                    break;
-                  }
-                  case FcgiType::kFCGI_DATA : {
-                    local_request_iter->second.AppendToDATA(
-                      &read_buffer[number_bytes_processed], number_to_write);
-                    break;
-                  }
-                  default : {
-                    i_ptr_->bad_interface_state_detected_ = true;
-                    // An invalid type should have been rejected upon header
-                    // completion. The presence of an invalid type here then
-                    // indicates a logic error in the program.
-                    throw std::logic_error {"An invalid type was encountered "
-                      "in a call to FcgiServerInterface::ReadRecords."};
-                  }
-                }
-              }
-              catch(...)
-              {
-                if(i_ptr_->bad_interface_state_detected_ != true)
-                {
-                  try
-                  {
-                    i_ptr_->application_closure_request_set_.insert(connection_);
-                  }
-                  catch(...)
-                  {
-                    i_ptr_->bad_interface_state_detected_ = true;
-                    throw;
-                  }
-                }
-                throw;
-              }
-            } // RELEASE interface_state_mutex_.
-          }
-          // Whether the record was valid or not and whether the data is added
-          // to RecordStatus or not, the tracking variables must be updated.
-          number_bytes_processed += number_to_write;
-          // Follow usage discipline for RecordStatus.
-          bytes_received_ += number_to_write;
-        }
-        else // Padding incomplete.
-        {
-          std::int_fast32_t remaining_padding 
-            {(header_and_content + padding_bytes_expected_) - bytes_received_};
-          std::int_fast32_t number_to_write = 
-            {(remaining_padding <= number_bytes_remaining) ?
-              remaining_padding : number_bytes_remaining};
-          // Ignore padding. Skip ahead without processing.
-          bytes_received_ += number_to_write;
-          number_bytes_processed += number_to_write;
-        }
+        unique_interface_state_lock.lock();
       }
-      // Potentially completed a record.
-      if(IsRecordComplete())
+      catch(...)
       {
-        try
-        {
-          std::map<FcgiRequestIdentifier, RequestData>::iterator result_iter
-            {ProcessCompleteRecord(&request_iterators, &local_request_iter)};
-          ClearRecord();
-          if(result_iter != request_map_end)
-            request_iterators.push_back(result_iter);
-        }
-        catch(...)
-        {
-          std::unique_lock<std::mutex> unique_interface_state_lock
-            {FcgiServerInterface::interface_state_mutex_, std::defer_lock};
-          try
-          {
-            // ACQUIRE interface_state_mutex_.
-            unique_interface_state_lock.lock();
-          }
-          catch(...)
-          {
-            std::terminate();
-          }
-          InterfaceCheck();
-          try
-          {
-            i_ptr_->application_closure_request_set_.insert(connection_);
-          }
-          catch(...)
-          {
-            i_ptr_->bad_interface_state_detected_ = true;
-            throw;
-          }
-          throw;
-        } // RELEASE interface_state_mutex_.
-      } // Loop to check if more received bytes need to be processed.
-    } // On exit, looped through all received data as partitioned by record
-      // segments.
-
-    // Check if an additional read should be made on the socket. A short count
-    // can only mean that a call to read() blocked as EOF and other errors
-    // were handled above.
-    if(number_bytes_received < kBufferSize)
-      break;
+        std::terminate();
+      }
+      InterfaceCheck();
+      if(i_ptr_->BudgetExceeded(connection_, request_iterators.size()))
+        break;
+    } // RELEASE interface_state_mutex_.
   } // End the while loop which keeps reading from the socket.
 
   return request_iterators;
@@ -818,20 +950,11 @@ FcgiServerInterface::RecordStatus::ReadRecords()
 void FcgiServerInterface::RecordStatus::UpdateAfterHeaderCompletion(
   std::map<FcgiRequestIdentifier, RequestData>::iterator* request_iter_ptr)
 {
-  // Extract number of content bytes from two bytes.
-  content_bytes_expected_ = header_[kHeaderContentLengthB1Index];
-  content_bytes_expected_ <<= 8; // one byte
-  content_bytes_expected_ += header_[kHeaderContentLengthB0Index];
-
-  // Extract number of padding bytes.
-  padding_bytes_expected_ = header_[kHeaderPaddingLengthIndex];
-
-  // Extract type and request_id.
-  type_ = static_cast<FcgiType>(header_[kHeaderTypeIndex]);
-  std::uint16_t Fcgi_request_id = header_[kHeaderRequestIDB1Index];
-  Fcgi_request_id <<= 8; // one byte
-  Fcgi_request_id += header_[kHeaderRequestIDB0Index];
+  const FcgiRecordDecoder::Header& header {decoder_.header()};
+  type_ = header.type;
+  std::uint16_t Fcgi_request_id {header.fcgi_id};
   request_id_ = FcgiRequestIdentifier(connection_, Fcgi_request_id);
+  std::uint16_t content_bytes_expected {header.content_length};
 
   // Determine if the record should be rejected based on header
   // information.
@@ -846,12 +969,12 @@ void FcgiServerInterface::RecordStatus::UpdateAfterHeaderCompletion(
   // check.
   switch(type_) {
     case FcgiType::kFCGI_BEGIN_REQUEST : {
-      if(content_bytes_expected_ != 8)
+      if(content_bytes_expected != 8)
         invalidated_by_header_ = true;
       break;
     }
     case FcgiType::kFCGI_ABORT_REQUEST : {
-      if(content_bytes_expected_ != 0)
+      if(content_bytes_expected != 0)
         invalidated_by_header_ = true;
       break;
     }
@@ -21,21 +21,35 @@
 // SOFTWARE.
 
 #include <algorithm>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <map>
+#include <memory>
+#include <new>
 #include <utility>
 #include <vector>
 
+#include "fcgi/include/fcgi_request_trace.h"
 #include "fcgi/include/fcgi_server_interface.h"
 #include "fcgi/include/fcgi_utilities.h"
+#include "fcgi/include/fcgi_well_known_params.h"
 
 namespace as_components {
 namespace fcgi {
 
 FcgiServerInterface::RequestData::
 RequestData(uint16_t role, bool close_connection)
-: role_ {role}, close_connection_ {close_connection}
-{}
+: role_ {role}, close_connection_ {close_connection},
+  begin_request_time_ {std::chrono::steady_clock::now()}
+{
+  // A request whose trace cannot be allocated is not traced.
+  if(FcgiTracing::enabled())
+    trace_.reset(new(std::nothrow) FcgiRequestTrace {});
+  if(trace_)
+    trace_->points[static_cast<std::size_t>(
+      FcgiTracePoint::kBeginRequestReceived)] = begin_request_time_;
+}
 
 bool FcgiServerInterface::RequestData::
 CheckRequestCompletionWithConditionalUpdate() noexcept
@@ -77,63 +91,94 @@ CheckRequestCompletionWithConditionalUpdate() noexcept
   }
 }
 
-bool FcgiServerInterface::RequestData::ProcessFCGI_PARAMS()
+void FcgiServerInterface::RequestData::ParsePARAMS()
 {
-  try
+  if(FCGI_PARAMS_malformed_)
+  {
+    // The bytes of a malformed stream are not needed.
+    FCGI_PARAMS_.clear();
+    return;
+  }
+
+  // A length is encoded in one byte if its high-order bit is zero and in four
+  // bytes otherwise. False is returned if the bytes of a length were not all
+  // received.
+  const std::uint8_t* begin {FCGI_PARAMS_.data()};
+  const std::uint8_t* current {begin};
+  const std::uint8_t* end {begin + FCGI_PARAMS_.size()};
+  auto ExtractLength = [&current, end](std::size_t* length_ptr)->bool
   {
-    if(FCGI_PARAMS_.size())
+    if(current == end)
+      return false;
+    if(!(*current >> 7))
     {
-      std::vector<ByteSeqPair> name_value_pair_list
-        {ExtractBinaryNameValuePairs(FCGI_PARAMS_.data(), FCGI_PARAMS_.size())};
-      if(name_value_pair_list.size())
-      {
-        std::map<std::vector<std::uint8_t>, std::vector<std::uint8_t>>::iterator
-          environment_map_end {environment_map_.end()};
-        std::vector<ByteSeqPair>::iterator nvp_list_begin
-          {name_value_pair_list.begin()};
-        std::vector<ByteSeqPair>::iterator nvp_list_end
-          {name_value_pair_list.end()};
-        std::sort(nvp_list_begin, nvp_list_end, NameLessThan);
-        std::vector<ByteSeqPair>::iterator current {nvp_list_begin};
-        std::vector<ByteSeqPair>::iterator next {nvp_list_begin};
-        ++next;
-        while(next != nvp_list_end)
-        {
-          if(current->first == next->first)
-          {
-            if(current->second == next->second)
-            {
-              ++next;
-            }
-            else
-            {
-              // A list of environment variables was sent which had distinct
-              // definitions for the same variable. Regard the list as corrupt.
-              return false;
-            }
-          }
-          else
-          {
-            environment_map_.emplace_hint(environment_map_end,
-              std::move(*current));
-            current = next;
-            ++next;
-          }
-        }
-        environment_map_.emplace_hint(environment_map_end, std::move(*current));
-      }
-      else // ExtractBinaryNameValuePairs found a formatting error.
-      {
-        return false;
-      }
+      *length_ptr = *current;
+      ++current;
+      return true;
     }
+    if((end - current) < 4)
+      return false;
+    *length_ptr = static_cast<std::size_t>(ExtractFourByteLength(current));
+    current += 4;
     return true;
+  };
+
+  // pair_begin is the start of the first pair which was not parsed.
+  const std::uint8_t* pair_begin {begin};
+  while(current != end)
+  {
+    std::size_t name_length;
+    std::size_t value_length;
+    if(!ExtractLength(&name_length) || !ExtractLength(&value_length) ||
+       (static_cast<std::size_t>(end - current) < (name_length + value_length)))
+      break;
+    const std::uint8_t* value {current + name_length};
+    const std::uint8_t* value_end {value + value_length};
+    std::pair<std::map<std::vector<std::uint8_t>,
+      std::vector<std::uint8_t>>::iterator, bool> insertion
+      {environment_map_.emplace(std::vector<std::uint8_t>(current, value),
+        std::vector<std::uint8_t>(value, value_end))};
+    if(insertion.second)
+    {
+      std::size_t param_index
+        {FcgiWellKnownParams::Find(current, name_length)};
+      if(param_index != FcgiWellKnownParams::kParamCount)
+        well_known_params_[param_index] = &insertion.first->second;
+    }
+    // A repeated definition is allowed if it is identical.
+    else if(!std::equal(insertion.first->second.begin(),
+      insertion.first->second.end(), value, value_end))
+    {
+      FCGI_PARAMS_malformed_ = true;
+      FCGI_PARAMS_.clear();
+      return;
+    }
+    current    = value_end;
+    pair_begin = current;
   }
-  catch(...)
+  // Only the bytes of a partial pair are retained.
+  FCGI_PARAMS_.erase(FCGI_PARAMS_.begin(),
+    FCGI_PARAMS_.begin() + (pair_begin - begin));
+}
+
+void FcgiServerInterface::RequestData::ReserveSTDIN(size limit)
+{
+  const std::vector<std::uint8_t>* value_ptr {well_known_params_[
+    static_cast<std::size_t>(FcgiParam::kContentLength)]};
+  if((value_ptr == nullptr) || value_ptr->empty())
+    return;
+
+  // The value is accumulated only until it exceeds limit so that it
+  // cannot overflow.
+  size content_length {0U};
+  for(std::uint8_t digit : *value_ptr)
   {
-    environment_map_.clear();
-    throw;
+    if((digit < '0') || (digit > '9'))
+      return;
+    if(content_length <= limit)
+      content_length = (10U * content_length) + (digit - '0');
   }
+  FCGI_STDIN_.reserve(std::min(content_length, limit));
 }
 
 } // namespace fcgi
@@ -0,0 +1,217 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "fcgi/include/fcgi_address_allowlist.h"
+
+namespace as_components {
+namespace fcgi {
+namespace test {
+
+namespace {
+
+// Returns the result of AddressAllowlist::Contains for the textual address
+// text of domain. Adds a failure and returns false if text is malformed.
+bool GTestNonFatalContains(const AddressAllowlist& allowlist, int domain,
+  const char* text, int invocation_line)
+{
+  ::testing::ScopedTrace tracer {__FILE__, invocation_line,
+    "GTestNonFatalContains"};
+  struct sockaddr_storage address {};
+  int inet_pton_return {};
+  if(domain == AF_INET)
+  {
+    struct sockaddr_in* inet_address_ptr {static_cast<struct sockaddr_in*>(
+      static_cast<void*>(&address))};
+    inet_address_ptr->sin_family = AF_INET;
+    inet_pton_return = inet_pton(AF_INET, text, &(inet_address_ptr->sin_addr));
+  }
+  else
+  {
+    struct sockaddr_in6* inet_address_ptr {static_cast<struct sockaddr_in6*>(
+      static_cast<void*>(&address))};
+    inet_address_ptr->sin6_family = AF_INET6;
+    inet_pton_return = inet_pton(AF_INET6, text,
+      &(inet_address_ptr->sin6_addr));
+  }
+  if(inet_pton_return != 1)
+  {
+    ADD_FAILURE() << "inet_pton did not accept " << text;
+    return false;
+  }
+  return allowlist.Contains(static_cast<struct sockaddr*>(
+    static_cast<void*>(&address)));
+}
+
+} // namespace
+
+// AddressAllowlist
+// Examined properties:
+// 1) Parsing of single addresses and CIDR prefixes for AF_INET and AF_INET6.
+//    Malformed tokens are rejected and do not change the allowlist.
+// 2) Matching at the boundaries of a prefix and for prefix lengths which are
+//    not multiples of eight.
+// 3) Coalescing of nested prefixes: a prefix which is covered by another
+//    prefix does not add a range regardless of insertion order.
+// 4) Addresses of the other domain are never matched.
+// 5) Construction errors: an unsupported domain and insertion into a
+//    default-constructed allowlist.
+//
+// Test cases:
+// 1) AF_INET: a single address, a /31 prefix, a /12 prefix, and malformed
+//    tokens. Boundary addresses of each prefix are checked.
+// 2) AF_INET: nested prefixes are added from most to least specific and the
+//    reverse. A /0 prefix matches every address.
+// 3) AF_INET6: a single address and a /7 prefix. An AF_INET address does not
+//    match.
+// 4) Construction errors.
+//
+// Modules which testing depends on: none.
+//
+// Other modules whose testing depends on this module:
+// 1) FcgiServerInterface address validation.
+TEST(AddressAllowlist, ParsingAndMatching)
+{
+  // Case 1
+  {
+    AddressAllowlist allowlist {AF_INET};
+    EXPECT_TRUE(allowlist.empty());
+    EXPECT_TRUE(allowlist.AddPrefix("127.0.0.1"));
+    EXPECT_TRUE(allowlist.AddPrefix("192.168.1.7/31"));
+    EXPECT_TRUE(allowlist.AddPrefix("172.16.0.0/12"));
+    EXPECT_FALSE(allowlist.AddPrefix(""));
+    EXPECT_FALSE(allowlist.AddPrefix("127.0.0.256"));
+    EXPECT_FALSE(allowlist.AddPrefix("10.0.0.0/33"));
+    EXPECT_FALSE(allowlist.AddPrefix("10.0.0.0/"));
+    EXPECT_FALSE(allowlist.AddPrefix("10.0.0.0/8a"));
+    EXPECT_FALSE(allowlist.AddPrefix("10.0.0.0/0008"));
+    EXPECT_FALSE(allowlist.AddPrefix("::1"));
+    EXPECT_EQ(allowlist.size(), 3U);
+
+    EXPECT_TRUE(GTestNonFatalContains(allowlist, AF_INET, "127.0.0.1",
+      __LINE__));
+    EXPECT_FALSE(GTestNonFatalContains(allowlist, AF_INET, "127.0.0.2",
+      __LINE__));
+    EXPECT_FALSE(GTestNonFatalContains(allowlist, AF_INET, "192.168.1.5",
+      __LINE__));
+    EXPECT_TRUE(GTestNonFatalContains(allowlist, AF_INET, "192.168.1.6",
+      __LINE__));
+    EXPECT_TRUE(GTestNonFatalContains(allowlist, AF_INET, "192.168.1.7",
+      __LINE__));
+    EXPECT_FALSE(GTestNonFatalContains(allowlist, AF_INET, "192.168.1.8",
+      __LINE__));
+    EXPECT_FALSE(GTestNonFatalContains(allowlist, AF_INET, "172.15.255.255",
+      __LINE__));
+    EXPECT_TRUE(GTestNonFatalContains(allowlist, AF_INET, "172.16.0.0",
+      __LINE__));
+    EXPECT_TRUE(GTestNonFatalContains(allowlist, AF_INET, "172.31.255.255",
+      __LINE__));
+    EXPECT_FALSE(GTestNonFatalContains(allowlist, AF_INET, "172.32.0.0",
+      __LINE__));
+    EXPECT_FALSE(GTestNonFatalContains(allowlist, AF_INET, "0.0.0.0",
+      __LINE__));
+    EXPECT_FALSE(GTestNonFatalContains(allowlist, AF_INET, "255.255.255.255",
+      __LINE__));
+  }
+
+  // Case 2
+  {
+    AddressAllowlist specific_first {AF_INET};
+    EXPECT_TRUE(specific_first.AddPrefix("10.1.2.3"));
+    EXPECT_TRUE(specific_first.AddPrefix("10.1.0.0/16"));
+    EXPECT_TRUE(specific_first.AddPrefix("10.2.0.0/16"));
+    EXPECT_EQ(specific_first.size(), 2U);
+    EXPECT_TRUE(specific_first.AddPrefix("10.0.0.0/8"));
+    EXPECT_EQ(specific_first.size(), 1U);
+
+    AddressAllowlist general_first {AF_INET};
+    EXPECT_TRUE(general_first.AddPrefix("10.0.0.0/8"));
+    EXPECT_TRUE(general_first.AddPrefix("10.1.0.0/16"));
+    EXPECT_TRUE(general_first.AddPrefix("10.1.2.3"));
+    EXPECT_EQ(general_first.size(), 1U);
+
+    for(const AddressAllowlist* allowlist_ptr :
+      {&specific_first, &general_first})
+    {
+      EXPECT_FALSE(GTestNonFatalContains(*allowlist_ptr, AF_INET,
+        "9.255.255.255", __LINE__));
+      EXPECT_TRUE(GTestNonFatalContains(*allowlist_ptr, AF_INET, "10.0.0.0",
+        __LINE__));
+      EXPECT_TRUE(GTestNonFatalContains(*allowlist_ptr, AF_INET,
+        "10.255.255.255", __LINE__));
+      EXPECT_FALSE(GTestNonFatalContains(*allowlist_ptr, AF_INET,
+        "11.0.0.0", __LINE__));
+    }
+
+    AddressAllowlist all {AF_INET};
+    EXPECT_TRUE(all.AddPrefix("127.0.0.1/0"));
+    EXPECT_TRUE(GTestNonFatalContains(all, AF_INET, "0.0.0.0", __LINE__));
+    EXPECT_TRUE(GTestNonFatalContains(all, AF_INET, "255.255.255.255",
+      __LINE__));
+  }
+
+  // Case 3
+  {
+    AddressAllowlist allowlist {AF_INET6};
+    EXPECT_TRUE(allowlist.AddPrefix("::1"));
+    EXPECT_TRUE(allowlist.AddPrefix("fc00::/7"));
+    EXPECT_FALSE(allowlist.AddPrefix("127.0.0.1"));
+    EXPECT_FALSE(allowlist.AddPrefix("fc00::/129"));
+    EXPECT_EQ(allowlist.size(), 2U);
+
+    EXPECT_TRUE(GTestNonFatalContains(allowlist, AF_INET6, "::1", __LINE__));
+    EXPECT_FALSE(GTestNonFatalContains(allowlist, AF_INET6, "::2",
+      __LINE__));
+    EXPECT_FALSE(GTestNonFatalContains(allowlist, AF_INET6,
+      "fbff:ffff:ffff:ffff:ffff:ffff:ffff:ffff", __LINE__));
+    EXPECT_TRUE(GTestNonFatalContains(allowlist, AF_INET6, "fc00::", __LINE__));
+    EXPECT_TRUE(GTestNonFatalContains(allowlist, AF_INET6, "fd00::1",
+      __LINE__));
+    EXPECT_TRUE(GTestNonFatalContains(allowlist, AF_INET6,
+      "fdff:ffff:ffff:ffff:ffff:ffff:ffff:ffff", __LINE__));
+    EXPECT_FALSE(GTestNonFatalContains(allowlist, AF_INET6, "fe00::",
+      __LINE__));
+    EXPECT_FALSE(GTestNonFatalContains(allowlist, AF_INET, "127.0.0.1",
+      __LINE__));
+  }
+
+  // Case 4
+  {
+    EXPECT_THROW(AddressAllowlist {AF_UNIX}, std::invalid_argument);
+    AddressAllowlist allowlist {};
+    EXPECT_TRUE(allowlist.empty());
+    EXPECT_THROW(allowlist.AddPrefix("127.0.0.1"), std::logic_error);
+    EXPECT_TRUE(allowlist.empty());
+  }
+}
+
+} // namespace test
+} // namespace fcgi
+} // namespace as_components
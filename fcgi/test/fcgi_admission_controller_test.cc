@@ -0,0 +1,144 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <stdexcept>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "fcgi/include/fcgi_admission_controller.h"
+
+namespace as_components {
+namespace fcgi {
+namespace test {
+
+// AdmissionController
+// Examined properties:
+// 1) Admit compares the in-flight count with the limit. Rejections are
+//    counted.
+// 2) The limit is only adjusted once an interval elapsed. A congested
+//    interval halves the limit down to minimum_limit. An uncongested interval
+//    in which the limit was reached increments the limit up to
+//    maximum_limit. An uncongested interval in which the limit was not
+//    reached and an interval without queueing delay samples leave the limit
+//    unchanged.
+// 3) Congestion is determined by the minimum queueing delay of an interval.
+//    A single short delay among long delays prevents a decrease.
+// 4) The completion rate and the minimum delay of the last interval.
+// 5) Construction errors for invalid parameters.
+//
+// Test cases:
+// 1) A target of 5 ms, an interval of 100 ms, and limits of 2 and 8.
+//    a) The limit starts at 8. Admit accepts 7 in-flight requests and
+//       rejects 8.
+//    b) Long delays before the interval elapsed leave the limit unchanged.
+//       After the interval, the limit is 4, then 2, then 2.
+//    c) A short delay among long delays prevents a decrease. With the limit
+//       reached, the limit increases to 3. Without it being reached, the
+//       limit is unchanged.
+//    d) An interval without samples leaves the limit unchanged. Ten
+//       completions over 100 ms give a rate of 100 per second.
+// 2) Negative targets, a zero interval, and invalid limits.
+//
+// Modules which testing depends on: none.
+//
+// Other modules whose testing depends on this module:
+// 1) FcgiServerInterface admission control.
+TEST(AdmissionController, LimitAdjustment)
+{
+  using std::chrono::milliseconds;
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  AdmissionController::Parameters parameters {};
+  parameters.target_delay  = milliseconds {5};
+  parameters.interval      = milliseconds {100};
+  parameters.minimum_limit = 2;
+  parameters.maximum_limit = 8;
+  TimePoint now {};
+  AdmissionController controller {parameters, now};
+
+  // Case 1a
+  EXPECT_EQ(controller.limit(), 8);
+  EXPECT_TRUE(controller.Admit(7U));
+  EXPECT_FALSE(controller.Admit(8U));
+  EXPECT_EQ(controller.rejections(), 1U);
+
+  // Case 1b
+  controller.RecordQueueingDelay(milliseconds {20});
+  now += milliseconds {50};
+  controller.Update(now);
+  EXPECT_EQ(controller.limit(), 8);
+  now += milliseconds {50};
+  controller.Update(now);
+  EXPECT_EQ(controller.limit(), 4);
+  EXPECT_EQ(controller.last_minimum_delay(), milliseconds {20});
+  for(int expected_limit : {2, 2})
+  {
+    controller.RecordQueueingDelay(milliseconds {20});
+    now += milliseconds {100};
+    controller.Update(now);
+    EXPECT_EQ(controller.limit(), expected_limit);
+  }
+
+  // Case 1c
+  controller.RecordQueueingDelay(milliseconds {20});
+  controller.RecordQueueingDelay(milliseconds {1});
+  controller.RecordQueueingDelay(milliseconds {30});
+  EXPECT_TRUE(controller.Admit(1U));
+  now += milliseconds {100};
+  controller.Update(now);
+  EXPECT_EQ(controller.limit(), 3);
+  EXPECT_EQ(controller.last_minimum_delay(), milliseconds {1});
+  controller.RecordQueueingDelay(milliseconds {1});
+  EXPECT_TRUE(controller.Admit(0U));
+  now += milliseconds {100};
+  controller.Update(now);
+  EXPECT_EQ(controller.limit(), 3);
+
+  // Case 1d
+  for(int i {0}; i < 10; ++i)
+    controller.RecordCompletion();
+  EXPECT_FALSE(controller.Admit(3U));
+  now += milliseconds {100};
+  controller.Update(now);
+  EXPECT_EQ(controller.limit(), 3);
+  EXPECT_EQ(controller.last_minimum_delay(), milliseconds {0});
+  EXPECT_DOUBLE_EQ(controller.last_completion_rate(), 100.0);
+
+  // Case 2
+  AdmissionController::Parameters invalid {parameters};
+  invalid.target_delay = milliseconds {-1};
+  EXPECT_THROW((AdmissionController {invalid, now}), std::invalid_argument);
+  invalid = parameters;
+  invalid.interval = milliseconds {0};
+  EXPECT_THROW((AdmissionController {invalid, now}), std::invalid_argument);
+  invalid = parameters;
+  invalid.minimum_limit = 0;
+  EXPECT_THROW((AdmissionController {invalid, now}), std::invalid_argument);
+  invalid = parameters;
+  invalid.maximum_limit = 1;
+  EXPECT_THROW((AdmissionController {invalid, now}), std::invalid_argument);
+}
+
+} // namespace test
+} // namespace fcgi
+} // namespace as_components
@@ -0,0 +1,160 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "fcgi/include/fcgi_metrics.h"
+#include "fcgi/include/fcgi_protocol_constants.h"
+
+namespace as_components {
+namespace fcgi {
+namespace test {
+
+// FcgiMetrics
+// Examined properties:
+// 1) Counter updates are reflected in a later snapshot. Counters are
+//    independent.
+// 2) Records are counted by type. A type value which is not an FcgiType
+//    value is counted at index 0.
+// 3) Histogram durations are placed in the bucket of the base-two logarithm
+//    of the duration. Zero and negative durations are placed in bucket 0.
+//    Durations which exceed the range are placed in the last bucket. Count
+//    and sum are maintained.
+// 4) Concurrent updates from more threads than shards are not lost.
+//
+// As the registry is process-wide, values are examined as differences
+// between snapshots.
+//
+// Test cases:
+// 1) Counter addition with the default and explicit increments.
+// 2) Record counts for kFCGI_PARAMS, kFCGI_STDIN, and the value 200.
+// 3) Durations of -5 ns, 0 ns, 1 ns, 2 ns, 3 ns, 1024 ns, and 1000 s.
+// 4) 2 * kShardCount threads each add 1000 to kBytesRead.
+//
+// Modules which testing depends on: none.
+//
+// Other modules whose testing depends on this module:
+// 1) FcgiServerInterface metrics checks.
+TEST(FcgiMetrics, CountersRecordsAndHistograms)
+{
+  using Snap = FcgiMetrics::MetricsSnapshot;
+
+  // Case 1
+  {
+    Snap before {FcgiMetrics::Snapshot()};
+    FcgiMetrics::Add(FcgiCounter::kConnectionsAccepted);
+    FcgiMetrics::Add(FcgiCounter::kBytesWritten, 4096U);
+    FcgiMetrics::Add(FcgiCounter::kBytesWritten, 4U);
+    Snap after {FcgiMetrics::Snapshot()};
+    EXPECT_EQ(after.counter(FcgiCounter::kConnectionsAccepted) -
+      before.counter(FcgiCounter::kConnectionsAccepted), 1U);
+    EXPECT_EQ(after.counter(FcgiCounter::kBytesWritten) -
+      before.counter(FcgiCounter::kBytesWritten), 4100U);
+    EXPECT_EQ(after.counter(FcgiCounter::kBytesRead),
+      before.counter(FcgiCounter::kBytesRead));
+    EXPECT_EQ(after.counter(FcgiCounter::kSelfPipeWakeups),
+      before.counter(FcgiCounter::kSelfPipeWakeups));
+  }
+
+  // Case 2
+  {
+    Snap before {FcgiMetrics::Snapshot()};
+    FcgiMetrics::CountRecord(FcgiType::kFCGI_PARAMS);
+    FcgiMetrics::CountRecord(FcgiType::kFCGI_PARAMS);
+    FcgiMetrics::CountRecord(FcgiType::kFCGI_STDIN);
+    FcgiMetrics::CountRecord(static_cast<FcgiType>(200U));
+    Snap after {FcgiMetrics::Snapshot()};
+    EXPECT_EQ(after.records_parsed(FcgiType::kFCGI_PARAMS) -
+      before.records_parsed(FcgiType::kFCGI_PARAMS), 2U);
+    EXPECT_EQ(after.records_parsed(FcgiType::kFCGI_STDIN) -
+      before.records_parsed(FcgiType::kFCGI_STDIN), 1U);
+    EXPECT_EQ(after.records_parsed_by_type[0] -
+      before.records_parsed_by_type[0], 1U);
+    EXPECT_EQ(after.records_parsed(static_cast<FcgiType>(200U)) -
+      before.records_parsed(static_cast<FcgiType>(200U)), 1U);
+    EXPECT_EQ(after.records_parsed(FcgiType::kFCGI_DATA),
+      before.records_parsed(FcgiType::kFCGI_DATA));
+  }
+
+  // Case 3
+  {
+    using std::chrono::nanoseconds;
+    constexpr FcgiHistogram h {FcgiHistogram::kFcgiRequestToComplete};
+    constexpr std::size_t last {FcgiMetrics::kBucketCount - 1U};
+    Snap before {FcgiMetrics::Snapshot()};
+    FcgiMetrics::Record(h, nanoseconds {-5});
+    FcgiMetrics::Record(h, nanoseconds {0});
+    FcgiMetrics::Record(h, nanoseconds {1});
+    FcgiMetrics::Record(h, nanoseconds {2});
+    FcgiMetrics::Record(h, nanoseconds {3});
+    FcgiMetrics::Record(h, nanoseconds {1024});
+    FcgiMetrics::Record(h, std::chrono::seconds {1000});
+    Snap after {FcgiMetrics::Snapshot()};
+    const FcgiMetrics::HistogramSnapshot& b {before.histogram(h)};
+    const FcgiMetrics::HistogramSnapshot& a {after.histogram(h)};
+    EXPECT_EQ(a.count - b.count, 7U);
+    EXPECT_EQ(a.sum_nanoseconds - b.sum_nanoseconds,
+      1U + 2U + 3U + 1024U + 1000000000000U);
+    EXPECT_EQ(a.buckets[0] - b.buckets[0], 3U);
+    EXPECT_EQ(a.buckets[1] - b.buckets[1], 2U);
+    EXPECT_EQ(a.buckets[2] - b.buckets[2], 0U);
+    EXPECT_EQ(a.buckets[10] - b.buckets[10], 1U);
+    EXPECT_EQ(a.buckets[last] - b.buckets[last], 1U);
+    const FcgiMetrics::HistogramSnapshot& other_b
+      {before.histogram(FcgiHistogram::kBeginRequestToFcgiRequest)};
+    const FcgiMetrics::HistogramSnapshot& other_a
+      {after.histogram(FcgiHistogram::kBeginRequestToFcgiRequest)};
+    EXPECT_EQ(other_a.count, other_b.count);
+  }
+
+  // Case 4
+  {
+    constexpr int kThreadCount {2 * static_cast<int>(FcgiMetrics::kShardCount)};
+    constexpr int kAdditionCount {1000};
+    Snap before {FcgiMetrics::Snapshot()};
+    std::vector<std::thread> threads {};
+    for(int i {0}; i < kThreadCount; ++i)
+    {
+      threads.emplace_back([]()->void
+      {
+        for(int j {0}; j < kAdditionCount; ++j)
+          FcgiMetrics::Add(FcgiCounter::kBytesRead);
+      });
+    }
+    for(std::thread& t : threads)
+      t.join();
+    Snap after {FcgiMetrics::Snapshot()};
+    EXPECT_EQ(after.counter(FcgiCounter::kBytesRead) -
+      before.counter(FcgiCounter::kBytesRead),
+      static_cast<std::uint64_t>(kThreadCount) * kAdditionCount);
+  }
+}
+
+} // namespace test
+} // namespace fcgi
+} // namespace as_components
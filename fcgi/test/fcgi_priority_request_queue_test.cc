@@ -0,0 +1,314 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "fcgi/include/fcgi_priority_request_queue.h"
+#include "fcgi/include/fcgi_request.h"
+#include "fcgi/include/fcgi_weighted_round_robin.h"
+
+namespace as_components {
+namespace fcgi {
+namespace test {
+
+namespace {
+
+// Performs count selections for levels which hold (*sizes_ptr)[i] items. A
+// level is ready while it holds an item. An item is removed from the chosen
+// level, and Idle is called for a level which became empty, as
+// PriorityRequestQueue does.
+std::vector<std::size_t> Select(WeightedRoundRobin* wrr_ptr,
+  std::vector<std::size_t>* sizes_ptr, std::size_t count)
+{
+  std::vector<std::size_t> result {};
+  for(std::size_t i {0U}; i < count; ++i)
+  {
+    std::size_t level {wrr_ptr->Select([sizes_ptr](std::size_t l)->bool
+      {
+        return (*sizes_ptr)[l] > 0U;
+      }
+    )};
+    result.push_back(level);
+    if(level == wrr_ptr->level_count())
+      continue;
+    if(--(*sizes_ptr)[level] == 0U)
+      wrr_ptr->Idle(level);
+  }
+  return result;
+}
+
+constexpr std::size_t kAlwaysReady {std::numeric_limits<std::size_t>::max()};
+
+} // namespace
+
+// WeightedRoundRobin
+// Examined properties:
+// 1) The order of selections while every level is ready, including the
+//    spreading of the selections of a level and ties between levels of equal
+//    credit, which are won by the lower level.
+// 2) For several sets of weights, every run of a sum of weights consecutive
+//    selections selects each level a number of times which is equal to its
+//    weight.
+// 3) A level of low weight is not starved by a level of high weight.
+// 4) Construction errors for empty weights and for a weight of zero.
+//
+// Test cases:
+// 1) Weights {3, 1}, {1, 1, 1}, {2, 2}, and {5, 1, 1}. The sequences of
+//    selections are compared with the expected sequences.
+// 2) Weights {1}, {2, 1}, {4, 2, 1}, {1, 7}, and {10, 1, 3}. Two runs of a
+//    sum of weights selections are counted.
+// 3) Weights {100, 1}. 101 selections.
+// 4) Weights {} and {1, 0}.
+//
+// Modules which testing depends on: none.
+//
+// Other modules whose testing depends on this module:
+// 1) PriorityRequestQueue
+TEST(WeightedRoundRobin, SelectionOrder)
+{
+  // Case 1
+  struct OrderCase
+  {
+    std::vector<unsigned int> weights;
+    std::vector<std::size_t>  expected;
+  };
+  const std::vector<OrderCase> order_cases
+  {
+    {{3U, 1U},      {0U, 0U, 1U, 0U, 0U, 0U, 1U, 0U}},
+    {{1U, 1U, 1U},  {0U, 1U, 2U, 0U, 1U, 2U}},
+    {{2U, 2U},      {0U, 1U, 0U, 1U}},
+    {{5U, 1U, 1U},  {0U, 0U, 1U, 0U, 2U, 0U, 0U, 0U, 0U, 1U, 0U, 2U, 0U,
+                     0U}}
+  };
+  for(const OrderCase& order_case : order_cases)
+  {
+    WeightedRoundRobin wrr {order_case.weights};
+    std::vector<std::size_t> sizes(order_case.weights.size(), kAlwaysReady);
+    EXPECT_EQ(Select(&wrr, &sizes, order_case.expected.size()),
+      order_case.expected);
+  }
+
+  // Case 2
+  const std::vector<std::vector<unsigned int>> weight_cases
+    {{1U}, {2U, 1U}, {4U, 2U, 1U}, {1U, 7U}, {10U, 1U, 3U}};
+  for(const std::vector<unsigned int>& weights : weight_cases)
+  {
+    WeightedRoundRobin wrr {weights};
+    EXPECT_EQ(wrr.level_count(), weights.size());
+    std::vector<std::size_t> sizes(weights.size(), kAlwaysReady);
+    std::size_t weight_sum {0U};
+    for(unsigned int weight : weights)
+      weight_sum += weight;
+    for(int run {0}; run < 2; ++run)
+    {
+      std::vector<std::size_t> counts(weights.size(), 0U);
+      for(std::size_t level : Select(&wrr, &sizes, weight_sum))
+      {
+        ASSERT_LT(level, weights.size());
+        ++counts[level];
+      }
+      for(std::size_t i {0U}; i < weights.size(); ++i)
+        EXPECT_EQ(counts[i], weights[i]) << "Level: " << i << " Run: " << run;
+    }
+  }
+
+  // Case 3
+  {
+    WeightedRoundRobin wrr {{100U, 1U}};
+    std::vector<std::size_t> sizes(2U, kAlwaysReady);
+    std::size_t low_count {0U};
+    for(std::size_t level : Select(&wrr, &sizes, 101U))
+      low_count += (level == 1U);
+    EXPECT_EQ(low_count, 1U);
+  }
+
+  // Case 4
+  EXPECT_THROW(WeightedRoundRobin {std::vector<unsigned int> {}},
+    std::invalid_argument);
+  EXPECT_THROW((WeightedRoundRobin {{1U, 0U}}), std::invalid_argument);
+}
+
+// WeightedRoundRobin
+// Examined properties:
+// 1) Changes of the set of ready levels, which change the share of each
+//    level:
+//    a) A level which is the only ready level is selected every time and
+//       accumulates neither credit nor debt.
+//    b) A level which became ready is selected as if the selections had
+//       started when it became ready.
+//    c) After Idle, a level which was emptied by its selection and becomes
+//       ready again is not delayed by the debt of that selection.
+// 2) The level count is returned when no level is ready.
+//
+// Test cases:
+// 1) Weights {3, 1}. Only level 1 is ready for three selections. Level 0
+//    then becomes ready.
+// 2) Weights {2, 1}. Level 0 holds one item and level 1 is always ready.
+//    Level 0 is emptied by the first selection and is then refilled.
+// 3) Weights {1, 1}. No level is ready.
+//
+// Modules which testing depends on: none.
+//
+// Other modules whose testing depends on this module:
+// 1) PriorityRequestQueue
+TEST(WeightedRoundRobin, ReadyLevelChanges)
+{
+  // Case 1
+  {
+    WeightedRoundRobin wrr {{3U, 1U}};
+    std::vector<std::size_t> sizes {0U, kAlwaysReady};
+    EXPECT_EQ(Select(&wrr, &sizes, 3U),
+      (std::vector<std::size_t> {1U, 1U, 1U}));
+    sizes[0] = kAlwaysReady;
+    EXPECT_EQ(Select(&wrr, &sizes, 4U),
+      (std::vector<std::size_t> {0U, 0U, 1U, 0U}));
+  }
+
+  // Case 2
+  {
+    WeightedRoundRobin wrr {{2U, 1U}};
+    std::vector<std::size_t> sizes {1U, kAlwaysReady};
+    EXPECT_EQ(Select(&wrr, &sizes, 1U), (std::vector<std::size_t> {0U}));
+    EXPECT_EQ(sizes[0], 0U);
+    sizes[0] = 5U;
+    // Without Idle, level 0 would carry a debt of 1 and level 1 would be
+    // selected first.
+    EXPECT_EQ(Select(&wrr, &sizes, 6U),
+      (std::vector<std::size_t> {0U, 1U, 0U, 0U, 1U, 0U}));
+  }
+
+  // Case 3
+  {
+    WeightedRoundRobin wrr {{1U, 1U}};
+    std::vector<std::size_t> sizes {0U, 0U};
+    EXPECT_EQ(Select(&wrr, &sizes, 2U),
+      (std::vector<std::size_t> {2U, 2U}));
+  }
+}
+
+// PriorityRequestQueue
+//    The dispatch order of levels is examined by the tests of
+// WeightedRoundRobin. The requests of this test are default-constructed and
+// have a priority of zero.
+//
+// Examined properties:
+// 1) Push of a single request and of a vector of requests. The vector is
+//    emptied.
+// 2) TryPop returns false without blocking when the queue is empty.
+// 3) Pop blocks until a request is pushed by another thread.
+// 4) After Close, Push throws std::logic_error, the requests in the queue
+//    remain available, and Pop returns false once the queue is empty. Close
+//    wakes a thread which is blocked in Pop.
+// 5) Construction errors for empty weights and for a weight of zero.
+//
+// Test cases:
+// 1) Weights {2, 1}. One request and then three requests are pushed and
+//    popped with TryPop.
+// 2) A thread blocks in Pop. The main thread pushes a request.
+// 3) Two requests are pushed and the queue is closed.
+// 4) A thread blocks in Pop on an empty queue which is then closed.
+// 5) Weights {} and {1, 0}.
+//
+// Modules which testing depends on:
+// 1) WeightedRoundRobin
+//
+// Other modules whose testing depends on this module: none.
+TEST(PriorityRequestQueue, PushPopAndClose)
+{
+  // Case 1
+  {
+    PriorityRequestQueue queue {{2U, 1U}};
+    EXPECT_EQ(queue.level_count(), 2U);
+    FcgiRequest request {};
+    EXPECT_FALSE(queue.TryPop(&request));
+    queue.Push(FcgiRequest {});
+    EXPECT_EQ(queue.size(), 1U);
+    std::vector<FcgiRequest> requests(3U);
+    queue.Push(std::move(requests));
+    EXPECT_TRUE(requests.empty());
+    EXPECT_EQ(queue.size(), 4U);
+    for(int i {0}; i < 4; ++i)
+      EXPECT_TRUE(queue.TryPop(&request));
+    EXPECT_FALSE(queue.TryPop(&request));
+    EXPECT_EQ(queue.size(), 0U);
+  }
+
+  // Case 2
+  {
+    PriorityRequestQueue queue {{1U}};
+    bool popped {false};
+    std::thread worker {[&queue, &popped]()->void
+      {
+        FcgiRequest request {};
+        popped = queue.Pop(&request);
+      }
+    };
+    queue.Push(FcgiRequest {});
+    worker.join();
+    EXPECT_TRUE(popped);
+    EXPECT_EQ(queue.size(), 0U);
+  }
+
+  // Case 3
+  {
+    PriorityRequestQueue queue {{1U, 1U}};
+    queue.Push(std::vector<FcgiRequest>(2U));
+    queue.Close();
+    EXPECT_THROW(queue.Push(FcgiRequest {}), std::logic_error);
+    EXPECT_THROW(queue.Push(std::vector<FcgiRequest>(1U)), std::logic_error);
+    FcgiRequest request {};
+    EXPECT_TRUE(queue.Pop(&request));
+    EXPECT_TRUE(queue.Pop(&request));
+    EXPECT_FALSE(queue.Pop(&request));
+  }
+
+  // Case 4
+  {
+    PriorityRequestQueue queue {{1U}};
+    bool popped {true};
+    std::thread worker {[&queue, &popped]()->void
+      {
+        FcgiRequest request {};
+        popped = queue.Pop(&request);
+      }
+    };
+    queue.Close();
+    worker.join();
+    EXPECT_FALSE(popped);
+  }
+
+  // Case 5
+  EXPECT_THROW(PriorityRequestQueue {std::vector<unsigned int> {}},
+    std::invalid_argument);
+  EXPECT_THROW((PriorityRequestQueue {{1U, 0U}}), std::invalid_argument);
+}
+
+} // namespace test
+} // namespace fcgi
+} // namespace as_components
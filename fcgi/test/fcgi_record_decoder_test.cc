@@ -0,0 +1,275 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "fcgi/include/fcgi_protocol_constants.h"
+#include "fcgi/include/fcgi_record_decoder.h"
+
+namespace as_components {
+namespace fcgi {
+namespace test {
+
+namespace {
+
+// Records the events of a decoder. Content is concatenated per record.
+struct RecordingHandler
+{
+  struct Record
+  {
+    FcgiRecordDecoder::Header header;
+    std::vector<std::uint8_t> content;
+    bool                      ended;
+  };
+
+  void OnHeader(const FcgiRecordDecoder::Header& header)
+  {
+    records.push_back({header, {}, false});
+  }
+
+  void OnContent(const std::uint8_t* begin, const std::uint8_t* end)
+  {
+    EXPECT_NE(begin, end);
+    ++content_calls;
+    records.back().content.insert(records.back().content.end(), begin, end);
+  }
+
+  void OnRecordEnd()
+  {
+    records.back().ended = true;
+  }
+
+  std::vector<Record> records {};
+  int                 content_calls {0};
+};
+
+// Appends a record with the given type, identifier, content, and padding
+// length to stream.
+void AppendRecord(std::vector<std::uint8_t>* stream, FcgiType type,
+  std::uint16_t fcgi_id, const std::vector<std::uint8_t>& content,
+  std::uint8_t padding_length)
+{
+  stream->push_back(FCGI_VERSION_1);
+  stream->push_back(static_cast<std::uint8_t>(type));
+  stream->push_back(static_cast<std::uint8_t>(fcgi_id >> 8U));
+  stream->push_back(static_cast<std::uint8_t>(fcgi_id));
+  stream->push_back(static_cast<std::uint8_t>(content.size() >> 8U));
+  stream->push_back(static_cast<std::uint8_t>(content.size()));
+  stream->push_back(padding_length);
+  stream->push_back(0U);
+  stream->insert(stream->end(), content.begin(), content.end());
+  stream->insert(stream->end(), padding_length, 0xFFU);
+}
+
+} // namespace
+
+// FcgiRecordDecoder
+// Examined properties:
+// 1) Header values are decoded. Content is reported without padding. The end
+//    of a record is reported after its padding.
+// 2) Records without content or padding, with content only, with padding
+//    only, and with both are decoded.
+// 3) The events which are reported do not depend on how the stream is split
+//    into spans. AtRecordBoundary is only true between records.
+// 4) An exception of a handler is propagated, and the bytes which were
+//    reported before the throw are not reported again.
+// 5) Reset discards a partial record.
+// 6) ContentRemaining reports the unconsumed content of the current record.
+//    Content which is consumed with ConsumeContent is not reported, and the
+//    end of the record is reported as for Decode.
+//
+// Test cases:
+// 1) A stream of four records: an empty FCGI_PARAMS record, an FCGI_STDIN
+//    record with 300 bytes of content, an FCGI_DATA record with 5 bytes of
+//    padding, and an FCGI_BEGIN_REQUEST record with 8 bytes of content and 3
+//    bytes of padding. The stream is decoded:
+//    a) In one span.
+//    b) One byte at a time.
+//    c) In spans of 7 bytes, which split every header.
+// 2) The handler throws from OnContent. Decoding continues with the
+//    remaining bytes.
+// 3) A partial header and partial content are discarded by Reset.
+// 4) The content of the FCGI_STDIN record is consumed with ConsumeContent in
+//    parts of 100 and 200 bytes. The content of the FCGI_BEGIN_REQUEST record
+//    is consumed in full, and the end of the record is reported when its
+//    padding is decoded.
+//
+// Modules which testing depends on: none.
+//
+// Other modules whose testing depends on this module:
+// 1) FcgiServerInterface
+// 2) TestFcgiClientInterface
+TEST(FcgiRecordDecoder, Decoding)
+{
+  std::vector<std::uint8_t> stdin_content(300U);
+  for(std::size_t i {0U}; i < stdin_content.size(); ++i)
+    stdin_content[i] = static_cast<std::uint8_t>(i);
+  std::vector<std::uint8_t> begin_content {0U, 1U, 1U, 0U, 0U, 0U, 0U, 0U};
+  std::vector<std::uint8_t> stream {};
+  AppendRecord(&stream, FcgiType::kFCGI_PARAMS, 1U, {}, 0U);
+  AppendRecord(&stream, FcgiType::kFCGI_STDIN, 258U, stdin_content, 0U);
+  AppendRecord(&stream, FcgiType::kFCGI_DATA, 1U, {}, 5U);
+  AppendRecord(&stream, FcgiType::kFCGI_BEGIN_REQUEST, 2U, begin_content, 3U);
+
+  // The offsets in stream of the ends of the records.
+  const std::size_t record_ends[4] = {8U, 316U, 329U, 348U};
+  ASSERT_EQ(stream.size(), record_ends[3]);
+
+  auto CheckRecords = [&](const RecordingHandler& handler)->void
+  {
+    ASSERT_EQ(handler.records.size(), 4U);
+    const std::vector<RecordingHandler::Record>& r {handler.records};
+    for(const RecordingHandler::Record& record : r)
+    {
+      EXPECT_EQ(record.header.version, FCGI_VERSION_1);
+      EXPECT_TRUE(record.ended);
+    }
+    EXPECT_EQ(r[0].header.type, FcgiType::kFCGI_PARAMS);
+    EXPECT_EQ(r[0].header.fcgi_id, 1U);
+    EXPECT_EQ(r[0].header.content_length, 0U);
+    EXPECT_EQ(r[0].content.size(), 0U);
+    EXPECT_EQ(r[1].header.type, FcgiType::kFCGI_STDIN);
+    EXPECT_EQ(r[1].header.fcgi_id, 258U);
+    EXPECT_EQ(r[1].header.content_length, 300U);
+    EXPECT_EQ(r[1].content, stdin_content);
+    EXPECT_EQ(r[2].header.type, FcgiType::kFCGI_DATA);
+    EXPECT_EQ(r[2].header.padding_length, 5U);
+    EXPECT_EQ(r[2].content.size(), 0U);
+    EXPECT_EQ(r[3].header.type, FcgiType::kFCGI_BEGIN_REQUEST);
+    EXPECT_EQ(r[3].header.fcgi_id, 2U);
+    EXPECT_EQ(r[3].header.content_length, 8U);
+    EXPECT_EQ(r[3].header.padding_length, 3U);
+    EXPECT_EQ(r[3].content, begin_content);
+  };
+
+  // Case 1
+  for(std::size_t span : {stream.size(), std::size_t {1U}, std::size_t {7U}})
+  {
+    FcgiRecordDecoder decoder {};
+    RecordingHandler handler {};
+    EXPECT_TRUE(decoder.AtRecordBoundary());
+    std::size_t boundary_count {0U};
+    for(std::size_t i {0U}; i < stream.size(); i += span)
+    {
+      std::size_t end {((i + span) < stream.size()) ? (i + span) :
+        stream.size()};
+      decoder.Decode(stream.data() + i, stream.data() + end, &handler);
+      bool between_records {false};
+      for(std::size_t offset : record_ends)
+        between_records = between_records || (end == offset);
+      EXPECT_EQ(decoder.AtRecordBoundary(), between_records) << span;
+      boundary_count += between_records;
+    }
+    EXPECT_TRUE(decoder.AtRecordBoundary());
+    CheckRecords(handler);
+    if(span == 1U)
+    {
+      EXPECT_EQ(handler.content_calls, 308);
+      EXPECT_EQ(boundary_count, 4U);
+    }
+  }
+
+  // Case 2
+  {
+    struct ThrowingHandler : public RecordingHandler
+    {
+      void OnContent(const std::uint8_t* begin, const std::uint8_t* end)
+      {
+        RecordingHandler::OnContent(begin, end);
+        if(throw_on_content)
+        {
+          throw_on_content = false;
+          throw std::runtime_error {"OnContent"};
+        }
+      }
+
+      bool throw_on_content {true};
+    };
+    FcgiRecordDecoder decoder {};
+    ThrowingHandler handler {};
+    // The content of the FCGI_STDIN record is split after 100 bytes.
+    std::size_t split {2U * FCGI_HEADER_LEN + 100U};
+    EXPECT_THROW(decoder.Decode(stream.data(), stream.data() + split,
+      &handler), std::runtime_error);
+    decoder.Decode(stream.data() + split, stream.data() + stream.size(),
+      &handler);
+    CheckRecords(handler);
+  }
+
+  // Case 3
+  {
+    FcgiRecordDecoder decoder {};
+    RecordingHandler handler {};
+    decoder.Decode(stream.data() + FCGI_HEADER_LEN,
+      stream.data() + FCGI_HEADER_LEN + 3, &handler);
+    EXPECT_FALSE(decoder.AtRecordBoundary());
+    decoder.Reset();
+    EXPECT_TRUE(decoder.AtRecordBoundary());
+    decoder.Decode(stream.data() + FCGI_HEADER_LEN,
+      stream.data() + 2 * FCGI_HEADER_LEN + 10, &handler);
+    EXPECT_FALSE(decoder.AtRecordBoundary());
+    decoder.Reset();
+    handler.records.clear();
+    decoder.Decode(stream.data(), stream.data() + stream.size(), &handler);
+    CheckRecords(handler);
+  }
+
+  // Case 4
+  {
+    FcgiRecordDecoder decoder {};
+    RecordingHandler handler {};
+    EXPECT_EQ(decoder.ContentRemaining(), 0U);
+    decoder.Decode(stream.data(), stream.data() + 2 * FCGI_HEADER_LEN,
+      &handler);
+    EXPECT_EQ(decoder.ContentRemaining(), 300U);
+    decoder.ConsumeContent(100U, &handler);
+    EXPECT_EQ(decoder.ContentRemaining(), 200U);
+    EXPECT_FALSE(handler.records.back().ended);
+    decoder.ConsumeContent(200U, &handler);
+    EXPECT_EQ(decoder.ContentRemaining(), 0U);
+    EXPECT_TRUE(decoder.AtRecordBoundary());
+    std::size_t begin_header {record_ends[2]};
+    decoder.Decode(stream.data() + record_ends[1],
+      stream.data() + begin_header + FCGI_HEADER_LEN, &handler);
+    EXPECT_EQ(decoder.ContentRemaining(), 8U);
+    decoder.ConsumeContent(8U, &handler);
+    EXPECT_FALSE(handler.records.back().ended);
+    EXPECT_FALSE(decoder.AtRecordBoundary());
+    decoder.Decode(stream.data() + begin_header + FCGI_HEADER_LEN + 8U,
+      stream.data() + stream.size(), &handler);
+    EXPECT_TRUE(decoder.AtRecordBoundary());
+    ASSERT_EQ(handler.records.size(), 4U);
+    for(const RecordingHandler::Record& record : handler.records)
+      EXPECT_TRUE(record.ended);
+    EXPECT_EQ(handler.records[1].content.size(), 0U);
+    EXPECT_EQ(handler.records[3].content.size(), 0U);
+    EXPECT_EQ(handler.content_calls, 0);
+  }
+}
+
+} // namespace test
+} // namespace fcgi
+} // namespace as_components
@@ -0,0 +1,126 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "fcgi/include/fcgi_request_identifier.h"
+#include "fcgi/include/fcgi_request_trace.h"
+
+namespace as_components {
+namespace fcgi {
+namespace test {
+
+// FcgiTracing
+// Examined properties:
+// 1) The enabled flag follows Enable and Disable.
+// 2) Sampling: one of every sample_period submitted traces is kept. A
+//    sample_period of zero keeps no traces.
+// 3) Ring behavior: the oldest trace is overwritten when a ring is full.
+//    Dump returns the traces of a ring in submission order and empties the
+//    rings.
+// 4) The traces of a thread which exited are returned by Dump.
+// 5) Enable throws std::invalid_argument for a ring capacity of zero.
+//
+// Test cases:
+// 1) sample_period == 1, ring_capacity == 3, five traces are submitted.
+// 2) sample_period == 2, four traces are submitted.
+// 3) sample_period == 0, two traces are submitted.
+// 4) A thread submits two traces and exits before Dump is called.
+// 5) Enable(1U, 0U).
+//
+// Modules which testing depends on: none.
+//
+// Other modules whose testing depends on this module:
+// 1) FcgiServerInterface request tracing.
+TEST(FcgiTracing, SamplingAndRings)
+{
+  // Traces are distinguished by the FastCGI identifier of request_id.
+  auto Trace = [](std::uint16_t id)->FcgiRequestTrace
+  {
+    FcgiRequestTrace trace {};
+    trace.request_id = FcgiRequestIdentifier {1, id};
+    trace.Mark(FcgiTracePoint::kCompleteWritten);
+    return trace;
+  };
+  auto Ids = [](const std::vector<FcgiRequestTrace>& traces)
+    ->std::vector<std::uint16_t>
+  {
+    std::vector<std::uint16_t> ids {};
+    for(const FcgiRequestTrace& trace : traces)
+      ids.push_back(trace.request_id.Fcgi_id());
+    return ids;
+  };
+
+  EXPECT_FALSE(FcgiTracing::enabled());
+  FcgiTracing::Dump();
+
+  // Case 1
+  FcgiTracing::Enable(1U, 3U);
+  EXPECT_TRUE(FcgiTracing::enabled());
+  for(std::uint16_t id {1U}; id <= 5U; ++id)
+    FcgiTracing::Submit(Trace(id));
+  std::vector<FcgiRequestTrace> traces {FcgiTracing::Dump()};
+  EXPECT_EQ(Ids(traces), (std::vector<std::uint16_t> {3U, 4U, 5U}));
+  if(traces.size())
+  {
+    EXPECT_TRUE(traces[0].reached(FcgiTracePoint::kCompleteWritten));
+    EXPECT_FALSE(traces[0].reached(FcgiTracePoint::kFirstWrite));
+  }
+  EXPECT_EQ(FcgiTracing::Dump().size(), 0U);
+
+  // Case 2
+  FcgiTracing::Enable(2U, 3U);
+  for(std::uint16_t id {1U}; id <= 4U; ++id)
+    FcgiTracing::Submit(Trace(id));
+  EXPECT_EQ(FcgiTracing::Dump().size(), 2U);
+
+  // Case 3
+  FcgiTracing::Enable(0U, 3U);
+  FcgiTracing::Submit(Trace(1U));
+  FcgiTracing::Submit(Trace(2U));
+  EXPECT_EQ(FcgiTracing::Dump().size(), 0U);
+
+  // Case 4
+  FcgiTracing::Enable(1U, 3U);
+  std::thread submitter {[&]()->void
+  {
+    FcgiTracing::Submit(Trace(7U));
+    FcgiTracing::Submit(Trace(8U));
+  }};
+  submitter.join();
+  EXPECT_EQ(Ids(FcgiTracing::Dump()), (std::vector<std::uint16_t> {7U, 8U}));
+
+  // Case 5
+  EXPECT_THROW(FcgiTracing::Enable(1U, 0U), std::invalid_argument);
+
+  FcgiTracing::Disable();
+  EXPECT_FALSE(FcgiTracing::enabled());
+}
+
+} // namespace test
+} // namespace fcgi
+} // namespace as_components
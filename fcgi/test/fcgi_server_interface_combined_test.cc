@@ -65,6 +65,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
@@ -75,14 +76,21 @@
 #include <stdexcept>
 #include <string>
 #include <system_error>
+#include <thread>
 #include <tuple>
 #include <vector>
 
 #include "googletest/include/gtest/gtest.h"
 
+#include "fcgi/include/fcgi_admission_controller.h"
+#include "fcgi/include/fcgi_metrics.h"
+#include "fcgi/include/fcgi_priority_request_queue.h"
 #include "fcgi/include/fcgi_protocol_constants.h"
 #include "fcgi/include/fcgi_request.h"
+#include "fcgi/include/fcgi_request_trace.h"
+#include "fcgi/include/fcgi_response_reactor.h"
 #include "fcgi/include/fcgi_server_interface.h"
+#include "fcgi/include/fcgi_well_known_params.h"
 #include "fcgi/test/include/fcgi_si_testing_utilities.h"
 #include "socket_functions/include/socket_functions.h"
 #include "testing/include/as_components_testing_utilities.h"
@@ -1681,6 +1689,9 @@ void ConnectionAcceptanceAndRejectionTest::RunTest()
 // 7) FCGI_WEB_SERVER_ADDRS contains the IPv6 loopback address fd00::1.
 //    A client with IPv6 loopback address ::1 tries to make a connection
 //    and it fails.
+// 8) FCGI_WEB_SERVER_ADDRS contains the IPv4 prefix 127.0.0.0/31 and a
+//    malformed prefix. As in case 6, a client with address 127.0.0.1
+//    succeeds and a client with address 127.0.0.2 fails.
 //
 // Modules which testing depends on:
 // 1) as_components::socket_functions::SocketRead
@@ -1869,6 +1880,37 @@ TEST(FcgiServerInterface, ConnectionAcceptanceAndRejection)
         "to setenv in case 7." << '\n' << std::strerror(errno);
   }
 
+  // 8) FCGI_WEB_SERVER_ADDRS contains the IPv4 prefix 127.0.0.0/31 and a
+  //    malformed prefix. A client with address 127.0.0.1 attempts to make a
+  //    connection and it succeeds. A client with address 127.0.0.2 attempts
+  //    to make a connection and it fails.
+  {
+    if(setenv("FCGI_WEB_SERVER_ADDRS", "127.0.0.0/33,127.0.0.0/31", 1) != -1)
+    {
+      struct ConnectionAcceptanceAndRejectionTestArguments args {};
+      args.inter_args.domain          = AF_INET;
+      args.inter_args.max_connections = 5;
+      args.inter_args.max_requests    = 10;
+      args.inter_args.app_status      = EXIT_FAILURE;
+      args.inter_args.unix_path       = path;
+
+      args.initial_connections        = 1;
+      args.overload_after             = 5; // No overload.
+      args.expected_status            = std::vector<std::uint8_t> {1,0};
+      args.test_case                  = 8;
+
+      ConnectionAcceptanceAndRejectionTest test {std::move(args)};
+      test.RunTest();
+
+      if(setenv("FCGI_WEB_SERVER_ADDRS", "", 1) == -1)
+        ADD_FAILURE() << "The environment could not be restored by a call to "
+          "setenv in case 8." << '\n' << std::strerror(errno);
+    }
+    else
+      ADD_FAILURE() << "The environment could not be modified with by a call "
+        "to setenv in case 8." << '\n' << std::strerror(errno);
+  }
+
   testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
     "ConnectionAcceptanceAndRejection", __LINE__);
 
@@ -1877,6 +1919,2590 @@ TEST(FcgiServerInterface, ConnectionAcceptanceAndRejection)
     __LINE__));
 }
 
+// AcceptBatchLimitAndCounters
+//    This test examines the bound on the number of connections which are
+// handled in a single call to AcceptRequests and the connection acceptance
+// counters of the interface.
+//
+// Examined properties:
+// 1) At most FcgiServerInterface::kAcceptBatchLimit connections are accepted
+//    in a call to AcceptRequests. Connections which remain pending are
+//    accepted in a later call.
+// 2) The values of the counters returned by connection_acceptance_counters:
+//    accepted, rejected_for_load, accept_batches, and
+//    accept_batch_limit_reached.
+// 3) Accepted connections are non-blocking and close-on-exec.
+//
+// Test cases: An AF_UNIX interface with a maximum connection count which is
+// larger than the number of connections which are made.
+// 1) kAcceptBatchLimit + 6 connections are made before AcceptRequests is
+//    called. The first call accepts kAcceptBatchLimit connections. The second
+//    call accepts the remaining connections.
+// 2) The interface is overloaded and two additional connections are made.
+//    Both are rejected.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, AcceptBatchLimitAndCounters)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+  constexpr const char*const path {"/tmp/fcgi_si_test_UNIX_interface_socket"};
+  constexpr int kBatchLimit {FcgiServerInterface::kAcceptBatchLimit};
+  constexpr int kInitialConnections {kBatchLimit + 6};
+
+  struct InterfaceCreationArguments inter_args {};
+  inter_args.domain          = AF_UNIX;
+  inter_args.backlog         = 2 * kBatchLimit;
+  inter_args.max_connections = 2 * kBatchLimit;
+  inter_args.max_requests    = 1;
+  inter_args.app_status      = EXIT_FAILURE;
+  inter_args.unix_path       = path;
+
+  GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+  FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+  ASSERT_NE(inter_ptr, nullptr);
+
+  std::vector<int> client_descriptors {};
+  auto Connect = [&](int count)->void
+  {
+    for(int i {0}; i < count; ++i)
+    {
+      int client {inter.Connect()};
+      ASSERT_NE(client, -1);
+      client_descriptors.push_back(client);
+    }
+  };
+
+  FcgiServerInterface::ConnectionAcceptanceCounters counters
+    {inter_ptr->connection_acceptance_counters()};
+  EXPECT_EQ(counters.accepted, 0U);
+  EXPECT_EQ(counters.accept_batches, 0U);
+
+  // Case 1
+  Connect(kInitialConnections);
+  if(!::testing::Test::HasFatalFailure())
+  {
+    inter.AcceptRequests();
+    EXPECT_EQ(inter_ptr->connection_count(),
+      static_cast<std::size_t>(kBatchLimit));
+    counters = inter_ptr->connection_acceptance_counters();
+    EXPECT_EQ(counters.accepted, static_cast<std::uint64_t>(kBatchLimit));
+    EXPECT_EQ(counters.accept_batches, 1U);
+    EXPECT_EQ(counters.accept_batch_limit_reached, 1U);
+
+    inter.AcceptRequests();
+    EXPECT_EQ(inter_ptr->connection_count(),
+      static_cast<std::size_t>(kInitialConnections));
+    counters = inter_ptr->connection_acceptance_counters();
+    EXPECT_EQ(counters.accepted,
+      static_cast<std::uint64_t>(kInitialConnections));
+    EXPECT_EQ(counters.accept_batches, 2U);
+    EXPECT_EQ(counters.accept_batch_limit_reached, 1U);
+    EXPECT_EQ(counters.rejected_for_load, 0U);
+    EXPECT_EQ(counters.rejected_for_address, 0U);
+
+    // The descriptors of accepted connections are the lowest available
+    // descriptors which are greater than the descriptor of the last client.
+    // Each should be non-blocking and close-on-exec.
+    int last_client {client_descriptors.back()};
+    for(int i {1}; i <= kInitialConnections; ++i)
+    {
+      int status_flags {fcntl(last_client + i, F_GETFL)};
+      int descriptor_flags {fcntl(last_client + i, F_GETFD)};
+      if((status_flags == -1) || (descriptor_flags == -1))
+        continue;
+      EXPECT_TRUE(status_flags & O_NONBLOCK) << last_client + i;
+      EXPECT_TRUE(descriptor_flags & FD_CLOEXEC) << last_client + i;
+    }
+  }
+
+  // Case 2
+  if(!::testing::Test::HasFatalFailure())
+  {
+    inter_ptr->set_overload(true);
+    Connect(2);
+    inter.AcceptRequests();
+    EXPECT_EQ(inter_ptr->connection_count(),
+      static_cast<std::size_t>(kInitialConnections));
+    counters = inter_ptr->connection_acceptance_counters();
+    EXPECT_EQ(counters.rejected_for_load, 2U);
+    EXPECT_EQ(counters.accepted,
+      static_cast<std::uint64_t>(kInitialConnections));
+    EXPECT_EQ(counters.accept_batches, 3U);
+  }
+
+  inter.CleanUp();
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "AcceptBatchLimitAndCounters", __LINE__);
+}
+
+// IoUringBackend
+//    This test examines an interface which was constructed with
+// IoBackend::kIoUring. The test is skipped if io_uring is not available.
+//
+// Examined properties:
+// 1) The backend which is reported by io_backend.
+// 2) Readiness of the listening socket is detected. The listening socket is
+//    re-armed when the batch limit left connections pending.
+// 3) Readiness of a connection is detected. A connection is re-armed after
+//    it was read.
+// 4) When the interface closes a connection, the pending poll operation of
+//    the connection is removed. Otherwise, the connection would remain open,
+//    and its peer would not observe end of file.
+//
+// Test cases: An AF_UNIX interface.
+// 1) kAcceptBatchLimit + 2 clients connect before AcceptRequests is called.
+//    Two calls accept all connections.
+// 2) A client sends an empty FCGI_GET_VALUES record, and AcceptRequests is
+//    called. This is performed twice. An FCGI_GET_VALUES_RESULT record is
+//    received each time.
+// 3) A client sends a complete request for which FCGI_KEEP_CONN is not set.
+//    Another client then sends an FCGI_GET_VALUES record so that the first
+//    connection is idle and has a pending poll operation. The request is
+//    completed, and AcceptRequests is called. The interface closes the first
+//    connection. The first client reads end of file.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, IoUringBackend)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+  constexpr const char*const path {"/tmp/fcgi_si_test_UNIX_interface_socket"};
+  constexpr int kClientCount {FcgiServerInterface::kAcceptBatchLimit + 2};
+
+  struct InterfaceCreationArguments inter_args {};
+  inter_args.domain          = AF_UNIX;
+  inter_args.backlog         = 2 * kClientCount;
+  inter_args.max_connections = 2 * kClientCount;
+  inter_args.max_requests    = 1;
+  inter_args.app_status      = EXIT_FAILURE;
+  inter_args.unix_path       = path;
+  inter_args.io_backend      = FcgiServerInterface::IoBackend::kIoUring;
+
+  GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+  FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+  ASSERT_NE(inter_ptr, nullptr);
+  if(inter_ptr->io_backend() != FcgiServerInterface::IoBackend::kIoUring)
+  {
+    inter.CleanUp();
+    GTEST_SKIP() << "io_uring is not available.";
+  }
+
+  std::vector<int> client_descriptors {};
+  // Returns true if an empty FCGI_GET_VALUES record was written to client
+  // and, after a call to AcceptRequests, an FCGI_GET_VALUES_RESULT record was
+  // read from client.
+  auto GetValuesRoundTrip = [&](int client)->bool
+  {
+    std::uint8_t header[FCGI_HEADER_LEN];
+    PopulateHeader(header, FcgiType::kFCGI_GET_VALUES, 0U, 0U, 0U);
+    if(write(client, header, FCGI_HEADER_LEN) != FCGI_HEADER_LEN)
+    {
+      ADD_FAILURE() << std::strerror(errno);
+      return false;
+    }
+    EXPECT_EQ(inter.AcceptRequests().size(), 0U);
+    std::uint8_t read_buffer[128U];
+    ssize_t read_return {read(client, read_buffer, 128U)};
+    return (read_return >= FCGI_HEADER_LEN) &&
+      (read_buffer[kHeaderTypeIndex] ==
+       static_cast<std::uint8_t>(FcgiType::kFCGI_GET_VALUES_RESULT));
+  };
+
+  // Case 1
+  for(int i {0}; i < kClientCount; ++i)
+  {
+    int client {inter.Connect()};
+    if(client == -1)
+      break;
+    client_descriptors.push_back(client);
+  }
+  if(!::testing::Test::HasFailure())
+  {
+    for(int i {0}; i < 2; ++i)
+      inter.AcceptRequests();
+    EXPECT_EQ(inter_ptr->connection_count(),
+      static_cast<std::size_t>(kClientCount));
+  }
+
+  // Case 2
+  if(!::testing::Test::HasFailure())
+  {
+    EXPECT_TRUE(GetValuesRoundTrip(client_descriptors[0]));
+    EXPECT_TRUE(GetValuesRoundTrip(client_descriptors[0]));
+  }
+
+  // Case 3
+  if(!::testing::Test::HasFailure())
+  {
+    constexpr std::uint16_t kFcgiId {1U};
+    std::uint8_t records[4 * FCGI_HEADER_LEN] = {};
+    PopulateBeginRequestRecord(records, kFcgiId, FCGI_RESPONDER, false);
+    PopulateHeader(records + 2 * FCGI_HEADER_LEN, FcgiType::kFCGI_PARAMS,
+      kFcgiId, 0U, 0U);
+    PopulateHeader(records + 3 * FCGI_HEADER_LEN, FcgiType::kFCGI_STDIN,
+      kFcgiId, 0U, 0U);
+    int first_client {client_descriptors[0]};
+    if(write(first_client, records, 4 * FCGI_HEADER_LEN) !=
+       4 * FCGI_HEADER_LEN)
+      ADD_FAILURE() << std::strerror(errno);
+    else
+    {
+      std::vector<FcgiRequest> requests {inter.AcceptRequests()};
+      ASSERT_EQ(requests.size(), 1U);
+      EXPECT_TRUE(GetValuesRoundTrip(client_descriptors[1]));
+      EXPECT_TRUE(requests[0].Complete(EXIT_SUCCESS));
+      inter.AcceptRequests();
+      EXPECT_EQ(inter_ptr->connection_count(),
+        static_cast<std::size_t>(kClientCount - 1));
+      // The response records precede end of file.
+      std::uint8_t read_buffer[128U];
+      ssize_t read_return {};
+      alarm(1U);
+      while((read_return = read(first_client, read_buffer, 128U)) > 0)
+        continue;
+      alarm(0U);
+      EXPECT_EQ(read_return, 0) << std::strerror(errno);
+    }
+  }
+
+  inter.CleanUp();
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "IoUringBackend", __LINE__);
+}
+
+// MetricsSnapshot
+//    This test examines the updates which an interface and the FcgiRequest
+// objects which it produces make to the process-wide FcgiMetrics registry.
+// As the registry is process-wide, values are examined as differences
+// between snapshots.
+//
+// Examined properties:
+// 1) Connection counters: accepted and closed.
+// 2) Request counters: accepted, completed, and rejected with
+//    FCGI_CANT_MPX_CONN.
+// 3) Records parsed by type and the bytes read and written by the interface
+//    and by an FcgiRequest object.
+// 4) The latency histograms each record one duration for a request which is
+//    produced and completed.
+//
+// Test cases: An AF_UNIX interface which allows a single request per
+// connection.
+// 1) Two FCGI_BEGIN_REQUEST records are sent on one connection followed by
+//    empty FCGI_PARAMS and FCGI_STDIN records for the first request. The
+//    second request is rejected. The first request is produced and
+//    completed. The client then closes the connection, and a second
+//    connection is made.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+// 2) FcgiMetrics
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, MetricsSnapshot)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+  constexpr const char*const path {"/tmp/fcgi_si_test_UNIX_interface_socket"};
+
+  struct InterfaceCreationArguments inter_args {};
+  inter_args.domain          = AF_UNIX;
+  inter_args.backlog         = 5;
+  inter_args.max_connections = 5;
+  inter_args.max_requests    = 1;
+  inter_args.app_status      = EXIT_FAILURE;
+  inter_args.unix_path       = path;
+
+  GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+  FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+  ASSERT_NE(inter_ptr, nullptr);
+
+  FcgiMetrics::MetricsSnapshot before {FcgiMetrics::Snapshot()};
+  auto CounterDelta = [&](const FcgiMetrics::MetricsSnapshot& after,
+    FcgiCounter c)->std::uint64_t
+  {
+    return after.counter(c) - before.counter(c);
+  };
+  auto RecordDelta = [&](const FcgiMetrics::MetricsSnapshot& after,
+    FcgiType type)->std::uint64_t
+  {
+    return after.records_parsed(type) - before.records_parsed(type);
+  };
+  auto HistogramDelta = [&](const FcgiMetrics::MetricsSnapshot& after,
+    FcgiHistogram h)->std::uint64_t
+  {
+    return after.histogram(h).count - before.histogram(h).count;
+  };
+
+  // Case 1
+  constexpr int kRecordsLength {6 * FCGI_HEADER_LEN};
+  std::uint8_t records[kRecordsLength] = {};
+  PopulateBeginRequestRecord(records, 1U, FCGI_RESPONDER, true);
+  PopulateBeginRequestRecord(records + 2 * FCGI_HEADER_LEN, 2U,
+    FCGI_RESPONDER, true);
+  PopulateHeader(records + 4 * FCGI_HEADER_LEN, FcgiType::kFCGI_PARAMS,
+    1U, 0U, 0U);
+  PopulateHeader(records + 5 * FCGI_HEADER_LEN, FcgiType::kFCGI_STDIN,
+    1U, 0U, 0U);
+  // A failure of Connect was reported by Connect.
+  int client {inter.Connect()};
+  if((client != -1) &&
+     (write(client, records, kRecordsLength) != kRecordsLength))
+  {
+    ADD_FAILURE() << std::strerror(errno);
+  }
+  else if(client != -1)
+  {
+    // The first call accepts the connection.
+    std::vector<FcgiRequest> requests {inter.AcceptRequests()};
+    while(requests.size() == 0U)
+      requests = inter.AcceptRequests();
+    EXPECT_EQ(requests.size(), 1U);
+    EXPECT_TRUE(requests[0].Complete(EXIT_SUCCESS));
+
+    FcgiMetrics::MetricsSnapshot after {FcgiMetrics::Snapshot()};
+    EXPECT_EQ(CounterDelta(after, FcgiCounter::kConnectionsAccepted), 1U);
+    EXPECT_EQ(CounterDelta(after, FcgiCounter::kRequestsAccepted), 1U);
+    EXPECT_EQ(CounterDelta(after, FcgiCounter::kRequestsCompleted), 1U);
+    EXPECT_EQ(CounterDelta(after, FcgiCounter::kRequestsRejectedCantMpxConn),
+      1U);
+    EXPECT_EQ(CounterDelta(after, FcgiCounter::kRequestsRejectedOverloaded),
+      0U);
+    EXPECT_EQ(CounterDelta(after, FcgiCounter::kBytesRead),
+      static_cast<std::uint64_t>(kRecordsLength));
+    // An FCGI_END_REQUEST record for the rejected request (16 bytes) and
+    // terminal FCGI_STDOUT, FCGI_STDERR, and FCGI_END_REQUEST records for
+    // the completed request (32 bytes).
+    EXPECT_EQ(CounterDelta(after, FcgiCounter::kBytesWritten),
+      static_cast<std::uint64_t>(6 * FCGI_HEADER_LEN));
+    EXPECT_EQ(RecordDelta(after, FcgiType::kFCGI_BEGIN_REQUEST), 2U);
+    EXPECT_EQ(RecordDelta(after, FcgiType::kFCGI_PARAMS), 1U);
+    EXPECT_EQ(RecordDelta(after, FcgiType::kFCGI_STDIN), 1U);
+    EXPECT_EQ(HistogramDelta(after,
+      FcgiHistogram::kBeginRequestToFcgiRequest), 1U);
+    EXPECT_EQ(HistogramDelta(after, FcgiHistogram::kFcgiRequestToComplete),
+      1U);
+
+    // The closure is observed in one call of AcceptRequests and the
+    // connection is closed in the next call. A second connection causes the
+    // next call to return.
+    inter.CloseClient(client);
+    inter.AcceptRequests();
+    if(inter.Connect() != -1)
+    {
+      inter.AcceptRequests();
+      EXPECT_EQ(inter_ptr->connection_count(), 1U);
+      after = FcgiMetrics::Snapshot();
+      EXPECT_EQ(CounterDelta(after, FcgiCounter::kConnectionsAccepted), 2U);
+      EXPECT_EQ(CounterDelta(after, FcgiCounter::kConnectionsClosed), 1U);
+    }
+  }
+
+  inter.CleanUp();
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "MetricsSnapshot", __LINE__);
+}
+
+// RequestTracing
+//    This test examines the trace points which are recorded for a request
+// when tracing was enabled with FcgiTracing::Enable.
+//
+// Examined properties:
+// 1) For a traced request which is produced, written to, and completed,
+//    every trace point is reached and the points are ordered.
+// 2) FcgiRequest::trace identifies the request. The completed trace is kept
+//    by the sink and returned by FcgiTracing::Dump.
+// 3) A request whose FCGI_BEGIN_REQUEST record is accepted while tracing is
+//    disabled has no trace and is not submitted to the sink.
+//
+// Test cases: An AF_UNIX interface and a single connection.
+// 1) Tracing is enabled. A request with FCGI_KEEP_CONN set is sent. It is
+//    written to and completed.
+// 2) Tracing is disabled. A second request is sent and completed.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+// 2) FcgiTracing
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, RequestTracing)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+  constexpr const char*const path {"/tmp/fcgi_si_test_UNIX_interface_socket"};
+
+  struct InterfaceCreationArguments inter_args {};
+  inter_args.domain          = AF_UNIX;
+  inter_args.backlog         = 5;
+  inter_args.max_connections = 5;
+  inter_args.max_requests    = 1;
+  inter_args.app_status      = EXIT_FAILURE;
+  inter_args.unix_path       = path;
+
+  GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+  FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+  ASSERT_NE(inter_ptr, nullptr);
+
+  auto CleanUp = [&]()->void
+  {
+    FcgiTracing::Disable();
+    FcgiTracing::Dump();
+    inter.CleanUp();
+  };
+
+  int client {inter.Connect()};
+  if(client == -1)
+  {
+    CleanUp();
+    return;
+  }
+  // Sends a request with empty FCGI_PARAMS and FCGI_STDIN streams and returns
+  // the requests which were produced. The response is discarded by the
+  // caller.
+  auto SendRequest = [&](std::uint16_t fcgi_id)->std::vector<FcgiRequest>
+  {
+    constexpr int kRecordsLength {4 * FCGI_HEADER_LEN};
+    std::uint8_t records[kRecordsLength] = {};
+    PopulateBeginRequestRecord(records, fcgi_id, FCGI_RESPONDER, true);
+    PopulateHeader(records + 2 * FCGI_HEADER_LEN, FcgiType::kFCGI_PARAMS,
+      fcgi_id, 0U, 0U);
+    PopulateHeader(records + 3 * FCGI_HEADER_LEN, FcgiType::kFCGI_STDIN,
+      fcgi_id, 0U, 0U);
+    std::vector<FcgiRequest> requests {};
+    if(write(client, records, kRecordsLength) != kRecordsLength)
+    {
+      ADD_FAILURE() << std::strerror(errno);
+      return requests;
+    }
+    while(requests.size() == 0U)
+      requests = inter.AcceptRequests();
+    return requests;
+  };
+  // Reads the response of a completed request.
+  auto ReadResponse = [&](int expected_length)->void
+  {
+    std::vector<std::uint8_t> response(expected_length);
+    alarm(1U);
+    EXPECT_EQ(socket_functions::SocketRead(client, response.data(),
+      expected_length), static_cast<std::size_t>(expected_length));
+    alarm(0U);
+  };
+
+  // Case 1
+  FcgiTracing::Enable(1U, 16U);
+  FcgiTracing::Dump();
+  {
+    std::vector<FcgiRequest> requests {SendRequest(1U)};
+    EXPECT_EQ(requests.size(), 1U);
+    if(requests.size() == 1U)
+    {
+      const std::uint8_t body[] = "Status: 200 OK\r\n\r\n";
+      EXPECT_TRUE(requests[0].Write(body, body + sizeof(body) - 1));
+      EXPECT_TRUE(requests[0].Complete(EXIT_SUCCESS));
+      const FcgiRequestTrace* trace_ptr {requests[0].trace()};
+      EXPECT_NE(trace_ptr, nullptr);
+      if(trace_ptr != nullptr)
+      {
+        const FcgiRequestTrace& trace {*trace_ptr};
+        EXPECT_EQ(trace.request_id, requests[0].get_request_identifier());
+        for(std::size_t i {0U}; i < FcgiRequestTrace::kPointCount; ++i)
+        {
+          EXPECT_TRUE(trace.reached(static_cast<FcgiTracePoint>(i))) << i;
+          if(i > 0U)
+          {
+            EXPECT_LE(trace.points[i - 1U], trace.points[i]) << i;
+          }
+        }
+        std::vector<FcgiRequestTrace> dumped {FcgiTracing::Dump()};
+        EXPECT_EQ(dumped.size(), 1U);
+        if(dumped.size() == 1U)
+        {
+          EXPECT_EQ(dumped[0].request_id, trace.request_id);
+          EXPECT_EQ(dumped[0].points, trace.points);
+        }
+      }
+      // One FCGI_STDOUT record with padding to a multiple of eight bytes and
+      // the three terminal records.
+      ReadResponse(FCGI_HEADER_LEN + 24 + 4 * FCGI_HEADER_LEN);
+    }
+  }
+
+  // Case 2
+  FcgiTracing::Disable();
+  {
+    std::vector<FcgiRequest> requests {SendRequest(1U)};
+    EXPECT_EQ(requests.size(), 1U);
+    if(requests.size() == 1U)
+    {
+      EXPECT_TRUE(requests[0].Complete(EXIT_SUCCESS));
+      EXPECT_EQ(requests[0].trace(), nullptr);
+      EXPECT_EQ(FcgiTracing::Dump().size(), 0U);
+      ReadResponse(4 * FCGI_HEADER_LEN);
+    }
+  }
+
+  CleanUp();
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "RequestTracing", __LINE__);
+}
+
+// Backpressure
+//    This test examines read throttling by the backpressure budgets of an
+// interface. Throttling is examined for both I/O backends. The kIoUring
+// cases are skipped if io_uring is not available.
+//
+// Examined properties:
+// 1) A connection which meets its assigned request budget is not read. A
+//    request which was sent over the connection is not produced until an
+//    assigned request of the connection is completed.
+// 2) The completion of an assigned request of a throttled connection wakes
+//    an interface which is blocked in AcceptRequests.
+// 3) Reading from a connection stops once its buffered byte budget is
+//    exceeded while it has an assigned request. Unread data is read after
+//    the assigned request is completed and is not lost.
+// 4) FcgiCounter::kReadThrottles counts transitions to the throttled state.
+// 5) set_backpressure_budgets rejects a negative request budget.
+//
+// Test cases: An AF_UNIX interface which allows five requests per connection
+// and a single client connection. A connection to the listening socket is
+// made by a second client to cause a blocked call of AcceptRequests to
+// return.
+// 1) The assigned request budget of a connection is one. A request is
+//    produced and held. A second request is sent, and a call of
+//    AcceptRequests is made to return by a new connection. The first
+//    request is completed, and the second request is produced.
+// 2) The buffered byte budget of a connection is 1024 bytes. The second
+//    request of case 1 is held. A third request is sent with 4096 bytes of
+//    FCGI_STDIN content. Fewer bytes than were sent are read. The second
+//    request is completed, and the third request is produced with all of its
+//    content.
+// 3) A budget of -1 assigned requests is provided.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+// 2) FcgiMetrics
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, Backpressure)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+  constexpr const char*const path {"/tmp/fcgi_si_test_UNIX_interface_socket"};
+  constexpr int kStdinLength {4096};
+
+  auto RunCases = [&](FcgiServerInterface::IoBackend backend)->void
+  {
+    struct InterfaceCreationArguments inter_args {};
+    inter_args.domain          = AF_UNIX;
+    inter_args.backlog         = 5;
+    inter_args.max_connections = 5;
+    inter_args.max_requests    = 5;
+    inter_args.app_status      = EXIT_FAILURE;
+    inter_args.unix_path       = path;
+    inter_args.io_backend      = backend;
+
+    GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+    FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+    if((inter_ptr == nullptr) || (inter_ptr->io_backend() != backend))
+      return;
+
+    // held_requests is destroyed before inter.
+    std::vector<FcgiRequest> held_requests {};
+    // Writes a request with FCGI_KEEP_CONN set, empty FCGI_PARAMS, and
+    // stdin_length bytes of FCGI_STDIN content.
+    auto SendRequest = [](int client, std::uint16_t fcgi_id,
+      int stdin_length)->bool
+    {
+      std::vector<std::uint8_t> records(5 * FCGI_HEADER_LEN + stdin_length,
+        0U);
+      PopulateBeginRequestRecord(records.data(), fcgi_id, FCGI_RESPONDER,
+        true);
+      PopulateHeader(records.data() + 2 * FCGI_HEADER_LEN,
+        FcgiType::kFCGI_PARAMS, fcgi_id, 0U, 0U);
+      PopulateHeader(records.data() + 3 * FCGI_HEADER_LEN,
+        FcgiType::kFCGI_STDIN, fcgi_id, stdin_length, 0U);
+      PopulateHeader(records.data() + 4 * FCGI_HEADER_LEN + stdin_length,
+        FcgiType::kFCGI_STDIN, fcgi_id, 0U, 0U);
+      return socket_functions::WriteOnSelect(client, records.data(),
+        records.size(), nullptr) == records.size();
+    };
+    // Calls AcceptRequests until a request is produced. A bounded number of
+    // calls is made.
+    auto AcceptRequest = [&]()->std::vector<FcgiRequest>
+    {
+      std::vector<FcgiRequest> requests {};
+      for(int i {0}; (i < 4) && (requests.size() == 0U); ++i)
+        requests = inter.AcceptRequests();
+      return requests;
+    };
+    // Causes a call of AcceptRequests to return even if no connection is
+    // read. Returns the requests which were produced.
+    auto AcceptRequestsWithWake = [&]()->std::vector<FcgiRequest>
+    {
+      if(inter.Connect() == -1)
+        return {};
+      return inter.AcceptRequests();
+    };
+
+    FcgiMetrics::MetricsSnapshot before {FcgiMetrics::Snapshot()};
+    int client {inter.Connect()};
+    if(client == -1)
+      return;
+
+    // Case 1
+    FcgiServerInterface::BackpressureBudgets budgets {};
+    budgets.connection_assigned_requests = 1;
+    inter_ptr->set_backpressure_budgets(budgets);
+    EXPECT_EQ(inter_ptr->backpressure_budgets().connection_assigned_requests,
+      1);
+    if(!SendRequest(client, 1U, 0))
+      ADD_FAILURE() << std::strerror(errno);
+    else
+    {
+      std::vector<FcgiRequest> requests {AcceptRequest()};
+      EXPECT_EQ(requests.size(), 1U);
+      if(!SendRequest(client, 2U, 0))
+        ADD_FAILURE() << std::strerror(errno);
+      else if(requests.size() == 1U)
+      {
+        // The connection is throttled. The call returns because of the new
+        // connection.
+        EXPECT_EQ(AcceptRequestsWithWake().size(), 0U);
+        EXPECT_TRUE(requests[0].Complete(EXIT_SUCCESS));
+        // The completion wakes the interface. The connection is read.
+        held_requests = inter.AcceptRequests();
+        EXPECT_EQ(held_requests.size(), 1U);
+        if(held_requests.size() == 1U)
+        {
+          EXPECT_EQ(held_requests[0].get_request_identifier().Fcgi_id(), 2U);
+        }
+      }
+    }
+
+    // Case 2
+    if(!::testing::Test::HasFailure())
+    {
+      budgets = FcgiServerInterface::BackpressureBudgets {};
+      budgets.connection_buffered_bytes = 1024U;
+      inter_ptr->set_backpressure_budgets(budgets);
+      FcgiMetrics::MetricsSnapshot before_read {FcgiMetrics::Snapshot()};
+      if(!SendRequest(client, 3U, kStdinLength))
+        ADD_FAILURE() << std::strerror(errno);
+      else
+      {
+        EXPECT_EQ(inter.AcceptRequests().size(), 0U);
+        EXPECT_EQ(AcceptRequestsWithWake().size(), 0U);
+        FcgiMetrics::MetricsSnapshot after_read {FcgiMetrics::Snapshot()};
+        EXPECT_LT(after_read.counter(FcgiCounter::kBytesRead) -
+          before_read.counter(FcgiCounter::kBytesRead),
+          static_cast<std::uint64_t>(kStdinLength));
+        EXPECT_TRUE(held_requests[0].Complete(EXIT_SUCCESS));
+        std::vector<FcgiRequest> requests {AcceptRequest()};
+        EXPECT_EQ(requests.size(), 1U);
+        if(requests.size() == 1U)
+        {
+          EXPECT_EQ(requests[0].get_request_identifier().Fcgi_id(), 3U);
+          EXPECT_EQ(requests[0].get_STDIN().size(),
+            static_cast<std::size_t>(kStdinLength));
+          EXPECT_TRUE(requests[0].Complete(EXIT_SUCCESS));
+        }
+      }
+    }
+    FcgiMetrics::MetricsSnapshot after {FcgiMetrics::Snapshot()};
+    EXPECT_GE(after.counter(FcgiCounter::kReadThrottles) -
+      before.counter(FcgiCounter::kReadThrottles), 2U);
+
+    // Case 3
+    budgets = FcgiServerInterface::BackpressureBudgets {};
+    budgets.total_assigned_requests = -1;
+    EXPECT_THROW(inter_ptr->set_backpressure_budgets(budgets),
+      std::invalid_argument);
+  };
+
+  RunCases(FcgiServerInterface::IoBackend::kSelect);
+  RunCases(FcgiServerInterface::IoBackend::kIoUring);
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "Backpressure", __LINE__);
+}
+
+// AdmissionControl
+//    This test examines the rejection of requests by the admission
+// controller of an interface and the adjustment of its limit by the
+// queueing delays of requests.
+//
+// Examined properties:
+// 1) admission_controller returns an empty optional unless admission control
+//    is enabled. EnableAdmissionControl rejects invalid parameters.
+// 2) The queueing delay of a request is recorded upon its first write. With
+//    a target delay of zero, an interval which elapsed after a write halves
+//    the limit.
+// 3) An FCGI_BEGIN_REQUEST record which is received while the limit is met
+//    is rejected with an FCGI_END_REQUEST record whose protocol status is
+//    FCGI_OVERLOADED. FcgiCounter::kRequestsRejectedByAdmission is
+//    incremented.
+// 4) DisableAdmissionControl removes the controller.
+//
+// Test cases: An AF_UNIX interface which allows five requests per connection
+// and a single connection.
+// 1) Admission control is enabled with a target delay of zero, an interval
+//    of one millisecond, and limits of 1 and 4. Request 1 is produced and
+//    completed. After the interval, request 2 is sent and produced. The limit
+//    is 2.
+// 2) Admission control is enabled with limits of 1 and 1 while request 2 is
+//    held. Request 3 is sent and rejected. Request 2 is completed.
+// 3) Admission control is disabled.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+// 2) AdmissionController
+// 3) FcgiMetrics
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, AdmissionControl)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+  constexpr const char*const path {"/tmp/fcgi_si_test_UNIX_interface_socket"};
+
+  struct InterfaceCreationArguments inter_args {};
+  inter_args.domain          = AF_UNIX;
+  inter_args.backlog         = 5;
+  inter_args.max_connections = 5;
+  inter_args.max_requests    = 5;
+  inter_args.app_status      = EXIT_FAILURE;
+  inter_args.unix_path       = path;
+
+  GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+  FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+  ASSERT_NE(inter_ptr, nullptr);
+
+  int client {-1};
+  std::vector<FcgiRequest> held_requests {};
+  auto CleanUp = [&]()->void
+  {
+    held_requests.clear();
+    inter.CleanUp();
+  };
+
+  // Writes a request with FCGI_KEEP_CONN set and empty FCGI_PARAMS and
+  // FCGI_STDIN streams.
+  auto SendRequest = [&](std::uint16_t fcgi_id)->bool
+  {
+    std::uint8_t records[4 * FCGI_HEADER_LEN] = {};
+    PopulateBeginRequestRecord(records, fcgi_id, FCGI_RESPONDER, true);
+    PopulateHeader(records + 2 * FCGI_HEADER_LEN, FcgiType::kFCGI_PARAMS,
+      fcgi_id, 0U, 0U);
+    PopulateHeader(records + 3 * FCGI_HEADER_LEN, FcgiType::kFCGI_STDIN,
+      fcgi_id, 0U, 0U);
+    return write(client, records, 4 * FCGI_HEADER_LEN) == 4 * FCGI_HEADER_LEN;
+  };
+
+  EXPECT_FALSE(inter_ptr->admission_controller().has_value());
+  AdmissionController::Parameters parameters {};
+  parameters.minimum_limit = 0;
+  EXPECT_THROW(inter_ptr->EnableAdmissionControl(parameters),
+    std::invalid_argument);
+  EXPECT_FALSE(inter_ptr->admission_controller().has_value());
+
+  client = inter.Connect();
+  if(client == -1)
+  {
+    CleanUp();
+    return;
+  }
+  // Accept the connection.
+  inter.AcceptRequests();
+
+  // Case 1
+  parameters.target_delay  = std::chrono::nanoseconds {0};
+  parameters.interval      = std::chrono::milliseconds {1};
+  parameters.minimum_limit = 1;
+  parameters.maximum_limit = 4;
+  inter_ptr->EnableAdmissionControl(parameters);
+  EXPECT_EQ(inter_ptr->admission_controller()->limit(), 4);
+  if(!SendRequest(1U))
+    ADD_FAILURE() << std::strerror(errno);
+  else
+  {
+    std::vector<FcgiRequest> requests {inter.AcceptRequests()};
+    EXPECT_EQ(requests.size(), 1U);
+    if(requests.size() == 1U)
+    {
+      EXPECT_TRUE(requests[0].Complete(EXIT_SUCCESS));
+    }
+    usleep(2000U);
+    if(!SendRequest(2U))
+      ADD_FAILURE() << std::strerror(errno);
+    else
+    {
+      held_requests = inter.AcceptRequests();
+      EXPECT_EQ(held_requests.size(), 1U);
+      EXPECT_EQ(inter_ptr->admission_controller()->limit(), 2);
+    }
+  }
+
+  // Case 2
+  if(!::testing::Test::HasFailure())
+  {
+    FcgiMetrics::MetricsSnapshot before {FcgiMetrics::Snapshot()};
+    parameters.interval      = std::chrono::seconds {60};
+    parameters.maximum_limit = 1;
+    inter_ptr->EnableAdmissionControl(parameters);
+    if(!SendRequest(3U))
+      ADD_FAILURE() << std::strerror(errno);
+    else
+    {
+      EXPECT_EQ(inter.AcceptRequests().size(), 0U);
+      FcgiMetrics::MetricsSnapshot after {FcgiMetrics::Snapshot()};
+      EXPECT_EQ(after.counter(FcgiCounter::kRequestsRejectedByAdmission) -
+        before.counter(FcgiCounter::kRequestsRejectedByAdmission), 1U);
+      EXPECT_EQ(inter_ptr->admission_controller()->rejections(), 1U);
+      // Find the FCGI_END_REQUEST record of request 3 among the records
+      // which were sent for request 1.
+      std::uint8_t read_buffer[256U];
+      ssize_t read_return {read(client, read_buffer, 256U)};
+      bool found {false};
+      for(ssize_t i {0}; (i + FCGI_HEADER_LEN) <= read_return; /*no-op*/)
+      {
+        std::uint16_t fcgi_id {static_cast<std::uint16_t>(
+          (read_buffer[i + kHeaderRequestIDB1Index] << 8) +
+           read_buffer[i + kHeaderRequestIDB0Index])};
+        int content_length {(read_buffer[i + kHeaderContentLengthB1Index] << 8)
+          + read_buffer[i + kHeaderContentLengthB0Index]};
+        if((read_buffer[i + kHeaderTypeIndex] ==
+            static_cast<std::uint8_t>(FcgiType::kFCGI_END_REQUEST)) &&
+           (fcgi_id == 3U) && ((i + 2 * FCGI_HEADER_LEN) <= read_return))
+        {
+          found = true;
+          EXPECT_EQ(read_buffer[i + FCGI_HEADER_LEN +
+            kEndRequestProtocolStatusIndex], FCGI_OVERLOADED);
+        }
+        i += FCGI_HEADER_LEN + content_length +
+          read_buffer[i + kHeaderPaddingLengthIndex];
+      }
+      EXPECT_TRUE(found);
+    }
+    if(held_requests.size() == 1U)
+    {
+      EXPECT_TRUE(held_requests[0].Complete(EXIT_SUCCESS));
+    }
+  }
+
+  // Case 3
+  inter_ptr->DisableAdmissionControl();
+  EXPECT_FALSE(inter_ptr->admission_controller().has_value());
+
+  CleanUp();
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "AdmissionControl", __LINE__);
+}
+
+// RequestClassificationAndPriorityQueue
+//    This test examines the assignment of priorities to requests by the
+// classifier of an interface and the dispatch of requests by
+// PriorityRequestQueue.
+//
+// Examined properties:
+// 1) The classifier is called once for each request with the environment map
+//    and the role of the request. The priority which it returns is available
+//    from FcgiRequest::get_priority.
+// 2) The requests which are returned by AcceptRequests are ordered by
+//    priority, and the order of requests with equal priorities is the order
+//    of their completion.
+// 3) PriorityRequestQueue rejects empty weight lists and weights of zero.
+//    A request whose priority is not less than the level count is placed in
+//    the last level. Levels are dispatched by smooth weighted round robin.
+//    Pop returns false once the queue is closed and empty, and Push throws
+//    after Close.
+// 4) When the classifier is cleared, requests have a priority of zero.
+//
+// Test cases: An AF_UNIX interface which allows ten requests per connection
+// and a single connection. The classifier returns the digit value of the
+// environment variable P.
+// 1) Six requests are written at once. Requests 1, 2, and 3 have P = 5.
+//    Requests 4, 5, and 6 have P = 0. The requests are returned in the order
+//    4, 5, 6, 1, 2, 3.
+// 2) The requests are pushed to a queue with weights {3, 1}. The priorities
+//    of the dispatched requests are 0, 0, 5, 0, 5, 5.
+// 3) The classifier is cleared. A request with P = 5 has a priority of zero.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, RequestClassificationAndPriorityQueue)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+  constexpr const char*const path {"/tmp/fcgi_si_test_UNIX_interface_socket"};
+
+  struct InterfaceCreationArguments inter_args {};
+  inter_args.domain          = AF_UNIX;
+  inter_args.backlog         = 5;
+  inter_args.max_connections = 5;
+  inter_args.max_requests    = 10;
+  inter_args.app_status      = EXIT_FAILURE;
+  inter_args.unix_path       = path;
+
+  GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+  FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+  ASSERT_NE(inter_ptr, nullptr);
+
+
+  constexpr int kRequestLength {6 * FCGI_HEADER_LEN};
+  // Writes a request with FCGI_KEEP_CONN set, an environment which defines
+  // P as p, and an empty FCGI_STDIN stream to buffer.
+  auto PopulateRequest = [](std::uint8_t* buffer, std::uint16_t fcgi_id,
+    std::uint8_t p)->void
+  {
+    PopulateBeginRequestRecord(buffer, fcgi_id, FCGI_RESPONDER, true);
+    PopulateHeader(buffer + 2 * FCGI_HEADER_LEN, FcgiType::kFCGI_PARAMS,
+      fcgi_id, 4U, 4U);
+    std::uint8_t* content_ptr {buffer + 3 * FCGI_HEADER_LEN};
+    content_ptr[0] = 1U;
+    content_ptr[1] = 1U;
+    content_ptr[2] = 'P';
+    content_ptr[3] = p;
+    PopulateHeader(buffer + 4 * FCGI_HEADER_LEN, FcgiType::kFCGI_PARAMS,
+      fcgi_id, 0U, 0U);
+    PopulateHeader(buffer + 5 * FCGI_HEADER_LEN, FcgiType::kFCGI_STDIN,
+      fcgi_id, 0U, 0U);
+  };
+
+  int classifier_calls {0};
+  inter_ptr->set_request_classifier(
+    [&classifier_calls](const std::map<std::vector<std::uint8_t>,
+      std::vector<std::uint8_t>>& environment_map, std::uint16_t role)
+      ->unsigned int
+    {
+      ++classifier_calls;
+      EXPECT_EQ(role, FCGI_RESPONDER);
+      std::map<std::vector<std::uint8_t>, std::vector<std::uint8_t>>::
+        const_iterator p_iter {environment_map.find({'P'})};
+      if((p_iter == environment_map.end()) || (p_iter->second.size() != 1U))
+        return 0U;
+      return p_iter->second[0] - '0';
+    }
+  );
+
+  int client {inter.Connect()};
+  if(client == -1)
+  {
+    inter.CleanUp();
+    return;
+  }
+  // Accept the connection.
+  inter.AcceptRequests();
+
+  // Case 1
+  std::uint8_t request_buffer[6 * kRequestLength] = {};
+  for(int i {0}; i < 6; ++i)
+    PopulateRequest(request_buffer + i * kRequestLength, i + 1,
+      (i < 3) ? '5' : '0');
+  std::vector<FcgiRequest> requests {};
+  if(write(client, request_buffer, 6 * kRequestLength) != 6 * kRequestLength)
+    ADD_FAILURE() << std::strerror(errno);
+  else
+  {
+    requests = inter.AcceptRequests();
+    EXPECT_EQ(classifier_calls, 6);
+    EXPECT_EQ(requests.size(), 6U);
+    if(requests.size() == 6U)
+    {
+      const std::uint16_t expected_ids[6] = {4U, 5U, 6U, 1U, 2U, 3U};
+      for(int i {0}; i < 6; ++i)
+      {
+        EXPECT_EQ(requests[i].get_request_identifier().Fcgi_id(),
+          expected_ids[i]);
+        EXPECT_EQ(requests[i].get_priority(), (i < 3) ? 0U : 5U);
+      }
+    }
+  }
+
+  // Case 2
+  EXPECT_THROW(PriorityRequestQueue {std::vector<unsigned int> {}},
+    std::invalid_argument);
+  EXPECT_THROW((PriorityRequestQueue {std::vector<unsigned int> {1U, 0U}}),
+    std::invalid_argument);
+  {
+    PriorityRequestQueue queue {std::vector<unsigned int> {3U, 1U}};
+    EXPECT_EQ(queue.level_count(), 2U);
+    std::size_t request_count {requests.size()};
+    queue.Push(std::move(requests));
+    EXPECT_EQ(queue.size(), request_count);
+    if(request_count == 6U)
+    {
+      const unsigned int expected_priorities[6] = {0U, 0U, 5U, 0U, 5U, 5U};
+      FcgiRequest popped {};
+      for(int i {0}; i < 6; ++i)
+      {
+        EXPECT_TRUE(queue.TryPop(&popped));
+        EXPECT_EQ(popped.get_priority(), expected_priorities[i]);
+        EXPECT_TRUE(popped.Complete(EXIT_SUCCESS));
+      }
+      EXPECT_FALSE(queue.TryPop(&popped));
+    }
+    queue.Close();
+    FcgiRequest popped {};
+    EXPECT_FALSE(queue.Pop(&popped));
+    EXPECT_THROW(queue.Push(FcgiRequest {}), std::logic_error);
+  }
+
+  // Case 3
+  inter_ptr->set_request_classifier(FcgiServerInterface::RequestClassifier {});
+  PopulateRequest(request_buffer, 7U, '5');
+  if(write(client, request_buffer, kRequestLength) != kRequestLength)
+    ADD_FAILURE() << std::strerror(errno);
+  else
+  {
+    requests = inter.AcceptRequests();
+    EXPECT_EQ(classifier_calls, 6);
+    EXPECT_EQ(requests.size(), 1U);
+    if(requests.size() == 1U)
+    {
+      EXPECT_EQ(requests[0].get_priority(), 0U);
+      EXPECT_TRUE(requests[0].Complete(EXIT_SUCCESS));
+    }
+  }
+
+  inter.CleanUp();
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "RequestClassificationAndPriorityQueue", __LINE__);
+}
+
+// ReadBudget
+//    This test examines the read budget of an interface and the round-robin
+// order in which connections are read. Both I/O backends are examined. The
+// kIoUring cases are skipped if io_uring is not available.
+//
+// Examined properties:
+// 1) The default read budget is kDefaultReadBudget.
+// 2) A connection whose budget is exhausted is not read further during a
+//    call of AcceptRequests. Its unread data is read during later calls and
+//    is not lost. FcgiCounter::kReadBudgetExhaustions is incremented.
+// 3) The call after an exhaustion reads connections starting after the
+//    connection whose budget was exhausted. The order wraps around to the
+//    lowest descriptor.
+// 4) A budget of zero reads a connection until it would block.
+//
+// Test cases: An AF_UNIX interface which allows five requests per
+// connection. Three clients A, B, and C are connected in that order, so that
+// the descriptors of their connections are ascending.
+// 1) The read budget is 1024 bytes. B sends a request with 8192 bytes of
+//    FCGI_STDIN content, and AcceptRequests is called once. A and C each
+//    send a request with no content. The next call returns the request of C
+//    and then the request of A. Later calls produce the request of B with
+//    all of its content.
+// 2) The read budget is zero. B sends a second request with 8192 bytes of
+//    FCGI_STDIN content. The request is produced by one call.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+// 2) FcgiMetrics
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, ReadBudget)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+  constexpr const char*const path {"/tmp/fcgi_si_test_UNIX_interface_socket"};
+  constexpr int kStdinLength {8192};
+
+  auto RunCases = [&](FcgiServerInterface::IoBackend backend)->void
+  {
+    struct InterfaceCreationArguments inter_args {};
+    inter_args.domain          = AF_UNIX;
+    inter_args.backlog         = 5;
+    inter_args.max_connections = 5;
+    inter_args.max_requests    = 5;
+    inter_args.app_status      = EXIT_FAILURE;
+    inter_args.unix_path       = path;
+    inter_args.io_backend      = backend;
+
+    GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+    FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+    if((inter_ptr == nullptr) || (inter_ptr->io_backend() != backend))
+      return;
+    EXPECT_EQ(inter_ptr->read_budget(),
+      FcgiServerInterface::kDefaultReadBudget);
+
+    const int client_a {inter.Connect()};
+    const int client_b {inter.Connect()};
+    const int client_c {inter.Connect()};
+    if((client_a == -1) || (client_b == -1) || (client_c == -1))
+      return;
+
+    // Writes a request with FCGI_KEEP_CONN set, empty FCGI_PARAMS, and
+    // stdin_length bytes of FCGI_STDIN content.
+    auto SendRequest = [](int client, std::uint16_t fcgi_id,
+      int stdin_length)->bool
+    {
+      std::vector<std::uint8_t> records(5 * FCGI_HEADER_LEN + stdin_length,
+        0U);
+      PopulateBeginRequestRecord(records.data(), fcgi_id, FCGI_RESPONDER,
+        true);
+      PopulateHeader(records.data() + 2 * FCGI_HEADER_LEN,
+        FcgiType::kFCGI_PARAMS, fcgi_id, 0U, 0U);
+      PopulateHeader(records.data() + 3 * FCGI_HEADER_LEN,
+        FcgiType::kFCGI_STDIN, fcgi_id, stdin_length, 0U);
+      PopulateHeader(records.data() + 4 * FCGI_HEADER_LEN + stdin_length,
+        FcgiType::kFCGI_STDIN, fcgi_id, 0U, 0U);
+      return socket_functions::WriteOnSelect(client, records.data(),
+        records.size(), nullptr) == records.size();
+    };
+    // Accept the connections.
+    inter.AcceptRequests();
+
+    // Case 1
+    FcgiMetrics::MetricsSnapshot before {FcgiMetrics::Snapshot()};
+    inter_ptr->set_read_budget(1024U);
+    EXPECT_EQ(inter_ptr->read_budget(), 1024U);
+    if(!SendRequest(client_b, 1U, kStdinLength))
+      ADD_FAILURE() << std::strerror(errno);
+    else
+    {
+      EXPECT_EQ(inter.AcceptRequests().size(), 0U);
+      if(!(SendRequest(client_a, 1U, 0) && SendRequest(client_c, 1U, 0)))
+        ADD_FAILURE() << std::strerror(errno);
+      else
+      {
+        std::vector<FcgiRequest> requests {inter.AcceptRequests()};
+        EXPECT_EQ(requests.size(), 2U);
+        if(requests.size() == 2U)
+        {
+          // C is read before A.
+          EXPECT_GT(requests[0].get_request_identifier().descriptor(),
+            requests[1].get_request_identifier().descriptor());
+          for(FcgiRequest& request : requests)
+          {
+            EXPECT_EQ(request.get_STDIN().size(), 0U);
+            EXPECT_TRUE(request.Complete(EXIT_SUCCESS));
+          }
+        }
+        // B is read over several calls.
+        int call_count {0};
+        while((call_count < 20) && (requests = inter.AcceptRequests()).empty())
+          ++call_count;
+        EXPECT_GT(call_count, 1);
+        EXPECT_EQ(requests.size(), 1U);
+        if(requests.size() == 1U)
+        {
+          EXPECT_EQ(requests[0].get_STDIN().size(),
+            static_cast<std::size_t>(kStdinLength));
+          EXPECT_TRUE(requests[0].Complete(EXIT_SUCCESS));
+        }
+      }
+      FcgiMetrics::MetricsSnapshot after {FcgiMetrics::Snapshot()};
+      EXPECT_GE(after.counter(FcgiCounter::kReadBudgetExhaustions) -
+        before.counter(FcgiCounter::kReadBudgetExhaustions), 2U);
+    }
+
+    // Case 2
+    inter_ptr->set_read_budget(0U);
+    if(!SendRequest(client_b, 2U, kStdinLength))
+      ADD_FAILURE() << std::strerror(errno);
+    else
+    {
+      std::vector<FcgiRequest> requests {inter.AcceptRequests()};
+      EXPECT_EQ(requests.size(), 1U);
+      if(requests.size() == 1U)
+      {
+        EXPECT_EQ(requests[0].get_STDIN().size(),
+          static_cast<std::size_t>(kStdinLength));
+        EXPECT_TRUE(requests[0].Complete(EXIT_SUCCESS));
+      }
+    }
+
+  };
+
+  RunCases(FcgiServerInterface::IoBackend::kSelect);
+  RunCases(FcgiServerInterface::IoBackend::kIoUring);
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "ReadBudget", __LINE__);
+}
+
+// WriteInterleaving
+//    This test examines the interleaving of the records of requests which are
+// multiplexed over a connection when one of the requests writes a response
+// which is larger than FcgiRequest::kWriteQuantum.
+//
+// Examined properties:
+// 1) A request which writes a large response releases the write mutex of the
+//    connection between quanta. The response of another request on the
+//    connection is sent before the large response was sent in full.
+// 2) The large response is received in full and in order.
+//
+// Test cases: An AF_UNIX interface which allows five requests per connection
+// and a single connection. The client does not read until both requests
+// have attempted to write.
+// 1) Request 1 writes 2 MiB to FCGI_STDOUT on a separate thread. The write
+//    blocks as the client does not read. Request 2 is completed on another
+//    thread. The client reads. The FCGI_END_REQUEST record of request 2 is
+//    received before the last FCGI_STDOUT record of request 1 which has
+//    content.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, WriteInterleaving)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+  constexpr const char*const path {"/tmp/fcgi_si_test_UNIX_interface_socket"};
+  constexpr std::size_t kResponseLength {2U * 1024U * 1024U};
+
+  struct InterfaceCreationArguments inter_args {};
+  inter_args.domain          = AF_UNIX;
+  inter_args.backlog         = 5;
+  inter_args.max_connections = 5;
+  inter_args.max_requests    = 5;
+  inter_args.app_status      = EXIT_FAILURE;
+  inter_args.unix_path       = path;
+
+  GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+  FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+  ASSERT_NE(inter_ptr, nullptr);
+
+  std::vector<FcgiRequest> requests {};
+  auto CleanUp = [&]()->void
+  {
+    requests.clear();
+    inter.CleanUp();
+  };
+
+  int client {inter.Connect()};
+  if(client == -1)
+  {
+    CleanUp();
+    return;
+  }
+  // Accept the connection.
+  inter.AcceptRequests();
+
+  // Send requests 1 and 2 with FCGI_KEEP_CONN set and empty FCGI_PARAMS and
+  // FCGI_STDIN streams.
+  std::uint8_t request_records[8 * FCGI_HEADER_LEN] = {};
+  for(std::uint16_t fcgi_id {1U}; fcgi_id <= 2U; ++fcgi_id)
+  {
+    std::uint8_t* record_ptr
+      {request_records + (fcgi_id - 1U) * 4 * FCGI_HEADER_LEN};
+    PopulateBeginRequestRecord(record_ptr, fcgi_id, FCGI_RESPONDER, true);
+    PopulateHeader(record_ptr + 2 * FCGI_HEADER_LEN, FcgiType::kFCGI_PARAMS,
+      fcgi_id, 0U, 0U);
+    PopulateHeader(record_ptr + 3 * FCGI_HEADER_LEN, FcgiType::kFCGI_STDIN,
+      fcgi_id, 0U, 0U);
+  }
+  if(write(client, request_records, 8 * FCGI_HEADER_LEN) !=
+     8 * FCGI_HEADER_LEN)
+  {
+    ADD_FAILURE() << std::strerror(errno);
+    CleanUp();
+    return;
+  }
+  requests = inter.AcceptRequests();
+  if(requests.size() != 2U)
+  {
+    ADD_FAILURE() << "Two requests were expected. Actual: " << requests.size();
+    CleanUp();
+    return;
+  }
+  FcgiRequest* request_1_ptr {&requests[0]};
+  FcgiRequest* request_2_ptr {&requests[1]};
+  if(request_1_ptr->get_request_identifier().Fcgi_id() != 1U)
+    std::swap(request_1_ptr, request_2_ptr);
+
+  // Case 1
+  std::vector<std::uint8_t> response(kResponseLength);
+  for(std::size_t i {0U}; i < kResponseLength; ++i)
+    response[i] = static_cast<std::uint8_t>(i % 251U);
+  bool write_result {false};
+  bool complete_result {false};
+  std::thread bulk_writer {[&]()->void
+    {
+      write_result = request_1_ptr->Write(response.begin(), response.end());
+    }
+  };
+  // Allow the bulk write to block with the write mutex held.
+  usleep(50000U);
+  std::thread small_writer {[&]()->void
+    {
+      complete_result = request_2_ptr->Complete(EXIT_SUCCESS);
+    }
+  };
+  usleep(50000U);
+
+  // Read until the FCGI_END_REQUEST record of request 2 and every byte of
+  // the response of request 1 were received. Records are parsed as they
+  // arrive.
+  std::vector<std::uint8_t> received {};
+  std::vector<std::uint8_t> stdout_content {};
+  std::size_t parse_position {0U};
+  std::size_t record_index {0U};
+  std::size_t end_request_2_index {0U};
+  std::size_t last_stdout_1_index {0U};
+  bool end_request_2_received {false};
+  std::uint8_t read_buffer[1U << 16];
+  alarm(5U);
+  while(!(end_request_2_received &&
+          (stdout_content.size() == kResponseLength)))
+  {
+    ssize_t read_return {read(client, read_buffer, sizeof(read_buffer))};
+    if(read_return <= 0)
+    {
+      ADD_FAILURE() << "The connection could not be read.";
+      break;
+    }
+    received.insert(received.end(), read_buffer, read_buffer + read_return);
+    while((received.size() - parse_position) >= FCGI_HEADER_LEN)
+    {
+      const std::uint8_t* header {received.data() + parse_position};
+      std::size_t content_length {(static_cast<std::size_t>(
+        header[kHeaderContentLengthB1Index]) << 8) +
+        header[kHeaderContentLengthB0Index]};
+      std::size_t record_length {FCGI_HEADER_LEN + content_length +
+        header[kHeaderPaddingLengthIndex]};
+      if((received.size() - parse_position) < record_length)
+        break;
+      std::uint16_t fcgi_id {static_cast<std::uint16_t>(
+        (header[kHeaderRequestIDB1Index] << 8) +
+         header[kHeaderRequestIDB0Index])};
+      FcgiType type {static_cast<FcgiType>(header[kHeaderTypeIndex])};
+      if((type == FcgiType::kFCGI_STDOUT) && (fcgi_id == 1U) &&
+         content_length)
+      {
+        stdout_content.insert(stdout_content.end(), header + FCGI_HEADER_LEN,
+          header + FCGI_HEADER_LEN + content_length);
+        last_stdout_1_index = record_index;
+      }
+      else if((type == FcgiType::kFCGI_END_REQUEST) && (fcgi_id == 2U))
+      {
+        end_request_2_received = true;
+        end_request_2_index = record_index;
+      }
+      parse_position += record_length;
+      ++record_index;
+    }
+  }
+  alarm(0U);
+  bulk_writer.join();
+  small_writer.join();
+
+  EXPECT_TRUE(write_result);
+  EXPECT_TRUE(complete_result);
+  EXPECT_TRUE(end_request_2_received);
+  EXPECT_LT(end_request_2_index, last_stdout_1_index);
+  EXPECT_EQ(stdout_content, response);
+  EXPECT_TRUE(request_1_ptr->Complete(EXIT_SUCCESS));
+
+  CleanUp();
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "WriteInterleaving", __LINE__);
+}
+
+// WriteCombining
+//    This test examines the combining of the writes of requests which are
+// multiplexed over a connection while the write mutex of the connection is
+// held by a request thread whose write blocks.
+//
+// Examined properties:
+// 1) A write which is made while another request thread holds the write
+//    mutex and is writing is handed over to that thread. This is observed
+//    through FcgiCounter::kCombinedWrites.
+// 2) The records of every request are received in full and without
+//    corruption.
+//
+// Test cases: An AF_UNIX interface which allows five requests per connection
+// and a single connection. The client does not read until every request has
+// attempted to write.
+// 1) Request 1 writes 2 MiB to FCGI_STDOUT on a separate thread. The write
+//    blocks as the client does not read. Requests 2, 3, and 4 each write a
+//    short response to FCGI_STDOUT on separate threads. The client reads.
+//    Every response is received intact, every write returns true, and at
+//    least one write was combined.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+// 2) FcgiMetrics
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, WriteCombining)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+  constexpr const char*const path {"/tmp/fcgi_si_test_UNIX_interface_socket"};
+  constexpr std::size_t kResponseLength {2U * 1024U * 1024U};
+  constexpr std::uint16_t kRequestCount {4U};
+
+  struct InterfaceCreationArguments inter_args {};
+  inter_args.domain          = AF_UNIX;
+  inter_args.backlog         = 5;
+  inter_args.max_connections = 5;
+  inter_args.max_requests    = 5;
+  inter_args.app_status      = EXIT_FAILURE;
+  inter_args.unix_path       = path;
+
+  GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+  FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+  ASSERT_NE(inter_ptr, nullptr);
+
+  std::vector<FcgiRequest> requests {};
+  auto CleanUp = [&]()->void
+  {
+    requests.clear();
+    inter.CleanUp();
+  };
+
+  int client {inter.Connect()};
+  if(client == -1)
+  {
+    CleanUp();
+    return;
+  }
+  // Accept the connection.
+  inter.AcceptRequests();
+
+  // Send the requests with FCGI_KEEP_CONN set and empty FCGI_PARAMS and
+  // FCGI_STDIN streams.
+  std::uint8_t request_records[kRequestCount * 4 * FCGI_HEADER_LEN] = {};
+  for(std::uint16_t fcgi_id {1U}; fcgi_id <= kRequestCount; ++fcgi_id)
+  {
+    std::uint8_t* record_ptr
+      {request_records + (fcgi_id - 1U) * 4 * FCGI_HEADER_LEN};
+    PopulateBeginRequestRecord(record_ptr, fcgi_id, FCGI_RESPONDER, true);
+    PopulateHeader(record_ptr + 2 * FCGI_HEADER_LEN, FcgiType::kFCGI_PARAMS,
+      fcgi_id, 0U, 0U);
+    PopulateHeader(record_ptr + 3 * FCGI_HEADER_LEN, FcgiType::kFCGI_STDIN,
+      fcgi_id, 0U, 0U);
+  }
+  if(write(client, request_records, sizeof(request_records)) !=
+     static_cast<ssize_t>(sizeof(request_records)))
+  {
+    ADD_FAILURE() << std::strerror(errno);
+    CleanUp();
+    return;
+  }
+  requests = inter.AcceptRequests();
+  if(requests.size() != kRequestCount)
+  {
+    ADD_FAILURE() << "Four requests were expected. Actual: "
+      << requests.size();
+    CleanUp();
+    return;
+  }
+  // Index requests by FastCGI request identifier.
+  std::vector<FcgiRequest*> request_ptrs(kRequestCount + 1U, nullptr);
+  for(FcgiRequest& request : requests)
+    request_ptrs[request.get_request_identifier().Fcgi_id()] = &request;
+
+  // Case 1
+  std::vector<std::vector<std::uint8_t>> responses(kRequestCount + 1U);
+  responses[1].resize(kResponseLength);
+  for(std::size_t i {0U}; i < kResponseLength; ++i)
+    responses[1][i] = static_cast<std::uint8_t>(i % 251U);
+  for(std::uint16_t fcgi_id {2U}; fcgi_id <= kRequestCount; ++fcgi_id)
+    responses[fcgi_id].assign(100U + fcgi_id,
+      static_cast<std::uint8_t>(fcgi_id));
+  std::uint64_t combined_before {FcgiMetrics::Snapshot().counter(
+    FcgiCounter::kCombinedWrites)};
+  // std::vector<bool> is not used as its elements are not distinct objects.
+  std::uint8_t write_results[kRequestCount + 1U] = {};
+  std::vector<std::thread> writers {};
+  auto StartWriter = [&](std::uint16_t fcgi_id)->void
+  {
+    writers.emplace_back([&, fcgi_id]()->void
+      {
+        write_results[fcgi_id] = request_ptrs[fcgi_id]->Write(
+          responses[fcgi_id].begin(), responses[fcgi_id].end());
+      }
+    );
+  };
+  StartWriter(1U);
+  // Allow the bulk write to block with the write mutex held.
+  usleep(50000U);
+  for(std::uint16_t fcgi_id {2U}; fcgi_id <= kRequestCount; ++fcgi_id)
+    StartWriter(fcgi_id);
+  usleep(50000U);
+
+  // Read until every byte of every response was received. Records are parsed
+  // as they arrive.
+  std::size_t expected_total {0U};
+  for(const std::vector<std::uint8_t>& response : responses)
+    expected_total += response.size();
+  std::vector<std::vector<std::uint8_t>> stdout_contents(kRequestCount + 1U);
+  std::size_t received_total {0U};
+  std::vector<std::uint8_t> received {};
+  std::size_t parse_position {0U};
+  std::uint8_t read_buffer[1U << 16];
+  alarm(5U);
+  while(received_total < expected_total)
+  {
+    ssize_t read_return {read(client, read_buffer, sizeof(read_buffer))};
+    if(read_return <= 0)
+    {
+      ADD_FAILURE() << "The connection could not be read.";
+      break;
+    }
+    received.insert(received.end(), read_buffer, read_buffer + read_return);
+    while((received.size() - parse_position) >= FCGI_HEADER_LEN)
+    {
+      const std::uint8_t* header {received.data() + parse_position};
+      std::size_t content_length {(static_cast<std::size_t>(
+        header[kHeaderContentLengthB1Index]) << 8) +
+        header[kHeaderContentLengthB0Index]};
+      std::size_t record_length {FCGI_HEADER_LEN + content_length +
+        header[kHeaderPaddingLengthIndex]};
+      if((received.size() - parse_position) < record_length)
+        break;
+      std::uint16_t fcgi_id {static_cast<std::uint16_t>(
+        (header[kHeaderRequestIDB1Index] << 8) +
+         header[kHeaderRequestIDB0Index])};
+      FcgiType type {static_cast<FcgiType>(header[kHeaderTypeIndex])};
+      if((type == FcgiType::kFCGI_STDOUT) && (fcgi_id >= 1U) &&
+         (fcgi_id <= kRequestCount))
+      {
+        stdout_contents[fcgi_id].insert(stdout_contents[fcgi_id].end(),
+          header + FCGI_HEADER_LEN, header + FCGI_HEADER_LEN +
+          content_length);
+        received_total += content_length;
+      }
+      else
+      {
+        ADD_FAILURE() << "An unexpected record was received.";
+      }
+      parse_position += record_length;
+    }
+  }
+  alarm(0U);
+  for(std::thread& writer : writers)
+    writer.join();
+
+  EXPECT_GE(FcgiMetrics::Snapshot().counter(FcgiCounter::kCombinedWrites),
+    combined_before + 1U);
+  for(std::uint16_t fcgi_id {1U}; fcgi_id <= kRequestCount; ++fcgi_id)
+  {
+    EXPECT_TRUE(write_results[fcgi_id]) << fcgi_id;
+    EXPECT_EQ(stdout_contents[fcgi_id], responses[fcgi_id]) << fcgi_id;
+    EXPECT_TRUE(request_ptrs[fcgi_id]->Complete(EXIT_SUCCESS)) << fcgi_id;
+  }
+
+  CleanUp();
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "WriteCombining", __LINE__);
+}
+
+// AbortNotification
+//    This test examines the abort signal of FcgiRequest objects which is
+// observed through AbortRequested and SetAbortCallback.
+//
+// Examined properties:
+// 1) AbortRequested returns false until an abort is signaled.
+// 2) An abort is signaled when an FCGI_ABORT_REQUEST record is processed for
+//    an assigned request, when the interface closes the connection of a
+//    request, and when the interface is destroyed.
+// 3) A registered callback is invoked once per signaled abort. A callback
+//    which is registered after notification is invoked by the registering
+//    thread.
+// 4) AbortStatus agrees with AbortRequested after an FCGI_ABORT_REQUEST
+//    record was processed.
+// 5) Default-constructed requests are never signaled.
+// 6) ConnectionClosed returns true only when the abort was signaled because
+//    the interface closed the connection of the request or was destroyed.
+//
+// Test cases: An AF_UNIX interface which allows five requests per connection.
+// 1) A request is assigned and a callback is registered. An
+//    FCGI_ABORT_REQUEST record is sent for the request. After AcceptRequests
+//    returns, AbortRequested and AbortStatus return true and the callback
+//    was invoked once. A second callback is invoked by SetAbortCallback.
+// 2) A request is assigned and a callback is registered. The client closes
+//    the connection. After the interface closed the connection,
+//    AbortRequested returns true and the callback was invoked once.
+// 3) A request is assigned and a callback is registered. The interface is
+//    destroyed. AbortRequested returns true and the callback was invoked
+//    once.
+// 4) A default-constructed request.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, AbortNotification)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+  constexpr const char*const path {"/tmp/fcgi_si_test_UNIX_interface_socket"};
+
+  struct InterfaceCreationArguments inter_args {};
+  inter_args.domain          = AF_UNIX;
+  inter_args.backlog         = 5;
+  inter_args.max_connections = 5;
+  inter_args.max_requests    = 5;
+  inter_args.app_status      = EXIT_FAILURE;
+  inter_args.unix_path       = path;
+
+  GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+  FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+  ASSERT_NE(inter_ptr, nullptr);
+
+  int client {-1};
+  std::vector<FcgiRequest> requests {};
+  auto CleanUp = [&]()->void
+  {
+    requests.clear();
+    inter.CleanUp();
+  };
+
+  // Connects a new client and sends a request with FCGI_KEEP_CONN set and
+  // empty FCGI_PARAMS and FCGI_STDIN streams. The request object is the only
+  // element of requests.
+  auto AssignRequest = [&]()->bool
+  {
+    if(client != -1)
+      inter.CloseClient(client);
+    client = inter.Connect();
+    if(client == -1)
+      return false;
+    inter.AcceptRequests();
+    std::uint8_t request_records[4 * FCGI_HEADER_LEN] = {};
+    PopulateBeginRequestRecord(request_records, 1U, FCGI_RESPONDER, true);
+    PopulateHeader(request_records + 2 * FCGI_HEADER_LEN,
+      FcgiType::kFCGI_PARAMS, 1U, 0U, 0U);
+    PopulateHeader(request_records + 3 * FCGI_HEADER_LEN,
+      FcgiType::kFCGI_STDIN, 1U, 0U, 0U);
+    if(write(client, request_records, sizeof(request_records)) !=
+       static_cast<ssize_t>(sizeof(request_records)))
+    {
+      ADD_FAILURE() << std::strerror(errno);
+      return false;
+    }
+    requests = inter.AcceptRequests();
+    if(requests.size() != 1U)
+    {
+      ADD_FAILURE() << "One request was expected. Actual: "
+        << requests.size();
+      return false;
+    }
+    return true;
+  };
+
+  // Case 1
+  if(!AssignRequest())
+  {
+    CleanUp();
+    return;
+  }
+  {
+    FcgiRequest& request {requests[0]};
+    int callback_count {0};
+    EXPECT_FALSE(request.AbortRequested());
+    request.SetAbortCallback([&callback_count]()->void {++callback_count;});
+    std::uint8_t abort_record[FCGI_HEADER_LEN] = {};
+    PopulateHeader(abort_record, FcgiType::kFCGI_ABORT_REQUEST, 1U, 0U, 0U);
+    if(write(client, abort_record, FCGI_HEADER_LEN) != FCGI_HEADER_LEN)
+    {
+      ADD_FAILURE() << std::strerror(errno);
+      CleanUp();
+      return;
+    }
+    EXPECT_EQ(inter.AcceptRequests().size(), 0U);
+    EXPECT_TRUE(request.AbortRequested());
+    EXPECT_FALSE(request.ConnectionClosed());
+    EXPECT_EQ(callback_count, 1);
+    EXPECT_TRUE(request.AbortStatus());
+    int late_callback_count {0};
+    request.SetAbortCallback([&late_callback_count]()->void
+      {++late_callback_count;});
+    EXPECT_EQ(late_callback_count, 1);
+    EXPECT_EQ(callback_count, 1);
+    EXPECT_TRUE(request.Complete(EXIT_SUCCESS));
+  }
+
+  // Case 2
+  if(!AssignRequest())
+  {
+    CleanUp();
+    return;
+  }
+  {
+    FcgiRequest& request {requests[0]};
+    int callback_count {0};
+    request.SetAbortCallback([&callback_count]()->void {++callback_count;});
+    inter.CloseClient(client);
+    client = -1;
+    // The first call reads the closure and schedules the connection for
+    // closure. The connection is closed at the start of the next call. A
+    // new connection is made so that the next call does not block.
+    inter.AcceptRequests();
+    EXPECT_FALSE(request.AbortRequested());
+    client = inter.Connect();
+    if(client == -1)
+    {
+      CleanUp();
+      return;
+    }
+    inter.AcceptRequests();
+    EXPECT_TRUE(request.AbortRequested());
+    EXPECT_TRUE(request.ConnectionClosed());
+    EXPECT_EQ(callback_count, 1);
+    EXPECT_TRUE(request.AbortStatus());
+    EXPECT_FALSE(request.Complete(EXIT_SUCCESS));
+  }
+
+  // Case 3
+  if(!AssignRequest())
+  {
+    CleanUp();
+    return;
+  }
+  {
+    int callback_count {0};
+    requests[0].SetAbortCallback([&callback_count]()->void
+      {++callback_count;});
+    inter.DestroyInterface();
+    EXPECT_TRUE(requests[0].AbortRequested());
+    EXPECT_TRUE(requests[0].ConnectionClosed());
+    EXPECT_EQ(callback_count, 1);
+    requests.clear();
+    EXPECT_EQ(callback_count, 1);
+  }
+
+  // Case 4
+  {
+    FcgiRequest request {};
+    bool invoked {false};
+    request.SetAbortCallback([&invoked]()->void {invoked = true;});
+    EXPECT_FALSE(request.AbortRequested());
+    EXPECT_FALSE(request.ConnectionClosed());
+    EXPECT_FALSE(invoked);
+  }
+
+  CleanUp();
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "AbortNotification", __LINE__);
+}
+
+// ResponseReactor
+//    This test examines the transmission of responses by a ResponseReactor.
+//
+// Examined properties:
+// 1) A request whose peer does not read does not prevent the response of
+//    another request from being sent.
+// 2) Responses are received in full and in order. Completion is sent after
+//    the output of a request.
+// 3) Completion callbacks are invoked with the results of operations.
+// 4) Operations for unknown handles and for completed requests are rejected.
+// 5) Operations of a request whose connection was closed by the interface
+//    fail and the request is removed. The descriptor of the connection is
+//    not polled after the abort of the request was signaled.
+// 6) Run returns after Stop.
+//
+// Test cases: An AF_UNIX interface and two connections with one request
+// each. The requests are adopted by a reactor with the default chunk size.
+// RunOnce is called by the test thread.
+// 1) 2 MiB is enqueued for request 1 and its client does not read. A short
+//    response and completion are enqueued for request 2. The reactor is run
+//    until request 2 is complete. Then client 2 reads its response, and the
+//    reactor is run while client 1 reads until request 1 is complete.
+// 2) Write and Complete are called with the handle of a completed request
+//    and with a handle which was not returned by Adopt.
+// 3) A third client sends a request which is adopted. A write and completion
+//    are enqueued. The client closes its socket and the interface closes the
+//    connection. The reactor is run until the callbacks are invoked.
+// 4) Run is called on a separate thread and Stop is called.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, ResponseReactor)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+  constexpr const char*const path {"/tmp/fcgi_si_test_UNIX_interface_socket"};
+  constexpr std::size_t kResponseLength {2U * 1024U * 1024U};
+
+  struct InterfaceCreationArguments inter_args {};
+  inter_args.domain          = AF_UNIX;
+  inter_args.backlog         = 5;
+  inter_args.max_connections = 5;
+  inter_args.max_requests    = 5;
+  inter_args.app_status      = EXIT_FAILURE;
+  inter_args.unix_path       = path;
+
+  GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+  FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+  ASSERT_NE(inter_ptr, nullptr);
+
+  int clients[3] = {-1, -1, -1};
+  std::unique_ptr<ResponseReactor> reactor_ptr {};
+  auto CleanUp = [&]()->void
+  {
+    reactor_ptr.reset();
+    inter.CleanUp();
+  };
+
+  // Connect both clients and send a request with FCGI_KEEP_CONN set and
+  // empty FCGI_PARAMS and FCGI_STDIN streams on each.
+  std::uint8_t request_records[4 * FCGI_HEADER_LEN] = {};
+  PopulateBeginRequestRecord(request_records, 1U, FCGI_RESPONDER, true);
+  PopulateHeader(request_records + 2 * FCGI_HEADER_LEN,
+    FcgiType::kFCGI_PARAMS, 1U, 0U, 0U);
+  PopulateHeader(request_records + 3 * FCGI_HEADER_LEN,
+    FcgiType::kFCGI_STDIN, 1U, 0U, 0U);
+  std::vector<FcgiRequest> requests {};
+  // The third client is used by case 3.
+  for(int index {0}; index < 2; ++index)
+  {
+    int& client {clients[index]};
+    client = inter.Connect();
+    if(client == -1)
+    {
+      CleanUp();
+      return;
+    }
+    inter.AcceptRequests();
+    if(write(client, request_records, sizeof(request_records)) !=
+       static_cast<ssize_t>(sizeof(request_records)))
+    {
+      ADD_FAILURE() << std::strerror(errno);
+      CleanUp();
+      return;
+    }
+    std::vector<FcgiRequest> new_requests {inter.AcceptRequests()};
+    if(new_requests.size() != 1U)
+    {
+      ADD_FAILURE() << "One request was expected. Actual: "
+        << new_requests.size();
+      CleanUp();
+      return;
+    }
+    requests.push_back(std::move(new_requests[0]));
+  }
+
+  reactor_ptr = std::make_unique<ResponseReactor>();
+  ResponseReactor::Handle handles[2] = {
+    reactor_ptr->Adopt(std::move(requests[0])),
+    reactor_ptr->Adopt(std::move(requests[1]))};
+  EXPECT_EQ(reactor_ptr->size(), 2U);
+
+  // Reads what is available on a client and parses the complete records
+  // which were received. Returns false if the client could not be read.
+  struct ClientState
+  {
+    std::vector<std::uint8_t> received {};
+    std::size_t               parse_position {0U};
+    std::vector<std::uint8_t> stdout_content {};
+    bool                      ended {false};
+  };
+  ClientState client_states[2] {};
+  auto ReadAvailable = [&](int index)->bool
+  {
+    ClientState& state {client_states[index]};
+    std::uint8_t read_buffer[1U << 16];
+    while(true)
+    {
+      ssize_t read_return {recv(clients[index], read_buffer,
+        sizeof(read_buffer), MSG_DONTWAIT)};
+      if(read_return > 0)
+      {
+        state.received.insert(state.received.end(), read_buffer,
+          read_buffer + read_return);
+        continue;
+      }
+      if((read_return == -1) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+        break;
+      ADD_FAILURE() << "The connection could not be read.";
+      return false;
+    }
+    while((state.received.size() - state.parse_position) >= FCGI_HEADER_LEN)
+    {
+      const std::uint8_t* header
+        {state.received.data() + state.parse_position};
+      std::size_t content_length {(static_cast<std::size_t>(
+        header[kHeaderContentLengthB1Index]) << 8) +
+        header[kHeaderContentLengthB0Index]};
+      std::size_t record_length {FCGI_HEADER_LEN + content_length +
+        header[kHeaderPaddingLengthIndex]};
+      if((state.received.size() - state.parse_position) < record_length)
+        break;
+      FcgiType type {static_cast<FcgiType>(header[kHeaderTypeIndex])};
+      if(type == FcgiType::kFCGI_STDOUT)
+      {
+        if(state.ended)
+          ADD_FAILURE() << "FCGI_STDOUT content followed FCGI_END_REQUEST.";
+        state.stdout_content.insert(state.stdout_content.end(),
+          header + FCGI_HEADER_LEN, header + FCGI_HEADER_LEN +
+          content_length);
+      }
+      else if(type == FcgiType::kFCGI_END_REQUEST)
+        state.ended = true;
+      state.parse_position += record_length;
+    }
+    return true;
+  };
+
+  // Case 1
+  std::vector<std::uint8_t> responses[2] {
+    std::vector<std::uint8_t>(kResponseLength),
+    std::vector<std::uint8_t>(100U, 2U)};
+  for(std::size_t i {0U}; i < kResponseLength; ++i)
+    responses[0][i] = static_cast<std::uint8_t>(i % 251U);
+  int results[2][2] = {{-1, -1}, {-1, -1}};
+  for(int index {0}; index < 2; ++index)
+  {
+    EXPECT_TRUE(reactor_ptr->Write(handles[index], responses[index],
+      [&results, index](bool result)->void
+      {
+        results[index][0] = result;
+      }
+    ));
+  }
+  EXPECT_TRUE(reactor_ptr->Complete(handles[1], EXIT_SUCCESS,
+    [&results](bool result)->void {results[1][1] = result;}));
+  alarm(5U);
+  while(results[1][1] == -1)
+    reactor_ptr->RunOnce(100);
+  EXPECT_EQ(results[1][0], 1);
+  EXPECT_EQ(results[1][1], 1);
+  // Request 1 cannot have been sent in full as client 1 did not read.
+  EXPECT_EQ(results[0][0], -1);
+  EXPECT_EQ(reactor_ptr->size(), 1U);
+  EXPECT_TRUE(ReadAvailable(1));
+  EXPECT_TRUE(client_states[1].ended);
+  EXPECT_EQ(client_states[1].stdout_content, responses[1]);
+
+  EXPECT_TRUE(reactor_ptr->Complete(handles[0], EXIT_SUCCESS,
+    [&results](bool result)->void {results[0][1] = result;}));
+  while(!client_states[0].ended)
+  {
+    reactor_ptr->RunOnce(10);
+    if(!ReadAvailable(0))
+      break;
+  }
+  alarm(0U);
+  EXPECT_EQ(results[0][0], 1);
+  EXPECT_EQ(results[0][1], 1);
+  EXPECT_EQ(client_states[0].stdout_content, responses[0]);
+  EXPECT_EQ(reactor_ptr->size(), 0U);
+
+  // Case 2
+  EXPECT_FALSE(reactor_ptr->Write(handles[0], responses[1]));
+  EXPECT_FALSE(reactor_ptr->Complete(handles[1], EXIT_SUCCESS));
+  EXPECT_FALSE(reactor_ptr->Write(handles[1] + 1U, responses[1]));
+
+  // Case 3
+  // Closure is observed by one call of AcceptRequests and processed at the
+  // start of the next call. An FCGI_GET_VALUES record on client 1 wakes the
+  // second call.
+  clients[2] = inter.Connect();
+  if(clients[2] == -1)
+  {
+    CleanUp();
+    return;
+  }
+  inter.AcceptRequests();
+  if(write(clients[2], request_records, sizeof(request_records)) !=
+     static_cast<ssize_t>(sizeof(request_records)))
+  {
+    ADD_FAILURE() << std::strerror(errno);
+    CleanUp();
+    return;
+  }
+  std::vector<FcgiRequest> closure_requests {inter.AcceptRequests()};
+  if(closure_requests.size() != 1U)
+  {
+    ADD_FAILURE() << "One request was expected. Actual: "
+      << closure_requests.size();
+    CleanUp();
+    return;
+  }
+  ResponseReactor::Handle closure_handle
+    {reactor_ptr->Adopt(std::move(closure_requests[0]))};
+  int closure_results[2] = {-1, -1};
+  EXPECT_TRUE(reactor_ptr->Write(closure_handle, responses[1],
+    [&closure_results](bool result)->void {closure_results[0] = result;}));
+  EXPECT_TRUE(reactor_ptr->Complete(closure_handle, EXIT_SUCCESS,
+    [&closure_results](bool result)->void {closure_results[1] = result;}));
+  inter.CloseClient(clients[2]);
+  clients[2] = -1;
+  inter.AcceptRequests();
+  std::uint8_t get_values[FCGI_HEADER_LEN] = {};
+  PopulateHeader(get_values, FcgiType::kFCGI_GET_VALUES, 0U, 0U, 0U);
+  if(write(clients[0], get_values, sizeof(get_values)) !=
+     static_cast<ssize_t>(sizeof(get_values)))
+    ADD_FAILURE() << std::strerror(errno);
+  inter.AcceptRequests();
+  // A bounded number of runs is used so that a request which is never
+  // stepped causes a failure instead of a hang.
+  for(int run_count {0}; (run_count < 100) && (closure_results[1] == -1);
+      ++run_count)
+    reactor_ptr->RunOnce(10);
+  EXPECT_EQ(closure_results[0], 0);
+  EXPECT_EQ(closure_results[1], 0);
+  EXPECT_EQ(reactor_ptr->size(), 0U);
+  // The connection is released by the interface once its request was
+  // removed.
+  if(write(clients[0], get_values, sizeof(get_values)) !=
+     static_cast<ssize_t>(sizeof(get_values)))
+    ADD_FAILURE() << std::strerror(errno);
+  inter.AcceptRequests();
+  EXPECT_EQ(inter_ptr->connection_count(), 2U);
+
+  // Case 4
+  std::thread run_thread {[&reactor_ptr]()->void {reactor_ptr->Run();}};
+  reactor_ptr->Stop();
+  run_thread.join();
+
+  CleanUp();
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "ResponseReactor", __LINE__);
+}
+
+// LoopbackConnection
+//    This test examines connections which are created by
+// CreateLoopbackConnection.
+//
+// Examined properties:
+// 1) A request which is sent on a loopback connection is accepted and its
+//    response is received on the returned descriptor.
+// 2) Loopback connections are counted by connection_count and by the
+//    connection acceptance counters.
+// 3) -1 is returned when the maximum connection count is met and when the
+//    interface is overloaded.
+// 4) Closure of the returned descriptor causes the interface to close its
+//    end of the connection.
+//
+// Test cases: An AF_UNIX interface with a maximum connection count of two
+// for each of IoBackend::kSelect and IoBackend::kIoUring.
+// 1) Two loopback connections are created and a third call is checked to
+//    return -1. A request is sent on the second connection, accepted, and
+//    completed. The FCGI_END_REQUEST record is read from the descriptor.
+// 2) The first descriptor is closed. After calls of AcceptRequests, the
+//    connection count is one.
+// 3) The interface is put into an overloaded state and a call is checked to
+//    return -1.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, LoopbackConnection)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+  constexpr const char*const path {"/tmp/fcgi_si_test_UNIX_interface_socket"};
+
+  auto RunCases = [&](FcgiServerInterface::IoBackend backend)->void
+  {
+    struct InterfaceCreationArguments inter_args {};
+    inter_args.domain          = AF_UNIX;
+    inter_args.backlog         = 5;
+    inter_args.max_connections = 2;
+    inter_args.max_requests    = 5;
+    inter_args.app_status      = EXIT_FAILURE;
+    inter_args.unix_path       = path;
+    inter_args.io_backend      = backend;
+
+    GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+    FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+    if((inter_ptr == nullptr) || (inter_ptr->io_backend() != backend))
+      return;
+
+    // Case 1
+    FcgiServerInterface::ConnectionAcceptanceCounters initial_counters
+      {inter_ptr->connection_acceptance_counters()};
+    int loopbacks[2] = {inter.ConnectLoopback(), inter.ConnectLoopback()};
+    if((loopbacks[0] == -1) || (loopbacks[1] == -1))
+      return;
+    EXPECT_EQ(inter_ptr->connection_count(), 2U);
+    EXPECT_EQ(inter_ptr->CreateLoopbackConnection(), -1);
+    FcgiServerInterface::ConnectionAcceptanceCounters counters
+      {inter_ptr->connection_acceptance_counters()};
+    EXPECT_EQ(counters.accepted - initial_counters.accepted, 2U);
+    EXPECT_EQ(counters.rejected_for_load - initial_counters.rejected_for_load,
+      1U);
+
+    std::uint8_t request_records[4 * FCGI_HEADER_LEN] = {};
+    PopulateBeginRequestRecord(request_records, 1U, FCGI_RESPONDER, true);
+    PopulateHeader(request_records + 2 * FCGI_HEADER_LEN,
+      FcgiType::kFCGI_PARAMS, 1U, 0U, 0U);
+    PopulateHeader(request_records + 3 * FCGI_HEADER_LEN,
+      FcgiType::kFCGI_STDIN, 1U, 0U, 0U);
+    if(write(loopbacks[1], request_records, sizeof(request_records)) !=
+       static_cast<ssize_t>(sizeof(request_records)))
+    {
+      ADD_FAILURE() << std::strerror(errno);
+      return;
+    }
+    std::vector<FcgiRequest> requests {inter.AcceptRequests()};
+    if(requests.size() != 1U)
+    {
+      ADD_FAILURE() << "One request was expected. Actual: "
+        << requests.size();
+      return;
+    }
+    EXPECT_TRUE(requests[0].Complete(0));
+    // The response is the terminal FCGI_STDOUT and FCGI_STDERR records and
+    // FCGI_END_REQUEST.
+    std::uint8_t response[4 * FCGI_HEADER_LEN] = {};
+    std::size_t received {0U};
+    while(received < sizeof(response))
+    {
+      alarm(1U);
+      ssize_t read_return {read(loopbacks[1], response + received,
+        sizeof(response) - received)};
+      alarm(0U);
+      if(read_return <= 0)
+        break;
+      received += static_cast<std::size_t>(read_return);
+    }
+    EXPECT_EQ(received, sizeof(response));
+    if(received == sizeof(response))
+    {
+      EXPECT_EQ(response[1],
+        static_cast<std::uint8_t>(FcgiType::kFCGI_STDOUT));
+      EXPECT_EQ(response[2 * FCGI_HEADER_LEN + 1],
+        static_cast<std::uint8_t>(FcgiType::kFCGI_END_REQUEST));
+    }
+
+    // Case 2
+    // Closure is observed by one call of AcceptRequests and processed at the
+    // start of the next call. An FCGI_GET_VALUES record wakes the second call.
+    inter.CloseClient(loopbacks[0]);
+    loopbacks[0] = -1;
+    inter.AcceptRequests();
+    std::uint8_t get_values[FCGI_HEADER_LEN] = {};
+    PopulateHeader(get_values, FcgiType::kFCGI_GET_VALUES, 0U, 0U, 0U);
+    if(write(loopbacks[1], get_values, sizeof(get_values)) !=
+       static_cast<ssize_t>(sizeof(get_values)))
+      ADD_FAILURE() << std::strerror(errno);
+    inter.AcceptRequests();
+    EXPECT_EQ(inter_ptr->connection_count(), 1U);
+
+    // Case 3
+    inter_ptr->set_overload(true);
+    EXPECT_EQ(inter_ptr->CreateLoopbackConnection(), -1);
+    inter_ptr->set_overload(false);
+  };
+
+  RunCases(FcgiServerInterface::IoBackend::kSelect);
+  RunCases(FcgiServerInterface::IoBackend::kIoUring);
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "LoopbackConnection", __LINE__);
+}
+
+// DirectStreamReads
+//    This test examines the receipt of FCGI_STDIN and FCGI_DATA content which
+// is large enough to be read directly into the streams of a request. Both I/O
+// backends are examined. The kIoUring cases are skipped if io_uring is not
+// available.
+//
+// Examined properties:
+// 1) Stream content which spans several records, which has padding, and which
+//    is split across reads is received in full and in order.
+// 2) The records of the streams of requests which are multiplexed over a
+//    connection are placed in the streams of the correct requests.
+// 3) FCGI_STDIN storage is reserved from the CONTENT_LENGTH value of
+//    FCGI_PARAMS. The reservation is limited to the content which was
+//    declared. A CONTENT_LENGTH value which is not a decimal integer is
+//    ignored.
+// 4) FcgiCounter::kBytesRead counts the bytes which were read directly.
+//
+// Test cases: An AF_INET interface which allows five requests per connection
+// and a single loopback connection. The records of a case are written by a
+// separate thread as the interface may need to read while they are written.
+// 1) A Filter request with CONTENT_LENGTH 150000. FCGI_STDIN is sent in
+//    records with content lengths 65535, 65535, and 18930 and with padding.
+//    FCGI_DATA is sent in one record with content length 3000. The capacity
+//    of the FCGI_STDIN stream of the request is 150000.
+// 2) Two Responder requests whose FCGI_STDIN records of 40000 bytes alternate.
+//    Request 1 has CONTENT_LENGTH 120000 and request 2 has CONTENT_LENGTH
+//    "12a". Each request has distinct content.
+// 3) A Responder request whose single FCGI_STDIN record of 60000 bytes is
+//    written in parts of 700 and 59300 bytes with a call of AcceptRequests
+//    after the first part.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+// 2) FcgiMetrics
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, DirectStreamReads)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+
+  // The content of a stream is a pattern which depends on seed.
+  auto Pattern = [](std::size_t length, std::uint8_t seed)
+    ->std::vector<std::uint8_t>
+  {
+    std::vector<std::uint8_t> content(length);
+    for(std::size_t i {0U}; i < length; ++i)
+      content[i] = static_cast<std::uint8_t>((7U * i) + seed);
+    return content;
+  };
+  // Appends a record with padding_length bytes of padding.
+  auto AppendRecord = [](std::vector<std::uint8_t>* records_ptr,
+    FcgiType type, std::uint16_t fcgi_id, const std::uint8_t* content,
+    std::uint16_t content_length, std::uint8_t padding_length)->void
+  {
+    std::size_t offset {records_ptr->size()};
+    records_ptr->resize(offset + FCGI_HEADER_LEN + content_length +
+      padding_length, 0U);
+    PopulateHeader(records_ptr->data() + offset, type, fcgi_id,
+      content_length, padding_length);
+    std::copy(content, content + content_length,
+      records_ptr->data() + offset + FCGI_HEADER_LEN);
+  };
+  // Appends FCGI_BEGIN_REQUEST and a complete FCGI_PARAMS stream which
+  // defines CONTENT_LENGTH. value must be shorter than 128 bytes.
+  auto AppendBeginAndParams = [&](std::vector<std::uint8_t>* records_ptr,
+    std::uint16_t fcgi_id, std::uint16_t role, const std::string& value)
+    ->void
+  {
+    std::size_t offset {records_ptr->size()};
+    records_ptr->resize(offset + 2 * FCGI_HEADER_LEN, 0U);
+    PopulateBeginRequestRecord(records_ptr->data() + offset, fcgi_id, role,
+      true);
+    const std::string name {"CONTENT_LENGTH"};
+    std::vector<std::uint8_t> params {static_cast<std::uint8_t>(name.size()),
+      static_cast<std::uint8_t>(value.size())};
+    params.insert(params.end(), name.begin(), name.end());
+    params.insert(params.end(), value.begin(), value.end());
+    AppendRecord(records_ptr, FcgiType::kFCGI_PARAMS, fcgi_id, params.data(),
+      static_cast<std::uint16_t>(params.size()), 3U);
+    AppendRecord(records_ptr, FcgiType::kFCGI_PARAMS, fcgi_id, nullptr, 0U,
+      0U);
+  };
+
+  auto RunCases = [&](FcgiServerInterface::IoBackend backend)->void
+  {
+    struct InterfaceCreationArguments inter_args {};
+    inter_args.domain          = AF_INET;
+    inter_args.backlog         = 5;
+    inter_args.max_connections = 1;
+    inter_args.max_requests    = 5;
+    inter_args.app_status      = EXIT_FAILURE;
+    inter_args.unix_path       = nullptr;
+    inter_args.io_backend      = backend;
+
+    // The listening socket is not used.
+    GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+    FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+    if((inter_ptr == nullptr) || (inter_ptr->io_backend() != backend))
+      return;
+    int client {inter.ConnectLoopback()};
+    if(client == -1)
+      return;
+
+    // Writes records on a separate thread and calls AcceptRequests until
+    // request_count requests were produced or a call limit is reached.
+    auto SendAndAccept = [&](const std::vector<std::uint8_t>& records,
+      std::size_t request_count)->std::vector<FcgiRequest>
+    {
+      bool written {false};
+      std::thread writer {[&]()->void
+      {
+        written = (socket_functions::WriteOnSelect(client, records.data(),
+          records.size(), nullptr) == records.size());
+      }};
+      std::vector<FcgiRequest> requests {};
+      for(int i {0}; (i < 50) && (requests.size() < request_count); ++i)
+      {
+        std::vector<FcgiRequest> new_requests {inter.AcceptRequests()};
+        for(FcgiRequest& request : new_requests)
+          requests.push_back(std::move(request));
+      }
+      writer.join();
+      EXPECT_TRUE(written) << std::strerror(errno);
+      EXPECT_EQ(requests.size(), request_count);
+      return requests;
+    };
+
+    // Case 1
+    {
+      FcgiMetrics::MetricsSnapshot before {FcgiMetrics::Snapshot()};
+      std::vector<std::uint8_t> stdin_content {Pattern(150000U, 1U)};
+      std::vector<std::uint8_t> data_content  {Pattern(3000U, 2U)};
+      std::vector<std::uint8_t> records {};
+      AppendBeginAndParams(&records, 1U, FCGI_FILTER, "150000");
+      AppendRecord(&records, FcgiType::kFCGI_STDIN, 1U,
+        stdin_content.data(), 65535U, 1U);
+      AppendRecord(&records, FcgiType::kFCGI_STDIN, 1U,
+        stdin_content.data() + 65535U, 65535U, 7U);
+      AppendRecord(&records, FcgiType::kFCGI_STDIN, 1U,
+        stdin_content.data() + 131070U, 18930U, 6U);
+      AppendRecord(&records, FcgiType::kFCGI_STDIN, 1U, nullptr, 0U, 0U);
+      AppendRecord(&records, FcgiType::kFCGI_DATA, 1U, data_content.data(),
+        3000U, 0U);
+      AppendRecord(&records, FcgiType::kFCGI_DATA, 1U, nullptr, 0U, 0U);
+      std::vector<FcgiRequest> requests {SendAndAccept(records, 1U)};
+      if(requests.size() == 1U)
+      {
+        EXPECT_EQ(requests[0].get_STDIN(), stdin_content);
+        EXPECT_EQ(requests[0].get_STDIN().capacity(), stdin_content.size());
+        EXPECT_EQ(requests[0].get_DATA(), data_content);
+        EXPECT_TRUE(requests[0].Complete(EXIT_SUCCESS));
+      }
+      FcgiMetrics::MetricsSnapshot after {FcgiMetrics::Snapshot()};
+      EXPECT_EQ(after.counter(FcgiCounter::kBytesRead) -
+        before.counter(FcgiCounter::kBytesRead), records.size());
+    }
+
+    // Case 2
+    {
+      std::vector<std::uint8_t> content_1 {Pattern(120000U, 3U)};
+      std::vector<std::uint8_t> content_2 {Pattern(120000U, 4U)};
+      std::vector<std::uint8_t> records {};
+      AppendBeginAndParams(&records, 1U, FCGI_RESPONDER, "120000");
+      AppendBeginAndParams(&records, 2U, FCGI_RESPONDER, "12a");
+      for(std::size_t offset {0U}; offset < 120000U; offset += 40000U)
+      {
+        AppendRecord(&records, FcgiType::kFCGI_STDIN, 1U,
+          content_1.data() + offset, 40000U, 0U);
+        AppendRecord(&records, FcgiType::kFCGI_STDIN, 2U,
+          content_2.data() + offset, 40000U, 2U);
+      }
+      AppendRecord(&records, FcgiType::kFCGI_STDIN, 1U, nullptr, 0U, 0U);
+      AppendRecord(&records, FcgiType::kFCGI_STDIN, 2U, nullptr, 0U, 0U);
+      std::vector<FcgiRequest> requests {SendAndAccept(records, 2U)};
+      for(FcgiRequest& request : requests)
+      {
+        std::uint16_t fcgi_id
+          {request.get_request_identifier().Fcgi_id()};
+        EXPECT_EQ(request.get_STDIN(), (fcgi_id == 1U) ? content_1 :
+          content_2);
+        if(fcgi_id == 1U)
+        {
+          EXPECT_EQ(request.get_STDIN().capacity(), content_1.size());
+        }
+        EXPECT_TRUE(request.Complete(EXIT_SUCCESS));
+      }
+    }
+
+    // Case 3
+    {
+      std::vector<std::uint8_t> content {Pattern(60000U, 5U)};
+      std::vector<std::uint8_t> records {};
+      AppendBeginAndParams(&records, 1U, FCGI_RESPONDER, "60000");
+      std::size_t first_part_end {records.size() + FCGI_HEADER_LEN + 700U};
+      AppendRecord(&records, FcgiType::kFCGI_STDIN, 1U, content.data(),
+        60000U, 0U);
+      AppendRecord(&records, FcgiType::kFCGI_STDIN, 1U, nullptr, 0U, 0U);
+      if(socket_functions::WriteOnSelect(client, records.data(),
+        first_part_end, nullptr) != first_part_end)
+        ADD_FAILURE() << std::strerror(errno);
+      else
+      {
+        EXPECT_EQ(inter.AcceptRequests().size(), 0U);
+        std::vector<std::uint8_t> second_part(records.begin() +
+          first_part_end, records.end());
+        std::vector<FcgiRequest> requests {SendAndAccept(second_part, 1U)};
+        if(requests.size() == 1U)
+        {
+          EXPECT_EQ(requests[0].get_STDIN(), content);
+          EXPECT_TRUE(requests[0].Complete(EXIT_SUCCESS));
+        }
+      }
+    }
+
+  };
+
+  RunCases(FcgiServerInterface::IoBackend::kSelect);
+  RunCases(FcgiServerInterface::IoBackend::kIoUring);
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "DirectStreamReads", __LINE__);
+}
+
+// IncrementalParamsParsing
+//    This test examines the parsing of the FCGI_PARAMS stream of a request as
+// its records are received. Both I/O backends are examined. The kIoUring
+// cases are skipped if io_uring is not available.
+//
+// Examined properties:
+// 1) Name-value pairs which straddle records are parsed. This includes pairs
+//    whose four-byte lengths are split across records.
+// 2) A repeated definition which is identical to the first definition is
+//    accepted.
+// 3) A request whose FCGI_PARAMS stream has distinct definitions for the same
+//    variable is rejected with FCGI_REQUEST_COMPLETE and the application
+//    status which is used for rejection (EXIT_FAILURE).
+// 4) A request whose FCGI_PARAMS stream ends with a partial pair is rejected
+//    as in 3.
+// 5) FcgiRequest::Param returns the value in the environment map of a
+//    well-known variable which was defined and null for one which was not.
+//    The result remains valid after the request is moved.
+//
+// Test cases: An AF_INET interface which allows five requests per connection
+// and a single loopback connection. Every request is a Responder request with
+// an empty FCGI_STDIN stream.
+// 1) The pairs {"A", "1"}, {"LONG", 200 bytes}, {"A", "1"}, {"B", ""}, and
+//    {"REQUEST_METHOD", "GET"} are sent in FCGI_PARAMS records with three
+//    bytes of content each.
+// 2) The pairs {"A", "1"} and {"A", "2"} are sent in one record.
+// 3) The pair {"A", "1"} and the first byte of another pair are sent in one
+//    record.
+//
+// Modules which testing depends on:
+// 1) GTestNonFatalInterfaceAndBlockingClients
+// 2) FcgiWellKnownParams
+//
+// Other modules whose testing depends on this module: none.
+TEST(FcgiServerInterface, IncrementalParamsParsing)
+{
+  testing::FileDescriptorLeakChecker fdlc {};
+
+  using ByteSequence = std::vector<std::uint8_t>;
+  // Appends a name-value pair to params. A length which is larger than 127
+  // is encoded in four bytes.
+  auto AppendPair = [](ByteSequence* params_ptr, const std::string& name,
+    const ByteSequence& value)->void
+  {
+    for(std::size_t length : {name.size(), value.size()})
+    {
+      if(length <= 127U)
+        params_ptr->push_back(static_cast<std::uint8_t>(length));
+      else
+      {
+        params_ptr->push_back(static_cast<std::uint8_t>((length >> 24) |
+          0x80U));
+        params_ptr->push_back(static_cast<std::uint8_t>(length >> 16));
+        params_ptr->push_back(static_cast<std::uint8_t>(length >> 8));
+        params_ptr->push_back(static_cast<std::uint8_t>(length));
+      }
+    }
+    params_ptr->insert(params_ptr->end(), name.begin(), name.end());
+    params_ptr->insert(params_ptr->end(), value.begin(), value.end());
+  };
+  // Produces the records of a request whose FCGI_PARAMS content is params.
+  // The content is sent in records with at most record_length bytes.
+  auto RequestRecords = [](std::uint16_t fcgi_id, const ByteSequence& params,
+    std::size_t record_length)->ByteSequence
+  {
+    ByteSequence records(2 * FCGI_HEADER_LEN, 0U);
+    PopulateBeginRequestRecord(records.data(), fcgi_id, FCGI_RESPONDER, true);
+    for(std::size_t offset {0U}; offset < params.size();
+      offset += record_length)
+    {
+      std::size_t length {std::min(record_length, params.size() - offset)};
+      std::size_t header_offset {records.size()};
+      records.resize(header_offset + FCGI_HEADER_LEN, 0U);
+      PopulateHeader(records.data() + header_offset, FcgiType::kFCGI_PARAMS,
+        fcgi_id, static_cast<std::uint16_t>(length), 0U);
+      records.insert(records.end(), params.begin() + offset,
+        params.begin() + offset + length);
+    }
+    std::size_t header_offset {records.size()};
+    records.resize(header_offset + 2 * FCGI_HEADER_LEN, 0U);
+    PopulateHeader(records.data() + header_offset, FcgiType::kFCGI_PARAMS,
+      fcgi_id, 0U, 0U);
+    PopulateHeader(records.data() + header_offset + FCGI_HEADER_LEN,
+      FcgiType::kFCGI_STDIN, fcgi_id, 0U, 0U);
+    return records;
+  };
+
+  auto RunCases = [&](FcgiServerInterface::IoBackend backend)->void
+  {
+    struct InterfaceCreationArguments inter_args {};
+    inter_args.domain          = AF_INET;
+    inter_args.backlog         = 5;
+    inter_args.max_connections = 1;
+    inter_args.max_requests    = 5;
+    inter_args.app_status      = EXIT_FAILURE;
+    inter_args.unix_path       = nullptr;
+    inter_args.io_backend      = backend;
+
+    // The listening socket is not used.
+    GTestNonFatalInterfaceAndBlockingClients inter {inter_args, __LINE__};
+    FcgiServerInterface* inter_ptr {inter.interface_ptr()};
+    if((inter_ptr == nullptr) || (inter_ptr->io_backend() != backend))
+      return;
+    int client {inter.ConnectLoopback()};
+    if(client == -1)
+      return;
+
+    auto Send = [&](const ByteSequence& records)->bool
+    {
+      bool written {socket_functions::WriteOnSelect(client, records.data(),
+        records.size(), nullptr) == records.size()};
+      if(!written)
+        ADD_FAILURE() << std::strerror(errno);
+      return written;
+    };
+    // Checks that the request was rejected and that no request was produced.
+    auto CheckRejection = [&](std::uint16_t fcgi_id)->void
+    {
+      EXPECT_EQ(inter.AcceptRequests().size(), 0U);
+      std::uint8_t response[2 * FCGI_HEADER_LEN] = {};
+      if(socket_functions::SocketRead(client, response, sizeof(response)) !=
+         sizeof(response))
+      {
+        ADD_FAILURE() << std::strerror(errno);
+        return;
+      }
+      EXPECT_EQ(response[kHeaderTypeIndex],
+        static_cast<std::uint8_t>(FcgiType::kFCGI_END_REQUEST));
+      EXPECT_EQ(response[kHeaderRequestIDB0Index], fcgi_id);
+      EXPECT_EQ(response[FCGI_HEADER_LEN + 3], EXIT_FAILURE);
+      EXPECT_EQ(response[FCGI_HEADER_LEN + 4], FCGI_REQUEST_COMPLETE);
+    };
+
+    // Case 1
+    {
+      ByteSequence long_value(200U);
+      for(std::size_t i {0U}; i < long_value.size(); ++i)
+        long_value[i] = static_cast<std::uint8_t>('a' + (i % 26U));
+      ByteSequence params {};
+      AppendPair(&params, "A", {'1'});
+      AppendPair(&params, "LONG", long_value);
+      AppendPair(&params, "A", {'1'});
+      AppendPair(&params, "B", {});
+      AppendPair(&params, "REQUEST_METHOD", {'G', 'E', 'T'});
+      if(Send(RequestRecords(1U, params, 3U)))
+      {
+        std::vector<FcgiRequest> requests {inter.AcceptRequests()};
+        EXPECT_EQ(requests.size(), 1U);
+        if(requests.size() == 1U)
+        {
+          ByteSequence method_name {'R', 'E', 'Q', 'U', 'E', 'S', 'T', '_',
+            'M', 'E', 'T', 'H', 'O', 'D'};
+          std::map<ByteSequence, ByteSequence> expected
+            {{{'A'}, {'1'}}, {{'B'}, {}}, {{'L', 'O', 'N', 'G'}, long_value},
+             {method_name, {'G', 'E', 'T'}}};
+          EXPECT_EQ(requests[0].get_environment_map(), expected);
+          FcgiRequest request {std::move(requests[0])};
+          EXPECT_EQ(requests[0].Param(FcgiParam::kRequestMethod), nullptr);
+          EXPECT_EQ(request.Param(FcgiParam::kRequestMethod),
+            &request.get_environment_map().at(method_name));
+          EXPECT_EQ(request.Param(FcgiParam::kQueryString), nullptr);
+          EXPECT_TRUE(request.Complete(EXIT_SUCCESS));
+          // The terminal FCGI_STDOUT and FCGI_STDERR records and the
+          // FCGI_END_REQUEST record of the response are discarded.
+          std::uint8_t response[4 * FCGI_HEADER_LEN] = {};
+          EXPECT_EQ(socket_functions::SocketRead(client, response,
+            sizeof(response)), sizeof(response));
+        }
+      }
+    }
+
+    // Case 2
+    {
+      ByteSequence params {};
+      AppendPair(&params, "A", {'1'});
+      AppendPair(&params, "A", {'2'});
+      if(Send(RequestRecords(2U, params, params.size())))
+        CheckRejection(2U);
+    }
+
+    // Case 3
+    {
+      ByteSequence params {};
+      AppendPair(&params, "A", {'1'});
+      params.push_back(1U);
+      if(Send(RequestRecords(3U, params, params.size())))
+        CheckRejection(3U);
+    }
+
+  };
+
+  RunCases(FcgiServerInterface::IoBackend::kSelect);
+  RunCases(FcgiServerInterface::IoBackend::kIoUring);
+  testing::gtest::GTestNonFatalCheckAndReportDescriptorLeaks(&fdlc,
+    "IncrementalParamsParsing", __LINE__);
+}
+
 // FcgiRequestGeneration
 // Test space discussion:
 // Notions related to sequences of received records:
@@ -0,0 +1,98 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "fcgi/include/fcgi_well_known_params.h"
+
+namespace as_components {
+namespace fcgi {
+namespace test {
+
+namespace {
+
+std::size_t Find(const std::string& name)
+{
+  return FcgiWellKnownParams::Find(
+    reinterpret_cast<const std::uint8_t*>(name.data()), name.size());
+}
+
+// Lookups may be performed at compile time.
+constexpr std::uint8_t kRequestMethod[] =
+  {'R', 'E', 'Q', 'U', 'E', 'S', 'T', '_', 'M', 'E', 'T', 'H', 'O', 'D'};
+static_assert(FcgiWellKnownParams::Find(kRequestMethod,
+  sizeof(kRequestMethod)) ==
+  static_cast<std::size_t>(FcgiParam::kRequestMethod), "");
+
+} // namespace
+
+// FcgiWellKnownParams
+// Examined properties:
+// 1) Find returns the index of each well-known name, and Name returns the
+//    name of each index.
+// 2) Find returns kParamCount for byte sequences which are not well-known
+//    names. This includes prefixes and extensions of names, names which
+//    differ only in case, names with an embedded null byte, the empty
+//    sequence, and a sequence which is longer than every name.
+//
+// Test cases:
+// 1) Every well-known name.
+// 2) "", "HTTP", "HTTPSX", "request_method", "REQUEST_METHOd", "HTTPS\0",
+//    "QUERY_STRINX", and a sequence of 1000 bytes.
+//
+// Modules which testing depends on: none.
+//
+// Other modules whose testing depends on this module:
+// 1) FcgiServerInterface
+// 2) FcgiRequest
+TEST(FcgiWellKnownParams, Find)
+{
+  // Case 1
+  for(std::size_t i {0U}; i < FcgiWellKnownParams::kParamCount; ++i)
+  {
+    const char* name {FcgiWellKnownParams::Name(static_cast<FcgiParam>(i))};
+    EXPECT_EQ(Find(name), i) << name;
+  }
+  EXPECT_STREQ(FcgiWellKnownParams::Name(FcgiParam::kContentLength),
+    "CONTENT_LENGTH");
+  EXPECT_STREQ(FcgiWellKnownParams::Name(FcgiParam::kServerSoftware),
+    "SERVER_SOFTWARE");
+
+  // Case 2
+  const std::size_t kNotFound {FcgiWellKnownParams::kParamCount};
+  EXPECT_EQ(FcgiWellKnownParams::Find(nullptr, 0U), kNotFound);
+  for(const std::string& name : {std::string {"HTTP"},
+    std::string {"HTTPSX"}, std::string {"request_method"},
+    std::string {"REQUEST_METHOd"}, std::string {"HTTPS\0", 6U},
+    std::string {"QUERY_STRINX"}, std::string(1000U, 'A')})
+  {
+    EXPECT_EQ(Find(name), kNotFound) << name;
+  }
+}
+
+} // namespace test
+} // namespace fcgi
+} // namespace as_components
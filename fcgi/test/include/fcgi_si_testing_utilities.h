@@ -168,12 +168,93 @@ struct InterfaceCreationArguments
   int max_requests;
   int app_status;
   const char* unix_path;
+  FcgiServerInterface::IoBackend io_backend
+    {FcgiServerInterface::IoBackend::kSelect};
 };
 
 std::tuple<std::unique_ptr<FcgiServerInterface>, int, in_port_t>
 GTestNonFatalCreateInterface(const struct InterfaceCreationArguments& args,
   int invocation_line);
 
+//    This class creates an interface with the parameters provided in
+// inter_args through GTestNonFatalCreateInterface. Unlike
+// GTestNonFatalSingleProcessInterfaceAndClients, clients are created on
+// demand and are blocking:
+// 1) Connect connects a client to the listening socket of the interface.
+//    It may only be used when inter_args.domain == AF_UNIX.
+// 2) ConnectLoopback creates a client with
+//    FcgiServerInterface::CreateLoopbackConnection. The listening socket is
+//    not used.
+//    The descriptors which are returned by Connect and ConnectLoopback are
+// owned by the instance. A client may be closed before clean up with
+// CloseClient.
+//    CleanUp closes the client descriptors, destroys the interface, closes
+// the listening socket, and, if inter_args.domain == AF_UNIX, removes the
+// socket file. It is called by the destructor and may be called before
+// descriptor leaks are checked. Failures are reported as non-fatal
+// failures.
+class GTestNonFatalInterfaceAndBlockingClients
+{
+ public:
+  // Null if the interface could not be created or was destroyed.
+  inline FcgiServerInterface* interface_ptr() noexcept
+  {
+    return std::get<0>(inter_tuple_).get();
+  }
+
+  inline int interface_descriptor() noexcept
+  {
+    return std::get<1>(inter_tuple_);
+  }
+
+  // Returns a connected client descriptor or -1. A failure is reported when
+  // -1 is returned.
+  int Connect();
+  int ConnectLoopback();
+
+  // Closes a descriptor which was returned by Connect or ConnectLoopback.
+  void CloseClient(int client);
+
+  // Calls AcceptRequests on the interface. An alarm of one second is set for
+  // the duration of the call.
+  std::vector<FcgiRequest> AcceptRequests();
+
+  // Destroys the interface. The listening socket remains open until CleanUp
+  // is called.
+  inline void DestroyInterface()
+  {
+    std::get<0>(inter_tuple_).reset();
+  }
+
+  void CleanUp();
+
+  // No copy or move.
+  GTestNonFatalInterfaceAndBlockingClients(
+    const struct InterfaceCreationArguments& inter_args, int invocation_line);
+  GTestNonFatalInterfaceAndBlockingClients(
+    const GTestNonFatalInterfaceAndBlockingClients&) = delete;
+  GTestNonFatalInterfaceAndBlockingClients(
+    GTestNonFatalInterfaceAndBlockingClients&&) = delete;
+
+  GTestNonFatalInterfaceAndBlockingClients&
+  operator=(const GTestNonFatalInterfaceAndBlockingClients&) = delete;
+  GTestNonFatalInterfaceAndBlockingClients&
+  operator=(GTestNonFatalInterfaceAndBlockingClients&&) = delete;
+
+  inline ~GTestNonFatalInterfaceAndBlockingClients()
+  {
+    CleanUp();
+  }
+
+ private:
+  struct InterfaceCreationArguments inter_args_;
+  int invocation_line_;
+  std::tuple<std::unique_ptr<FcgiServerInterface>, int, in_port_t>
+  inter_tuple_;
+  std::vector<int> client_descriptors_ {};
+  bool cleaned_up_ {false};
+};
+
 //    This class creates an interface with the parameters provided in
 // inter_args. client_number sockets are created and connected to the
 // interface. These sockets are made non-blocking to facilitate testing
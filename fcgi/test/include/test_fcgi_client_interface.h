@@ -27,17 +27,21 @@
 #include <netinet/in.h>
 #include <sys/uio.h>
 
+#include <cstddef>
 #include <cstdlib>
 #include <cstdint>
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
 #include <set>
 #include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "fcgi/include/fcgi_protocol_constants.h"
+#include "fcgi/include/fcgi_record_decoder.h"
 #include "fcgi/include/fcgi_request_identifier.h"
 #include "id_manager/include/id_manager_template.h"
 
@@ -47,6 +51,18 @@ namespace test {
 
 using ParamsMap = std::map<std::vector<std::uint8_t>, std::vector<std::uint8_t>>;
 
+//    The type of the stream handlers of TestFcgiClientInterface. When a stream
+// handler applies to a pending application request, FCGI_STDOUT and
+// FCGI_STDERR content is passed to the handler as it is received instead of
+// being accumulated for the FcgiResponse instance of the request.
+//    The arguments of an invocation are the identifier of the request, the
+// type of the stream (FcgiType::kFCGI_STDOUT or FcgiType::kFCGI_STDERR), and
+// the range [begin, end) of received content. The range is only valid during
+// the invocation. An invocation with an empty range indicates that the stream
+// was completed by the receipt of a terminal record.
+using StreamHandler = std::function<void(FcgiRequestIdentifier, FcgiType,
+  const std::uint8_t*, const std::uint8_t*)>;
+
 //    This is a reference type which contains the metadata of a FastCGI request
 // and references to the data of the request.
 // 1) TestFcgiClientInterface::SendRequest accepts an FcgiRequestDataReference
@@ -165,6 +181,10 @@ class ConnectionClosure : public ServerEvent
 class FcgiResponse : public ServerEvent
 {
  public:
+  // TestFcgiClientInterface recycles the stream buffers of FcgiResponse
+  // instances which were delivered through VisitServerEvent.
+  friend class TestFcgiClientInterface;
+
   inline std::int32_t AppStatus() const noexcept
   {
     return app_status_;
@@ -498,11 +518,42 @@ class UnknownType : public ServerEvent
   struct ManagementRequestData request_;
 };
 
+//    A tagged union of the types derived from ServerEvent. The ready event
+// queue of TestFcgiClientInterface stores ServerEventVariant instances by
+// value. TestFcgiClientInterface::VisitServerEvent exposes the next ready
+// event as a ServerEventVariant instance without a heap allocation or a
+// dynamic_cast.
+using ServerEventVariant = std::variant<FcgiResponse, ConnectionClosure,
+  GetValuesResult, InvalidRecord, UnknownType>;
+
 // See the README for namespace fcgi for a description of
 // TestFcgiClientInterface.
 class TestFcgiClientInterface
 {
  public:
+  // Takes ownership of a connected stream socket which was created by the
+  // caller, for example by FcgiServerInterface::CreateLoopbackConnection. The
+  // connection is then managed as a connection which was opened by Connect.
+  //
+  // Parameters:
+  // connection: The file descriptor of a connected stream socket.
+  //
+  // Preconditions:
+  // 1) connection is not managed by the interface.
+  //
+  // Exceptions:
+  // 1) A call may throw exceptions derived from std::exception.
+  // 2) If a throw occurred, connection was closed and internal state was not
+  //    modified.
+  //
+  // Effects:
+  // 1) connection was returned.
+  // 2) The file description associated with connection is non-blocking.
+  // 3) As for Connect, if the descriptor had previously been used and had
+  //    requests which were not released by a call to ReleaseId, those
+  //    requests continue to be active.
+  int AdoptConnection(int connection);
+
   // Attempts to close the socket descriptor connection when it refers to a
   // socket opened by the TestFcgiClientInterface instance.
   //
@@ -624,7 +675,7 @@ class TestFcgiClientInterface
   // no longer in the ready event queue.
   inline std::size_t ReadyEventCount() const noexcept
   {
-    return micro_event_queue_.size();
+    return micro_event_queue_count_;
   }
 
   // Attempts to release the FastCGI request identifier of id when id refers
@@ -776,6 +827,77 @@ class TestFcgiClientInterface
   //       queue.
   std::unique_ptr<ServerEvent> RetrieveServerEvent();
 
+  // VisitServerEvent is an alternative to RetrieveServerEvent. The next ready
+  // event is passed to visitor by a call to std::visit instead of being
+  // returned in a std::unique_ptr<ServerEvent> instance. Events are stored by
+  // value in the ready event queue. As such, no allocation is made for an
+  // event and no dynamic_cast is needed to recover the type of the event.
+  //
+  // Parameters:
+  // visitor: A callable object which can be invoked with an lvalue reference
+  //          to each of the alternatives of ServerEventVariant. The return
+  //          value of an invocation is discarded. The referenced event may be
+  //          moved from if it must outlive the call.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions:
+  // 1) As for RetrieveServerEvent with the following addition: an exception
+  //    which was thrown by visitor is propagated. The visited event was
+  //    removed from the ready event queue in this case.
+  //
+  // Termination: As for RetrieveServerEvent.
+  //
+  // Effects:
+  // 1) Ready event generation occurred as for RetrieveServerEvent.
+  // 2) The next ready event was passed to visitor and then removed from the
+  //    ready event queue.
+  // 3) If the visited event was an FcgiResponse instance, then the capacity
+  //    of its stream buffers which was not moved from by visitor was retained
+  //    by the interface. Retained buffers are used to accumulate the
+  //    FCGI_STDOUT and FCGI_STDERR streams of subsequently sent requests.
+  //    In the steady state of a request-response cycle, stream accumulation
+  //    does not cause allocation.
+  template<typename Visitor>
+  void VisitServerEvent(Visitor&& visitor);
+
+  // Registers a stream handler for the requests of a connection or for a
+  // single pending request. See StreamHandler.
+  //
+  // Parameters:
+  // connection: The descriptor of a socket connection.
+  // id:         The identifier of a pending request.
+  // handler:    The handler to be registered. An empty handler removes a
+  //             previously registered handler.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions:
+  // 1) A call may throw exceptions derived from std::exception.
+  // 2) Strong exception guarantee.
+  //
+  // Termination:
+  // 1) A registered handler must not throw. If a handler throws when it is
+  //    invoked during a call to RetrieveServerEvent or VisitServerEvent, the
+  //    program is terminated.
+  //
+  // Effects:
+  // 1) If false was returned, then connection was not a connected socket
+  //    descriptor which was opened by the interface or id did not refer to a
+  //    pending request. No handler was registered.
+  // 2) If true was returned, then handler was registered. Stream content
+  //    which is received for a request after registration is passed to the
+  //    handler of the request, if one is registered, and otherwise to the
+  //    handler of the connection of the request, if one is registered. When
+  //    a handler was invoked for the content of a stream, the corresponding
+  //    stream of the FcgiResponse instance of the request does not hold the
+  //    content.
+  // 3) The handler of a connection is removed when the connection is closed.
+  //    The handler of a request is removed when the request is completed or
+  //    when the request is removed while pending.
+  bool SetStreamHandler(int connection, StreamHandler handler);
+  bool SetStreamHandler(FcgiRequestIdentifier id, StreamHandler handler);
+
   // Attempts to send a FastCGI request abort record for id.Fcgi_id() on
   // id.descriptor() when id refers to a pending FastCGI request.
   //
@@ -995,14 +1117,11 @@ class TestFcgiClientInterface
   {
     inline RecordState() noexcept
     : invalidated            {false},
+      version                {0U},
       fcgi_id                {0U},
       type                   {static_cast<FcgiType>(0U)},
-      header                 {},
-      header_bytes_received  {0U},
       content_bytes_expected {0U},
-      content_bytes_received {0U},
       padding_bytes_expected {0U},
-      padding_bytes_received {0U},
       local_buffer           {}
     {}
 
@@ -1015,14 +1134,11 @@ class TestFcgiClientInterface
     ~RecordState()                             = default;
 
     bool                      invalidated;
+    std::uint8_t              version;
     std::uint16_t             fcgi_id;
     FcgiType                  type;
-    std::uint8_t              header[FCGI_HEADER_LEN];
-    std::uint8_t              header_bytes_received;
     std::uint16_t             content_bytes_expected;
-    std::uint16_t             content_bytes_received;
     std::uint8_t              padding_bytes_expected;
-    std::uint8_t              padding_bytes_received;
     std::vector<std::uint8_t> local_buffer;
   };
 
@@ -1035,7 +1151,12 @@ class TestFcgiClientInterface
     bool                                  connected;
     as_components::IdManager<std::uint16_t> id_manager;
     RecordState                           record_state;
+    // Tracks the receipt of the header, content, and padding of the current
+    // record. It is separate from record_state as record_state is
+    // reinitialized by ProcessCompleteRecord during decoding.
+    FcgiRecordDecoder                     record_decoder;
     std::list<ManagementRequestData>      management_queue;
+    StreamHandler                         stream_handler;
   };
 
   // as_components::IdManager<std::uint16_t>
@@ -1054,7 +1175,9 @@ class TestFcgiClientInterface
       fcgi_stdout      {},
       stdout_completed {false},
       fcgi_stderr      {},
-      stderr_completed {false}
+      stderr_completed {false},
+      stderr_received  {false},
+      stream_handler   {}
     {}
 
     inline RequestData(
@@ -1068,7 +1191,9 @@ class TestFcgiClientInterface
       fcgi_stdout {std::move(stdout_content)},
       stdout_completed {stdout_status},
       fcgi_stderr {std::move(stderr_content)},
-      stderr_completed {stderr_status}
+      stderr_completed {stderr_status},
+      stderr_received {false},
+      stream_handler {}
     {}
 
     RequestData(const RequestData&)            = default;
@@ -1084,6 +1209,10 @@ class TestFcgiClientInterface
     bool                      stdout_completed;
     std::vector<std::uint8_t> fcgi_stderr;
     bool                      stderr_completed;
+    // True if FCGI_STDERR content was passed to a stream handler. In this
+    // case, fcgi_stderr may be empty when FCGI_STDERR content was received.
+    bool                      stderr_received;
+    StreamHandler             stream_handler;
   };
 
   static_assert(std::is_nothrow_default_constructible<TestFcgiClientInterface::RequestData>::value);
@@ -1204,6 +1333,57 @@ class TestFcgiClientInterface
     const char*                              system_error_message
   );
 
+  // Returns a pointer to the stream handler which applies to the pending
+  // request referred to by pending_iter. The handler of the request is
+  // preferred to the handler of the connection of the request. A null pointer
+  // is returned if neither handler is registered.
+  //
+  // Preconditions:
+  // 1) connection_iter and pending_iter are valid, are not end iterators, and
+  //    refer to the same connection.
+  StreamHandler* FindStreamHandler(
+    std::map<int, ConnectionState>::iterator connection_iter,
+    std::map<FcgiRequestIdentifier, RequestData>::iterator pending_iter)
+    noexcept;
+
+  // Ready event queue operations.
+  //    micro_event_queue_ is used as a ring buffer. The capacity of the ring
+  // is micro_event_queue_.size() and is either zero or a power of two. The
+  // first ready event is at index micro_event_queue_head_. The number of ready
+  // events is micro_event_queue_count_.
+  //
+  // MicroEventQueueReserve
+  // Exceptions:
+  // 1) A call may throw exceptions derived from std::exception.
+  // 2) Strong exception guarantee.
+  // Effects:
+  // 1) The ring has space for at least one more event. The relative order of
+  //    ready events was preserved.
+  //
+  // MicroEventQueuePush
+  // Exceptions:
+  // 1) As for MicroEventQueueReserve. A call does not throw if the ring had
+  //    space for another event.
+  // Effects:
+  // 1) event was moved to the end of the ready event queue.
+  //
+  // MicroEventQueuePopFront
+  // Preconditions:
+  // 1) micro_event_queue_count_ > 0.
+  // Effects:
+  // 1) The first ready event was removed.
+  // 2) If the event was an FcgiResponse instance, then its stream buffers
+  //    were cleared and retained in recycled_buffer_list_ when space was
+  //    available. A buffer whose capacity exceeds
+  //    kRecycledBufferCapacityLimit_ is released instead.
+  void MicroEventQueueReserve();
+  void MicroEventQueuePush(ServerEventVariant&& event);
+  void MicroEventQueuePopFront() noexcept;
+
+  // Returns a cleared buffer from recycled_buffer_list_ if one is available.
+  // Returns an empty buffer otherwise.
+  std::vector<std::uint8_t> TakeRecycledBuffer() noexcept;
+
   // ProcessCompleteRecord is intended to only be used within the
   // implementation of ExamineSelectReturn (which is in turn only intended to
   // be used within the implementation of RetrieveServerEvent).
@@ -1263,6 +1443,12 @@ class TestFcgiClientInterface
     std::map<int, ConnectionState>::iterator connection_iter,
     std::map<FcgiRequestIdentifier, RequestData>::iterator pending_iter);
 
+  // Performs the I/O multiplexing and record processing of
+  // RetrieveServerEvent until the ready event queue is non-empty. Exceptions,
+  // termination, and effects are as described for RetrieveServerEvent with
+  // the exception that no event is removed from the ready event queue.
+  void WaitForReadyEvent();
+
   bool SendBinaryManagementRequestHelper(
     std::map<int, ConnectionState>::iterator connection_iter,
     FcgiType type, ManagementRequestData&& queue_item);
@@ -1323,9 +1509,9 @@ class TestFcgiClientInterface
   //          FCGI_GET_VALUES requests).
   //       4) The content length of the record was not 8 bytes.
   //    g) The record was not of one the above types.
-  // 2) The information contained in the header was used to update the
-  //    following fields of the RecordState instance referred to by
-  //    connection_iter: type, fcgi_id, content_bytes_expected, and
+  // 2) The information contained in the header of record_decoder was used to
+  //    update the following fields of the RecordState instance referred to by
+  //    connection_iter: version, type, fcgi_id, content_bytes_expected, and
   //    padding_bytes_expected.
   // 3) A valid iterator of pending_request_map_ was returned.
   std::map<FcgiRequestIdentifier, RequestData>::iterator
@@ -1336,7 +1522,11 @@ class TestFcgiClientInterface
   std::set<FcgiRequestIdentifier>              completed_request_set_;
   std::map<int, ConnectionState>               connection_map_;
   std::map<FcgiRequestIdentifier, RequestData> pending_request_map_;
-  std::list<std::unique_ptr<ServerEvent>>      micro_event_queue_;
+  // The ready event queue. See MicroEventQueueReserve.
+  std::vector<ServerEventVariant>              micro_event_queue_;
+  std::size_t                                  micro_event_queue_head_;
+  std::size_t                                  micro_event_queue_count_;
+  std::vector<std::vector<std::uint8_t>>       recycled_buffer_list_;
   int                                          number_connected_;
   // I/O multiplexing tracking state
   int                                          remaining_ready_;
@@ -1349,10 +1539,21 @@ class TestFcgiClientInterface
     {"write or select"};
   static constexpr const char*const            kWritevOrSelect_
     {"writev or select"};
+  static constexpr std::size_t                 kMinimumEventQueueCapacity_
+    {16U};
+  static constexpr std::size_t                 kRecycledBufferLimit_
+    {64U};
+  // Buffers of responses which were larger than this are not retained so
+  // that one large response does not pin its memory for the life of the
+  // client interface.
+  static constexpr std::size_t                 kRecycledBufferCapacityLimit_
+    {64U * 1024U};
 };
 
 } // namespace test
 } // namespace fcgi
 } // namespace as_components
 
+#include "fcgi/test/include/test_fcgi_client_interface_templates.h"
+
 #endif // AS_COMPONENTS_FCGI_TEST_INCLUDE_TEST_FCGI_CLIENT_INTERFACE_H_
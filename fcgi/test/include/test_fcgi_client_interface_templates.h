@@ -0,0 +1,60 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Template definitions for TestFcgiClientInterface. This file is included as
+// a template definition header by the TestFcgiClientInterface header.
+
+#ifndef AS_COMPONENTS_FCGI_TEST_INCLUDE_TEST_FCGI_CLIENT_INTERFACE_TEMPLATES_H_
+#define AS_COMPONENTS_FCGI_TEST_INCLUDE_TEST_FCGI_CLIENT_INTERFACE_TEMPLATES_H_
+
+#include "fcgi/test/include/test_fcgi_client_interface.h"
+
+#include <utility>
+#include <variant>
+
+namespace as_components {
+namespace fcgi {
+namespace test {
+
+template<typename Visitor>
+void TestFcgiClientInterface::VisitServerEvent(Visitor&& visitor)
+{
+  WaitForReadyEvent();
+  ServerEventVariant* front_ptr
+    {&(micro_event_queue_[micro_event_queue_head_])};
+  try
+  {
+    std::visit(std::forward<Visitor>(visitor), *front_ptr);
+  }
+  catch(...)
+  {
+    MicroEventQueuePopFront();
+    throw;
+  }
+  MicroEventQueuePopFront();
+}
+
+} // namespace test
+} // namespace fcgi
+} // namespace as_components
+
+#endif // AS_COMPONENTS_FCGI_TEST_INCLUDE_TEST_FCGI_CLIENT_INTERFACE_TEMPLATES_H_
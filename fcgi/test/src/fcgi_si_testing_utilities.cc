@@ -160,7 +160,7 @@ GTestNonFatalCreateInterface(const struct InterfaceCreationArguments& args,
   {
     interface_uptr = std::unique_ptr<FcgiServerInterface> 
       {new FcgiServerInterface {socket_fd, args.max_connections, 
-        args.max_requests, args.app_status}};
+        args.max_requests, args.app_status, args.io_backend}};
   }
   catch(...)
   {
@@ -179,6 +179,124 @@ GTestNonFatalCreateInterface(const struct InterfaceCreationArguments& args,
   );
 }
 
+GTestNonFatalInterfaceAndBlockingClients::
+GTestNonFatalInterfaceAndBlockingClients(
+  const struct InterfaceCreationArguments& inter_args, int invocation_line)
+: inter_args_      {inter_args},
+  invocation_line_ {invocation_line},
+  inter_tuple_     {GTestNonFatalCreateInterface(inter_args, invocation_line)}
+{
+  if(!std::get<0>(inter_tuple_))
+  {
+    ::testing::ScopedTrace tracer {__FILE__, invocation_line_,
+      "GTestNonFatalInterfaceAndBlockingClients::"
+      "GTestNonFatalInterfaceAndBlockingClients"};
+    ADD_FAILURE() << "The interface could not be created.";
+    // The listening socket and socket file were released by
+    // GTestNonFatalCreateInterface.
+    cleaned_up_ = true;
+  }
+}
+
+int GTestNonFatalInterfaceAndBlockingClients::Connect()
+{
+  ::testing::ScopedTrace tracer {__FILE__, invocation_line_,
+    "GTestNonFatalInterfaceAndBlockingClients::Connect"};
+  if(inter_args_.domain != AF_UNIX)
+  {
+    ADD_FAILURE() << "Connect was called for an interface which is not in "
+      "the AF_UNIX domain.";
+    return -1;
+  }
+  int client {socket(AF_UNIX, SOCK_STREAM, 0)};
+  if(client == -1)
+  {
+    ADD_FAILURE() << "A call to socket failed." << '\n'
+      << std::strerror(errno);
+    return -1;
+  }
+  client_descriptors_.push_back(client);
+  struct sockaddr_un address {};
+  address.sun_family = AF_UNIX;
+  std::strcpy(address.sun_path, inter_args_.unix_path);
+  if(connect(client, static_cast<struct sockaddr*>(static_cast<void*>(
+    &address)), sizeof(address)) == -1)
+  {
+    ADD_FAILURE() << "A call to connect failed." << '\n'
+      << std::strerror(errno);
+    return -1;
+  }
+  return client;
+}
+
+int GTestNonFatalInterfaceAndBlockingClients::ConnectLoopback()
+{
+  ::testing::ScopedTrace tracer {__FILE__, invocation_line_,
+    "GTestNonFatalInterfaceAndBlockingClients::ConnectLoopback"};
+  int client {-1};
+  try
+  {
+    client = interface_ptr()->CreateLoopbackConnection();
+  }
+  catch(const std::exception& e)
+  {
+    ADD_FAILURE() << "A call to CreateLoopbackConnection threw an exception."
+      << '\n' << e.what();
+    return -1;
+  }
+  if(client == -1)
+  {
+    ADD_FAILURE() << "A loopback connection could not be created.";
+    return -1;
+  }
+  client_descriptors_.push_back(client);
+  return client;
+}
+
+void GTestNonFatalInterfaceAndBlockingClients::CloseClient(int client)
+{
+  std::vector<int>::iterator client_iter {std::find(
+    client_descriptors_.begin(), client_descriptors_.end(), client)};
+  if(client_iter == client_descriptors_.end())
+  {
+    ::testing::ScopedTrace tracer {__FILE__, invocation_line_,
+      "GTestNonFatalInterfaceAndBlockingClients::CloseClient"};
+    ADD_FAILURE() << "A descriptor which is not a client was given.";
+    return;
+  }
+  client_descriptors_.erase(client_iter);
+  close(client);
+}
+
+std::vector<FcgiRequest> GTestNonFatalInterfaceAndBlockingClients::
+AcceptRequests()
+{
+  alarm(1U);
+  std::vector<FcgiRequest> result {interface_ptr()->AcceptRequests()};
+  alarm(0U);
+  return result;
+}
+
+void GTestNonFatalInterfaceAndBlockingClients::CleanUp()
+{
+  if(cleaned_up_)
+    return;
+  cleaned_up_ = true;
+  ::testing::ScopedTrace tracer {__FILE__, invocation_line_,
+    "GTestNonFatalInterfaceAndBlockingClients::CleanUp"};
+  for(int client : client_descriptors_)
+    close(client);
+  client_descriptors_.clear();
+  std::get<0>(inter_tuple_).reset();
+  close(std::get<1>(inter_tuple_));
+  if(inter_args_.domain == AF_UNIX)
+  {
+    if(unlink(inter_args_.unix_path) == -1)
+      ADD_FAILURE() << "The socket file could not be removed." << '\n'
+        << std::strerror(errno);
+  }
+}
+
 std::tuple<bool, bool, bool, bool, std::size_t, std::vector<std::uint8_t>>
 ExtractContent(int fd, FcgiType type, std::uint16_t id)
 {
@@ -46,6 +46,7 @@
 #include <system_error>
 #include <type_traits>
 #include <utility>
+#include <variant>
 
 #include "fcgi/include/fcgi_protocol_constants.h"
 #include "fcgi/include/fcgi_request_identifier.h"
@@ -142,16 +143,24 @@ static_assert(std::is_nothrow_move_assignable<GetValuesResult>::value);
 static_assert(std::is_nothrow_default_constructible<UnknownType>::value);
 static_assert(std::is_nothrow_move_constructible<UnknownType>::value);
 static_assert(std::is_nothrow_move_assignable<UnknownType>::value);
+// ServerEventVariant
+// Move operations on the ring buffer of ready events are required to be
+// noexcept.
+static_assert(std::is_nothrow_move_constructible<ServerEventVariant>::value);
+static_assert(std::is_nothrow_move_assignable<ServerEventVariant>::value);
 
 TestFcgiClientInterface::TestFcgiClientInterface()
-: completed_request_set_ {},
-  connection_map_        {},
-  pending_request_map_   {},
-  micro_event_queue_     {},
-  number_connected_      {0},
-  remaining_ready_       {0},
-  next_connection_       {connection_map_.end()},
-  select_set_            {}
+: completed_request_set_   {},
+  connection_map_          {},
+  pending_request_map_     {},
+  micro_event_queue_       {},
+  micro_event_queue_head_  {0U},
+  micro_event_queue_count_ {0U},
+  recycled_buffer_list_    {},
+  number_connected_        {0},
+  remaining_ready_         {0},
+  next_connection_         {connection_map_.end()},
+  select_set_              {}
 {
   FD_ZERO(&select_set_);
 }
@@ -170,6 +179,91 @@ TestFcgiClientInterface::~TestFcgiClientInterface()
   }
 }
 
+int TestFcgiClientInterface::AdoptConnection(int connection)
+{
+  if(connection >= FD_SETSIZE)
+  {
+    close(connection);
+    throw std::runtime_error
+      {"In a call to TestFcgiClientInterface::AdoptConnection, a file "
+       "descriptor was too large to be used in a call to select in a call to "
+       "TestFcgiClientInterface::RetrieveServerEvent."};
+  }
+  // Make the descriptor non-blocking for later I/O multiplexing.
+  auto CloseAndThrowOnError = [connection]
+  (int error, const char* message)->void
+  {
+    std::error_code ec {error, std::system_category()};
+    std::system_error se {ec, message};
+    close(connection);
+    throw se;
+  };
+  int flags {fcntl(connection, F_GETFL)};
+  if(flags == -1)
+  {
+    CloseAndThrowOnError(errno, "fcntl with F_GETFL");
+  }
+  flags |= O_NONBLOCK;
+  if(fcntl(connection, F_SETFL, flags) == -1)
+  {
+    CloseAndThrowOnError(errno, "fcntl with F_SETFL");
+  }
+
+  // Update internal state.
+  // Pair construction could throw. Insertion could throw.
+  try
+  {
+    // TestFcgiClientInterface allows requests represented by unique
+    // FcgiRequestIdentifier values to outlive the connection on which they
+    // originated. If a connection is closed and the descriptor value of the
+    // connection is used for a new connection, unreleased requests on the
+    // previous connection must be accunted for when new FcgiRequestIdentifier
+    // values are chosen. Persisting ConnectionState instances across
+    // instances of "connected == true" state allows this through persistence
+    // of id_manager instances.
+    std::map<int, ConnectionState>::iterator search_iter
+      {connection_map_.find(connection)};
+    if(search_iter != connection_map_.end())
+    {
+      bool* conn_ptr {&(search_iter->second.connected)};
+      if(*conn_ptr)
+      {
+        throw std::logic_error {"In a call to "
+          "TestFcgiClientInterface::AdoptConnection, a connection was made on a "
+          "file descriptor which was already considered to be connected."};
+      }
+      else
+      {
+        *conn_ptr = true;
+        // When a connection is closed and the item in connection_map_ for the
+        // connection is not removed, the closure operation should cause the
+        // ConnectionState instance of the item to be updated so that, except
+        // for the state of id_manager, it has the state of a newly-constructed
+        // instance (connected == false, record_state == RecordState {},
+        // management_queue.size() == 0U).
+      }
+    }
+    else // A new map item is needed.
+    {
+      ConnectionState connection_state {};
+      std::pair<std::map<int, ConnectionState>::iterator, bool> insert_return
+        {connection_map_.insert(
+          {connection, std::move(connection_state)}
+        )};
+      // Set connected to true after insertion to simplify exception handling.
+      // No undo step is needed in the event of an exception when this is done.
+      insert_return.first->second.connected = true;
+    }
+  }
+  catch(...)
+  {
+    close(connection);
+    throw;
+  }
+  ++number_connected_;
+  return connection;
+}
+
 bool TestFcgiClientInterface::CloseConnection(int connection)
 {
   std::map<int, ConnectionState>::iterator
@@ -219,18 +313,17 @@ bool TestFcgiClientInterface::CloseConnection(int connection)
 
     // Update state using calls which can't throw.
     state_ptr->record_state.invalidated            = false;
-    state_ptr->record_state.header_bytes_received  = 0U;
     state_ptr->record_state.content_bytes_expected = 0U;
-    state_ptr->record_state.content_bytes_received = 0U;
     state_ptr->record_state.padding_bytes_expected = 0U;
-    state_ptr->record_state.padding_bytes_received = 0U;
     state_ptr->record_state.local_buffer.clear();
+    state_ptr->record_decoder.Reset();
     // Ensure that queue swap is noexcept.
     static_assert(
       std::is_nothrow_swappable<std::list<ManagementRequestData>>::value ==
       true
     );
     state_ptr->management_queue.swap(empty_queue);
+    state_ptr->stream_handler = nullptr;
     state_ptr->connected = false;
     //    The erasure of pending requests requires releasing the
     // FcgiRequestIdentifier values which are associated with these requests
@@ -382,79 +475,7 @@ int TestFcgiClientInterface::Connect(const char* address, in_port_t port)
     break;
   }
   // socket_connection must now refer to a connected socket descriptor.
-  // Make the descriptor non-blocking for later I/O multiplexing.
-  auto CloseAndThrowOnError = [socket_connection]
-  (int error, const char* message)->void
-  {
-    std::error_code ec {error, std::system_category()};
-    std::system_error se {ec, message};
-    close(socket_connection);
-    throw se;
-  };
-  int flags {fcntl(socket_connection, F_GETFL)};
-  if(flags == -1)
-  {
-    CloseAndThrowOnError(errno, "fcntl with F_GETFL");
-  }
-  flags |= O_NONBLOCK;
-  if(fcntl(socket_connection, F_SETFL, flags) == -1)
-  {
-    CloseAndThrowOnError(errno, "fcntl with F_SETFL");
-  }
-
-  // Update internal state.
-  // Pair construction could throw. Insertion could throw.
-  try
-  {
-    // TestFcgiClientInterface allows requests represented by unique
-    // FcgiRequestIdentifier values to outlive the connection on which they
-    // originated. If a connection is closed and the descriptor value of the
-    // connection is used for a new connection, unreleased requests on the
-    // previous connection must be accunted for when new FcgiRequestIdentifier
-    // values are chosen. Persisting ConnectionState instances across
-    // instances of "connected == true" state allows this through persistence
-    // of id_manager instances.
-    std::map<int, ConnectionState>::iterator search_iter
-      {connection_map_.find(socket_connection)};
-    if(search_iter != connection_map_.end())
-    {
-      bool* conn_ptr {&(search_iter->second.connected)};
-      if(*conn_ptr)
-      {
-        throw std::logic_error {"In a call to "
-          "TestFcgiClientInterface::Connect, a connection was made on a file "
-          "descriptor which was already considered to be connected."};
-      }
-      else
-      {
-        *conn_ptr = true;
-        // When a connection is closed and the item in connection_map_ for the
-        // connection is not removed, the closure operation should cause the
-        // ConnectionState instance of the item to be updated so that, except
-        // for the state of id_manager, it has the state of a newly-constructed
-        // instance (connected == false, record_state == RecordState {},
-        // management_queue.size() == 0U).
-      }
-    }
-    else // A new map item is needed.
-    {
-      ConnectionState connection_state {};
-      std::pair<std::map<int, ConnectionState>::iterator, bool> insert_return
-        {connection_map_.insert(
-          {socket_connection, std::move(connection_state)}
-        )};
-      // Set connected to true after insertion to simplify exception handling.
-      // No undo step is needed in the event of an exception when this is done.
-      insert_return.first->second.connected = true;
-    }
-  }
-  catch(...)
-  {
-    close(socket_connection);
-    throw;
-  }
-  ++number_connected_;
-  return socket_connection;
+  return AdoptConnection(socket_connection);
 }
 
 std::size_t TestFcgiClientInterface::CompletedRequestCount(int connection) const
@@ -521,109 +542,104 @@ void TestFcgiClientInterface::ExamineSelectReturn()
         std::map<FcgiRequestIdentifier, RequestData>::iterator
         pending_iter {pending_end};
 
-        // Start reading until the connection blocks.
-        constexpr unsigned int buffer_size {1U << 9U};
-        std::uint8_t buffer[buffer_size];
-
-        // next_connection_ must be updated to the next connection by the time
-        // that this loop exits.
-        while(true)
+        // Receives the parts of records from the decoder of the connection.
+        // As a local class, RecordHandler has the access of
+        // ExamineSelectReturn.
+        struct RecordHandler
         {
-          unsigned int read_return {static_cast<unsigned int>(
-            socket_functions::SocketRead(descriptor, buffer, buffer_size))};
-          int saved_errno {errno};
-          unsigned int remaining_data {read_return};
-          std::uint8_t* current_byte {buffer};
-          // The entire below loop is currently equivalent to a
-          // noexcept-equivalent block. Calls either no not throw (i.e., are
-          // noexcept or have C semantics) or are wrapped in a try block which
-          // causes program termination upon a throw.
-          while(remaining_data > 0U)
+          // A function to ensure that the assumptions on pending_iter are met
+          // and to update pending_iter when that is needed.
+          void PendingIterCheckAndUpdate()
           {
-            // Header
-            std::uint8_t received_header
-              {state_ptr->record_state.header_bytes_received};
-            if(received_header < FCGI_HEADER_LEN)
+            FcgiRequestIdentifier id {descriptor,
+              state_ptr->record_state.fcgi_id};
+            if((*pending_iter_ptr == pending_end) ||
+               ((*pending_iter_ptr)->first != id))
             {
-              std::uint8_t remaining_header {static_cast<std::uint8_t>(
-                FCGI_HEADER_LEN - received_header)};
-              std::uint8_t copy_size {(remaining_data >= remaining_header) ?
-                remaining_header : static_cast<std::uint8_t>(remaining_data)};
-              std::memcpy(state_ptr->record_state.header + received_header,
-                current_byte, copy_size);
-              current_byte                                  += copy_size;
-              remaining_data                                -= copy_size;
-              received_header                               += copy_size;
-              state_ptr->record_state.header_bytes_received  = received_header;
-              if(received_header == FCGI_HEADER_LEN)
+              *pending_iter_ptr = i_ptr->pending_request_map_.find(id);
+              if(*pending_iter_ptr == pending_end)
               {
-                try // noexcept-equivalent block.
+                throw std::logic_error {"A request was not present when "
+                  "expected in a call to "
+                  "TestFcgiClientInterface::RetrieveServerEvent."};
+              }
+            }
+          }
+
+          void OnHeader(const FcgiRecordDecoder::Header&)
+          {
+            try // noexcept-equivalent block.
+            {
+              *pending_iter_ptr = i_ptr->UpdateOnHeaderCompletion(
+                i_ptr->next_connection_, *pending_iter_ptr);
+            }
+            catch(...)
+            {
+              std::terminate();
+              // Failure of UpdateOnHeaderCompletion will cause invariants of
+              // the class to be violated.
+            }
+          }
+
+          void OnContent(const std::uint8_t* content_begin,
+            const std::uint8_t* content_end)
+          {
+            RecordState* record_ptr {&(state_ptr->record_state)};
+            FcgiType record_type {record_ptr->type};
+            if(!(record_ptr->invalidated)                    &&
+               (record_ptr->fcgi_id != FCGI_NULL_REQUEST_ID) &&
+               (record_type != FcgiType::kFCGI_END_REQUEST))
+            {
+              // Type is either FCGI_STDOUT or FCGI_STDERR.
+              try // noexcept-equivalent block.
+              {
+                PendingIterCheckAndUpdate();
+              }
+              catch(...)
+              {
+                std::terminate();
+                // A throw indicates an internal logic error than cannot be
+                // recovered from. Logging may be put here later.
+              }
+              std::map<FcgiRequestIdentifier, RequestData>::iterator
+                pending_iter {*pending_iter_ptr};
+              bool is_out {record_type == FcgiType::kFCGI_STDOUT};
+              try // noexcept-equivalent block.
+              {
+                StreamHandler* handler_ptr {i_ptr->FindStreamHandler(
+                  i_ptr->next_connection_, pending_iter)};
+                if(handler_ptr)
                 {
-                  pending_iter = UpdateOnHeaderCompletion(next_connection_,
-                    pending_iter);
-                  if((state_ptr->record_state.content_bytes_expected == 0U) && 
-                    (state_ptr->record_state.padding_bytes_expected == 0U))
+                  (*handler_ptr)(pending_iter->first, record_type,
+                    content_begin, content_end);
+                  if(!is_out)
                   {
-                    // ProcessCompleteRecord may invalidate pending_iter during
-                    // its execution. It is required to return a valid value
-                    // for pending_iter.
-                    pending_iter = ProcessCompleteRecord(next_connection_,
-                      pending_iter);
-                    continue;
+                    pending_iter->second.stderr_received = true;
                   }
                 }
-                catch(...)
+                else
                 {
-                  std::terminate(); 
-                  // Failure of UpdateOnHeaderCompletion and
-                  // ProcessCompleteRecord will cause invariants of the class
-                  // to be violated.
+                  std::vector<std::uint8_t>* stream_ptr {(is_out) ?
+                    &(pending_iter->second.fcgi_stdout) :
+                    &(pending_iter->second.fcgi_stderr)};
+                  stream_ptr->insert(stream_ptr->end(), content_begin,
+                    content_end);
                 }
               }
-            }
-            if(remaining_data == 0U)
-              break;
-            
-            // Some common state for ptocessing content and padding.
-            std::uint16_t fcgi_id {state_ptr->record_state.fcgi_id};
-            FcgiType record_type {state_ptr->record_state.type};
-            bool invalidated {state_ptr->record_state.invalidated};
-
-            // A lambda to ensure that the assumptions on pending_iter
-            // are met and to update pending_iter when that is needed.
-            auto PendingIterCheckAndUpdate =
-            [&pending_iter, &pending_end, &descriptor, &fcgi_id, this]()->void
-            {
-              FcgiRequestIdentifier id {descriptor, fcgi_id};
-              if((pending_iter == pending_end) || (pending_iter->first != id))
+              catch(...)
               {
-                pending_iter = pending_request_map_.find(id);
-                if(pending_iter == pending_end)
-                {
-                  throw std::logic_error {"A request was not present when "
-                    "expected in a call to "
-                    "TestFcgiClientInterface::RetrieveServerEvent."};
-                }
+                std::terminate();
+                // Termination is performed for simplicity as this is an
+                // interface for testing. Recovery may be possible. A throw
+                // from a stream handler is a violation of the requirements
+                // of SetStreamHandler.
               }
-            };
-
-            // Content
-            std::uint16_t received_content
-              {state_ptr->record_state.content_bytes_received};
-            std::uint16_t expected_content
-              {state_ptr->record_state.content_bytes_expected};
-            if(received_content < expected_content)
+            }
+            else
             {
-              std::uint16_t remaining_content {static_cast<std::uint16_t>(
-                expected_content - received_content)};
-              std::uint16_t copy_size {(remaining_data >= remaining_content) ?
-                remaining_content : static_cast<std::uint16_t>(remaining_data)};              
-              std::uint8_t* current_end {current_byte + copy_size};
-              if(!invalidated                      &&
-                 (fcgi_id != FCGI_NULL_REQUEST_ID) &&
-                 (record_type != FcgiType::kFCGI_END_REQUEST))
+              if((record_type == FcgiType::kFCGI_END_REQUEST) &&
+                 !(record_ptr->invalidated))
               {
-                // Type is either FCGI_STDOUT or FCGI_STDERR.
                 try // noexcept-equivalent block.
                 {
                   PendingIterCheckAndUpdate();
@@ -632,133 +648,80 @@ void TestFcgiClientInterface::ExamineSelectReturn()
                 {
                   std::terminate();
                   // A throw indicates an internal logic error than cannot be
-                  // recovered from. Logging may be put here later. 
-                }
-                bool is_out {record_type == FcgiType::kFCGI_STDOUT};
-                std::vector<std::uint8_t>::iterator content_end_iter {(is_out) ?
-                  pending_iter->second.fcgi_stdout.end() :
-                  pending_iter->second.fcgi_stderr.end()};
-                try // noexcept-equivalent block.
-                {
-                  (is_out) ?
-                    pending_iter->second.fcgi_stdout.insert(content_end_iter,
-                      current_byte, current_end) :
-                    pending_iter->second.fcgi_stderr.insert(content_end_iter,
-                      current_byte, current_end);
-                }
-                catch(...)
-                {
-                  std::terminate();
-                  // Termination is performed for simplicity as this is an
-                  // interface for testing. Recovery may be possible.
+                  // recovered from. Logging may be put here later.
                 }
               }
-              else
+              try // noexcept-equivalent block.
               {
-                if((record_type == FcgiType::kFCGI_END_REQUEST) &&
-                   (!invalidated))
-                {
-                  try // noexcept-equivalent block.
-                  {
-                    PendingIterCheckAndUpdate();
-                  }
-                  catch(...)
-                  {
-                    std::terminate();
-                    // A throw indicates an internal logic error than cannot be
-                    // recovered from. Logging may be put here later. 
-                  }
-                }
-                std::vector<std::uint8_t>* local_buffer_ptr
-                  {&(state_ptr->record_state.local_buffer)};
-                std::vector<std::uint8_t>::iterator local_buffer_end
-                  {local_buffer_ptr->end()};
-                try // noexcept-equivalent block.
-                {
-                  local_buffer_ptr->insert(local_buffer_end, current_byte,
-                    current_byte + copy_size);
-                }
-                catch(...)
-                {
-                  std::terminate();
-                  // Termination is performed for simplicity as this is an
-                  // interface for testing. Recovery may be possible.
-                }
+                record_ptr->local_buffer.insert(record_ptr->local_buffer.end(),
+                  content_begin, content_end);
               }
-              current_byte                                  += copy_size;
-              remaining_data                                -= copy_size;
-              received_content                              += copy_size;
-              state_ptr->record_state.content_bytes_received = received_content;
-              // Check if the record is complete.
-              if((received_content == expected_content) &&
-                 (state_ptr->record_state.padding_bytes_expected == 0U))
+              catch(...)
               {
-                try // noexcept-equivalent block.
-                {
-                  // Note that PendingIterCheckAndUpdate was called in the
-                  // three cases in which this is required, i.e. record_type is
-                  // FCGI_END_REQUEST, FCGI_STDERR, or FCGI_STDOUT and, for
-                  // each case, the record is valid.
-                  pending_iter = ProcessCompleteRecord(next_connection_,
-                    pending_iter);
-                  continue;
-                }
-                catch(...)
-                {
-                  std::terminate();
-                  // As above, failure is an invariant violation that cannot be
-                  // recovered from.
-                }
+                std::terminate();
+                // Termination is performed for simplicity as this is an
+                // interface for testing. Recovery may be possible.
               }
             }
-            if(remaining_data == 0U)
-              break;
-
-            // Padding
-            std::uint8_t expected_padding
-              {state_ptr->record_state.padding_bytes_expected};
-            std::uint8_t received_padding
-              {state_ptr->record_state.padding_bytes_received};
-            if(received_padding < expected_padding)
+          }
+
+          void OnRecordEnd()
+          {
+            RecordState* record_ptr {&(state_ptr->record_state)};
+            try // noexcept-equivalent block.
             {
-              std::uint8_t remaining_padding
-                {static_cast<std::uint8_t>(expected_padding - received_padding)};
-              std::uint8_t copy_size {static_cast<std::uint8_t>(
-                (remaining_data >= remaining_padding) ?
-                  remaining_padding : remaining_data)};
-              // Padding is discarded.
-              current_byte                                  += copy_size;
-              remaining_data                                -= copy_size;
-              received_padding                              += copy_size;
-              state_ptr->record_state.padding_bytes_received = received_padding;
-
-              // Check if the record is complete.
-              if(received_padding == expected_padding)
+              // Ensure that pending_iter refers to the appropriate pending
+              // request when this is needed.
+              if(!(record_ptr->invalidated) &&
+                 ((record_ptr->type == FcgiType::kFCGI_END_REQUEST) ||
+                  (record_ptr->type == FcgiType::kFCGI_STDERR)      ||
+                  (record_ptr->type == FcgiType::kFCGI_STDOUT)))
               {
-                try // noexcept-equivalent block.
-                {
-                  // Ensure that pending_iter refers to the appropriate pending
-                  // request when this is needed.
-                  if(!invalidated &&
-                     ((record_type == FcgiType::kFCGI_END_REQUEST) ||
-                      (record_type == FcgiType::kFCGI_STDERR)      ||
-                      (record_type == FcgiType::kFCGI_STDOUT)))
-                  {
-                    PendingIterCheckAndUpdate();
-                  }
-                  pending_iter = ProcessCompleteRecord(next_connection_,
-                    pending_iter);
-                }
-                catch(...)
-                {
-                  std::terminate();
-                  // As above, failure of either PendingIterCheckAndUpdate or
-                  // ProcessCompleteRecord cannot be recovered from (though
-                  // for different reasons).
-                }
+                PendingIterCheckAndUpdate();
               }
+              // ProcessCompleteRecord may invalidate pending_iter during its
+              // execution. It is required to return a valid value for
+              // pending_iter.
+              *pending_iter_ptr = i_ptr->ProcessCompleteRecord(
+                i_ptr->next_connection_, *pending_iter_ptr);
+            }
+            catch(...)
+            {
+              std::terminate();
+              // Failure of either PendingIterCheckAndUpdate or
+              // ProcessCompleteRecord cannot be recovered from (though for
+              // different reasons).
             }
-          } // End iterating over data received from a call to SocketRead.
+          }
+
+          TestFcgiClientInterface* i_ptr;
+          ConnectionState*         state_ptr;
+          int                      descriptor;
+          std::map<FcgiRequestIdentifier, RequestData>::iterator
+            pending_end;
+          std::map<FcgiRequestIdentifier, RequestData>::iterator*
+            pending_iter_ptr;
+        };
+        RecordHandler handler {this, state_ptr, descriptor, pending_end,
+          &pending_iter};
+
+        // Start reading until the connection blocks.
+        constexpr unsigned int buffer_size {1U << 9U};
+        std::uint8_t buffer[buffer_size];
+
+        // next_connection_ must be updated to the next connection by the time
+        // that this loop exits.
+        while(true)
+        {
+          unsigned int read_return {static_cast<unsigned int>(
+            socket_functions::SocketRead(descriptor, buffer, buffer_size))};
+          int saved_errno {errno};
+          // Decoding is currently equivalent to a noexcept-equivalent block.
+          // The decoder does not throw, and the calls of handler either do not
+          // throw (i.e., are noexcept or have C semantics) or are wrapped in a
+          // try block which causes program termination upon a throw.
+          state_ptr->record_decoder.Decode(buffer, buffer + read_return,
+            &handler);
 
           // Handle errors that may have occurred when SocketRead was called
           // and conditionally break;
@@ -803,8 +766,7 @@ void TestFcgiClientInterface::ExamineSelectReturn()
                 {
                   // Close the connection.
                   CloseConnection(descriptor);
-                  micro_event_queue_.push_back(std::unique_ptr<ServerEvent> {
-                    new ConnectionClosure {descriptor}});
+                  MicroEventQueuePush(ConnectionClosure {descriptor});
                 }
               }
               catch(...)
@@ -866,8 +828,7 @@ void TestFcgiClientInterface::FailedWrite(
     if(!(nothing_written && (error_code != EPIPE)))
     {
       CloseConnection(connection_iter->first);
-      micro_event_queue_.push_back(std::unique_ptr<ServerEvent>
-        {new ConnectionClosure {connection_iter->first}});
+      MicroEventQueuePush(ConnectionClosure {connection_iter->first});
     }
   }
   catch(...)
@@ -881,6 +842,22 @@ void TestFcgiClientInterface::FailedWrite(
   }
 }
 
+StreamHandler* TestFcgiClientInterface::FindStreamHandler(
+  std::map<int, ConnectionState>::iterator connection_iter,
+  std::map<FcgiRequestIdentifier, RequestData>::iterator pending_iter)
+  noexcept
+{
+  if(pending_iter->second.stream_handler)
+  {
+    return &(pending_iter->second.stream_handler);
+  }
+  if(connection_iter->second.stream_handler)
+  {
+    return &(connection_iter->second.stream_handler);
+  }
+  return nullptr;
+}
+
 bool TestFcgiClientInterface::IsConnected(int connection) const
 {
   std::map<int, ConnectionState>::const_iterator found_iter
@@ -900,6 +877,68 @@ std::size_t TestFcgiClientInterface::ManagementRequestCount(int connection) cons
   return connection_iter->second.management_queue.size();
 }
 
+void TestFcgiClientInterface::MicroEventQueuePopFront() noexcept
+{
+  ServerEventVariant* front_ptr
+    {&(micro_event_queue_[micro_event_queue_head_])};
+  if(FcgiResponse* response_ptr {std::get_if<FcgiResponse>(front_ptr)})
+  {
+    // Retain the stream buffers of the response for reuse. A failure to
+    // retain a buffer is not an error. Large buffers are released with the
+    // event.
+    for(std::vector<std::uint8_t>* buffer_ptr :
+      {&(response_ptr->fcgi_stdout_), &(response_ptr->fcgi_stderr_)})
+    {
+      if(buffer_ptr->capacity() &&
+         (buffer_ptr->capacity() <= kRecycledBufferCapacityLimit_) &&
+         (recycled_buffer_list_.size() < kRecycledBufferLimit_))
+      {
+        buffer_ptr->clear();
+        try
+        {
+          recycled_buffer_list_.push_back(std::move(*buffer_ptr));
+        }
+        catch(...)
+        {}
+      }
+    }
+  }
+  // Release any other resources held by the event.
+  *front_ptr = ConnectionClosure {};
+  micro_event_queue_head_ =
+    (micro_event_queue_head_ + 1U) & (micro_event_queue_.size() - 1U);
+  --micro_event_queue_count_;
+}
+
+void TestFcgiClientInterface::MicroEventQueuePush(ServerEventVariant&& event)
+{
+  MicroEventQueueReserve();
+  std::size_t capacity {micro_event_queue_.size()};
+  micro_event_queue_[(micro_event_queue_head_ + micro_event_queue_count_) &
+    (capacity - 1U)] = std::move(event);
+  ++micro_event_queue_count_;
+}
+
+void TestFcgiClientInterface::MicroEventQueueReserve()
+{
+  std::size_t capacity {micro_event_queue_.size()};
+  if(micro_event_queue_count_ < capacity)
+  {
+    return;
+  }
+  std::vector<ServerEventVariant> new_queue {};
+  new_queue.resize((capacity) ? (2U * capacity) : kMinimumEventQueueCapacity_);
+  // Moves are noexcept. The strong exception guarantee holds as the only
+  // potentially-throwing operation is the allocation above.
+  for(std::size_t i {0U}; i < micro_event_queue_count_; ++i)
+  {
+    new_queue[i] = std::move(micro_event_queue_[(micro_event_queue_head_ + i) &
+      (capacity - 1U)]);
+  }
+  micro_event_queue_.swap(new_queue);
+  micro_event_queue_head_ = 0U;
+}
+
 std::size_t TestFcgiClientInterface::PendingRequestCount(int connection) const
 {
   std::map<FcgiRequestIdentifier, RequestData>::const_iterator
@@ -933,43 +972,32 @@ TestFcgiClientInterface::ProcessCompleteRecord(
 
   ConnectionState* state_ptr {&(connection_iter->second)};
 
-  auto TryToAssignLastQueueItemPointer = [this]
-  (std::unique_ptr<ServerEvent>** assign_to)->void
+  // When an event will be generated, space for the event is reserved before
+  // any other state is modified. After this call, MicroEventQueuePush does not
+  // throw.
+  if(state_ptr->record_state.invalidated                     ||
+     ((state_ptr->record_state.type != FcgiType::kFCGI_STDOUT) &&
+      (state_ptr->record_state.type != FcgiType::kFCGI_STDERR)))
   {
-    try
-    {
-      *assign_to = &(micro_event_queue_.back());
-    }
-    catch(...)
-    {
-      // Assumes that pop_back is effectively noexcept.
-      micro_event_queue_.pop_back();
-      throw;
-    }
-  };
+    MicroEventQueueReserve();
+  }
 
   auto GenerateInvalidRecord =
   [
     this,
     connection_iter,
-    &TryToAssignLastQueueItemPointer,
     state_ptr
   ]
   ()->void
   {
-    std::unique_ptr<InvalidRecord> new_event {new InvalidRecord {}};
-    micro_event_queue_.push_back(std::unique_ptr<ServerEvent> {});
-    std::unique_ptr<ServerEvent>* back_ptr {nullptr};
-    TryToAssignLastQueueItemPointer(&back_ptr);
-    *new_event = InvalidRecord
+    MicroEventQueuePush(InvalidRecord
     {
-      state_ptr->record_state.header[kHeaderVersionIndex],
+      state_ptr->record_state.version,
       state_ptr->record_state.type,
       {connection_iter->first, state_ptr->record_state.fcgi_id},
       std::move(state_ptr->record_state.local_buffer),
       state_ptr->record_state.padding_bytes_expected
-    };
-    *back_ptr = std::move(new_event); // Upcast to ServerEvent*.
+    });
   };
 
   if(state_ptr->record_state.invalidated)
@@ -999,17 +1027,13 @@ TestFcgiClientInterface::ProcessCompleteRecord(
           GenerateInvalidRecord();
           break;
         }
-        std::unique_ptr<FcgiResponse> new_event {new FcgiResponse {}};
-        micro_event_queue_.push_back(std::unique_ptr<ServerEvent> {});
-        std::unique_ptr<ServerEvent>* back_ptr {nullptr};
-        TryToAssignLastQueueItemPointer(&back_ptr);
         if(!(completed_request_set_.insert(pending_iter->first).second))
         {
           throw std::logic_error {"A request was found to be present in the "
             "completed request tracking set when it should not have been "
             "in a call to TestFcgiClientInterface::RetrieveServerEvent."};
         }
-        *new_event = FcgiResponse
+        MicroEventQueuePush(FcgiResponse
         {
           local_app_status,
           std::move(pending_iter->second.fcgi_stderr),
@@ -1017,8 +1041,7 @@ TestFcgiClientInterface::ProcessCompleteRecord(
           lps,
           pending_iter->second.request,
           pending_iter->first
-        };
-        *back_ptr = std::move(new_event); // Upcast to ServerEvent*.
+        });
         pending_request_map_.erase(pending_iter);
         // The previous call invalidated pending iter. It must be brought to a
         // valid state.
@@ -1029,6 +1052,21 @@ TestFcgiClientInterface::ProcessCompleteRecord(
         if(state_ptr->record_state.content_bytes_expected == 0U)
         {
           pending_iter->second.stdout_completed = true;
+          // As for content, a throw from a stream handler terminates the
+          // program.
+          try
+          {
+            if(StreamHandler* handler_ptr
+              {FindStreamHandler(connection_iter, pending_iter)})
+            {
+              (*handler_ptr)(pending_iter->first, FcgiType::kFCGI_STDOUT,
+                nullptr, nullptr);
+            }
+          }
+          catch(...)
+          {
+            std::terminate();
+          }
         }
         break;
       }
@@ -1036,6 +1074,21 @@ TestFcgiClientInterface::ProcessCompleteRecord(
         if(state_ptr->record_state.content_bytes_expected == 0U)
         {
           pending_iter->second.stderr_completed = true;
+          // As for content, a throw from a stream handler terminates the
+          // program.
+          try
+          {
+            if(StreamHandler* handler_ptr
+              {FindStreamHandler(connection_iter, pending_iter)})
+            {
+              (*handler_ptr)(pending_iter->first, FcgiType::kFCGI_STDERR,
+                nullptr, nullptr);
+            }
+          }
+          catch(...)
+          {
+            std::terminate();
+          }
         }
         break;
       }
@@ -1092,34 +1145,24 @@ TestFcgiClientInterface::ProcessCompleteRecord(
             }
           }
         }
-        std::unique_ptr<GetValuesResult> new_event {new GetValuesResult {}};
-        micro_event_queue_.push_back(std::unique_ptr<ServerEvent> {});
-        std::unique_ptr<ServerEvent>* back_ptr {nullptr};
-        TryToAssignLastQueueItemPointer(&back_ptr);
-        *new_event = GetValuesResult
+        MicroEventQueuePush(GetValuesResult
         {
           (local_buffer_size) ? params_error : false,
           {connection_iter->first, FCGI_NULL_REQUEST_ID},
           std::move(state_ptr->management_queue.front().params_map),
           std::move(params_result)
-        };
-        *back_ptr = std::move(new_event); // Upcast to ServerEvent*.
+        });
         // Assumes that pop_front is effectively noexcept.
         state_ptr->management_queue.pop_front();
         break;
       }
       case FcgiType::kFCGI_UNKNOWN_TYPE : {
-        std::unique_ptr<UnknownType> new_event {new UnknownType {}};
-        micro_event_queue_.push_back(std::unique_ptr<ServerEvent> {});
-        std::unique_ptr<ServerEvent>* back_ptr {nullptr};
-        TryToAssignLastQueueItemPointer(&back_ptr);
-        *new_event = UnknownType
+        MicroEventQueuePush(UnknownType
         {
           {connection_iter->first, FCGI_NULL_REQUEST_ID},
           static_cast<FcgiType>(state_ptr->record_state.local_buffer[0]),
           std::move(state_ptr->management_queue.front())
-        };
-        *back_ptr = std::move(new_event); // Upcast to ServerEvent*.
+        });
         // Assumes that pop_front is effectively noexcept.
         state_ptr->management_queue.pop_front();
         break;
@@ -1230,28 +1273,38 @@ bool TestFcgiClientInterface::ReleaseId(int connection)
   // are performed below.
   if(connected)
   {
-    std::vector<std::uint16_t> fcgi_id_cache {};
     // Ensure that each completed request is present in the id_manager.
     //
     // Absence of a completed requests in the pending map is not verified.
     for(std::set<FcgiRequestIdentifier>::iterator
       start_copy {start}; start_copy != end; ++start_copy)
     {
-      std::uint16_t local_id {start_copy->Fcgi_id()};
-      fcgi_id_cache.push_back(local_id);
-      if(!(id_manager_ptr->IsUsed(local_id)))
+      if(!(id_manager_ptr->IsUsed(start_copy->Fcgi_id())))
       {
         throw std::logic_error {"A completed and unreleased request was not "
           "present in the appropriate IdManager instance in a call to "
           "TestFcgiClientInterface::ReleaseId."};
       }
     }
-    // It is assumed that ReleaseId won't throw because of the success of the
-    // previous check.
-    for(std::vector<std::uint16_t>::iterator i {fcgi_id_cache.begin()};
-      i != fcgi_id_cache.end(); ++i)
+    //    The completed request identifiers of the connection are ordered by
+    // FastCGI identifier. Runs of consecutive identifiers are released with a
+    // single call to ReleaseRange. As every identifier of a run is used, the
+    // run is exactly the set of identifiers which is released.
+    //    IdManager<std::uint16_t> is BitsetIdManager<std::uint16_t>, for which
+    // ReleaseRange is noexcept.
+    static_assert(noexcept(id_manager_ptr->ReleaseRange(0U, 0U)));
+    std::set<FcgiRequestIdentifier>::iterator run_start {start};
+    while(run_start != end)
     {
-      id_manager_ptr->ReleaseId(*i);
+      std::uint16_t run_last {run_start->Fcgi_id()};
+      std::set<FcgiRequestIdentifier>::iterator run_end {std::next(run_start)};
+      while((run_end != end) && (run_end->Fcgi_id() == run_last + 1U))
+      {
+        ++run_last;
+        ++run_end;
+      }
+      id_manager_ptr->ReleaseRange(run_start->Fcgi_id(), run_last);
+      run_start = run_end;
     }
   }
   else
@@ -1276,78 +1329,18 @@ bool TestFcgiClientInterface::ReleaseId(int connection)
 
 std::unique_ptr<ServerEvent> TestFcgiClientInterface::RetrieveServerEvent()
 {
-  // Outline:
-  // 1) micro_event_queue_ is always emptied before ready descriptors are
-  //    read.
-  // 2) If the queue is empty, then the next ready descriptor is read until
-  //    it blocks.
-  // 3) Once a descriptor blocks, the microevent queue is checked as in 1. The
-  //    above process continues until some event is returned or the ready
-  //    descriptors are exhausted.
-  // 4) If the ready descriptors are exhausted, a call to select is made. When
-  //    the call returns, 2 is performed (as if the queue was empty).
-  //
-  // The loop below may be viewed as an iterative implementation of a recursive
-  // definition of RetrieveServerEvent.
-  while(true)
-  {
-    if(micro_event_queue_.size())
-    {
-      std::unique_ptr<ServerEvent> new_event
-        {std::move(micro_event_queue_.front())};
-      micro_event_queue_.pop_front();
-      return new_event;
-    }
-    if(remaining_ready_ > 0)
-    {
-      ExamineSelectReturn();
-      continue;
-    }
-    // Prepare to call select.
-    // select_set_ is filled with all connections which are ready for reading.
-    // If no connections are ready for reading, then an exception is thrown.
-    FD_ZERO(&select_set_);
-    int max_for_select {-1};
-    std::map<int, ConnectionState>::reverse_iterator r_iter
-      {connection_map_.rbegin()};
-    std::map<int, ConnectionState>::reverse_iterator r_end
-      {connection_map_.rend()};
-    while(r_iter != r_end)
-    {
-      if(r_iter->second.connected)
-      {
-        max_for_select = r_iter->first;
-        break;
-      }
-      ++r_iter;
-    }
-    while(r_iter != r_end)
+  WaitForReadyEvent();
+  // The allocation of the returned event may throw. The event is removed
+  // from the ready event queue only after the allocation succeeded.
+  std::unique_ptr<ServerEvent> new_event {std::visit(
+    [](auto& event)->std::unique_ptr<ServerEvent>
     {
-      if(r_iter->second.connected)
-      {
-        FD_SET(r_iter->first, &select_set_);
-      }
-      ++r_iter;
-    }
-    if(max_for_select == -1)
-    {
-      throw std::logic_error {"A call to "
-        "TestFcgiClientInterface::RetrieveServerEvent was made when no "
-        "server connections were active."};
-    }
-    int number_ready {0};
-    while(((number_ready = select(max_for_select + 1, &select_set_, nullptr,
-      nullptr, nullptr)) == -1) && (errno == EINTR))
-      continue;
-    if(number_ready == -1)
-    {
-      std::error_code ec {errno, std::system_category()};
-      throw std::system_error {ec, "select"};
-    }
-    remaining_ready_ = number_ready;
-    next_connection_ = connection_map_.begin();
-    ExamineSelectReturn();
-  }
+      using EventType = std::decay_t<decltype(event)>;
+      return std::unique_ptr<ServerEvent> {new EventType {std::move(event)}};
+    },
+    micro_event_queue_[micro_event_queue_head_])};
+  MicroEventQueuePopFront();
+  return new_event;
 }
 
 bool TestFcgiClientInterface::SendAbortRequest(FcgiRequestIdentifier id)
@@ -1739,14 +1732,14 @@ FcgiRequestIdentifier TestFcgiClientInterface::SendRequest(int connection,
         kWriteOrSelect_);
       return FcgiRequestIdentifier {};
     }
-    // Insert a new RequestData instance to pending_request_map_.
+    // Insert a new RequestData instance to pending_request_map_. The
+    // instance is moved into the map so that the capacity of recycled
+    // buffers is kept. Insertion of a braced pair would copy it.
     try
     {
-      pending_request_map_.insert(
-      {
-        {connection, new_id},
-        {request, {}, false, {}, false}
-      });
+      pending_request_map_.emplace(FcgiRequestIdentifier {connection, new_id},
+        RequestData {request, TakeRecycledBuffer(), false,
+          TakeRecycledBuffer(), false});
     }
     catch(const std::system_error& se)
     {
@@ -1770,8 +1763,7 @@ FcgiRequestIdentifier TestFcgiClientInterface::SendRequest(int connection,
       // Connection closure implies destruction of the IdManager associated
       // with the connection.
       CloseConnection(connection);
-      micro_event_queue_.push_back(std::unique_ptr<ServerEvent>
-        {new ConnectionClosure {connection}});
+      MicroEventQueuePush(ConnectionClosure {connection});
     }
     catch(...)
     {
@@ -1781,6 +1773,44 @@ FcgiRequestIdentifier TestFcgiClientInterface::SendRequest(int connection,
   }
 }
 
+bool TestFcgiClientInterface::SetStreamHandler(int connection,
+  StreamHandler handler)
+{
+  std::map<int, ConnectionState>::iterator connection_iter
+    {ConnectedCheck(connection)};
+  if(connection_iter == connection_map_.end())
+  {
+    return false;
+  }
+  connection_iter->second.stream_handler = std::move(handler);
+  return true;
+}
+
+bool TestFcgiClientInterface::SetStreamHandler(FcgiRequestIdentifier id,
+  StreamHandler handler)
+{
+  std::map<FcgiRequestIdentifier, RequestData>::iterator pending_iter
+    {pending_request_map_.find(id)};
+  if(pending_iter == pending_request_map_.end())
+  {
+    return false;
+  }
+  pending_iter->second.stream_handler = std::move(handler);
+  return true;
+}
+
+std::vector<std::uint8_t> TestFcgiClientInterface::TakeRecycledBuffer()
+  noexcept
+{
+  std::vector<std::uint8_t> buffer {};
+  if(recycled_buffer_list_.size())
+  {
+    buffer.swap(recycled_buffer_list_.back());
+    recycled_buffer_list_.pop_back();
+  }
+  return buffer;
+}
+
 std::map<FcgiRequestIdentifier, 
   TestFcgiClientInterface::RequestData>::iterator
 TestFcgiClientInterface::UpdateOnHeaderCompletion(
@@ -1793,22 +1823,12 @@ TestFcgiClientInterface::UpdateOnHeaderCompletion(
     {pending_request_map_.end()};
 
   // Extract the header information.
-  std::uint8_t protocol_version {state_ptr->record_state.
-    header[kHeaderVersionIndex]};
-  FcgiType record_type {static_cast<FcgiType>(
-    state_ptr->record_state.header[kHeaderTypeIndex])};
-  std::uint16_t fcgi_id {state_ptr->record_state.
-    header[kHeaderRequestIDB1Index]};
-  fcgi_id <<= 8U;
-  fcgi_id += state_ptr->record_state.
-    header[kHeaderRequestIDB0Index];
-  std::uint16_t expected_content {state_ptr->record_state.
-    header[kHeaderContentLengthB1Index]};
-  expected_content <<= 8U;
-  expected_content += state_ptr->record_state.
-    header[kHeaderContentLengthB0Index];
-  std::uint8_t expected_padding {state_ptr->record_state.
-    header[kHeaderPaddingLengthIndex]};
+  const FcgiRecordDecoder::Header& header {state_ptr->record_decoder.header()};
+  std::uint8_t protocol_version {header.version};
+  FcgiType record_type {header.type};
+  std::uint16_t fcgi_id {header.fcgi_id};
+  std::uint16_t expected_content {header.content_length};
+  std::uint8_t expected_padding {header.padding_length};
 
   // This lambda function is used to update pending_iter in the case that
   // it does not refer to the request of the current record.
@@ -1850,7 +1870,9 @@ TestFcgiClientInterface::UpdateOnHeaderCompletion(
         //    FCGI_STDERR is always optional. If no data is sent over
         // FCGI_STDERR, then a terminal record is not needed for FCGI_STDERR.
         // This logic is implemented below.
-        bool stderr_empty {pending_iter->second.fcgi_stderr.size() == 0U};
+        bool stderr_empty {(pending_iter != pending_end)              &&
+          (pending_iter->second.fcgi_stderr.size() == 0U)            &&
+          !(pending_iter->second.stderr_received)};
         if(/* Case 1 */(pending_iter == pending_end)              ||
            /* Case 2 */!(pending_iter->second.stderr_completed ||
                          stderr_empty)                            ||
@@ -1915,6 +1937,7 @@ TestFcgiClientInterface::UpdateOnHeaderCompletion(
   }
   // Update the RecordState instance with the extracted information and the
   // validation status.
+  state_ptr->record_state.version                = protocol_version;
   state_ptr->record_state.type                   = record_type;
   state_ptr->record_state.fcgi_id                = fcgi_id;
   state_ptr->record_state.content_bytes_expected = expected_content;
@@ -1931,6 +1954,78 @@ TestFcgiClientInterface::UpdateOnHeaderCompletion(
   return pending_iter;
 }
 
+void TestFcgiClientInterface::WaitForReadyEvent()
+{
+  // Outline:
+  // 1) Ready descriptors are only read when micro_event_queue_ is empty.
+  // 2) If the queue is empty, then the next ready descriptor is read until
+  //    it blocks.
+  // 3) Once a descriptor blocks, the microevent queue is checked as in 1. The
+  //    above process continues until some event is ready or the ready
+  //    descriptors are exhausted.
+  // 4) If the ready descriptors are exhausted, a call to select is made. When
+  //    the call returns, 2 is performed (as if the queue was empty).
+  //
+  // The loop below may be viewed as an iterative implementation of a recursive
+  // definition of WaitForReadyEvent.
+  while(true)
+  {
+    if(micro_event_queue_count_)
+    {
+      return;
+    }
+    if(remaining_ready_ > 0)
+    {
+      ExamineSelectReturn();
+      continue;
+    }
+    // Prepare to call select.
+    // select_set_ is filled with all connections which are ready for reading.
+    // If no connections are ready for reading, then an exception is thrown.
+    FD_ZERO(&select_set_);
+    int max_for_select {-1};
+    std::map<int, ConnectionState>::reverse_iterator r_iter
+      {connection_map_.rbegin()};
+    std::map<int, ConnectionState>::reverse_iterator r_end
+      {connection_map_.rend()};
+    while(r_iter != r_end)
+    {
+      if(r_iter->second.connected)
+      {
+        max_for_select = r_iter->first;
+        break;
+      }
+      ++r_iter;
+    }
+    while(r_iter != r_end)
+    {
+      if(r_iter->second.connected)
+      {
+        FD_SET(r_iter->first, &select_set_);
+      }
+      ++r_iter;
+    }
+    if(max_for_select == -1)
+    {
+      throw std::logic_error {"A call to "
+        "TestFcgiClientInterface::RetrieveServerEvent was made when no "
+        "server connections were active."};
+    }
+    int number_ready {0};
+    while(((number_ready = select(max_for_select + 1, &select_set_, nullptr,
+      nullptr, nullptr)) == -1) && (errno == EINTR))
+      continue;
+    if(number_ready == -1)
+    {
+      std::error_code ec {errno, std::system_category()};
+      throw std::system_error {ec, "select"};
+    }
+    remaining_ready_ = number_ready;
+    next_connection_ = connection_map_.begin();
+    ExamineSelectReturn();
+  }
+}
+
 } // namespace test
 } // namespace fcgi
 } // namespace as_components
@@ -154,8 +154,10 @@
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <typeinfo>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "googletest/include/gtest/gtest.h"
@@ -1726,6 +1728,121 @@ TEST(Connect, ConnectCase4)
   ASSERT_NO_THROW(EXPECT_EQ(client_inter.Connect(nullptr, 8000), -1));
 }
 
+// AdoptConnection
+// Examined properties:
+// 1) A connection which was created outside of the client interface may be
+//    used as a connection which was made by Connect.
+// 2) Appropriate updates to observable state.
+// 3) The non-blocking status of the adopted descriptor.
+//
+// Test cases:
+// AdoptConnectionCase1
+// 1) An AF_UNIX server interface is created with a maximum connection count
+//    of one. A connection is created by a call to
+//    FcgiServerInterface::CreateLoopbackConnection, and a second call is
+//    checked to return -1. The returned descriptor is adopted and a
+//    request-response cycle is performed. The connection is then closed
+//    by invoking CloseConnection.
+//
+// Modules which testing depends on:
+// 1) FcgiServerInterface::CreateLoopbackConnection
+//
+// Other modules whose testing depends on this module: none.
+
+TEST_F(TestFcgiClientInterfaceTestFixture, AdoptConnectionCase1)
+{
+  // Creates the server interface.
+  struct InterfaceCreationArguments inter_args {kDefaultInterfaceArguments};
+  inter_args.domain          = AF_UNIX;
+  inter_args.max_connections = 1;
+  inter_args.unix_path       = kUnixPath1;
+  std::tuple<std::unique_ptr<FcgiServerInterface>, int, in_port_t>
+  inter_return {};
+  ASSERT_NO_THROW(inter_return =
+    GTestNonFatalCreateInterface(inter_args, __LINE__));
+  std::unique_ptr<FcgiServerInterface>& inter_uptr
+    {std::get<0>(inter_return)};
+  ASSERT_NE(inter_uptr.get(), nullptr);
+  ASSERT_NO_THROW(descriptor_resource_list_.push_back(
+      std::get<1>(inter_return)));
+  ASSERT_NO_THROW(path_resource_list_.push_back(kUnixPath1));
+
+  int loopback {-1};
+  ASSERT_NO_THROW(loopback = inter_uptr->CreateLoopbackConnection());
+  ASSERT_NE(loopback, -1);
+  EXPECT_EQ(inter_uptr->connection_count(), 1U);
+  int rejected_loopback {};
+  ASSERT_NO_THROW(rejected_loopback = inter_uptr->CreateLoopbackConnection());
+  EXPECT_EQ(rejected_loopback, -1);
+
+  TestFcgiClientInterface client_inter {};
+  int connection {-1};
+  ASSERT_NO_THROW(connection = client_inter.AdoptConnection(loopback));
+  ASSERT_EQ(connection, loopback);
+  int flags {fcntl(connection, F_GETFL)};
+  ASSERT_NE(flags, -1) << std::strerror(errno);
+  EXPECT_TRUE(flags & O_NONBLOCK);
+  struct ClientInterfaceObserverValues observer
+  {
+    /* co = */
+    {
+      /* connection                         = */ connection,
+      /* connection_completed_request_count = */ 0U,
+      /* is_connected                       = */ true,
+      /* management_request_count           = */ 0U,
+      /* connection_pending_request_count   = */ 0U
+    },
+    /* in = */
+    {
+      /* total_completed_request_count = */ 0U,
+      /* connection_count              = */ 1,
+      /* total_pending_request_count   = */ 0U,
+      /* ready_event_count             = */ 0U
+    }
+  };
+  ASSERT_NO_FATAL_FAILURE(GTestFatalClientInterfaceObserverCheck(client_inter,
+    observer, __LINE__));
+
+  FcgiRequestIdentifier id {};
+  ASSERT_NO_THROW(ASSERT_NE(id = client_inter.SendRequest(connection,
+    kExerciseDataRef), FcgiRequestIdentifier {}));
+  ++(observer.co.connection_pending_request_count);
+  ++(observer.in.total_pending_request_count);
+  ASSERT_NO_FATAL_FAILURE(GTestFatalClientInterfaceObserverCheck(client_inter,
+    observer, __LINE__));
+  std::vector<FcgiRequest> accept_buffer {};
+  ASSERT_NO_THROW
+  (
+    while(!accept_buffer.size())
+    {
+      accept_buffer = inter_uptr->AcceptRequests();
+    }
+  );
+  EXPECT_EQ(accept_buffer.size(), 1U);
+  ASSERT_NO_FATAL_FAILURE(GTestFatalOperationForRequestEcho(&accept_buffer,
+    kSharedExerciseParams, kExerciseDataRef.role, kExerciseDataRef.keep_conn,
+    __LINE__));
+  std::unique_ptr<ServerEvent> event_uptr {};
+  ASSERT_NO_THROW(event_uptr = client_inter.RetrieveServerEvent());
+  ASSERT_NE(event_uptr.get(), nullptr);
+  FcgiResponse* response_ptr {dynamic_cast<FcgiResponse*>(event_uptr.get())};
+  ASSERT_NE(response_ptr, nullptr);
+  --(observer.co.connection_pending_request_count);
+  --(observer.in.total_pending_request_count);
+  ++(observer.co.connection_completed_request_count);
+  ++(observer.in.total_completed_request_count);
+  ASSERT_NO_FATAL_FAILURE(GTestFatalClientInterfaceObserverCheck(client_inter,
+    observer, __LINE__));
+  ASSERT_NO_FATAL_FAILURE(GTestFatalEchoResponseCompare(kExerciseDataRef,
+    response_ptr, __LINE__));
+
+  ASSERT_NO_THROW(ASSERT_TRUE(client_inter.CloseConnection(connection)));
+  observer.co.is_connected = false;
+  --(observer.in.connection_count);
+  ASSERT_NO_FATAL_FAILURE(GTestFatalClientInterfaceObserverCheck(client_inter,
+    observer, __LINE__));
+}
+
 // Testing of:
 // std::size_t CompletedRequestCount()
 // std::size_t CompletedRequestCount(int)
@@ -3559,6 +3676,154 @@ TEST_F(TestFcgiClientInterfaceTestFixture, RetrieveServerEventInvalidRecordSet)
   ASSERT_NO_FATAL_FAILURE(GTestFatalGetValuesRetrieveCompare(__LINE__));
 }
 
+// VisitServerEvent
+// Examined properties:
+// 1) The type of the event which is passed to the visitor.
+// 2) Interaction with the ready event queue: a visited event is removed from
+//    the queue. This includes the case that the visitor throws.
+// 3) Reuse of the stream buffers of visited FcgiResponse instances for the
+//    responses of subsequent requests.
+// 4) Exception behavior when no connections and no ready events are present.
+//
+// Test cases:
+// 1) An FCGI_GET_VALUES request and an application request are sent over a
+//    single connection. Two events are visited: a GetValuesResult instance and
+//    then an FcgiResponse instance. The response is compared to the request.
+// 2) The application request cycle of 1 is repeated after the completed
+//    request was released. The response is compared as before. The
+//    FCGI_STDOUT and FCGI_STDERR buffers of the response are the buffers of
+//    the response of 1.
+// 3) As in 2, but the visitor throws. The exception propagates, and the
+//    event is not present in the ready event queue.
+// 4) The server is destroyed. A ConnectionClosure instance is visited.
+//    A subsequent call throws std::logic_error.
+//
+// Modules which testing depends on:
+// 1) RetrieveServerEvent through shared implementation.
+//
+// Other modules whose testing depends on this module: none.
+
+TEST_F(TestFcgiClientInterfaceTestFixture, VisitServerEvent)
+{
+  // Creates the server interface.
+  struct InterfaceCreationArguments inter_args {kDefaultInterfaceArguments};
+  inter_args.domain          = AF_UNIX;
+  inter_args.unix_path       = kUnixPath1;
+  std::tuple<std::unique_ptr<FcgiServerInterface>, int, in_port_t>
+  inter_return {};
+  ASSERT_NO_THROW(inter_return =
+    GTestNonFatalCreateInterface(inter_args, __LINE__));
+  std::unique_ptr<FcgiServerInterface>& inter_uptr
+    {std::get<0>(inter_return)};
+  ASSERT_NE(inter_uptr.get(), nullptr);
+  ASSERT_NO_THROW(descriptor_resource_list_.push_back(
+      std::get<1>(inter_return)));
+  ASSERT_NO_THROW(path_resource_list_.push_back(kUnixPath1));
+
+  TestFcgiClientInterface client_inter {};
+  int connection {};
+  ASSERT_NO_THROW(ASSERT_NE(connection = client_inter.Connect(kUnixPath1, 0U),
+    -1)) << std::strerror(errno);
+
+  // The index of ServerEventVariant of the most recently visited event.
+  std::size_t visited_index {std::variant_npos};
+  FcgiRequestIdentifier visited_id {};
+  auto IndexRecorder = [&visited_index, &visited_id]
+  (auto& event)->void
+  {
+    visited_id = event.RequestId();
+    visited_index =
+      ServerEventVariant {std::in_place_type<std::decay_t<decltype(event)>>}.
+        index();
+  };
+  // The addresses of the stream buffers of the most recently visited
+  // FcgiResponse instance.
+  std::set<const std::uint8_t*> response_buffers {};
+  auto GTestFatalEchoCycle = [&](bool get_values_sent, int invocation_line)
+  ->void
+  {
+    ::testing::ScopedTrace tracer {__FILE__, invocation_line,
+      "lambda GTestFatalEchoCycle"};
+    FcgiRequestIdentifier request_id {};
+    ASSERT_NO_THROW(ASSERT_NE(request_id = client_inter.SendRequest(
+      connection, kExerciseDataRef), FcgiRequestIdentifier {}));
+    ASSERT_NO_FATAL_FAILURE(GTestFatalAcceptRequestsRequestEcho(
+      inter_uptr.get(), *(kExerciseDataRef.params_map_ptr), FCGI_RESPONDER,
+      true, __LINE__));
+    if(get_values_sent)
+    {
+      ASSERT_NO_THROW(client_inter.VisitServerEvent([](auto& event)->void
+      {
+        using EventType = std::decay_t<decltype(event)>;
+        ASSERT_TRUE((std::is_same<EventType, GetValuesResult>::value));
+        if constexpr(std::is_same<EventType, GetValuesResult>::value)
+        {
+          EXPECT_FALSE(event.IsCorrupt());
+          EXPECT_EQ(event.RequestMap(), kMpxsNameMap);
+          EXPECT_EQ(event.ResponseMap(), kMpxsMapWithValue);
+        }
+      }));
+    }
+    bool response_visited {false};
+    ASSERT_NO_THROW(client_inter.VisitServerEvent([&](auto& event)->void
+    {
+      using EventType = std::decay_t<decltype(event)>;
+      if constexpr(std::is_same<EventType, FcgiResponse>::value)
+      {
+        response_visited = true;
+        response_buffers = {event.FcgiStdout().data(),
+          event.FcgiStderr().data()};
+        EXPECT_EQ(event.RequestId(), request_id);
+        GTestFatalEchoResponseCompare(kExerciseDataRef, &event, __LINE__);
+      }
+    }));
+    ASSERT_TRUE(response_visited);
+    ASSERT_EQ(client_inter.ReadyEventCount(), 0U);
+    ASSERT_EQ(client_inter.CompletedRequestCount(), 1U);
+    ASSERT_TRUE(client_inter.ReleaseId(request_id));
+  };
+
+  // TEST CASE 1
+  ASSERT_NO_THROW(ASSERT_TRUE(client_inter.SendGetValuesRequest(connection,
+    kMpxsNameMap)));
+  ASSERT_NO_FATAL_FAILURE(GTestFatalEchoCycle(true, __LINE__));
+  ASSERT_EQ(client_inter.ManagementRequestCount(connection), 0U);
+
+  // TEST CASE 2
+  std::set<const std::uint8_t*> first_response_buffers {response_buffers};
+  ASSERT_EQ(first_response_buffers.size(), 2U);
+  ASSERT_NO_FATAL_FAILURE(GTestFatalEchoCycle(false, __LINE__));
+  EXPECT_EQ(response_buffers, first_response_buffers);
+
+  // TEST CASE 3
+  FcgiRequestIdentifier request_id {};
+  ASSERT_NO_THROW(ASSERT_NE(request_id = client_inter.SendRequest(
+    connection, kExerciseDataRef), FcgiRequestIdentifier {}));
+  ASSERT_NO_FATAL_FAILURE(GTestFatalAcceptRequestsRequestEcho(
+    inter_uptr.get(), *(kExerciseDataRef.params_map_ptr), FCGI_RESPONDER,
+    true, __LINE__));
+  EXPECT_THROW(client_inter.VisitServerEvent([&](auto& event)->void
+    {
+      IndexRecorder(event);
+      throw std::runtime_error {"VisitServerEvent visitor throw"};
+    }), std::runtime_error);
+  EXPECT_EQ(visited_index, 0U);
+  EXPECT_EQ(visited_id, request_id);
+  EXPECT_EQ(client_inter.ReadyEventCount(), 0U);
+  EXPECT_EQ(client_inter.CompletedRequestCount(), 1U);
+  EXPECT_EQ(client_inter.PendingRequestCount(), 0U);
+
+  // TEST CASE 4
+  delete(inter_uptr.release());
+  ASSERT_NO_THROW(client_inter.VisitServerEvent(IndexRecorder));
+  EXPECT_EQ(visited_index, 1U);
+  EXPECT_EQ(visited_id, (FcgiRequestIdentifier {connection,
+    FCGI_NULL_REQUEST_ID}));
+  ASSERT_EQ(client_inter.ConnectionCount(), 0);
+  ASSERT_EQ(client_inter.ReadyEventCount(), 0U);
+  EXPECT_THROW(client_inter.VisitServerEvent(IndexRecorder), std::logic_error);
+}
+
 // SendAbortRequest
 // Examined properties:
 // 1) Four properties, each with distinct possible values, are present which
@@ -6375,6 +6640,191 @@ TEST_F(TestFcgiClientInterfaceTestFixture, SendRequestCaseSet5)
     kUnixPath1, 0U, &client_inter, inter_uptr.get(), disconnector, __LINE__)));
 }
 
+// SetStreamHandler
+// Examined properties:
+// 1) Registration failure for a connection which is not connected and for an
+//    identifier which does not refer to a pending request.
+// 2) Delivery of stream content to a connection handler instead of to the
+//    FcgiResponse instance of a request.
+// 3) Precedence of a request handler over a connection handler.
+// 4) Removal of a handler by the registration of an empty handler.
+// 5) Removal of a connection handler upon connection closure.
+//
+// Test cases:
+// 1) SetStreamHandler is called for a connection which was never connected
+//    and for a default-constructed FcgiRequestIdentifier instance.
+// 2) A connection handler which counts received bytes is registered. An
+//    application request-response cycle is performed. The byte counts equal
+//    the lengths of the echoed streams, the terminal FCGI_STDOUT record is
+//    reported with an empty range, and the streams of the response are empty.
+// 3) As in 2, but a request handler which retains the first two bytes of
+//    FCGI_STDOUT is registered for the request. The counts of the connection
+//    handler do not change.
+// 4) The connection handler is removed. A request-response cycle produces a
+//    response which holds the echoed streams.
+// 5) A connection handler is registered, the connection is closed, and a new
+//    connection is made with the same descriptor. A request-response cycle
+//    produces a response which holds the echoed streams.
+//
+// Modules which testing depends on:
+// 1) SendRequest
+// 2) RetrieveServerEvent
+//
+// Other modules whose testing depends on this module: none.
+
+TEST_F(TestFcgiClientInterfaceTestFixture, SetStreamHandler)
+{
+  // Creates the server interface.
+  struct InterfaceCreationArguments inter_args {kDefaultInterfaceArguments};
+  inter_args.domain          = AF_UNIX;
+  inter_args.unix_path       = kUnixPath1;
+  std::tuple<std::unique_ptr<FcgiServerInterface>, int, in_port_t>
+  inter_return {};
+  ASSERT_NO_THROW(inter_return =
+    GTestNonFatalCreateInterface(inter_args, __LINE__));
+  std::unique_ptr<FcgiServerInterface>& inter_uptr
+    {std::get<0>(inter_return)};
+  ASSERT_NE(inter_uptr.get(), nullptr);
+  ASSERT_NO_THROW(descriptor_resource_list_.push_back(
+      std::get<1>(inter_return)));
+  ASSERT_NO_THROW(path_resource_list_.push_back(kUnixPath1));
+
+  TestFcgiClientInterface client_inter {};
+  std::size_t stdout_byte_count {0U};
+  std::size_t stderr_byte_count {0U};
+  int stdout_completion_count {0};
+  StreamHandler counter {[&]
+  (
+    FcgiRequestIdentifier,
+    FcgiType type,
+    const std::uint8_t* begin,
+    const std::uint8_t* end
+  )->void
+  {
+    bool is_out {type == FcgiType::kFCGI_STDOUT};
+    if(begin == end)
+    {
+      if(is_out)
+      {
+        ++stdout_completion_count;
+      }
+      return;
+    }
+    ((is_out) ? stdout_byte_count : stderr_byte_count) += (end - begin);
+  }};
+
+  // TEST CASE 1
+  EXPECT_FALSE(client_inter.SetStreamHandler(1000, counter));
+  EXPECT_FALSE(client_inter.SetStreamHandler(FcgiRequestIdentifier {},
+    counter));
+
+  int connection {};
+  ASSERT_NO_THROW(ASSERT_NE(connection = client_inter.Connect(kUnixPath1, 0U),
+    -1)) << std::strerror(errno);
+
+  // Sends kExerciseDataRef, echoes it, and retrieves the response. The
+  // response is compared to the request when compare is true. Otherwise, the
+  // streams of the response are expected to be empty.
+  auto GTestFatalHandlerCycle = [&]
+  (
+    StreamHandler request_handler,
+    bool compare,
+    int invocation_line
+  )->void
+  {
+    ::testing::ScopedTrace tracer {__FILE__, invocation_line,
+      "lambda GTestFatalHandlerCycle"};
+    FcgiRequestIdentifier request_id {};
+    ASSERT_NO_THROW(ASSERT_NE(request_id = client_inter.SendRequest(
+      connection, kExerciseDataRef), FcgiRequestIdentifier {}));
+    if(request_handler)
+    {
+      ASSERT_TRUE(client_inter.SetStreamHandler(request_id,
+        std::move(request_handler)));
+    }
+    ASSERT_NO_FATAL_FAILURE(GTestFatalAcceptRequestsRequestEcho(
+      inter_uptr.get(), *(kExerciseDataRef.params_map_ptr), FCGI_RESPONDER,
+      true, __LINE__));
+    std::unique_ptr<ServerEvent> event_uptr {};
+    ASSERT_NO_THROW(event_uptr = client_inter.RetrieveServerEvent());
+    FcgiResponse* response_ptr {dynamic_cast<FcgiResponse*>(event_uptr.get())};
+    ASSERT_NE(response_ptr, nullptr);
+    EXPECT_EQ(response_ptr->RequestId(), request_id);
+    if(compare)
+    {
+      ASSERT_NO_FATAL_FAILURE(GTestFatalEchoResponseCompare(kExerciseDataRef,
+        response_ptr, __LINE__));
+    }
+    else
+    {
+      EXPECT_EQ(response_ptr->AppStatus(), EXIT_SUCCESS);
+      EXPECT_EQ(response_ptr->ProtocolStatus(), FCGI_REQUEST_COMPLETE);
+      EXPECT_EQ(response_ptr->FcgiStdout().size(), 0U);
+      EXPECT_EQ(response_ptr->FcgiStderr().size(), 0U);
+    }
+    // The handler of a completed request cannot be set.
+    EXPECT_FALSE(client_inter.SetStreamHandler(request_id, counter));
+    ASSERT_TRUE(client_inter.ReleaseId(request_id));
+  };
+
+  // TEST CASE 2
+  ASSERT_TRUE(client_inter.SetStreamHandler(connection, counter));
+  ASSERT_NO_FATAL_FAILURE(GTestFatalHandlerCycle(StreamHandler {}, false,
+    __LINE__));
+  EXPECT_EQ(stdout_byte_count, kStdinDataForClientExercise.size());
+  EXPECT_EQ(stderr_byte_count, kFcgiDataForClientExercise.size());
+  EXPECT_EQ(stdout_completion_count, 1);
+
+  // TEST CASE 3
+  std::vector<std::uint8_t> stdout_prefix {};
+  StreamHandler prefix_keeper {[&stdout_prefix]
+  (
+    FcgiRequestIdentifier,
+    FcgiType type,
+    const std::uint8_t* begin,
+    const std::uint8_t* end
+  )->void
+  {
+    constexpr std::size_t prefix_limit {2U};
+    if(type != FcgiType::kFCGI_STDOUT)
+    {
+      return;
+    }
+    while((begin != end) && (stdout_prefix.size() < prefix_limit))
+    {
+      stdout_prefix.push_back(*begin);
+      ++begin;
+    }
+  }};
+  ASSERT_NO_FATAL_FAILURE(GTestFatalHandlerCycle(std::move(prefix_keeper),
+    false, __LINE__));
+  EXPECT_EQ(stdout_prefix, (std::vector<std::uint8_t>
+    {kStdinDataForClientExercise.begin(),
+     kStdinDataForClientExercise.begin() + 2}));
+  EXPECT_EQ(stdout_byte_count, kStdinDataForClientExercise.size());
+  EXPECT_EQ(stderr_byte_count, kFcgiDataForClientExercise.size());
+  EXPECT_EQ(stdout_completion_count, 1);
+
+  // TEST CASE 4
+  ASSERT_TRUE(client_inter.SetStreamHandler(connection, StreamHandler {}));
+  ASSERT_NO_FATAL_FAILURE(GTestFatalHandlerCycle(StreamHandler {}, true,
+    __LINE__));
+  EXPECT_EQ(stdout_completion_count, 1);
+
+  // TEST CASE 5
+  ASSERT_TRUE(client_inter.SetStreamHandler(connection, counter));
+  ASSERT_TRUE(client_inter.CloseConnection(connection));
+  ASSERT_NO_FATAL_FAILURE(GTestFatalAcceptRequestsExpectNone(inter_uptr.get(),
+    __LINE__));
+  int new_connection {};
+  ASSERT_NO_THROW(ASSERT_NE(new_connection = client_inter.Connect(kUnixPath1,
+    0U), -1)) << std::strerror(errno);
+  ASSERT_EQ(new_connection, connection);
+  ASSERT_NO_FATAL_FAILURE(GTestFatalHandlerCycle(StreamHandler {}, true,
+    __LINE__));
+  EXPECT_EQ(stdout_completion_count, 1);
+}
+
 } // namespace test
 } // namespace test
 } // namespace fcgi
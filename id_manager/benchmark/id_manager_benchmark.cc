@@ -0,0 +1,164 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Compares IntervalIdManager<std::uint16_t> and BitsetIdManager<std::uint16_t>
+// under the access patterns of a FastCGI client which assigns request
+// identifiers with GetId and releases them when requests complete.
+//
+// Benchmarks:
+// 1) Sequential: range(0) IDs are acquired and then released in the order in
+//    which they were acquired. Each iteration performs range(0) GetId and
+//    range(0) ReleaseId calls. This models requests which complete in the
+//    order in which they were sent.
+// 2) Random: range(0) IDs are acquired before timing starts. Each iteration
+//    releases a pseudo-randomly selected in-use ID and acquires a new ID.
+//    This models requests which complete out of order. For the interval
+//    representation, this pattern fragments the used set.
+// 3) Threaded: each of state.threads() threads shares a single manager. A
+//    thread keeps range(0) IDs outstanding and, in each iteration, releases
+//    its oldest ID and acquires a new ID. ConcurrentIdManager<std::uint16_t>
+//    is compared with a BitsetIdManager<std::uint16_t> which is guarded by a
+//    std::mutex.
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include "googlebenchmark/include/benchmark/benchmark.h"
+
+#include "id_manager/include/concurrent_id_manager_template.h"
+#include "id_manager/include/id_manager_template.h"
+
+namespace {
+
+template<typename Manager>
+void BM_SequentialRelease(benchmark::State& state)
+{
+  const std::size_t id_count {static_cast<std::size_t>(state.range(0))};
+  std::vector<std::uint16_t> ids(id_count);
+  Manager manager {};
+  for(auto _ : state)
+  {
+    for(std::size_t i {0U}; i < id_count; ++i)
+      ids[i] = manager.GetId();
+    for(std::size_t i {0U}; i < id_count; ++i)
+      manager.ReleaseId(ids[i]);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * id_count * 2);
+}
+
+template<typename Manager>
+void BM_RandomRelease(benchmark::State& state)
+{
+  const std::size_t id_count {static_cast<std::size_t>(state.range(0))};
+  std::vector<std::uint16_t> ids(id_count);
+  Manager manager {};
+  for(std::size_t i {0U}; i < id_count; ++i)
+    ids[i] = manager.GetId();
+  // Indices are generated before timing starts so that the random number
+  // engine is not measured.
+  constexpr std::size_t kIndexCount {1U << 16};
+  std::vector<std::size_t> indices(kIndexCount);
+  std::mt19937 engine {1U};
+  std::uniform_int_distribution<std::size_t> distribution {0U, id_count - 1U};
+  for(std::size_t& index : indices)
+    index = distribution(engine);
+
+  std::size_t position {0U};
+  for(auto _ : state)
+  {
+    std::size_t index {indices[position]};
+    position = (position + 1U) % kIndexCount;
+    manager.ReleaseId(ids[index]);
+    ids[index] = manager.GetId();
+    benchmark::DoNotOptimize(ids[index]);
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// A BitsetIdManager which is made thread-safe with a mutex. It serves as the
+// baseline of the threaded benchmark.
+class MutexBitsetManager
+{
+ public:
+  std::uint16_t GetId()
+  {
+    std::lock_guard<std::mutex> lock {mutex_};
+    return manager_.GetId();
+  }
+
+  void ReleaseId(std::uint16_t id)
+  {
+    std::lock_guard<std::mutex> lock {mutex_};
+    manager_.ReleaseId(id);
+  }
+
+ private:
+  std::mutex mutex_ {};
+  as_components::BitsetIdManager<std::uint16_t> manager_ {};
+};
+
+template<typename Manager>
+void BM_ThreadedRelease(benchmark::State& state)
+{
+  // The shared manager is constructed on first use. Threads begin their timed
+  // loops together, and all IDs are released before a thread returns.
+  static Manager manager {};
+  const std::size_t id_count {static_cast<std::size_t>(state.range(0))};
+  std::vector<std::uint16_t> ids(id_count);
+  for(std::size_t i {0U}; i < id_count; ++i)
+    ids[i] = manager.GetId();
+
+  std::size_t oldest {0U};
+  for(auto _ : state)
+  {
+    manager.ReleaseId(ids[oldest]);
+    ids[oldest] = manager.GetId();
+    benchmark::DoNotOptimize(ids[oldest]);
+    oldest = (oldest + 1U) % id_count;
+  }
+  for(std::uint16_t id : ids)
+    manager.ReleaseId(id);
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+using IntervalManager   = as_components::IntervalIdManager<std::uint16_t>;
+using BitsetManager     = as_components::BitsetIdManager<std::uint16_t>;
+using ConcurrentManager = as_components::ConcurrentIdManager<std::uint16_t>;
+
+BENCHMARK_TEMPLATE(BM_SequentialRelease, IntervalManager)
+  ->Arg(16)->Arg(256)->Arg(4096)->Arg(65535);
+BENCHMARK_TEMPLATE(BM_SequentialRelease, BitsetManager)
+  ->Arg(16)->Arg(256)->Arg(4096)->Arg(65535);
+BENCHMARK_TEMPLATE(BM_RandomRelease, IntervalManager)
+  ->Arg(16)->Arg(256)->Arg(4096)->Arg(65535);
+BENCHMARK_TEMPLATE(BM_RandomRelease, BitsetManager)
+  ->Arg(16)->Arg(256)->Arg(4096)->Arg(65535);
+BENCHMARK_TEMPLATE(BM_ThreadedRelease, MutexBitsetManager)
+  ->Arg(64)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ThreadedRelease, ConcurrentManager)
+  ->Arg(64)->ThreadRange(1, 8)->UseRealTime();
+
+} // namespace
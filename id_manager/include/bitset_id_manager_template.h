@@ -0,0 +1,550 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef AS_COMPONENTS_ID_MANAGER_INCLUDE_BITSET_ID_MANAGER_TEMPLATE_H_
+#define AS_COMPONENTS_ID_MANAGER_INCLUDE_BITSET_ID_MANAGER_TEMPLATE_H_
+
+// Class Description:
+//    BitsetIdManager<I> implements the semantics of IdManager<I> which are
+// described in id_manager_template.h. It is intended for small integral types
+// such as std::uint16_t, the type of FastCGI request identifiers. For such
+// types, every value of [0, I_max] can be represented by a single bit at a
+// modest, fixed space cost.
+//
+// Requirements on I:
+// 1) I is an integral type other than bool.
+// 2) The number of non-sign bits of I is at least 6 and at most 16. This
+//    implies that I_max + 1 is a multiple of 64.
+//
+// Implementation discussion:
+//    The dynamic set is stored in a three-level bitset hierarchy. Let a word
+// be a std::uint64_t value.
+// 1) words_ holds one bit per value of [0, I_max]. Value i is represented by
+//    bit i % 64 of words_[i / 64]. Bit 0 of words_[0], which represents the
+//    value 0, is always set so that 0 is never returned by GetId.
+// 2) summary_ holds one bit per word of words_. Bit j % 64 of summary_[j / 64]
+//    is set if and only if words_[j] is full (has all bits set).
+// 3) top_ holds one bit per word of summary_. Bit k is set if and only if
+//    summary_[k] is full.
+//    Bits of summary_ and top_ which do not correspond to a word of the level
+// below are set on construction and never cleared. As such, a full top_
+// means that every value is in use.
+//    The least unused value is found by locating the least clear bit at each
+// level. This requires three count-trailing-zeros operations. A release
+// clears at most one bit per level. No operation allocates.
+//    The bulk operations GetIds and ReleaseRange act on a word at a time. The
+// summary level allows GetIds to skip full words. Their cost is proportional
+// to the number of words which are touched rather than to the number of IDs.
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace as_components {
+
+// IsBitsetIdManagerType<I>::value is true if and only if I satisfies the
+// requirements of BitsetIdManager<I>.
+template<typename I>
+struct IsBitsetIdManagerType
+  : std::integral_constant<bool,
+      std::is_integral<I>::value                            &&
+      !std::is_same<typename std::remove_cv<I>::type, bool>::value &&
+      (std::numeric_limits<I>::digits >= 6)                 &&
+      (std::numeric_limits<I>::digits <= 16)>
+{};
+
+template<typename I>
+class BitsetIdManager
+{
+ public:
+  // A constant forward iterator over the maximal intervals of used IDs in
+  // increasing order. For an iterator it, it->first is the least and
+  // it->second is the greatest ID of an interval. An iterator is invalidated
+  // by any modification of its BitsetIdManager instance.
+  class UsedIntervalIterator
+  {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::pair<I, I>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const value_type*;
+    using reference         = const value_type&;
+
+    inline reference operator*() const noexcept
+    {
+      return interval_;
+    }
+
+    inline pointer operator->() const noexcept
+    {
+      return &interval_;
+    }
+
+    UsedIntervalIterator& operator++() noexcept;
+
+    inline UsedIntervalIterator operator++(int) noexcept
+    {
+      UsedIntervalIterator copy {*this};
+      ++(*this);
+      return copy;
+    }
+
+    // As 0 is never used, an interval which starts at 0 denotes the end.
+    inline bool operator==(const UsedIntervalIterator& other) const noexcept
+    {
+      return interval_.first == other.interval_.first;
+    }
+
+    inline bool operator!=(const UsedIntervalIterator& other) const noexcept
+    {
+      return !(*this == other);
+    }
+
+    UsedIntervalIterator() = default;
+
+   private:
+    friend class BitsetIdManager;
+
+    // Positions the iterator at the first interval whose least ID is not
+    // less than position.
+    UsedIntervalIterator(const BitsetIdManager* manager_ptr,
+      std::size_t position) noexcept;
+
+    const BitsetIdManager* manager_ptr_ {nullptr};
+    value_type interval_ {0, 0};
+  };
+
+  // Returns the least unused ID. IDs start at 1.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions:
+  // 1) If all allowed IDs are in use, std::length_error is thrown. In this
+  //    case, no change to the instance occurred.
+  //
+  // Effects:
+  // 1) The least value of [1, I_max] which was not in use was returned.
+  // 2) The returned ID is regarded as used.
+  I GetId();
+
+  // Acquires the n least unused IDs and writes them in increasing order to
+  // the output iterator out.
+  //
+  // Parameters:
+  // n:   The number of IDs to acquire. No action is taken if n <= 0.
+  // out: An output iterator to a sequence which can receive n values of I.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions:
+  // 1) If fewer than n IDs are unused, std::length_error is thrown.
+  // 2) Exceptions thrown by operations on out are propagated.
+  // 3) If an exception is thrown, the instance is unchanged. The state of the
+  //    output sequence is unspecified in this case.
+  //
+  // Effects:
+  // 1) The n least unused IDs were written to out and are regarded as used.
+  // 2) The returned iterator is one past the last written value.
+  template<typename OutputIt>
+  OutputIt GetIds(I n, OutputIt out);
+
+  // Returns true if the id is in use. Returns false otherwise.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions: noexcept.
+  inline bool IsUsed(I i) const noexcept
+  {
+    if(i <= 0)
+      return false;
+    std::size_t index {static_cast<std::size_t>(i)};
+    return (words_[index / 64U] >> (index % 64U)) & 1U;
+  }
+
+  inline I NumberOfUsedIds() const noexcept
+  {
+    return size_;
+  }
+
+  // Informs the BitsetIdManager instance that id should no longer be regarded
+  // as used.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions:
+  // 1) If id is not currently in use, std::logic_error is thrown. In this
+  //    case, no change to the instance occurred.
+  //
+  // Effects:
+  // 1) The instance recorded that id is no longer in use.
+  void ReleaseId(I id);
+
+  // Releases every used ID of [lo, hi]. Unused IDs of [lo, hi] are ignored.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions: noexcept.
+  //
+  // Effects:
+  // 1) The used IDs of [lo, hi] are no longer regarded as used. The number of
+  //    released IDs was returned. If hi < lo, 0 was returned.
+  I ReleaseRange(I lo, I hi) noexcept;
+
+  // Releases every used ID. The instance has the state of a newly-constructed
+  // instance.
+  void ReleaseAll() noexcept;
+
+  inline UsedIntervalIterator UsedIntervalsBegin() const noexcept
+  {
+    return UsedIntervalIterator {this, 1U};
+  }
+
+  inline UsedIntervalIterator UsedIntervalsEnd() const noexcept
+  {
+    return UsedIntervalIterator {};
+  }
+
+  BitsetIdManager() noexcept;
+
+  BitsetIdManager(const BitsetIdManager&) = default;
+  BitsetIdManager(BitsetIdManager&&) = default;
+
+  BitsetIdManager& operator=(const BitsetIdManager&) = default;
+  BitsetIdManager& operator=(BitsetIdManager&&) = default;
+
+  ~BitsetIdManager() = default;
+
+ private:
+  static_assert(IsBitsetIdManagerType<I>::value, "BitsetIdManager<I> requires "
+    "an integral type other than bool with between 6 and 16 non-sign bits.");
+
+  static constexpr std::size_t kIdCount_
+    {std::size_t {1U} << std::numeric_limits<I>::digits};
+  static constexpr std::size_t kWordCount_ {kIdCount_ / 64U};
+  static constexpr std::size_t kSummaryCount_ {(kWordCount_ + 63U) / 64U};
+  static constexpr std::uint64_t kFullWord_
+    {std::numeric_limits<std::uint64_t>::max()};
+
+  static_assert(kSummaryCount_ <= 64U);
+
+  // Returns the index of the least significant clear bit of word.
+  // Precondition: word != kFullWord_.
+  // (std::countr_one is not available in C++17.)
+  static inline std::size_t LeastClearBit(std::uint64_t word) noexcept
+  {
+    return static_cast<std::size_t>(__builtin_ctzll(~word));
+  }
+
+  // Returns the index of the first word of words_ at or after word_index
+  // which is not full. Returns kWordCount_ if no such word exists.
+  std::size_t NextNonFullWord(std::size_t word_index) const noexcept;
+
+  // Returns the least value at or after position whose bit is set (or clear
+  // for NextClear). Returns kIdCount_ if no such value exists.
+  std::size_t NextSet(std::size_t position) const noexcept;
+  std::size_t NextClear(std::size_t position) const noexcept;
+
+  // Calls visitor(word_index, mask) for each word which holds some of the n
+  // least unused IDs in increasing order of word_index. mask has the bits of
+  // these IDs for the word. Precondition: at least n IDs are unused.
+  template<typename Visitor>
+  void VisitLeastUnused(std::size_t n, Visitor&& visitor) const;
+
+  // Sets the bits of mask in words_[word_index] and updates summary_ and
+  // top_.
+  void SetBits(std::size_t word_index, std::uint64_t mask) noexcept;
+
+  I size_;
+  std::uint64_t top_;
+  std::uint64_t summary_[kSummaryCount_];
+  std::uint64_t words_[kWordCount_];
+};
+
+template<typename I>
+BitsetIdManager<I>::BitsetIdManager() noexcept
+: size_    {0},
+  top_     {},
+  summary_ {},
+  words_   {}
+{
+  ReleaseAll();
+}
+
+template<typename I>
+void BitsetIdManager<I>::ReleaseAll() noexcept
+{
+  size_ = 0;
+  top_  = (kSummaryCount_ == 64U) ? std::uint64_t {0U} :
+    (kFullWord_ << kSummaryCount_);
+  for(std::uint64_t& summary_word : summary_)
+    summary_word = 0U;
+  for(std::uint64_t& word : words_)
+    word = 0U;
+  // Reserve 0.
+  words_[0] = 1U;
+  // Mark the bits of the final summary word which do not correspond to a word
+  // of words_ as full.
+  std::size_t remainder {kWordCount_ % 64U};
+  if(remainder)
+    summary_[kSummaryCount_ - 1U] = kFullWord_ << remainder;
+}
+
+template<typename I>
+std::size_t BitsetIdManager<I>::NextNonFullWord(std::size_t word_index)
+  const noexcept
+{
+  std::size_t summary_index {word_index / 64U};
+  if(summary_index >= kSummaryCount_)
+    return kWordCount_;
+  std::uint64_t candidates
+    {~summary_[summary_index] & (kFullWord_ << (word_index % 64U))};
+  while(!candidates)
+  {
+    if(++summary_index == kSummaryCount_)
+      return kWordCount_;
+    candidates = ~summary_[summary_index];
+  }
+  // Padding bits of summary_ are set. The result is a valid word index.
+  return 64U * summary_index +
+    static_cast<std::size_t>(__builtin_ctzll(candidates));
+}
+
+template<typename I>
+std::size_t BitsetIdManager<I>::NextSet(std::size_t position) const noexcept
+{
+  std::size_t word_index {position / 64U};
+  if(word_index >= kWordCount_)
+    return kIdCount_;
+  std::uint64_t bits {words_[word_index] & (kFullWord_ << (position % 64U))};
+  while(!bits)
+  {
+    if(++word_index == kWordCount_)
+      return kIdCount_;
+    bits = words_[word_index];
+  }
+  return 64U * word_index + static_cast<std::size_t>(__builtin_ctzll(bits));
+}
+
+template<typename I>
+std::size_t BitsetIdManager<I>::NextClear(std::size_t position) const noexcept
+{
+  std::size_t word_index {position / 64U};
+  if(word_index >= kWordCount_)
+    return kIdCount_;
+  std::uint64_t bits {~words_[word_index] & (kFullWord_ << (position % 64U))};
+  if(!bits)
+  {
+    // Full words are skipped with the summary level.
+    word_index = NextNonFullWord(word_index + 1U);
+    if(word_index == kWordCount_)
+      return kIdCount_;
+    bits = ~words_[word_index];
+  }
+  return 64U * word_index + static_cast<std::size_t>(__builtin_ctzll(bits));
+}
+
+template<typename I>
+template<typename Visitor>
+void BitsetIdManager<I>::VisitLeastUnused(std::size_t n, Visitor&& visitor)
+  const
+{
+  std::size_t word_index {NextNonFullWord(0U)};
+  while(n)
+  {
+    std::uint64_t free_bits {~words_[word_index]};
+    std::size_t free_count
+      {static_cast<std::size_t>(__builtin_popcountll(free_bits))};
+    std::uint64_t mask {};
+    if(free_count <= n)
+    {
+      mask = free_bits;
+      n -= free_count;
+    }
+    else
+    {
+      for(; n; --n)
+      {
+        // Move the least set bit of free_bits to mask.
+        std::uint64_t least {free_bits & (~free_bits + 1U)};
+        mask |= least;
+        free_bits ^= least;
+      }
+    }
+    visitor(word_index, mask);
+    word_index = NextNonFullWord(word_index + 1U);
+  }
+}
+
+template<typename I>
+void BitsetIdManager<I>::SetBits(std::size_t word_index, std::uint64_t mask)
+  noexcept
+{
+  words_[word_index] |= mask;
+  if(words_[word_index] == kFullWord_)
+  {
+    std::size_t summary_index {word_index / 64U};
+    summary_[summary_index] |= (std::uint64_t {1U} << (word_index % 64U));
+    if(summary_[summary_index] == kFullWord_)
+      top_ |= (std::uint64_t {1U} << summary_index);
+  }
+}
+
+template<typename I>
+BitsetIdManager<I>::UsedIntervalIterator::UsedIntervalIterator(
+  const BitsetIdManager* manager_ptr, std::size_t position) noexcept
+: manager_ptr_ {manager_ptr},
+  interval_    {0, 0}
+{
+  std::size_t first {manager_ptr_->NextSet(position)};
+  if(first == kIdCount_)
+    return;
+  std::size_t last {manager_ptr_->NextClear(first) - 1U};
+  interval_ = value_type {static_cast<I>(first), static_cast<I>(last)};
+}
+
+template<typename I>
+typename BitsetIdManager<I>::UsedIntervalIterator&
+BitsetIdManager<I>::UsedIntervalIterator::operator++() noexcept
+{
+  // The position after an interval is either clear or kIdCount_.
+  *this = UsedIntervalIterator {manager_ptr_,
+    static_cast<std::size_t>(interval_.second) + 2U};
+  return *this;
+}
+
+template<typename I>
+template<typename OutputIt>
+OutputIt BitsetIdManager<I>::GetIds(I n, OutputIt out)
+{
+  if(n <= 0)
+    return out;
+  std::size_t count {static_cast<std::size_t>(n)};
+  if((kIdCount_ - 1U - static_cast<std::size_t>(size_)) < count)
+  {
+    throw std::length_error {"A request for new IDs was made through a "
+      "call to BitsetIdManager<I>::GetIds. Too few IDs were unused."};
+  }
+  // The IDs are written before the bitset is modified so that an exception
+  // which is thrown by out leaves the instance unchanged.
+  VisitLeastUnused(count,
+    [&out](std::size_t word_index, std::uint64_t mask)->void
+    {
+      while(mask)
+      {
+        std::size_t bit_index
+          {static_cast<std::size_t>(__builtin_ctzll(mask))};
+        *out++ = static_cast<I>(64U * word_index + bit_index);
+        mask &= (mask - 1U);
+      }
+    }
+  );
+  VisitLeastUnused(count,
+    [this](std::size_t word_index, std::uint64_t mask)->void
+    {
+      SetBits(word_index, mask);
+    }
+  );
+  size_ = static_cast<I>(size_ + n);
+  return out;
+}
+
+template<typename I>
+I BitsetIdManager<I>::ReleaseRange(I lo, I hi) noexcept
+{
+  if(lo < 1)
+    lo = 1;
+  if(hi < lo)
+    return 0;
+  std::size_t first {static_cast<std::size_t>(lo)};
+  std::size_t last {static_cast<std::size_t>(hi)};
+  std::size_t released {0U};
+  for(std::size_t word_index {first / 64U}; word_index <= last / 64U;
+    ++word_index)
+  {
+    std::uint64_t mask {kFullWord_};
+    if(word_index == first / 64U)
+      mask &= (kFullWord_ << (first % 64U));
+    if(word_index == last / 64U)
+      mask &= (kFullWord_ >> (63U - (last % 64U)));
+    std::uint64_t cleared {words_[word_index] & mask};
+    if(!cleared)
+      continue;
+    released += static_cast<std::size_t>(__builtin_popcountll(cleared));
+    words_[word_index] &= ~mask;
+    std::size_t summary_index {word_index / 64U};
+    summary_[summary_index] &= ~(std::uint64_t {1U} << (word_index % 64U));
+    top_ &= ~(std::uint64_t {1U} << summary_index);
+  }
+  size_ = static_cast<I>(static_cast<std::size_t>(size_) - released);
+  return static_cast<I>(released);
+}
+
+template<typename I>
+I BitsetIdManager<I>::GetId()
+{
+  if(top_ == kFullWord_)
+  {
+    throw std::length_error {"A request for a new ID was made through a "
+      "call to BitsetIdManager<I>::GetId. All possible IDs had been "
+      "assigned."};
+  }
+  std::size_t summary_index {LeastClearBit(top_)};
+  std::size_t word_index {64U * summary_index +
+    LeastClearBit(summary_[summary_index])};
+  std::size_t bit_index {LeastClearBit(words_[word_index])};
+  words_[word_index] |= (std::uint64_t {1U} << bit_index);
+  if(words_[word_index] == kFullWord_)
+  {
+    summary_[summary_index] |= (std::uint64_t {1U} << (word_index % 64U));
+    if(summary_[summary_index] == kFullWord_)
+      top_ |= (std::uint64_t {1U} << summary_index);
+  }
+  ++size_;
+  return static_cast<I>(64U * word_index + bit_index);
+}
+
+template<typename I>
+void BitsetIdManager<I>::ReleaseId(I id)
+{
+  if(!IsUsed(id))
+  {
+    throw std::logic_error {"Release was requested for an ID which "
+      "was not in use."};
+  }
+  std::size_t index {static_cast<std::size_t>(id)};
+  std::size_t word_index {index / 64U};
+  std::size_t summary_index {word_index / 64U};
+  // Clearing any bit of a word makes the word, its summary word, and top_
+  // non-full.
+  words_[word_index] &= ~(std::uint64_t {1U} << (index % 64U));
+  summary_[summary_index] &= ~(std::uint64_t {1U} << (word_index % 64U));
+  top_ &= ~(std::uint64_t {1U} << summary_index);
+  --size_;
+}
+
+} // namespace as_components
+
+#endif // AS_COMPONENTS_ID_MANAGER_INCLUDE_BITSET_ID_MANAGER_TEMPLATE_H_
@@ -0,0 +1,267 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef AS_COMPONENTS_ID_MANAGER_INCLUDE_CONCURRENT_ID_MANAGER_TEMPLATE_H_
+#define AS_COMPONENTS_ID_MANAGER_INCLUDE_CONCURRENT_ID_MANAGER_TEMPLATE_H_
+
+// Class Description:
+//    ConcurrentIdManager<I> provides the interface of IdManager<I> for use by
+// multiple threads without external synchronization. It is defined for the
+// types I for which BitsetIdManager<I> is defined (see
+// bitset_id_manager_template.h).
+//
+// Progress guarantees:
+// 1) IsUsed is wait-free.
+// 2) GetId and ReleaseId are lock-free.
+//
+// Semantics:
+// 1) GetId returns an ID of [1, I_max] which was not in use when the ID was
+//    acquired. When no call to ReleaseId is concurrent with a call to GetId,
+//    the returned ID is the least unused ID as it is for IdManager<I>.
+// 2) GetId throws std::length_error if every ID was observed to be in use
+//    during a complete scan of the bitset.
+// 3) ReleaseId throws std::logic_error if its ID was not in use.
+// 4) NumberOfUsedIds is exact when no calls to GetId or ReleaseId are
+//    concurrent with it.
+//
+// Implementation discussion:
+//    The dynamic set is stored as an array of atomic 64-bit words with one bit
+// per value of [0, I_max]. The bit for 0 is always set. An ID is acquired by
+// a compare-and-swap which sets the least clear bit of a word. An ID is
+// released by an atomic fetch_and.
+//    A search hint, hint_, holds a word index at which GetId begins its scan.
+// The invariant maintained for the absence of concurrent calls is that hint_
+// is not greater than the index of the least non-full word. As such, the
+// lowest-free semantics of IdManager<I> hold in this case.
+// 1) When GetId observes that the word at hint_ is full, it attempts to
+//    advance hint_ by one. After the advance, it reloads the word. If the word
+//    is no longer full, it lowers hint_ back to the word index.
+// 2) ReleaseId clears the bit of its ID before lowering hint_ to the word
+//    index of the ID if hint_ is greater than that index.
+//    All atomic operations use sequentially consistent ordering. Given a
+// single total order on these operations, either the reload of 1 observes
+// the clear of 2, or the lowering of 2 occurs after the advance of 1. In
+// either case, hint_ is not left greater than the index of a non-full word.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#include "id_manager/include/bitset_id_manager_template.h"
+
+namespace as_components {
+
+template<typename I>
+class ConcurrentIdManager
+{
+ public:
+  // Returns an unused ID. IDs start at 1.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions:
+  // 1) If every ID was observed to be in use, std::length_error is thrown. In
+  //    this case, no change to the instance occurred.
+  //
+  // Effects:
+  // 1) An ID of [1, I_max] which was unused when it was acquired was
+  //    returned. If no call to ReleaseId was concurrent with the call, the
+  //    returned ID was the least unused ID.
+  // 2) The returned ID is regarded as used.
+  I GetId();
+
+  // Returns true if the id is in use. Returns false otherwise.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions: noexcept.
+  inline bool IsUsed(I i) const noexcept
+  {
+    if(i <= 0)
+      return false;
+    std::size_t index {static_cast<std::size_t>(i)};
+    return (words_[index / 64U].load() >> (index % 64U)) & 1U;
+  }
+
+  inline I NumberOfUsedIds() const noexcept
+  {
+    return static_cast<I>(size_.load());
+  }
+
+  // Informs the ConcurrentIdManager instance that id should no longer be
+  // regarded as used.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions:
+  // 1) If id is not currently in use, std::logic_error is thrown. In this
+  //    case, no change to the instance occurred.
+  //
+  // Effects:
+  // 1) The instance recorded that id is no longer in use.
+  void ReleaseId(I id);
+
+  ConcurrentIdManager() noexcept;
+
+  // Atomic members are neither copyable nor movable.
+  ConcurrentIdManager(const ConcurrentIdManager&) = delete;
+  ConcurrentIdManager(ConcurrentIdManager&&) = delete;
+
+  ConcurrentIdManager& operator=(const ConcurrentIdManager&) = delete;
+  ConcurrentIdManager& operator=(ConcurrentIdManager&&) = delete;
+
+  ~ConcurrentIdManager() = default;
+
+ private:
+  static_assert(IsBitsetIdManagerType<I>::value, "ConcurrentIdManager<I> "
+    "requires an integral type other than bool with between 6 and 16 "
+    "non-sign bits.");
+
+  static constexpr std::size_t kIdCount_
+    {std::size_t {1U} << std::numeric_limits<I>::digits};
+  static constexpr std::size_t kWordCount_ {kIdCount_ / 64U};
+  static constexpr std::uint64_t kFullWord_
+    {std::numeric_limits<std::uint64_t>::max()};
+
+  // Attempts to acquire a bit of words_[word_index]. Returns true and writes
+  // the acquired ID to *id_ptr on success. Returns false if the word was
+  // observed to be full.
+  bool TryAcquireInWord(std::size_t word_index, I* id_ptr) noexcept;
+
+  // Advances hint_ past word_index if hint_ is equal to word_index. See the
+  // implementation discussion.
+  void AdvanceHint(std::size_t word_index) noexcept;
+
+  // Sets hint_ to word_index if hint_ is greater than word_index.
+  void LowerHint(std::size_t word_index) noexcept;
+
+  std::atomic<std::size_t> size_;
+  std::atomic<std::size_t> hint_;
+  std::atomic<std::uint64_t> words_[kWordCount_];
+
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+  static_assert(std::atomic<std::size_t>::is_always_lock_free);
+};
+
+template<typename I>
+ConcurrentIdManager<I>::ConcurrentIdManager() noexcept
+: size_  {0U},
+  hint_  {0U}
+{
+  // Reserve 0.
+  words_[0].store(1U, std::memory_order_relaxed);
+  for(std::size_t i {1U}; i < kWordCount_; ++i)
+    words_[i].store(0U, std::memory_order_relaxed);
+}
+
+template<typename I>
+bool ConcurrentIdManager<I>::TryAcquireInWord(std::size_t word_index,
+  I* id_ptr) noexcept
+{
+  std::atomic<std::uint64_t>& word {words_[word_index]};
+  std::uint64_t value {word.load()};
+  while(value != kFullWord_)
+  {
+    std::size_t bit_index
+      {static_cast<std::size_t>(__builtin_ctzll(~value))};
+    // On failure, value is updated with the current value of the word.
+    if(word.compare_exchange_weak(value,
+      value | (std::uint64_t {1U} << bit_index)))
+    {
+      size_.fetch_add(1U);
+      *id_ptr = static_cast<I>(64U * word_index + bit_index);
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename I>
+void ConcurrentIdManager<I>::AdvanceHint(std::size_t word_index) noexcept
+{
+  std::size_t expected {word_index};
+  if(hint_.compare_exchange_strong(expected, word_index + 1U))
+  {
+    if(words_[word_index].load() != kFullWord_)
+      LowerHint(word_index);
+  }
+}
+
+template<typename I>
+void ConcurrentIdManager<I>::LowerHint(std::size_t word_index) noexcept
+{
+  std::size_t current {hint_.load()};
+  while((current > word_index) &&
+        !hint_.compare_exchange_weak(current, word_index))
+  {}
+}
+
+template<typename I>
+I ConcurrentIdManager<I>::GetId()
+{
+  std::size_t start {hint_.load()};
+  I id {};
+  // The scan begins at the hint. As the hint is advisory during concurrent
+  // use, the words before the hint are scanned before exhaustion is reported.
+  for(std::size_t i {start}; i < kWordCount_; ++i)
+  {
+    if(TryAcquireInWord(i, &id))
+      return id;
+    AdvanceHint(i);
+  }
+  for(std::size_t i {0U}; (i < start) && (i < kWordCount_); ++i)
+  {
+    if(TryAcquireInWord(i, &id))
+      return id;
+  }
+  throw std::length_error {"A request for a new ID was made through a "
+    "call to ConcurrentIdManager<I>::GetId. All possible IDs had been "
+    "assigned."};
+}
+
+template<typename I>
+void ConcurrentIdManager<I>::ReleaseId(I id)
+{
+  if(id <= 0)
+  {
+    throw std::logic_error {"Release was requested for an ID which "
+      "was not in use."};
+  }
+  std::size_t index {static_cast<std::size_t>(id)};
+  std::size_t word_index {index / 64U};
+  std::uint64_t mask {std::uint64_t {1U} << (index % 64U)};
+  std::uint64_t previous {words_[word_index].fetch_and(~mask)};
+  if(!(previous & mask))
+  {
+    // The bit was already clear. fetch_and did not change the word.
+    throw std::logic_error {"Release was requested for an ID which "
+      "was not in use."};
+  }
+  size_.fetch_sub(1U);
+  LowerHint(word_index);
+}
+
+} // namespace as_components
+
+#endif // AS_COMPONENTS_ID_MANAGER_INCLUDE_CONCURRENT_ID_MANAGER_TEMPLATE_H_
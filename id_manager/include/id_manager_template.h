@@ -59,6 +59,22 @@
 //
 //    IdManager can be seen as a specialization of a dynamic set which holds
 // integral values.
+//
+// Representation selection:
+//    IdManager<I> is an alias template. Two class templates implement the
+// semantics described above:
+// 1) IntervalIdManager<I> (defined below) stores the dynamic set as a set of
+//    disjoint intervals. Its space requirement is proportional to the number
+//    of intervals. It may be used with any integral type.
+// 2) BitsetIdManager<I> (see bitset_id_manager_template.h) stores the dynamic
+//    set as a hierarchical bitset with one bit per value of [0, I_max]. Each
+//    operation is performed with a small, constant number of word operations
+//    and without allocation. It is only defined for integral types whose
+//    non-sign bit count is at most 16. For std::uint16_t, the type of FastCGI
+//    request identifiers, the bitset occupies 8 KiB.
+//    IdManager<I> names BitsetIdManager<I> when I satisfies the requirements
+// of BitsetIdManager<I> and names IntervalIdManager<I> otherwise. Both
+// templates return the least unused identifier from GetId.
 
 // Implementation discussion:
 //    Instead of using a set data structure whose members are values i of I,
@@ -125,16 +141,26 @@
 // class instance is then to implement state transitions between the minimal
 // sets of ranges discussed above which follow the semantics of IdManager.
 
+#include <iterator>
 #include <limits>
 #include <map>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
+
+#include "id_manager/include/bitset_id_manager_template.h"
 
 namespace as_components {
 
 template<typename I>
-class IdManager
+class IntervalIdManager
 {
  public:
+  // A constant forward iterator over the disjoint intervals of used IDs in
+  // increasing order. For an iterator it, it->first is the least and
+  // it->second is the greatest ID of an interval.
+  using UsedIntervalIterator = typename std::map<I, I>::const_iterator;
+
   // Returns an unused ID. IDs start at 1. 
   //
   // Preconditions: none.
@@ -154,6 +180,29 @@ class IdManager
   // 4) The returned ID is regarded as used.
   I GetId();
 
+  // Acquires the n least unused IDs and writes them in increasing order to
+  // the output iterator out.
+  //
+  // Parameters:
+  // n:   The number of IDs to acquire. No action is taken if n <= 0.
+  // out: An output iterator to a sequence which can receive n values of I.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions:
+  // 1) Exceptions derived from std::exception may be thrown.
+  // 2) If fewer than n IDs are unused, std::length_error is thrown.
+  // 3) If an exception is thrown, the instance is unchanged. The state of the
+  //    output sequence is unspecified in this case.
+  //
+  // Effects:
+  // 1) The n least unused IDs were written to out and are regarded as used.
+  // 2) The returned iterator is one past the last written value.
+  // 3) The cost is proportional to the number of intervals which were
+  //    merged or extended plus n for the output.
+  template<typename OutputIt>
+  OutputIt GetIds(I n, OutputIt out);
+
   // Returns true if the id is in use. Returns false otherwise.
   //
   // Preconditions: none.
@@ -187,18 +236,52 @@ class IdManager
 
   void ReleaseId(I);
 
-  inline IdManager() noexcept
+  // Releases every used ID of [lo, hi]. Unused IDs of [lo, hi] are ignored.
+  //
+  // Preconditions: none.
+  //
+  // Exceptions:
+  // 1) Exceptions derived from std::exception may be thrown.
+  // 2) Strong exception guarantee. An exception may only be thrown when the
+  //    range is strictly contained in a single interval of used IDs.
+  //
+  // Effects:
+  // 1) The used IDs of [lo, hi] are no longer regarded as used. The number of
+  //    released IDs was returned. If hi < lo, 0 was returned.
+  // 2) The cost is logarithmic in the number of intervals plus the number of
+  //    intervals which intersect [lo, hi].
+  I ReleaseRange(I lo, I hi);
+
+  // Releases every used ID. The instance has the state of a newly-constructed
+  // instance.
+  inline void ReleaseAll() noexcept
+  {
+    id_intervals_.clear();
+    size_ = 0;
+  }
+
+  inline UsedIntervalIterator UsedIntervalsBegin() const noexcept
+  {
+    return id_intervals_.cbegin();
+  }
+
+  inline UsedIntervalIterator UsedIntervalsEnd() const noexcept
+  {
+    return id_intervals_.cend();
+  }
+
+  inline IntervalIdManager() noexcept
   : size_         {0},
     id_intervals_ {}
   {}
 
-  IdManager(const IdManager&) = default;
-  IdManager(IdManager&&) = default;
+  IntervalIdManager(const IntervalIdManager&) = default;
+  IntervalIdManager(IntervalIdManager&&) = default;
 
-  IdManager& operator=(const IdManager&) = default;
-  IdManager& operator=(IdManager&&) = default;
+  IntervalIdManager& operator=(const IntervalIdManager&) = default;
+  IntervalIdManager& operator=(IntervalIdManager&&) = default;
 
-  ~IdManager() = default;
+  ~IntervalIdManager() = default;
 
  private:
   typename std::map<I, I>::iterator FindInterval(I);
@@ -212,7 +295,7 @@ class IdManager
 
 template<typename I>
 typename std::map<I, I>::iterator 
-IdManager<I>::FindInterval(I id)
+IntervalIdManager<I>::FindInterval(I id)
 {
   typename std::map<I, I>::iterator intervals_end
     {id_intervals_.end()};
@@ -266,7 +349,7 @@ IdManager<I>::FindInterval(I id)
 
 template<typename I>
 typename std::map<I, I>::const_iterator 
-IdManager<I>::FindInterval(I id) const
+IntervalIdManager<I>::FindInterval(I id) const
 {
   typename std::map<I, I>::const_iterator intervals_end {id_intervals_.cend()};
 
@@ -318,7 +401,7 @@ IdManager<I>::FindInterval(I id) const
 }
 
 template<typename I>
-I IdManager<I>::GetId()
+I IntervalIdManager<I>::GetId()
 {
   if(!(id_intervals_.size()))
   {
@@ -376,7 +459,7 @@ I IdManager<I>::GetId()
         if(i_min->second == std::numeric_limits<I>::max())
         {
           throw std::length_error {"A request for a new ID was made through a "
-            "call to IdManager<I>::GetId. All possible IDs had been assigned."};
+            "call to IntervalIdManager<I>::GetId. All possible IDs had been assigned."};
         }
         else
         {
@@ -389,7 +472,7 @@ I IdManager<I>::GetId()
 }
 
 template<typename I>
-void IdManager<I>::ReleaseId(I id)
+void IntervalIdManager<I>::ReleaseId(I id)
 {
   typename std::map<I, I>::iterator i_release {FindInterval(id)};
 
@@ -429,6 +512,149 @@ void IdManager<I>::ReleaseId(I id)
   --size_;
 }
 
+template<typename I>
+template<typename OutputIt>
+OutputIt IntervalIdManager<I>::GetIds(I n, OutputIt out)
+{
+  if(n <= 0)
+    return out;
+  if((std::numeric_limits<I>::max() - size_) < n)
+  {
+    throw std::length_error {"A request for new IDs was made through a "
+      "call to IntervalIdManager<I>::GetIds. Too few IDs were unused."};
+  }
+
+  // The gaps between intervals are visited in increasing order. The IDs are
+  // written before the map is modified so that an exception which is thrown
+  // by out leaves the map unchanged.
+  auto WriteRange = [&out](I first, I count)->void
+  {
+    for(I i {0}; i < count; ++i)
+      *out++ = static_cast<I>(first + i);
+  };
+  I remaining {n};
+  I previous_max {0};
+  for(typename std::map<I, I>::const_iterator iter {id_intervals_.cbegin()};
+    (remaining > 0) && (iter != id_intervals_.cend()); ++iter)
+  {
+    I gap {static_cast<I>(iter->first - previous_max - 1)};
+    I count {(gap < remaining) ? gap : remaining};
+    WriteRange(static_cast<I>(previous_max + 1), count);
+    remaining -= count;
+    previous_max = iter->second;
+  }
+  if(remaining > 0)
+    WriteRange(static_cast<I>(previous_max + 1), remaining);
+
+  // Update the map. Only the insertion of a new first interval may allocate,
+  // and it occurs before any other modification.
+  remaining = n;
+  typename std::map<I, I>::iterator iter {id_intervals_.begin()};
+  if((iter == id_intervals_.end()) || (iter->first > 1))
+  {
+    I gap {(iter == id_intervals_.end()) ? std::numeric_limits<I>::max() :
+      static_cast<I>(iter->first - 1)};
+    if((iter == id_intervals_.end()) || (remaining < gap))
+    {
+      id_intervals_.emplace_hint(iter, 1, remaining);
+      size_ += n;
+      return out;
+    }
+    // The first gap is filled. The key of the first interval becomes 1.
+    // Node extraction and reinsertion does not allocate.
+    typename std::map<I, I>::node_type node {id_intervals_.extract(iter)};
+    node.key() = 1;
+    iter = id_intervals_.insert(std::move(node)).position;
+    remaining -= gap;
+  }
+  while(remaining > 0)
+  {
+    typename std::map<I, I>::iterator next {std::next(iter)};
+    if(next == id_intervals_.end())
+    {
+      iter->second += remaining;
+      break;
+    }
+    I gap {static_cast<I>(next->first - iter->second - 1)};
+    if(remaining < gap)
+    {
+      iter->second += remaining;
+      break;
+    }
+    // The gap is filled. The next interval is merged with the current one.
+    iter->second = next->second;
+    id_intervals_.erase(next);
+    remaining -= gap;
+  }
+  size_ += n;
+  return out;
+}
+
+template<typename I>
+I IntervalIdManager<I>::ReleaseRange(I lo, I hi)
+{
+  if(lo < 1)
+    lo = 1;
+  if(hi < lo)
+    return 0;
+
+  // Find the first interval which intersects [lo, hi].
+  typename std::map<I, I>::iterator iter {id_intervals_.upper_bound(lo)};
+  if(iter != id_intervals_.begin())
+  {
+    typename std::map<I, I>::iterator previous {std::prev(iter)};
+    if(previous->second >= lo)
+      iter = previous;
+  }
+  if((iter == id_intervals_.end()) || (iter->first > hi))
+    return 0;
+
+  // Is [lo, hi] strictly contained in an interval? This is the only case in
+  // which the number of intervals increases.
+  if((iter->first < lo) && (iter->second > hi))
+  {
+    id_intervals_.emplace_hint(std::next(iter), static_cast<I>(hi + 1),
+      iter->second);
+    iter->second = static_cast<I>(lo - 1);
+    I released {static_cast<I>(hi - lo + 1)};
+    size_ -= released;
+    return released;
+  }
+
+  I released {0};
+  if(iter->first < lo)
+  {
+    // The interval is truncated from above.
+    released += static_cast<I>(iter->second - lo + 1);
+    iter->second = static_cast<I>(lo - 1);
+    ++iter;
+  }
+  while((iter != id_intervals_.end()) && (iter->second <= hi))
+  {
+    // The interval is contained in [lo, hi].
+    released += static_cast<I>(iter->second - iter->first + 1);
+    iter = id_intervals_.erase(iter);
+  }
+  if((iter != id_intervals_.end()) && (iter->first <= hi))
+  {
+    // The interval is truncated from below. Node extraction and reinsertion
+    // does not allocate.
+    released += static_cast<I>(hi - iter->first + 1);
+    typename std::map<I, I>::node_type node {id_intervals_.extract(iter)};
+    node.key() = static_cast<I>(hi + 1);
+    id_intervals_.insert(std::move(node));
+  }
+  size_ -= released;
+  return released;
+}
+
+template<typename I>
+using IdManager = typename std::conditional<
+  IsBitsetIdManagerType<I>::value,
+  BitsetIdManager<I>,
+  IntervalIdManager<I>
+>::type;
+
 } // namespace as_components
 
 #endif // AS_COMPONENTS_ID_MANAGER_INCLUDE_ID_MANAGER_TEMPLATE_H_
@@ -0,0 +1,221 @@
+// MIT License
+//
+// Copyright (c) 2021 Adam J. Breland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "id_manager/include/bitset_id_manager_template.h"
+#include "id_manager/include/concurrent_id_manager_template.h"
+
+// Test explanation
+// Examined properties:
+// 1) In the absence of concurrency, ConcurrentIdManager<I> has the semantics
+//    of IdManager<I>: IDs start at 1, the least unused ID is returned by
+//    GetId, exceptions are thrown on exhaustion and on the release of an
+//    unused ID, and IsUsed and NumberOfUsedIds are consistent with the
+//    history of calls.
+// 2) Under concurrent use:
+//    a) An ID is never returned by GetId while it is in use.
+//    b) Every ID which is released may be acquired again.
+//    c) When all threads have completed, NumberOfUsedIds is exact and the
+//       lowest-free semantics hold again.
+//    d) When threads compete to exhaust the ID space, every ID of [1, I_max]
+//       is acquired exactly once before std::length_error is thrown.
+//
+// Test Cases:
+// 1) BitsetIdManager<std::uint16_t> and ConcurrentIdManager<std::uint16_t>
+//    are subjected to the same pseudo-random sequence of GetId and ReleaseId
+//    calls on a single thread. Return values and used-ID counts are compared
+//    after each call.
+// 2) ConcurrentIdManager<std::int8_t>: all IDs are acquired in order, GetId
+//    throws, and ReleaseId throws for 0, a negative value, and an unused ID.
+// 3) Eight threads perform pseudo-random GetId and ReleaseId calls on a shared
+//    ConcurrentIdManager<std::uint16_t>. A shared array of ownership flags
+//    detects the return of an ID which is in use. All IDs are released at
+//    the end and the final state is examined.
+// 4) Eight threads call GetId on a shared ConcurrentIdManager<std::uint16_t>
+//    until std::length_error is thrown. The union of the acquired IDs is
+//    examined.
+
+TEST(ConcurrentIdManager, SingleThreadAgreement)
+{
+  as_components::BitsetIdManager<std::uint16_t> bitset_manager {};
+  as_components::ConcurrentIdManager<std::uint16_t> concurrent_manager {};
+  std::vector<std::uint16_t> in_use {};
+  std::mt19937 engine {11U};
+  EXPECT_FALSE(concurrent_manager.IsUsed(0U));
+  EXPECT_FALSE(concurrent_manager.IsUsed(1U));
+  for(int i {0}; i < 20000; ++i)
+  {
+    if(in_use.empty() || (engine() % 8U) < 5U)
+    {
+      std::uint16_t bitset_id {bitset_manager.GetId()};
+      std::uint16_t concurrent_id {concurrent_manager.GetId()};
+      ASSERT_EQ(bitset_id, concurrent_id) << "iteration count: " << i;
+      EXPECT_TRUE(concurrent_manager.IsUsed(concurrent_id));
+      in_use.push_back(concurrent_id);
+    }
+    else
+    {
+      std::size_t index {engine() % in_use.size()};
+      std::uint16_t id {in_use[index]};
+      in_use[index] = in_use.back();
+      in_use.pop_back();
+      ASSERT_NO_THROW(bitset_manager.ReleaseId(id));
+      ASSERT_NO_THROW(concurrent_manager.ReleaseId(id));
+      EXPECT_FALSE(concurrent_manager.IsUsed(id));
+    }
+    ASSERT_EQ(bitset_manager.NumberOfUsedIds(),
+      concurrent_manager.NumberOfUsedIds());
+  }
+}
+
+TEST(ConcurrentIdManager, SingleThreadExceptions)
+{
+  as_components::ConcurrentIdManager<std::int8_t> id_manager {};
+  for(int i {1}; i <= std::numeric_limits<std::int8_t>::max(); ++i)
+  {
+    ASSERT_EQ(id_manager.GetId(), i);
+    EXPECT_EQ(id_manager.NumberOfUsedIds(), i);
+  }
+  EXPECT_THROW(id_manager.GetId(), std::length_error);
+  EXPECT_THROW(id_manager.ReleaseId(0), std::logic_error);
+  EXPECT_THROW(id_manager.ReleaseId(-1), std::logic_error);
+  ASSERT_NO_THROW(id_manager.ReleaseId(100));
+  EXPECT_THROW(id_manager.ReleaseId(100), std::logic_error);
+  EXPECT_EQ(id_manager.NumberOfUsedIds(),
+    std::numeric_limits<std::int8_t>::max() - 1);
+  ASSERT_NO_THROW(id_manager.ReleaseId(3));
+  EXPECT_EQ(id_manager.GetId(), 3);
+  EXPECT_EQ(id_manager.GetId(), 100);
+}
+
+TEST(ConcurrentIdManager, MultiThreadedStress)
+{
+  constexpr int kThreadCount {8};
+  constexpr int kIterationCount {50000};
+  constexpr std::size_t kFlagCount
+    {std::size_t {std::numeric_limits<std::uint16_t>::max()} + 1U};
+  as_components::ConcurrentIdManager<std::uint16_t> id_manager {};
+  std::vector<std::atomic<bool>> owned(kFlagCount);
+  std::atomic<int> duplicate_count {0};
+  std::atomic<int> exception_count {0};
+
+  auto worker = [&](unsigned int seed)->void
+  {
+    std::mt19937 engine {seed};
+    std::vector<std::uint16_t> local_ids {};
+    try
+    {
+      for(int i {0}; i < kIterationCount; ++i)
+      {
+        if(local_ids.empty() || (local_ids.size() < 256U &&
+           (engine() % 2U)))
+        {
+          std::uint16_t id {id_manager.GetId()};
+          if(id == 0U || owned[id].exchange(true))
+            duplicate_count.fetch_add(1);
+          local_ids.push_back(id);
+        }
+        else
+        {
+          std::size_t index {engine() % local_ids.size()};
+          std::uint16_t id {local_ids[index]};
+          local_ids[index] = local_ids.back();
+          local_ids.pop_back();
+          // The flag is cleared before the release so that the ID may be
+          // claimed by another thread as soon as it is released.
+          owned[id].store(false);
+          id_manager.ReleaseId(id);
+        }
+      }
+      for(std::uint16_t id : local_ids)
+      {
+        owned[id].store(false);
+        id_manager.ReleaseId(id);
+      }
+    }
+    catch(...)
+    {
+      exception_count.fetch_add(1);
+    }
+  };
+
+  std::vector<std::thread> threads {};
+  for(int i {0}; i < kThreadCount; ++i)
+    threads.emplace_back(worker, static_cast<unsigned int>(i + 1));
+  for(std::thread& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(duplicate_count.load(), 0);
+  EXPECT_EQ(exception_count.load(), 0);
+  EXPECT_EQ(id_manager.NumberOfUsedIds(), 0U);
+  for(std::size_t i {1U}; i < kFlagCount; ++i)
+  {
+    ASSERT_FALSE(id_manager.IsUsed(static_cast<std::uint16_t>(i))) << i;
+  }
+  EXPECT_EQ(id_manager.GetId(), 1U);
+  EXPECT_EQ(id_manager.GetId(), 2U);
+}
+
+TEST(ConcurrentIdManager, MultiThreadedExhaustion)
+{
+  constexpr int kThreadCount {8};
+  constexpr std::size_t kFlagCount
+    {std::size_t {std::numeric_limits<std::uint16_t>::max()} + 1U};
+  as_components::ConcurrentIdManager<std::uint16_t> id_manager {};
+  std::vector<std::atomic<int>> acquisition_counts(kFlagCount);
+
+  auto worker = [&]()->void
+  {
+    try
+    {
+      while(true)
+        acquisition_counts[id_manager.GetId()].fetch_add(1);
+    }
+    catch(std::length_error&)
+    {}
+  };
+
+  std::vector<std::thread> threads {};
+  for(int i {0}; i < kThreadCount; ++i)
+    threads.emplace_back(worker);
+  for(std::thread& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(acquisition_counts[0].load(), 0);
+  for(std::size_t i {1U}; i < kFlagCount; ++i)
+  {
+    ASSERT_EQ(acquisition_counts[i].load(), 1) << i;
+  }
+  EXPECT_EQ(id_manager.NumberOfUsedIds(),
+    std::numeric_limits<std::uint16_t>::max());
+  EXPECT_THROW(id_manager.GetId(), std::length_error);
+}
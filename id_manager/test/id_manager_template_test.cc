@@ -20,10 +20,17 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <cstdint>
 #include <exception>
+#include <iterator>
 #include <limits>
+#include <random>
 #include <set>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "googletest/include/gtest/gtest.h"
 
@@ -304,3 +311,301 @@ TEST(IdManager, NewInstanceUseAndEmpty)
 //   }
 //   EXPECT_THROW(id_manager.GetId(), std::exception);
 // }
+
+// BitsetIdManager
+// Test explanation
+// Examined properties:
+// 1) IdManager<I> names BitsetIdManager<I> for small integral types and
+//    IntervalIdManager<I> otherwise.
+// 2) The properties examined above for IdManager<int>: IDs start at 1, the
+//    least unused ID is returned, exceptions are thrown on exhaustion and on
+//    the release of an unused ID, and IsUsed and NumberOfUsedIds are
+//    consistent with the history of calls.
+// 3) Agreement with IntervalIdManager<I> for an arbitrary sequence of calls.
+//    Both templates return the least unused ID.
+//
+// Test Cases:
+// 1) Static checks of the IdManager alias.
+// 2) BitsetIdManager<std::int8_t>: every ID of [1, 127] is acquired in order.
+//    GetId then throws. ID 0 and negative IDs are never in use.
+// 3) BitsetIdManager<std::uint16_t>: every ID of [1, 65535] is acquired.
+//    GetId throws std::length_error. A set of IDs which span different words
+//    and summary words is released. GetId then returns these IDs in
+//    increasing order. Releasing an unused ID throws std::logic_error.
+// 4) A pseudo-random sequence of GetId and ReleaseId calls is applied to both
+//    BitsetIdManager<std::uint16_t> and IntervalIdManager<std::uint16_t>.
+//    The returned IDs and used-ID counts are compared after each call.
+
+TEST(BitsetIdManager, AliasSelection)
+{
+  static_assert(std::is_same<as_components::IdManager<std::uint16_t>,
+    as_components::BitsetIdManager<std::uint16_t>>::value);
+  static_assert(std::is_same<as_components::IdManager<std::int8_t>,
+    as_components::BitsetIdManager<std::int8_t>>::value);
+  static_assert(std::is_same<as_components::IdManager<int>,
+    as_components::IntervalIdManager<int>>::value);
+  static_assert(std::is_same<as_components::IdManager<bool>,
+    as_components::IntervalIdManager<bool>>::value);
+  static_assert(std::is_nothrow_default_constructible<
+    as_components::IdManager<std::uint16_t>>::value);
+  static_assert(std::is_nothrow_move_constructible<
+    as_components::IdManager<std::uint16_t>>::value);
+}
+
+TEST(BitsetIdManager, SmallTypeExhaustion)
+{
+  as_components::BitsetIdManager<std::int8_t> id_manager {};
+  EXPECT_FALSE(id_manager.IsUsed(0));
+  EXPECT_FALSE(id_manager.IsUsed(-1));
+  EXPECT_FALSE(id_manager.IsUsed(std::numeric_limits<std::int8_t>::min()));
+  for(int i {1}; i <= std::numeric_limits<std::int8_t>::max(); ++i)
+  {
+    ASSERT_EQ(id_manager.GetId(), i);
+    EXPECT_EQ(id_manager.NumberOfUsedIds(), i);
+  }
+  EXPECT_THROW(id_manager.GetId(), std::length_error);
+  EXPECT_FALSE(id_manager.IsUsed(0));
+  EXPECT_TRUE(id_manager.IsUsed(std::numeric_limits<std::int8_t>::max()));
+  EXPECT_THROW(id_manager.ReleaseId(0), std::logic_error);
+  ASSERT_NO_THROW(id_manager.ReleaseId(64));
+  EXPECT_EQ(id_manager.GetId(), 64);
+}
+
+TEST(BitsetIdManager, FullRangeLeastUnused)
+{
+  as_components::BitsetIdManager<std::uint16_t> id_manager {};
+  constexpr int kMax {std::numeric_limits<std::uint16_t>::max()};
+  for(int i {1}; i <= kMax; ++i)
+  {
+    ASSERT_EQ(id_manager.GetId(), i);
+  }
+  EXPECT_EQ(id_manager.NumberOfUsedIds(), kMax);
+  EXPECT_THROW(id_manager.GetId(), std::length_error);
+  EXPECT_EQ(id_manager.NumberOfUsedIds(), kMax);
+
+  // IDs at word and summary-word boundaries and in the last word.
+  std::vector<int> released {kMax, 4096, 4095, 1, 63, 64, 65, 40000};
+  for(int id : released)
+  {
+    ASSERT_NO_THROW(id_manager.ReleaseId(static_cast<std::uint16_t>(id)));
+    EXPECT_FALSE(id_manager.IsUsed(static_cast<std::uint16_t>(id)));
+  }
+  EXPECT_THROW(id_manager.ReleaseId(4096), std::logic_error);
+  EXPECT_EQ(id_manager.NumberOfUsedIds(), kMax - released.size());
+  std::sort(released.begin(), released.end());
+  for(int id : released)
+  {
+    EXPECT_EQ(id_manager.GetId(), id);
+  }
+  EXPECT_THROW(id_manager.GetId(), std::length_error);
+}
+
+TEST(BitsetIdManager, AgreementWithIntervalIdManager)
+{
+  as_components::BitsetIdManager<std::uint16_t> bitset_manager {};
+  as_components::IntervalIdManager<std::uint16_t> interval_manager {};
+  std::vector<std::uint16_t> in_use {};
+  std::mt19937 engine {5U};
+  for(int i {0}; i < 20000; ++i)
+  {
+    // Bias toward acquisition so that the used set grows over the sequence.
+    if(in_use.empty() || (engine() % 8U) < 5U)
+    {
+      std::uint16_t bitset_id {bitset_manager.GetId()};
+      std::uint16_t interval_id {interval_manager.GetId()};
+      ASSERT_EQ(bitset_id, interval_id) << "iteration count: " << i;
+      in_use.push_back(bitset_id);
+    }
+    else
+    {
+      std::size_t index {engine() % in_use.size()};
+      std::uint16_t id {in_use[index]};
+      in_use[index] = in_use.back();
+      in_use.pop_back();
+      ASSERT_NO_THROW(bitset_manager.ReleaseId(id));
+      ASSERT_NO_THROW(interval_manager.ReleaseId(id));
+      EXPECT_FALSE(bitset_manager.IsUsed(id));
+    }
+    ASSERT_EQ(bitset_manager.NumberOfUsedIds(),
+      interval_manager.NumberOfUsedIds());
+  }
+}
+
+// Bulk operations
+// Test explanation
+// Examined properties:
+// 1) GetIds(n, out) writes the n least unused IDs in increasing order and
+//    regards them as used. When too few IDs are unused, std::length_error is
+//    thrown and the instance is unchanged.
+// 2) ReleaseRange(lo, hi) releases exactly the used IDs of [lo, hi] and
+//    returns their number. Unused IDs and values less than 1 are ignored.
+// 3) ReleaseAll returns an instance to the state of a newly-constructed
+//    instance.
+// 4) The used-interval iterators of each representation visit the minimal
+//    set of disjoint intervals of used IDs in increasing order.
+//
+// Test Cases:
+// 1) IntervalIdManager<int>: GetIds on an empty instance, GetIds which fills
+//    gaps and merges intervals, ReleaseRange which splits an interval,
+//    truncates intervals from above and below, and removes whole intervals,
+//    and ReleaseAll. The interval list is checked after each step.
+// 2) BitsetIdManager<std::uint16_t> and IntervalIdManager<std::uint16_t> are
+//    subjected to the same pseudo-random sequence of GetIds, ReleaseRange,
+//    ReleaseId, and ReleaseAll calls. The written IDs, return values, used-ID
+//    counts, and interval lists are compared. GetIds requests which exceed
+//    the unused ID count are included.
+
+namespace {
+
+template<typename Manager>
+std::vector<std::pair<int, int>> UsedIntervals(const Manager& manager)
+{
+  std::vector<std::pair<int, int>> intervals {};
+  for(typename Manager::UsedIntervalIterator
+    iter {manager.UsedIntervalsBegin()};
+    iter != manager.UsedIntervalsEnd(); ++iter)
+  {
+    intervals.emplace_back(iter->first, iter->second);
+  }
+  return intervals;
+}
+
+} // namespace
+
+TEST(IdManagerBulk, IntervalOperations)
+{
+  using IntervalList = std::vector<std::pair<int, int>>;
+  as_components::IntervalIdManager<int> id_manager {};
+  std::vector<int> ids {};
+
+  EXPECT_EQ(UsedIntervals(id_manager), IntervalList {});
+  id_manager.GetIds(0, std::back_inserter(ids));
+  EXPECT_TRUE(ids.empty());
+  id_manager.GetIds(10, std::back_inserter(ids));
+  EXPECT_EQ(ids, (std::vector<int> {1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+  EXPECT_EQ(UsedIntervals(id_manager), (IntervalList {{1, 10}}));
+  EXPECT_EQ(id_manager.NumberOfUsedIds(), 10);
+
+  // Split [1, 10].
+  EXPECT_EQ(id_manager.ReleaseRange(4, 5), 2);
+  EXPECT_EQ(UsedIntervals(id_manager), (IntervalList {{1, 3}, {6, 10}}));
+  // Truncate from below and from above; unused IDs are ignored.
+  EXPECT_EQ(id_manager.ReleaseRange(-5, 1), 1);
+  EXPECT_EQ(id_manager.ReleaseRange(9, 20), 2);
+  EXPECT_EQ(UsedIntervals(id_manager), (IntervalList {{2, 3}, {6, 8}}));
+  EXPECT_EQ(id_manager.ReleaseRange(4, 5), 0);
+  EXPECT_EQ(id_manager.ReleaseRange(5, 4), 0);
+  EXPECT_EQ(id_manager.NumberOfUsedIds(), 5);
+
+  // Fill the gaps [1, 1] and [4, 5] and extend the last interval.
+  ids.clear();
+  id_manager.GetIds(5, std::back_inserter(ids));
+  EXPECT_EQ(ids, (std::vector<int> {1, 4, 5, 9, 10}));
+  EXPECT_EQ(UsedIntervals(id_manager), (IntervalList {{1, 10}}));
+
+  // Remove whole intervals, truncate around them.
+  EXPECT_EQ(id_manager.ReleaseRange(2, 2), 1);
+  EXPECT_EQ(id_manager.ReleaseRange(5, 5), 1);
+  EXPECT_EQ(id_manager.ReleaseRange(8, 8), 1);
+  EXPECT_EQ(UsedIntervals(id_manager),
+    (IntervalList {{1, 1}, {3, 4}, {6, 7}, {9, 10}}));
+  EXPECT_EQ(id_manager.ReleaseRange(2, 9), 5);
+  EXPECT_EQ(UsedIntervals(id_manager), (IntervalList {{1, 1}, {10, 10}}));
+  EXPECT_EQ(id_manager.NumberOfUsedIds(), 2);
+  // A partial fill of a gap which does not start at 1.
+  ids.clear();
+  id_manager.GetIds(3, std::back_inserter(ids));
+  EXPECT_EQ(ids, (std::vector<int> {2, 3, 4}));
+  EXPECT_EQ(UsedIntervals(id_manager), (IntervalList {{1, 4}, {10, 10}}));
+
+  id_manager.ReleaseAll();
+  EXPECT_EQ(id_manager.NumberOfUsedIds(), 0);
+  EXPECT_EQ(UsedIntervals(id_manager), IntervalList {});
+  EXPECT_EQ(id_manager.GetId(), 1);
+
+  // A partial fill of the gap before the first interval.
+  id_manager.ReleaseAll();
+  ASSERT_EQ(id_manager.ReleaseRange(1, 1), 0);
+  id_manager.GetIds(10, std::back_inserter(ids));
+  EXPECT_EQ(id_manager.ReleaseRange(1, 5), 5);
+  ids.clear();
+  id_manager.GetIds(2, std::back_inserter(ids));
+  EXPECT_EQ(ids, (std::vector<int> {1, 2}));
+  EXPECT_EQ(UsedIntervals(id_manager), (IntervalList {{1, 2}, {6, 10}}));
+}
+
+TEST(IdManagerBulk, BitsetAgreesWithInterval)
+{
+  constexpr int kMax {std::numeric_limits<std::uint16_t>::max()};
+  as_components::BitsetIdManager<std::uint16_t> bitset_manager {};
+  as_components::IntervalIdManager<std::uint16_t> interval_manager {};
+  std::mt19937 engine {17U};
+  std::uniform_int_distribution<int> count_distribution {0, 12000};
+  std::uniform_int_distribution<int> id_distribution {0, kMax};
+  for(int i {0}; i < 400; ++i)
+  {
+    unsigned int action {static_cast<unsigned int>(engine() % 32U)};
+    if(action < 16U)
+    {
+      int n {count_distribution(engine)};
+      std::vector<std::uint16_t> bitset_ids {};
+      std::vector<std::uint16_t> interval_ids {};
+      if((kMax - bitset_manager.NumberOfUsedIds()) < n)
+      {
+        std::vector<std::pair<int, int>> before {UsedIntervals(bitset_manager)};
+        EXPECT_THROW(bitset_manager.GetIds(static_cast<std::uint16_t>(n),
+          std::back_inserter(bitset_ids)), std::length_error);
+        EXPECT_THROW(interval_manager.GetIds(static_cast<std::uint16_t>(n),
+          std::back_inserter(interval_ids)), std::length_error);
+        EXPECT_EQ(UsedIntervals(bitset_manager), before);
+      }
+      else
+      {
+        bitset_manager.GetIds(static_cast<std::uint16_t>(n),
+          std::back_inserter(bitset_ids));
+        interval_manager.GetIds(static_cast<std::uint16_t>(n),
+          std::back_inserter(interval_ids));
+        ASSERT_EQ(bitset_ids.size(), static_cast<std::size_t>(n));
+        ASSERT_EQ(bitset_ids, interval_ids) << "iteration count: " << i;
+        EXPECT_TRUE(std::is_sorted(bitset_ids.begin(), bitset_ids.end()));
+      }
+    }
+    else if(action < 28U)
+    {
+      int lo {id_distribution(engine)};
+      int hi {lo + (count_distribution(engine) / 4) - 100};
+      hi = (hi > kMax) ? kMax : ((hi < 0) ? 0 : hi);
+      std::uint16_t bitset_released {bitset_manager.ReleaseRange(
+        static_cast<std::uint16_t>(lo), static_cast<std::uint16_t>(hi))};
+      std::uint16_t interval_released {interval_manager.ReleaseRange(
+        static_cast<std::uint16_t>(lo), static_cast<std::uint16_t>(hi))};
+      ASSERT_EQ(bitset_released, interval_released) << "iteration count: " << i;
+    }
+    else if(action < 31U)
+    {
+      std::uint16_t id {static_cast<std::uint16_t>(id_distribution(engine))};
+      if(bitset_manager.IsUsed(id))
+      {
+        ASSERT_NO_THROW(bitset_manager.ReleaseId(id));
+        ASSERT_NO_THROW(interval_manager.ReleaseId(id));
+      }
+      else
+      {
+        EXPECT_THROW(bitset_manager.ReleaseId(id), std::logic_error);
+        EXPECT_FALSE(interval_manager.IsUsed(id));
+      }
+    }
+    else
+    {
+      bitset_manager.ReleaseAll();
+      interval_manager.ReleaseAll();
+      EXPECT_EQ(bitset_manager.NumberOfUsedIds(), 0U);
+      EXPECT_EQ(bitset_manager.GetId(), 1U);
+      EXPECT_EQ(interval_manager.GetId(), 1U);
+    }
+    ASSERT_EQ(bitset_manager.NumberOfUsedIds(),
+      interval_manager.NumberOfUsedIds()) << "iteration count: " << i;
+    ASSERT_EQ(UsedIntervals(bitset_manager), UsedIntervals(interval_manager))
+      << "iteration count: " << i;
+  }
+}
@@ -63,6 +63,7 @@ cd /usr/local/src/as_components &&
 # configured.
 if [[ !(-d external_repo_links) ]]; then
     ./make_repository_symlinks.sh \
+        googlebenchmark=/usr/local/src/googlebenchmark \
         googletest=/usr/local/src/googletest \
         simple_bazel_cpp_toolchain=/usr/local/src/simple_bazel_cpp_toolchain    
 fi &&
@@ -63,6 +63,7 @@
 # path is extracted and associated with its respective key.
 declare -A external_dependency_map
 external_dependency_map=(\
+  [googlebenchmark]= \
   [googletest]= \
   [simple_bazel_cpp_toolchain]=)
 
@@ -94,11 +95,14 @@ function CreateSymlinksForExternalDependencies
 {
   mkdir -v external_repo_links || return 1
   local original_directory=${PWD}
+  cd "${external_dependency_map[googlebenchmark]}"
+  local absolute_googlebenchmark_directory=${PWD}
   cd "${external_dependency_map[googletest]}"
   local absolute_googletest_directory=${PWD}
   cd "${external_dependency_map[simple_bazel_cpp_toolchain]}"
   local absolute_toolchain_directory=${PWD}
   cd ${original_directory}
+  ln -v -s ${absolute_googlebenchmark_directory} external_repo_links/googlebenchmark &&
   ln -v -s ${absolute_googletest_directory} external_repo_links/googletest &&
   ln -v -s ${absolute_toolchain_directory}  external_repo_links/simple_bazel_cpp_toolchain ||
   return 1